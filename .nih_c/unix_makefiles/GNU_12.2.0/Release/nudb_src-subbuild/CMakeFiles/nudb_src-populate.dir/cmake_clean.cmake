@@ -0,0 +1,17 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/nudb_src-populate"
+  "CMakeFiles/nudb_src-populate-complete"
+  "nudb_src-populate-prefix/src/nudb_src-populate-stamp/nudb_src-populate-build"
+  "nudb_src-populate-prefix/src/nudb_src-populate-stamp/nudb_src-populate-configure"
+  "nudb_src-populate-prefix/src/nudb_src-populate-stamp/nudb_src-populate-download"
+  "nudb_src-populate-prefix/src/nudb_src-populate-stamp/nudb_src-populate-install"
+  "nudb_src-populate-prefix/src/nudb_src-populate-stamp/nudb_src-populate-mkdir"
+  "nudb_src-populate-prefix/src/nudb_src-populate-stamp/nudb_src-populate-patch"
+  "nudb_src-populate-prefix/src/nudb_src-populate-stamp/nudb_src-populate-test"
+  "nudb_src-populate-prefix/src/nudb_src-populate-stamp/nudb_src-populate-update"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/nudb_src-populate.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,22 @@
+# Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+# file Copyright.txt or https://cmake.org/licensing for details.
+
+cmake_minimum_required(VERSION 3.5)
+
+file(MAKE_DIRECTORY
+  "/root/repo/.nih_c/unix_makefiles/GNU_12.2.0/Release/src/rocksdb"
+  "/root/repo/.nih_c/unix_makefiles/GNU_12.2.0/Release/src/rocksdb-build"
+  "/root/repo/.nih_c/unix_makefiles/GNU_12.2.0/Release"
+  "/root/repo/.nih_c/unix_makefiles/GNU_12.2.0/Release/tmp"
+  "/root/repo/.nih_c/unix_makefiles/GNU_12.2.0/Release/src/rocksdb-stamp"
+  "/root/repo/.nih_c/unix_makefiles/GNU_12.2.0/Release/src"
+  "/root/repo/.nih_c/unix_makefiles/GNU_12.2.0/Release/src/rocksdb-stamp"
+)
+
+set(configSubDirs Debug;Release)
+foreach(subDir IN LISTS configSubDirs)
+    file(MAKE_DIRECTORY "/root/repo/.nih_c/unix_makefiles/GNU_12.2.0/Release/src/rocksdb-stamp/${subDir}")
+endforeach()
+if(cfgdir)
+  file(MAKE_DIRECTORY "/root/repo/.nih_c/unix_makefiles/GNU_12.2.0/Release/src/rocksdb-stamp${cfgdir}") # cfgdir has leading slash
+endif()
@@ -132,7 +132,7 @@ RCLConsensus::Adaptor::share(RCLCxTx const& tx)
     if (app_.getHashRouter().shouldRelay(tx.id()))
     {
         JLOG(j_.debug()) << "Relaying disputed tx " << tx.id();
-        auto const slice = tx.tx_.slice();
+        auto const slice = tx.tx_->slice();
         protocol::TMTransaction msg;
         msg.set_rawtransaction(slice.data(), slice.size());
         msg.set_status(protocol::tsNEW);
@@ -277,8 +277,8 @@ RCLConsensus::Adaptor::onClose(
             tx.first->getTransactionID();
         Serializer s(2048);
         tx.first->add(s);
-        initialSet->addItem(
-            SHAMapItem(tx.first->getTransactionID(), std::move(s)),
+        initialSet->addGiveItem(
+            make_shamapitem(tx.first->getTransactionID(), s),
             true,
             false);
     }
@@ -306,7 +306,7 @@ RCLConsensus::Adaptor::onClose(
         RCLCensorshipDetector<TxID, LedgerIndex>::TxIDSeqVec proposed;
 
         initialSet->visitLeaves(
-            [&proposed, seq](std::shared_ptr<SHAMapItem const> const& item)
+            [&proposed, seq](boost::intrusive_ptr<SHAMapItem const> const& item)
             {
                 proposed.emplace_back(item->key(), seq);
             });
@@ -442,7 +442,7 @@ RCLConsensus::Adaptor::doAccept(
         std::vector<TxID> accepted;
 
         result.txns.map_->visitLeaves (
-            [&accepted](std::shared_ptr<SHAMapItem const> const& item)
+            [&accepted](boost::intrusive_ptr<SHAMapItem const> const& item)
             {
                 accepted.push_back(item->key());
             });
@@ -502,7 +502,7 @@ RCLConsensus::Adaptor::doAccept(
                         << "Test applying disputed transaction that did"
                         << " not get in " << it.second.tx().id();
 
-                    SerialIter sit(it.second.tx().tx_.slice());
+                    SerialIter sit(it.second.tx().tx_->slice());
                     auto txn = std::make_shared<STTx const>(sit);
 
                     if (isPseudoTx(*txn))
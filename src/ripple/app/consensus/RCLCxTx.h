@@ -17,17 +17,17 @@ public:
     using ID = uint256;
 
     
-    RCLCxTx(SHAMapItem const& txn) : tx_{txn}
+    RCLCxTx(SHAMapItem const& txn) : tx_{&txn}
     {
     }
 
     ID const&
     id() const
     {
-        return tx_.key();
+        return tx_->key();
     }
 
-    SHAMapItem const tx_;
+    boost::intrusive_ptr<SHAMapItem const> const tx_;
 };
 
 
@@ -51,8 +51,7 @@ public:
         bool
         insert(Tx const& t)
         {
-            return map_->addItem(
-                SHAMapItem{t.id(), t.tx_.peekData()}, true, false);
+            return map_->addGiveItem(t.tx_, true, false);
         }
 
         
@@ -82,7 +81,7 @@ public:
     }
 
     
-    std::shared_ptr<const SHAMapItem> const&
+    boost::intrusive_ptr<SHAMapItem const> const&
     find(Tx::ID const& entry) const
     {
         return map_->peekItem(entry);
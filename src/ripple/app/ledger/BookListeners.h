@@ -29,7 +29,7 @@ public:
 
     
     void
-    publish(Json::Value const& jvObj, hash_set<std::uint64_t>& havePublished);
+    publish(InfoSubMessage const& msg, hash_set<std::uint64_t>& havePublished);
 
 private:
     std::recursive_mutex mLock;
@@ -130,6 +130,11 @@ private:
     neededStateHashes (
         int max, SHAMapSyncFilter* filter) const;
 
+    void findNeighbor ();
+
+    SHAMap const*
+    neighborState () const;
+
     std::shared_ptr<Ledger> mLedger;
     bool mHaveHeader;
     bool mHaveState;
@@ -143,6 +148,10 @@ private:
 
     SHAMapAddNode mStats;
 
+    std::shared_ptr<Ledger const> mNeighbor;
+    bool mNeighborChecked {false};
+    int mLocalNodes {0};
+
     std::mutex mReceivedDataLock;
     std::vector <PeerDataPairType> mReceivedData;
     bool mReceiveDispatched;
@@ -3,6 +3,7 @@
 #include <ripple/app/ledger/Ledger.h>
 #include <ripple/app/ledger/AcceptedLedger.h>
 #include <ripple/app/ledger/InboundLedgers.h>
+#include <ripple/app/ledger/LedgerDBWriter.h>
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/consensus/LedgerTiming.h>
 #include <ripple/app/ledger/LedgerToJson.h>
@@ -97,7 +98,7 @@ public:
     sles_type::value_type
     dereference() const override
     {
-        auto const item = *iter_;
+        auto const& item = *iter_;
         SerialIter sit(item.slice());
         return std::make_shared<SLE const>(
             sit, item.key());
@@ -148,7 +149,7 @@ public:
     txs_type::value_type
     dereference() const override
     {
-        auto const item = *iter_;
+        auto const& item = *iter_;
         if (metadata_)
             return deserializeTxPlusMeta(item);
         return { deserializeTx(item), nullptr };
@@ -341,8 +342,8 @@ Ledger::setAccepted(NetClock::time_point closeTime,
 
 bool Ledger::addSLE (SLE const& sle)
 {
-    SHAMapItem item (sle.key(), sle.getSerializer());
-    return stateMap_->addItem(std::move(item), false, false);
+    return stateMap_->addGiveItem(
+        make_shamapitem(sle.key(), sle.getSerializer()), false, false);
 }
 
 
@@ -500,9 +501,7 @@ Ledger::rawInsert(std::shared_ptr<SLE> const& sle)
 {
     Serializer ss;
     sle->add(ss);
-    auto item = std::make_shared<
-        SHAMapItem const>(sle->key(),
-            std::move(ss));
+    auto item = make_shamapitem(sle->key(), ss);
     if (! stateMap_->addGiveItem(
             std::move(item), false, false))
         LogicError("Ledger::rawInsert: key already exists");
@@ -513,9 +512,7 @@ Ledger::rawReplace(std::shared_ptr<SLE> const& sle)
 {
     Serializer ss;
     sle->add(ss);
-    auto item = std::make_shared<
-        SHAMapItem const>(sle->key(),
-            std::move(ss));
+    auto item = make_shamapitem(sle->key(), ss);
     if (! stateMap_->updateGiveItem(
             std::move(item), false, false))
         LogicError("Ledger::rawReplace: key not found");
@@ -533,8 +530,7 @@ Ledger::rawTxInsert (uint256 const& key,
         metaData->getDataLength () + 16);
     s.addVL (txn->peekData ());
     s.addVL (metaData->peekData ());
-    auto item = std::make_shared<
-        SHAMapItem const> (key, std::move(s));
+    auto item = make_shamapitem (key, s);
     if (! txMap().addGiveItem
             (std::move(item), true, true))
         LogicError("duplicate_tx: " + to_string(key));
@@ -744,7 +740,8 @@ void Ledger::updateSkipList ()
 static bool saveValidatedLedger (
     Application& app,
     std::shared_ptr<Ledger const> const& ledger,
-    bool current)
+    bool current,
+    bool synchronous)
 {
     auto j = app.journal ("Ledger");
     auto seq = ledger->info().seq;
@@ -757,14 +754,6 @@ static bool saveValidatedLedger (
     JLOG (j.trace())
         << "saveValidatedLedger "
         << (current ? "" : "fromAcquire ") << seq;
-    static boost::format deleteLedger (
-        "DELETE FROM Ledgers WHERE LedgerSeq = %u;");
-    static boost::format deleteTrans1 (
-        "DELETE FROM Transactions WHERE LedgerSeq = %u;");
-    static boost::format deleteTrans2 (
-        "DELETE FROM AccountTransactions WHERE LedgerSeq = %u;");
-    static boost::format deleteAcctTrans (
-        "DELETE FROM AccountTransactions WHERE TransID = '%s';");
 
     if (! ledger->info().accountHash.isNonZero ())
     {
@@ -810,136 +799,36 @@ static bool saveValidatedLedger (
         return false;
     }
 
-    {
-        auto db = app.getLedgerDB ().checkoutDb();
-        *db << boost::str (deleteLedger % seq);
-    }
+    LedgerDBWriter::Record record;
+    record.info = ledger->info();
+    record.txns.reserve (aLedger->getMap ().size ());
 
+    for (auto const& vt : aLedger->getMap ())
     {
-        auto db = app.getTxnDB ().checkoutDb ();
+        uint256 transactionID = vt.second->getTransactionID ();
 
-        soci::transaction tr(*db);
+        app.getMasterTransaction ().inLedger (
+            transactionID, seq);
 
-        *db << boost::str (deleteTrans1 % seq);
-        *db << boost::str (deleteTrans2 % seq);
+        LedgerDBWriter::Transaction txn;
+        txn.id = transactionID;
+        txn.txnSeq = vt.second->getTxnSeq ();
+        txn.metaSQL = vt.second->getTxn ()->getMetaSQL (
+            seq, vt.second->getEscMeta ());
 
-        std::string const ledgerSeq (std::to_string (seq));
+        auto const& accts = vt.second->getAffected ();
+        txn.accounts.assign (accts.begin (), accts.end ());
 
-        for (auto const& vt : aLedger->getMap ())
+        if (accts.empty ())
         {
-            uint256 transactionID = vt.second->getTransactionID ();
-
-            app.getMasterTransaction ().inLedger (
-                transactionID, seq);
-
-            std::string const txnId (to_string (transactionID));
-            std::string const txnSeq (std::to_string (vt.second->getTxnSeq ()));
-
-            *db << boost::str (deleteAcctTrans % transactionID);
-
-            auto const& accts = vt.second->getAffected ();
-
-            if (!accts.empty ())
-            {
-                std::string sql (
-                    "INSERT INTO AccountTransactions "
-                    "(TransID, Account, LedgerSeq, TxnSeq) VALUES ");
-
-                sql.reserve (sql.length () + (accts.size () * 128));
-
-                bool first = true;
-                for (auto const& account : accts)
-                {
-                    if (!first)
-                        sql += ", ('";
-                    else
-                    {
-                        sql += "('";
-                        first = false;
-                    }
-
-                    sql += txnId;
-                    sql += "','";
-                    sql += app.accountIDCache().toBase58(account);
-                    sql += "',";
-                    sql += ledgerSeq;
-                    sql += ",";
-                    sql += txnSeq;
-                    sql += ")";
-                }
-                sql += ";";
-                JLOG (j.trace()) << "ActTx: " << sql;
-                *db << sql;
-            }
-            else
-            {
-                JLOG (j.warn())
-                    << "Transaction in ledger " << seq
-                    << " affects no accounts";
-                JLOG (j.warn())
-                    << vt.second->getTxn()->getJson(JsonOptions::none);
-            }
-
-            *db <<
-               (STTx::getMetaSQLInsertReplaceHeader () +
-                vt.second->getTxn ()->getMetaSQL (
-                    seq, vt.second->getEscMeta ()) + ";");
+            JLOG (j.warn())
+                << vt.second->getTxn()->getJson(JsonOptions::none);
         }
 
-        tr.commit ();
-    }
-
-    {
-        static std::string addLedger(
-            R"sql(INSERT OR REPLACE INTO Ledgers
-                (LedgerHash,LedgerSeq,PrevHash,TotalCoins,ClosingTime,PrevClosingTime,
-                CloseTimeRes,CloseFlags,AccountSetHash,TransSetHash)
-            VALUES
-                (:ledgerHash,:ledgerSeq,:prevHash,:totalCoins,:closingTime,:prevClosingTime,
-                :closeTimeRes,:closeFlags,:accountSetHash,:transSetHash);)sql");
-        static std::string updateVal(
-            R"sql(UPDATE Validations SET LedgerSeq = :ledgerSeq, InitialSeq = :initialSeq
-                WHERE LedgerHash = :ledgerHash;)sql");
-
-        auto db (app.getLedgerDB ().checkoutDb ());
-
-        soci::transaction tr(*db);
-
-        auto const hash = to_string (ledger->info().hash);
-        auto const parentHash = to_string (ledger->info().parentHash);
-        auto const drops = to_string (ledger->info().drops);
-        auto const closeTime =
-            ledger->info().closeTime.time_since_epoch().count();
-        auto const parentCloseTime =
-            ledger->info().parentCloseTime.time_since_epoch().count();
-        auto const closeTimeResolution =
-            ledger->info().closeTimeResolution.count();
-        auto const closeFlags = ledger->info().closeFlags;
-        auto const accountHash = to_string (ledger->info().accountHash);
-        auto const txHash = to_string (ledger->info().txHash);
-
-        *db << addLedger,
-            soci::use(hash),
-            soci::use(seq),
-            soci::use(parentHash),
-            soci::use(drops),
-            soci::use(closeTime),
-            soci::use(parentCloseTime),
-            soci::use(closeTimeResolution),
-            soci::use(closeFlags),
-            soci::use(accountHash),
-            soci::use(txHash);
-
-
-        *db << updateVal,
-            soci::use(seq),
-            soci::use(seq),
-            soci::use(hash);
-
-        tr.commit();
+        record.txns.push_back (std::move (txn));
     }
 
-    app.pendingSaves().finishWork(seq);
+    app.getLedgerDBWriter().save (std::move (record), synchronous);
     return true;
 }
 
@@ -982,13 +871,13 @@ bool pendSaveValidated (
     if (!isSynchronous &&
         app.getJobQueue().addJob (jobType, jobName,
         [&app, ledger, isCurrent] (Job&) {
-            saveValidatedLedger(app, ledger, isCurrent);
+            saveValidatedLedger(app, ledger, isCurrent, false);
         }))
     {
         return true;
     }
 
-    return saveValidatedLedger(app, ledger, isCurrent);
+    return saveValidatedLedger(app, ledger, isCurrent, true);
 }
 
 void
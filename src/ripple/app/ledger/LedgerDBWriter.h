@@ -0,0 +1,111 @@
+
+
+#ifndef RIPPLE_APP_LEDGER_LEDGERDBWRITER_H_INCLUDED
+#define RIPPLE_APP_LEDGER_LEDGERDBWRITER_H_INCLUDED
+
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/core/Stoppable.h>
+#include <ripple/json/json_value.h>
+#include <ripple/ledger/ReadView.h>
+#include <ripple/protocol/AccountID.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ripple {
+
+class Application;
+
+
+class LedgerDBWriter
+    : public Stoppable
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    static std::size_t constexpr maxBatch = 16;
+
+    static std::size_t constexpr maxQueued = 64;
+
+    static std::size_t constexpr rowsPerInsert = 100;
+
+    struct Transaction
+    {
+        uint256 id;
+        std::uint32_t txnSeq;
+        std::string metaSQL;
+        std::vector<AccountID> accounts;
+    };
+
+    struct Record
+    {
+        LedgerInfo info;
+        std::vector<Transaction> txns;
+        clock_type::time_point queued;
+    };
+
+    LedgerDBWriter (Application& app, Stoppable& parent,
+        beast::Journal journal);
+
+    LedgerDBWriter (LedgerDBWriter const&) = delete;
+    LedgerDBWriter& operator= (LedgerDBWriter const&) = delete;
+
+    
+    void
+    save (Record&& record, bool synchronous);
+
+    
+    bool
+    overloaded () const;
+
+    std::size_t
+    size () const;
+
+    Json::Value
+    getJson () const;
+
+private:
+    void
+    onStop () override;
+
+    void
+    schedule (std::unique_lock<std::mutex>& lock);
+
+    void
+    drain (std::unique_lock<std::mutex>& lock);
+
+    void
+    write (std::vector<Record>& batch);
+
+    void
+    writeTransactions (std::vector<Record> const& batch);
+
+    void
+    writeLedgers (std::vector<Record> const& batch);
+
+    Application& app_;
+    beast::Journal j_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<Record> pending_;
+    bool scheduled_ = false;
+    bool writing_ = false;
+    bool stopping_ = false;
+
+    std::uint64_t batches_ = 0;
+    std::uint64_t ledgers_ = 0;
+    std::uint64_t transactions_ = 0;
+    std::size_t maxBatchSize_ = 0;
+    std::chrono::milliseconds lastLatency_ {0};
+    std::chrono::milliseconds peakLatency_ {0};
+    std::chrono::milliseconds totalLatency_ {0};
+};
+
+}
+
+#endif
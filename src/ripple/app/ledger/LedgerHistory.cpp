@@ -374,7 +374,7 @@ LedgerHistory::handleMismatch(
         }
         else
         {
-            if ((*b)->peekData() != (*v)->peekData())
+            if ((*b)->slice() != (*v)->slice())
             {
                 log_metadata_difference(
                     *builtLedger,
@@ -16,6 +16,8 @@ namespace ripple {
 class LedgerHistory
 {
 public:
+    using LedgersByHash = TaggedCache <LedgerHash, Ledger const>;
+
     LedgerHistory (beast::insight::Collector::ptr const& collector,
         Application& app);
 
@@ -29,6 +31,11 @@ public:
         return m_ledgers_by_hash.getHitRate ();
     }
 
+    LedgersByHash& getLedgerCache ()
+    {
+        return m_ledgers_by_hash;
+    }
+
     
     std::shared_ptr<Ledger const>
     getLedgerBySeq (LedgerIndex ledgerIndex);
@@ -81,8 +88,6 @@ private:
     beast::insight::Collector::ptr collector_;
     beast::insight::Counter mismatch_counter_;
 
-    using LedgersByHash = TaggedCache <LedgerHash, Ledger const>;
-
     LedgersByHash m_ledgers_by_hash;
 
     struct cv_entry
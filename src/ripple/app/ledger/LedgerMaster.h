@@ -149,6 +149,7 @@ public:
     void tune (int size, std::chrono::seconds age);
     void sweep ();
     float getCacheHitRate ();
+    LedgerHistory::LedgersByHash& getLedgerCache ();
 
     void checkAccept (std::shared_ptr<Ledger const> const& ledger);
     void checkAccept (uint256 const& hash, std::uint32_t seq);
@@ -1,12 +1,14 @@
 
 
 #include <ripple/app/ledger/OrderBookDB.h>
+#include <ripple/app/ledger/AcceptedLedger.h>
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/basics/Log.h>
 #include <ripple/core/Config.h>
 #include <ripple/core/JobQueue.h>
 #include <ripple/protocol/Indexes.h>
+#include <algorithm>
 
 namespace ripple {
 
@@ -14,6 +16,8 @@ OrderBookDB::OrderBookDB (Application& app, Stoppable& parent)
     : Stoppable ("OrderBookDB", parent)
     , app_ (app)
     , mSeq (0)
+    , mPubSeq (0)
+    , mUpdating (0)
     , j_ (app.journal ("OrderBookDB"))
 {
 }
@@ -22,6 +26,7 @@ void OrderBookDB::invalidate ()
 {
     std::lock_guard <std::recursive_mutex> sl (mLock);
     mSeq = 0;
+    mPubSeq = 0;
 }
 
 void OrderBookDB::setup(
@@ -45,6 +50,9 @@ void OrderBookDB::setup(
             << "Advancing from " << mSeq << " to " << seq;
 
         mSeq = seq;
+
+        if (app_.config().PATH_SEARCH_MAX != 0)
+            ++mUpdating;
     }
 
     if (app_.config().PATH_SEARCH_MAX == 0)
@@ -52,10 +60,15 @@ void OrderBookDB::setup(
     }
     else if (app_.config().standalone())
         update(ledger);
-    else
-        app_.getJobQueue().addJob(
+    else if (! app_.getJobQueue().addJob(
             jtUPDATE_PF, "OrderBookDB::update",
-            [this, ledger] (Job&) { update(ledger); });
+            [this, ledger] (Job&) { update(ledger); }))
+    {
+        std::lock_guard <std::recursive_mutex> sl (mLock);
+        mSeq = 0;
+        if (mUpdating > 0 && --mUpdating == 0)
+            mPendingDeltas.clear ();
+    }
 }
 
 void OrderBookDB::update(
@@ -73,6 +86,15 @@ void OrderBookDB::update(
         return;
     }
 
+    auto failed = [this]
+    {
+        std::lock_guard <std::recursive_mutex> sl (mLock);
+        mSeq = 0;
+        mPubSeq = 0;
+        if (mUpdating > 0 && --mUpdating == 0)
+            mPendingDeltas.clear ();
+    };
+
     int books = 0;
 
     try
@@ -83,8 +105,7 @@ void OrderBookDB::update(
             {
                 JLOG (j_.info())
                     << "OrderBookDB::update exiting due to isStopping";
-                std::lock_guard <std::recursive_mutex> sl (mLock);
-                mSeq = 0;
+                failed ();
                 return;
             }
 
@@ -115,8 +136,7 @@ void OrderBookDB::update(
     {
         JLOG (j_.info())
             << "OrderBookDB::update encountered a missing node";
-        std::lock_guard <std::recursive_mutex> sl (mLock);
-        mSeq = 0;
+        failed ();
         return;
     }
 
@@ -125,13 +145,228 @@ void OrderBookDB::update(
     {
         std::lock_guard <std::recursive_mutex> sl (mLock);
 
+        auto next = ledger->info().seq + 1;
+        for (auto const& delta : mPendingDeltas)
+        {
+            if (delta.first < next)
+                continue;
+            if (delta.first != next)
+                break;
+            applyDelta (delta.second, sourceMap, destMap, XRPBooks);
+            ++next;
+        }
+
+        JLOG (j_.debug())
+            << "OrderBookDB::update caught up to " << (next - 1);
+
         mXRPBooks.swap(XRPBooks);
         mSourceMap.swap(sourceMap);
         mDestMap.swap(destMap);
+        mPubSeq = next - 1;
+        mSeq = std::max (mSeq, mPubSeq);
+
+        if (mUpdating > 0 && --mUpdating == 0)
+            mPendingDeltas.clear ();
     }
     app_.getLedgerMaster().newOrderBookDB();
 }
 
+void OrderBookDB::processLedger (
+    std::shared_ptr<ReadView const> const& ledger,
+    AcceptedLedger const& accepted)
+{
+    if (app_.config().PATH_SEARCH_MAX == 0)
+        return;
+
+    auto const seq = ledger->info().seq;
+    bool rebuild = false;
+    std::size_t changed = 0;
+
+    BookDelta delta;
+    try
+    {
+        delta = getDelta (*ledger, accepted);
+    }
+    catch (SHAMapMissingNode const&)
+    {
+        JLOG (j_.info())
+            << "OrderBookDB::processLedger encountered a missing node";
+        rebuild = true;
+    }
+
+    {
+        std::lock_guard <std::recursive_mutex> sl (mLock);
+
+        if (mUpdating != 0)
+        {
+            if (! rebuild)
+                mPendingDeltas[seq] = std::move (delta);
+            return;
+        }
+
+        if (mPubSeq != 0 && seq <= mPubSeq)
+        {
+            return;
+        }
+        else if (! rebuild && mPubSeq != 0 && seq == mPubSeq + 1)
+        {
+            changed = applyDelta (delta, mSourceMap, mDestMap, mXRPBooks);
+            mPubSeq = seq;
+            mSeq = seq;
+        }
+        else
+        {
+            rebuild = true;
+        }
+
+        if (rebuild)
+        {
+            JLOG (j_.info())
+                << "OrderBookDB::processLedger rebuilding at " << seq
+                << ", books current to " << mPubSeq;
+            mSeq = 0;
+        }
+    }
+
+    if (rebuild)
+    {
+        setup (ledger);
+    }
+    else if (changed != 0)
+    {
+        JLOG (j_.debug())
+            << "OrderBookDB::processLedger " << changed
+            << " books changed in " << seq;
+        app_.getLedgerMaster().newOrderBookDB();
+    }
+}
+
+OrderBookDB::BookDelta
+OrderBookDB::getDelta (ReadView const& ledger,
+    AcceptedLedger const& accepted) const
+{
+    BookDelta delta;
+
+    auto h160 = [](STObject const& obj, SField const& field)
+    {
+        return obj.isFieldPresent (field) ?
+            obj.getFieldH160 (field) : uint160 ();
+    };
+
+    for (auto const& item : accepted.getMap ())
+    {
+        auto const& meta = item.second->getMeta ();
+        if (! meta)
+            continue;
+
+        for (auto const& node : meta->getNodes ())
+        {
+            if (node.getFieldU16 (sfLedgerEntryType) != ltDIR_NODE)
+                continue;
+
+            bool const created = node.getFName () == sfCreatedNode;
+            if (! created && node.getFName () != sfDeletedNode)
+                continue;
+
+            auto data = dynamic_cast<const STObject*> (
+                node.peekAtPField (created ? sfNewFields : sfFinalFields));
+
+            if (! data ||
+                ! data->isFieldPresent (sfExchangeRate) ||
+                ! data->isFieldPresent (sfRootIndex) ||
+                data->getFieldH256 (sfRootIndex) !=
+                    node.getFieldH256 (sfLedgerIndex))
+            {
+                continue;
+            }
+
+            Book book;
+            book.in.currency = h160 (*data, sfTakerPaysCurrency);
+            book.in.account = h160 (*data, sfTakerPaysIssuer);
+            book.out.account = h160 (*data, sfTakerGetsIssuer);
+            book.out.currency = h160 (*data, sfTakerGetsCurrency);
+
+            if (created)
+            {
+                delta.added.push_back (book);
+            }
+            else
+            {
+                auto const base = getBookBase (book);
+                if (! ledger.succ (base, getQualityNext (base)))
+                    delta.removed.push_back (book);
+            }
+        }
+    }
+
+    return delta;
+}
+
+std::size_t
+OrderBookDB::applyDelta (BookDelta const& delta,
+    IssueToOrderBook& sourceMap, IssueToOrderBook& destMap,
+    hash_set <Issue>& XRPBooks)
+{
+    std::size_t changed = 0;
+
+    for (auto const& book : delta.added)
+    {
+        uint256 index = getBookBase (book);
+        auto& books = sourceMap[book.in];
+        if (std::any_of (books.begin (), books.end (),
+            [&index](OrderBook::pointer const& ob)
+            {
+                return ob->getBookBase () == index;
+            }))
+        {
+            continue;
+        }
+
+        auto orderBook = std::make_shared<OrderBook> (index, book);
+        books.push_back (orderBook);
+        destMap[book.out].push_back (orderBook);
+        if (isXRP (book.out))
+            XRPBooks.insert (book.in);
+        ++changed;
+    }
+
+    auto erase = [](IssueToOrderBook& map,
+        Issue const& issue, uint256 const& index)
+    {
+        auto it = map.find (issue);
+        if (it == map.end ())
+            return false;
+
+        auto& books = it->second;
+        auto const last = std::remove_if (books.begin (), books.end (),
+            [&index](OrderBook::pointer const& ob)
+            {
+                return ob->getBookBase () == index;
+            });
+        if (last == books.end ())
+            return false;
+
+        books.erase (last, books.end ());
+        if (books.empty ())
+            map.erase (it);
+        return true;
+    };
+
+    for (auto const& book : delta.removed)
+    {
+        uint256 index = getBookBase (book);
+        if (erase (sourceMap, book.in, index))
+        {
+            erase (destMap, book.out, index);
+            if (isXRP (book.out))
+                XRPBooks.erase (book.in);
+            ++changed;
+        }
+    }
+
+    return changed;
+}
+
 void OrderBookDB::addOrderBook(Book const& book)
 {
     bool toXRP = isXRP (book.out);
@@ -214,7 +449,7 @@ BookListeners::pointer OrderBookDB::getBookListeners (Book const& book)
 
 void OrderBookDB::processTxn (
     std::shared_ptr<ReadView const> const& ledger,
-        const AcceptedLedgerTx& alTx, Json::Value const& jvObj)
+        const AcceptedLedgerTx& alTx, InfoSubMessage const& msg)
 {
     std::lock_guard <std::recursive_mutex> sl (mLock);
     if (alTx.getResult () == tesSUCCESS)
@@ -251,7 +486,7 @@ void OrderBookDB::processTxn (
                             auto listeners = getBookListeners(b);
                             if (listeners)
                             {
-                                listeners->publish(jvObj, havePublished);
+                                listeners->publish(msg, havePublished);
                             }
                         }
                     }
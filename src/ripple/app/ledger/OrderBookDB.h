@@ -7,10 +7,14 @@
 #include <ripple/app/ledger/BookListeners.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/OrderBook.h>
+#include <map>
 #include <mutex>
+#include <vector>
 
 namespace ripple {
 
+class AcceptedLedger;
+
 class OrderBookDB
     : public Stoppable
 {
@@ -36,13 +40,32 @@ public:
 
     void processTxn (
         std::shared_ptr<ReadView const> const& ledger,
-        const AcceptedLedgerTx& alTx, Json::Value const& jvObj);
+        const AcceptedLedgerTx& alTx, InfoSubMessage const& msg);
+
+    
+    void processLedger (
+        std::shared_ptr<ReadView const> const& ledger,
+        AcceptedLedger const& accepted);
 
     using IssueToOrderBook = hash_map <Issue, OrderBook::List>;
 
 private:
+    struct BookDelta
+    {
+        std::vector<Book> added;
+        std::vector<Book> removed;
+    };
+
     void rawAddBook(Book const&);
 
+    
+    BookDelta getDelta (ReadView const& ledger,
+        AcceptedLedger const& accepted) const;
+
+    static std::size_t applyDelta (BookDelta const& delta,
+        IssueToOrderBook& sourceMap, IssueToOrderBook& destMap,
+        hash_set <Issue>& XRPBooks);
+
     Application& app_;
 
     IssueToOrderBook mSourceMap;
@@ -59,6 +82,13 @@ private:
 
     std::uint32_t mSeq;
 
+    
+    std::uint32_t mPubSeq;
+
+    
+    int mUpdating;
+    std::map <std::uint32_t, BookDelta> mPendingDeltas;
+
     beast::Journal j_;
 };
 
@@ -24,7 +24,7 @@ public:
     fetch (uint256 const& , bool checkDisk);
 
     std::shared_ptr<STTx const>
-    fetch (std::shared_ptr<SHAMapItem> const& item,
+    fetch (boost::intrusive_ptr<SHAMapItem const> const& item,
         SHAMapTreeNode::TNType type, bool checkDisk,
             std::uint32_t uCommitLedger);
 
@@ -7,7 +7,9 @@
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/CanonicalTXSet.h>
 #include <ripple/app/tx/apply.h>
+#include <ripple/core/JobQueue.h>
 #include <ripple/protocol/Feature.h>
+#include <thread>
 
 namespace ripple {
 
@@ -39,10 +41,17 @@ buildLedgerImpl(
     built->updateSkipList();
     {
 
+        int const helpers = std::thread::hardware_concurrency();
+        auto const schedule = [&app](std::function<void()> f) {
+            return app.getJobQueue().addJob(
+                jtACCEPT, "SHAMap::flushDirty", [f = std::move(f)](Job&) {
+                    f();
+                });
+        };
         int const asf = built->stateMap().flushDirty(
-            hotACCOUNT_NODE, built->info().seq);
+            hotACCOUNT_NODE, built->info().seq, helpers, schedule);
         int const tmf = built->txMap().flushDirty(
-            hotTRANSACTION_NODE, built->info().seq);
+            hotTRANSACTION_NODE, built->info().seq, helpers, schedule);
         JLOG(j.debug()) << "Flushed " << asf << " accounts and " << tmf
                         << " transaction nodes";
     }
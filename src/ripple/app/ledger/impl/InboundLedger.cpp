@@ -211,12 +211,58 @@ InboundLedger::neededStateHashes (
         if (mLedger->stateMap().getHash().isZero ())
             ret.push_back (mLedger->info().accountHash);
         else
-            ret = mLedger->stateMap().getNeededHashes (max, filter);
+        {
+            for (auto const& n : mLedger->stateMap().getMissingNodes (
+                    max, filter, neighborState ()))
+                ret.push_back (n.second);
+        }
     }
 
     return ret;
 }
 
+void
+InboundLedger::findNeighbor ()
+{
+    if (mNeighborChecked || ! mLedger || mReason == Reason::SHARD)
+        return;
+    mNeighborChecked = true;
+
+    auto& ledgerMaster = app_.getLedgerMaster ();
+    auto const seq = mLedger->info().seq;
+    auto usable = [&](std::shared_ptr<Ledger const> const& l)
+    {
+        return l && ledgerMaster.haveLedger (l->info().seq) &&
+            &l->stateMap().family() == &mLedger->stateMap().family();
+    };
+
+    if (seq > 1 && ledgerMaster.haveLedger (seq - 1))
+    {
+        auto l = ledgerMaster.getLedgerByHash (mLedger->info().parentHash);
+        if (usable (l))
+            mNeighbor = std::move (l);
+    }
+    if (! mNeighbor && ledgerMaster.haveLedger (seq + 1))
+    {
+        auto l = ledgerMaster.getLedgerBySeq (seq + 1);
+        if (usable (l) && l->info().parentHash == mHash)
+            mNeighbor = std::move (l);
+    }
+
+    if (mNeighbor)
+    {
+        JLOG (m_journal.debug()) <<
+            "Acquiring " << mHash << " relative to ledger " <<
+            mNeighbor->info().seq;
+    }
+}
+
+SHAMap const*
+InboundLedger::neighborState () const
+{
+    return mNeighbor ? &mNeighbor->stateMap() : nullptr;
+}
+
 LedgerInfo
 InboundLedger::deserializeHeader (
     Slice data,
@@ -327,6 +373,7 @@ InboundLedger::tryDB(Family& f)
             mFailed = true;
             return;
         }
+        findNeighbor();
         AccountStateSF filter(mLedger->stateMap().family().db(),
             app_.getLedgerMaster());
         if (mLedger->stateMap().fetchRoot(
@@ -425,7 +472,13 @@ void InboundLedger::done ()
         ((getTimeouts () == 0) ? std::string() :
             (std::string ("timeouts:") +
             to_string (getTimeouts ()) + " ")) <<
-        mStats.get ();
+        mStats.get () << " local:" << mLocalNodes <<
+        " network:" << mStats.getGood ();
+
+    {
+        ScopedLockType sl (mLock);
+        mNeighbor.reset ();
+    }
 
     assert (mComplete || mFailed);
 
@@ -616,10 +669,14 @@ void InboundLedger::trigger (std::shared_ptr<Peer> const& peer, TriggerReason re
             AccountStateSF filter(mLedger->stateMap().family().db(),
                 app_.getLedgerMaster());
 
+            auto const neighbor = mNeighbor;
+            int localNodes = 0;
             sl.unlock();
             auto nodes = mLedger->stateMap().getMissingNodes (
-                missingNodesFind, &filter);
+                missingNodesFind, &filter,
+                neighbor ? &neighbor->stateMap() : nullptr, &localNodes);
             sl.lock();
+            mLocalNodes += localNodes;
 
             if (!mFailed && !mComplete && !mHaveState)
             {
@@ -688,7 +745,7 @@ void InboundLedger::trigger (std::shared_ptr<Peer> const& peer, TriggerReason re
                 app_.getLedgerMaster());
 
             auto nodes = mLedger->txMap().getMissingNodes (
-                missingNodesFind, &filter);
+                missingNodesFind, &filter, nullptr, &mLocalNodes);
 
             if (nodes.empty ())
             {
@@ -1243,6 +1300,11 @@ Json::Value InboundLedger::getJson (int)
 
     ret[jss::timeouts] = getTimeouts ();
 
+    ret[jss::local_nodes] = mLocalNodes;
+    ret[jss::network_nodes] = mStats.getGood ();
+    if (mNeighbor)
+        ret[jss::reference_ledger] = mNeighbor->info().seq;
+
     if (mHaveHeader && !mHaveState)
     {
         Json::Value hv (Json::arrayValue);
@@ -0,0 +1,384 @@
+
+
+#include <ripple/app/ledger/LedgerDBWriter.h>
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/ledger/PendingSaves.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/app/misc/AccountTxStore.h>
+#include <ripple/basics/Log.h>
+#include <ripple/core/DatabaseCon.h>
+#include <ripple/core/JobQueue.h>
+#include <ripple/core/SociDB.h>
+#include <ripple/protocol/jss.h>
+#include <ripple/protocol/STTx.h>
+#include <algorithm>
+#include <iterator>
+
+namespace ripple {
+
+LedgerDBWriter::LedgerDBWriter (Application& app, Stoppable& parent,
+        beast::Journal journal)
+    : Stoppable ("LedgerDBWriter", parent)
+    , app_ (app)
+    , j_ (journal)
+{
+}
+
+void
+LedgerDBWriter::save (Record&& record, bool synchronous)
+{
+    record.queued = clock_type::now ();
+
+    std::unique_lock<std::mutex> lock (mutex_);
+    pending_.push_back (std::move (record));
+
+    if (synchronous || stopping_ || (pending_.size () >= maxQueued))
+        drain (lock);
+    else
+        schedule (lock);
+}
+
+void
+LedgerDBWriter::onStop ()
+{
+    {
+        std::unique_lock<std::mutex> lock (mutex_);
+        stopping_ = true;
+
+        JLOG (j_.debug()) << "Flushing " << pending_.size () <<
+            " queued ledgers";
+        drain (lock);
+    }
+
+    stopped ();
+}
+
+bool
+LedgerDBWriter::overloaded () const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return pending_.size () >= (maxQueued / 2);
+}
+
+std::size_t
+LedgerDBWriter::size () const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    return pending_.size ();
+}
+
+Json::Value
+LedgerDBWriter::getJson () const
+{
+    Json::Value ret (Json::objectValue);
+
+    std::lock_guard<std::mutex> lock (mutex_);
+    ret[jss::queued] = static_cast<Json::UInt> (pending_.size ());
+    ret[jss::batches] = std::to_string (batches_);
+    ret[jss::ledgers] = std::to_string (ledgers_);
+    ret[jss::transactions] = std::to_string (transactions_);
+    ret[jss::max_batch] = static_cast<Json::UInt> (maxBatchSize_);
+
+    Json::Value& latency = (ret[jss::latency_ms] = Json::objectValue);
+    latency[jss::last] = static_cast<Json::UInt> (lastLatency_.count ());
+    latency[jss::peak] = static_cast<Json::UInt> (peakLatency_.count ());
+    latency[jss::average] = static_cast<Json::UInt> (
+        ledgers_ ? (totalLatency_.count () / ledgers_) : 0);
+
+    return ret;
+}
+
+void
+LedgerDBWriter::schedule (std::unique_lock<std::mutex>& lock)
+{
+    if (scheduled_)
+        return;
+
+    if (app_.getJobQueue ().addJob (
+        jtWRITE, "LedgerDBWriter::write",
+        [this] (Job&)
+        {
+            std::unique_lock<std::mutex> lock (mutex_);
+            scheduled_ = false;
+            drain (lock);
+        }))
+    {
+        scheduled_ = true;
+        return;
+    }
+
+    drain (lock);
+}
+
+void
+LedgerDBWriter::drain (std::unique_lock<std::mutex>& lock)
+{
+    while (true)
+    {
+        cond_.wait (lock, [this] { return ! writing_; });
+
+        if (pending_.empty ())
+            return;
+
+        auto const last = pending_.begin () +
+            std::min (maxBatch, pending_.size ());
+        std::vector<Record> batch (
+            std::make_move_iterator (pending_.begin ()),
+            std::make_move_iterator (last));
+        pending_.erase (pending_.begin (), last);
+        writing_ = true;
+
+        lock.unlock ();
+        write (batch);
+        lock.lock ();
+
+        writing_ = false;
+        cond_.notify_all ();
+    }
+}
+
+void
+LedgerDBWriter::write (std::vector<Record>& batch)
+{
+    auto const start = clock_type::now ();
+    std::size_t txns = 0;
+
+    try
+    {
+        {
+            auto db = app_.getLedgerDB ().checkoutDb ();
+
+            std::uint32_t seq = 0;
+            soci::statement st = (db->prepare <<
+                "DELETE FROM Ledgers WHERE LedgerSeq = :seq;",
+                soci::use (seq));
+
+            for (auto const& record : batch)
+            {
+                seq = record.info.seq;
+                st.execute (true);
+            }
+        }
+
+        writeTransactions (batch);
+        writeLedgers (batch);
+    }
+    catch (std::exception const& e)
+    {
+        JLOG (j_.fatal()) << "Unable to save ledgers " <<
+            batch.front ().info.seq << "-" << batch.back ().info.seq <<
+            ": " << e.what ();
+
+        for (auto const& record : batch)
+        {
+            app_.getLedgerMaster ().failedSave (
+                record.info.seq, record.info.hash);
+            app_.pendingSaves ().finishWork (record.info.seq);
+        }
+        return;
+    }
+
+    auto const now = clock_type::now ();
+
+    for (auto const& record : batch)
+    {
+        txns += record.txns.size ();
+        app_.pendingSaves ().finishWork (record.info.seq);
+    }
+
+    JLOG (j_.debug()) << "Saved " << batch.size () << " ledgers, " <<
+        txns << " transactions in " <<
+        std::chrono::duration_cast<std::chrono::milliseconds> (
+            now - start).count () << "ms";
+
+    std::lock_guard<std::mutex> lock (mutex_);
+    ++batches_;
+    ledgers_ += batch.size ();
+    transactions_ += txns;
+    maxBatchSize_ = std::max (maxBatchSize_, batch.size ());
+    for (auto const& record : batch)
+    {
+        auto const latency = std::chrono::duration_cast<
+            std::chrono::milliseconds> (now - record.queued);
+        lastLatency_ = latency;
+        peakLatency_ = std::max (peakLatency_, latency);
+        totalLatency_ += latency;
+    }
+}
+
+void
+LedgerDBWriter::writeTransactions (std::vector<Record> const& batch)
+{
+    auto const store = app_.getAccountTxStore ();
+    auto db = app_.getTxnDB ().checkoutDb ();
+
+    soci::transaction tr (*db);
+
+    std::uint32_t seq = 0;
+    std::uint32_t txnSeq = 0;
+    std::string txnId;
+    std::string account;
+
+    {
+        soci::statement delTrans = (db->prepare <<
+            "DELETE FROM Transactions WHERE LedgerSeq = :seq;",
+            soci::use (seq));
+        soci::statement delAcctTrans = (db->prepare <<
+            "DELETE FROM AccountTransactions WHERE LedgerSeq = :seq;",
+            soci::use (seq));
+
+        for (auto const& record : batch)
+        {
+            seq = record.info.seq;
+            delTrans.execute (true);
+            if (! store)
+                delAcctTrans.execute (true);
+        }
+    }
+
+    soci::statement delTxn = (db->prepare <<
+        "DELETE FROM AccountTransactions WHERE TransID = :txnId;",
+        soci::use (txnId));
+    soci::statement insAcctTrans = (db->prepare <<
+        "INSERT INTO AccountTransactions "
+        "(TransID, Account, LedgerSeq, TxnSeq) VALUES "
+        "(:txnId, :account, :seq, :txnSeq);",
+        soci::use (txnId),
+        soci::use (account),
+        soci::use (seq),
+        soci::use (txnSeq));
+
+    std::string sql;
+    std::size_t rows = 0;
+
+    auto flush = [&]
+    {
+        if (rows == 0)
+            return;
+        sql += ";";
+        *db << sql;
+        sql.clear ();
+        rows = 0;
+    };
+
+    for (auto const& record : batch)
+    {
+        seq = record.info.seq;
+
+        for (auto const& txn : record.txns)
+        {
+            txnId = to_string (txn.id);
+            txnSeq = txn.txnSeq;
+
+            if (txn.accounts.empty ())
+            {
+                JLOG (j_.warn())
+                    << "Transaction " << txn.id << " in ledger "
+                    << seq << " affects no accounts";
+            }
+
+            if (! store)
+            {
+                delTxn.execute (true);
+
+                for (auto const& acct : txn.accounts)
+                {
+                    account = app_.accountIDCache ().toBase58 (acct);
+                    insAcctTrans.execute (true);
+                }
+            }
+
+            if (rows == 0)
+                sql = STTx::getMetaSQLInsertReplaceHeader ();
+            else
+                sql += ", ";
+            sql += txn.metaSQL;
+
+            if (++rows == rowsPerInsert)
+                flush ();
+        }
+    }
+
+    flush ();
+
+    tr.commit ();
+
+    if (! store)
+        return;
+
+    for (auto const& record : batch)
+    {
+        std::vector<AccountTxStore::Transaction> txns;
+        txns.reserve (record.txns.size ());
+        for (auto const& txn : record.txns)
+            txns.push_back ({txn.txnSeq, txn.id, txn.accounts});
+        store->insert (record.info.seq, txns);
+    }
+}
+
+void
+LedgerDBWriter::writeLedgers (std::vector<Record> const& batch)
+{
+    auto db = app_.getLedgerDB ().checkoutDb ();
+
+    soci::transaction tr (*db);
+
+    std::string hash;
+    std::uint32_t seq = 0;
+    std::string parentHash;
+    std::string drops;
+    std::uint32_t closeTime = 0;
+    std::uint32_t parentCloseTime = 0;
+    int closeTimeResolution = 0;
+    int closeFlags = 0;
+    std::string accountHash;
+    std::string txHash;
+
+    soci::statement addLedger = (db->prepare <<
+        R"sql(INSERT OR REPLACE INTO Ledgers
+            (LedgerHash,LedgerSeq,PrevHash,TotalCoins,ClosingTime,PrevClosingTime,
+            CloseTimeRes,CloseFlags,AccountSetHash,TransSetHash)
+        VALUES
+            (:ledgerHash,:ledgerSeq,:prevHash,:totalCoins,:closingTime,:prevClosingTime,
+            :closeTimeRes,:closeFlags,:accountSetHash,:transSetHash);)sql",
+        soci::use (hash),
+        soci::use (seq),
+        soci::use (parentHash),
+        soci::use (drops),
+        soci::use (closeTime),
+        soci::use (parentCloseTime),
+        soci::use (closeTimeResolution),
+        soci::use (closeFlags),
+        soci::use (accountHash),
+        soci::use (txHash));
+
+    soci::statement updateVal = (db->prepare <<
+        R"sql(UPDATE Validations SET LedgerSeq = :ledgerSeq, InitialSeq = :initialSeq
+            WHERE LedgerHash = :ledgerHash;)sql",
+        soci::use (seq),
+        soci::use (seq),
+        soci::use (hash));
+
+    for (auto const& record : batch)
+    {
+        auto const& info = record.info;
+
+        hash = to_string (info.hash);
+        seq = info.seq;
+        parentHash = to_string (info.parentHash);
+        drops = to_string (info.drops);
+        closeTime = info.closeTime.time_since_epoch ().count ();
+        parentCloseTime = info.parentCloseTime.time_since_epoch ().count ();
+        closeTimeResolution = info.closeTimeResolution.count ();
+        closeFlags = info.closeFlags;
+        accountHash = to_string (info.accountHash);
+        txHash = to_string (info.txHash);
+
+        addLedger.execute (true);
+        updateVal.execute (true);
+    }
+
+    tr.commit ();
+}
+
+}
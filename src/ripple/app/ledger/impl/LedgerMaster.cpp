@@ -1,6 +1,7 @@
 
 
 #include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/ledger/LedgerDBWriter.h>
 #include <ripple/app/ledger/OpenLedger.h>
 #include <ripple/app/ledger/OrderBookDB.h>
 #include <ripple/app/ledger/PendingSaves.h>
@@ -1431,6 +1432,12 @@ LedgerMaster::getCacheHitRate ()
     return mLedgerHistory.getCacheHitRate ();
 }
 
+LedgerHistory::LedgersByHash&
+LedgerMaster::getLedgerCache ()
+{
+    return mLedgerHistory.getLedgerCache ();
+}
+
 beast::PropertyStream::Source&
 LedgerMaster::getPropertySource ()
 {
@@ -1612,6 +1619,7 @@ void LedgerMaster::doAdvance (ScopedLockType& sl)
         {
             if (!standalone_ && !app_.getFeeTrack().isLoadedLocal() &&
                 (app_.getJobQueue().getJobCount(jtPUBOLDLEDGER) < 10) &&
+                !app_.getLedgerDBWriter().overloaded() &&
                 (mValidLedgerSeq == mPubLedgerSeq) &&
                 (getValidatedLedgerAge() < MAX_LEDGER_AGE_ACQUIRE) &&
                 (app_.getNodeStore().getWriteLoad() < MAX_WRITE_LOAD_ACQUIRE))
@@ -46,7 +46,7 @@ TransactionMaster::fetch (uint256 const& txnID, bool checkDisk)
 }
 
 std::shared_ptr<STTx const>
-TransactionMaster::fetch (std::shared_ptr<SHAMapItem> const& item,
+TransactionMaster::fetch (boost::intrusive_ptr<SHAMapItem const> const& item,
     SHAMapTreeNode::TNType type,
         bool checkDisk, std::uint32_t uCommitLedger)
 {
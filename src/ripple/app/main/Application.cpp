@@ -12,6 +12,8 @@
 #include <ripple/app/ledger/OpenLedger.h>
 #include <ripple/app/ledger/OrderBookDB.h>
 #include <ripple/app/ledger/PendingSaves.h>
+#include <ripple/app/ledger/LedgerDBWriter.h>
+#include <ripple/app/misc/AccountTxStore.h>
 #include <ripple/app/ledger/InboundTransactions.h>
 #include <ripple/app/ledger/TransactionMaster.h>
 #include <ripple/app/main/LoadManager.h>
@@ -19,6 +21,7 @@
 #include <ripple/app/main/NodeStoreScheduler.h>
 #include <ripple/app/misc/AmendmentTable.h>
 #include <ripple/app/misc/HashRouter.h>
+#include <ripple/app/misc/SignatureBatch.h>
 #include <ripple/app/misc/LoadFeeTrack.h>
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/app/misc/SHAMapStore.h>
@@ -28,6 +31,7 @@
 #include <ripple/app/paths/PathRequests.h>
 #include <ripple/app/tx/apply.h>
 #include <ripple/basics/ByteUtilities.h>
+#include <ripple/basics/MemoryGovernor.h>
 #include <ripple/basics/ResolverAsio.h>
 #include <ripple/basics/safe_cast.h>
 #include <ripple/basics/Sustain.h>
@@ -51,6 +55,7 @@
 #include <iostream>
 #include <mutex>
 #include <sstream>
+#include <thread>
 
 namespace ripple {
 
@@ -326,6 +331,10 @@ public:
     std::unique_ptr <AmendmentTable> m_amendmentTable;
     std::unique_ptr <LoadFeeTrack> mFeeTrack;
     std::unique_ptr <HashRouter> mHashRouter;
+    std::unique_ptr <SignatureBatch> signatureBatch_;
+    std::unique_ptr <LedgerDBWriter> ledgerDBWriter_;
+    std::unique_ptr <AccountTxStore> accountTxStore_;
+    MemoryGovernor memoryGovernor_;
     RCLValidations mValidations;
     std::unique_ptr <LoadManager> m_loadManager;
     std::unique_ptr <TxQ> txQ_;
@@ -470,6 +479,22 @@ public:
             stopwatch(), HashRouter::getDefaultHoldTime (),
             HashRouter::getDefaultRecoverLimit ()))
 
+        , signatureBatch_ (std::make_unique<SignatureBatch>(
+            *mHashRouter, *m_jobQueue, get_io_service (),
+            std::max (1u, std::thread::hardware_concurrency ()),
+            std::chrono::milliseconds {2},
+            logs_->journal("SignatureBatch")))
+
+        , ledgerDBWriter_ (std::make_unique<LedgerDBWriter>(
+            *this, *m_jobQueue, logs_->journal("LedgerDBWriter")))
+
+        , accountTxStore_ (make_AccountTxStore (
+            config_->section (ConfigSection::accountTxStore ()),
+            logs_->journal("AccountTxStore")))
+
+        , memoryGovernor_ (config_->MEMORY_BUDGET,
+            logs_->journal("MemoryGovernor"))
+
         , mValidations (ValidationParms(),stopwatch(), *this, logs_->journal("Validations"))
 
         , m_loadManager (make_LoadManager (*this, *this, logs_->journal("LoadManager")))
@@ -496,6 +521,8 @@ public:
                 *this, *shardStore_, *m_collectorManager);
         add (m_resourceManager.get ());
 
+        addGovernedCaches ();
+
 
         m_nodeStoreScheduler.setJobQueue (*m_jobQueue);
 
@@ -675,6 +702,11 @@ public:
         return *mHashRouter;
     }
 
+    SignatureBatch& getSignatureBatch () override
+    {
+        return *signatureBatch_;
+    }
+
     RCLValidations& getValidations () override
     {
         return mValidations;
@@ -715,6 +747,21 @@ public:
         return pendingSaves_;
     }
 
+    LedgerDBWriter& getLedgerDBWriter () override
+    {
+        return *ledgerDBWriter_;
+    }
+
+    AccountTxStore* getAccountTxStore () override
+    {
+        return accountTxStore_.get();
+    }
+
+    MemoryGovernor& getMemoryGovernor () override
+    {
+        return memoryGovernor_;
+    }
+
     AccountIDCache const&
     accountIDCache() const override
     {
@@ -1019,9 +1066,37 @@ public:
             sFamily_->treecache().sweep();
         cachedSLEs_.expire();
 
+        memoryGovernor_.govern();
+
         setSweepTimer();
     }
 
+    static
+    MemoryGovernor::Cache
+    governedCache (NodeStore::Database& db)
+    {
+        return {
+            [&db] { return db.getCacheBytes(); },
+            [&db] { return db.takeCacheMarginalHits(); },
+            [&db] (std::uint64_t bytes) { return db.evictCache(bytes); }};
+    }
+
+    void addGovernedCaches ()
+    {
+        memoryGovernor_.add ("node_store", governedCache (*m_nodeStore));
+        memoryGovernor_.add ("tree_node", family_.treecache());
+        memoryGovernor_.add ("ledger_history",
+            m_ledgerMaster->getLedgerCache());
+        memoryGovernor_.add ("transaction_master", m_txMaster.getCache());
+        memoryGovernor_.add ("cached_sles", cachedSLEs_);
+        memoryGovernor_.add ("accepted_ledger", m_acceptedLedgerCache);
+        if (shardStore_)
+        {
+            memoryGovernor_.add ("shard_store", governedCache (*shardStore_));
+            memoryGovernor_.add ("shard_tree_node", sFamily_->treecache());
+        }
+    }
+
     LedgerIndex getMaxDisallowedLedger() override
     {
         return maxDisallowedLedger_;
@@ -1036,6 +1111,7 @@ private:
     bool updateTables ();
     bool nodeToShards ();
     bool validateShards ();
+    bool importAccountTx ();
     void startGenesisLedger ();
 
     std::shared_ptr<Ledger>
@@ -1075,6 +1151,19 @@ bool ApplicationImp::setup()
         if (logs_->threshold() > kDebug)
             logs_->threshold (kDebug);
     }
+
+    {
+        auto const& section = config_->section (SECTION_DEBUG_LOG_QUEUE);
+        auto const size = get<std::size_t> (section, "size", 0);
+        auto const overflow = get<std::string> (section, "overflow", "drop");
+
+        if (size != 0)
+        {
+            logs_->startAsync (size, overflow == "block"
+                ? Logs::Overflow::block
+                : Logs::Overflow::drop);
+        }
+    }
     JLOG(m_journal.info()) << "process starting: "
         << BuildInfo::getFullVersionString();
 
@@ -1237,6 +1326,19 @@ bool ApplicationImp::setup()
         *config_);
     add (*m_overlay); 
 
+    if (config_->importAccountTx)
+    {
+        if (!importAccountTx())
+            return false;
+    }
+    else if (accountTxStore_ && !accountTxStore_->empty())
+    {
+        // Ledgers committed to the Transactions table after the store's
+        // last write, such as just before a crash, are indexed again.
+        replayAccountTransactions(
+            getTxnDB(), *accountTxStore_, logs_->journal("AccountTxStore"));
+    }
+
     if (!config_->standalone())
     {
         if (config_->nodeToShard && !nodeToShards())
@@ -2059,6 +2161,26 @@ bool ApplicationImp::validateShards()
     return true;
 }
 
+bool ApplicationImp::importAccountTx()
+{
+    if (!accountTxStore_)
+    {
+        JLOG (m_journal.fatal()) <<
+            "The [account_tx_store] configuration setting must be set";
+        return false;
+    }
+    if (!accountTxStore_->empty())
+    {
+        JLOG (m_journal.fatal()) <<
+            "The account transaction store " <<
+            accountTxStore_->getName() << " is not empty";
+        return false;
+    }
+    importAccountTransactions(
+        getTxnDB(), *accountTxStore_, logs_->journal("AccountTxStore"));
+    return true;
+}
+
 void ApplicationImp::setMaxDisallowedLedger()
 {
     boost::optional <LedgerIndex> seq;
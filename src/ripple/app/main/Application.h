@@ -25,6 +25,7 @@ class CachedSLEs;
 class CollectorManager;
 class Family;
 class HashRouter;
+class SignatureBatch;
 class Logs;
 class LoadFeeTrack;
 class JobQueue;
@@ -40,6 +41,9 @@ class OrderBookDB;
 class Overlay;
 class PathRequests;
 class PendingSaves;
+class LedgerDBWriter;
+class AccountTxStore;
+class MemoryGovernor;
 class PublicKey;
 class SecretKey;
 class AccountIDCache;
@@ -99,6 +103,7 @@ public:
     virtual CachedSLEs&                 cachedSLEs() = 0;
     virtual AmendmentTable&             getAmendmentTable() = 0;
     virtual HashRouter&                 getHashRouter () = 0;
+    virtual SignatureBatch&             getSignatureBatch () = 0;
     virtual LoadFeeTrack&               getFeeTrack () = 0;
     virtual LoadManager&                getLoadManager () = 0;
     virtual Overlay&                    overlay () = 0;
@@ -136,6 +141,9 @@ public:
     virtual PathRequests&           getPathRequests () = 0;
     virtual SHAMapStore&            getSHAMapStore () = 0;
     virtual PendingSaves&           pendingSaves() = 0;
+    virtual LedgerDBWriter&         getLedgerDBWriter () = 0;
+    virtual AccountTxStore*         getAccountTxStore () = 0;
+    virtual MemoryGovernor&         getMemoryGovernor () = 0;
     virtual AccountIDCache const&   accountIDCache() const = 0;
     virtual OpenLedger&             openLedger() = 0;
     virtual OpenLedger const&       openLedger() const = 0;
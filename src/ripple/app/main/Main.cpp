@@ -298,6 +298,8 @@ int run (int argc, char** argv)
     po::options_description data ("Ledger/Data Options");
     data.add_options ()
     ("import", importText.c_str ())
+    ("importAccountTx",
+        "Import the SQLite account transaction index into [account_tx_store].")
     ("ledger", po::value<std::string> (),
         "Load the specified ledger and start from the value given.")
     ("ledgerfile", po::value<std::string> (), "Load the specified ledger file.")
@@ -527,6 +529,9 @@ int run (int argc, char** argv)
     if (vm.count ("validateShards"))
         config->validateShards = true;
 
+    if (vm.count ("importAccountTx"))
+        config->importAccountTx = true;
+
     if (vm.count ("ledger"))
     {
         config->START_LEDGER = vm["ledger"].as<std::string> ();
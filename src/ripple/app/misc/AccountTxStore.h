@@ -0,0 +1,109 @@
+
+
+#ifndef RIPPLE_APP_MISC_ACCOUNTTXSTORE_H_INCLUDED
+#define RIPPLE_APP_MISC_ACCOUNTTXSTORE_H_INCLUDED
+
+#include <ripple/basics/BasicConfig.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/json/json_value.h>
+#include <ripple/protocol/AccountID.h>
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ripple {
+
+class DatabaseCon;
+
+
+class AccountTxStore
+{
+public:
+    struct Transaction
+    {
+        std::uint32_t txnSeq;
+        uint256 id;
+        std::vector<AccountID> accounts;
+    };
+
+    struct Entry
+    {
+        std::uint32_t ledgerSeq;
+        std::uint32_t txnSeq;
+        uint256 id;
+    };
+
+    
+    struct Marker
+    {
+        std::uint32_t ledgerSeq;
+        std::uint32_t txnSeq;
+    };
+
+    virtual ~AccountTxStore() = default;
+
+    virtual
+    std::string
+    getName() const = 0;
+
+    
+    virtual
+    void
+    insert(std::uint32_t ledgerSeq,
+        std::vector<Transaction> const& txns) = 0;
+
+    
+    virtual
+    std::vector<Entry>
+    page(AccountID const& account, std::uint32_t minLedger,
+        std::uint32_t maxLedger, bool forward,
+            boost::optional<Marker>& marker, std::size_t limit) = 0;
+
+    
+    virtual
+    void
+    deleteBefore(std::uint32_t ledgerSeq) = 0;
+
+    
+    virtual
+    void
+    compact() = 0;
+
+    virtual
+    bool
+    empty() const = 0;
+
+    /** The highest ledger whose transactions the store is known to hold.
+
+        Ledgers above this one may have been written to the Transactions
+        table without reaching the store, and are replayed at startup.
+    */
+    virtual
+    std::uint32_t
+    highWater() const = 0;
+
+    virtual
+    Json::Value
+    getJson() const = 0;
+};
+
+
+std::unique_ptr<AccountTxStore>
+make_AccountTxStore(Section const& section, beast::Journal journal);
+
+
+std::uint64_t
+importAccountTransactions(DatabaseCon& txnDB,
+    AccountTxStore& store, beast::Journal journal);
+
+
+std::uint64_t
+replayAccountTransactions(DatabaseCon& txnDB,
+    AccountTxStore& store, beast::Journal journal);
+
+}
+
+#endif
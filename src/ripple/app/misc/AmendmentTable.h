@@ -95,9 +95,9 @@ public:
             amendTx.add (s);
 
             initialPosition->addGiveItem (
-                std::make_shared <SHAMapItem> (
+                make_shamapitem (
                     amendTx.getTransactionID(),
-                    s.peekData()),
+                    s),
                 true,
                 false);
         }
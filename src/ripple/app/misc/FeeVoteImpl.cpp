@@ -207,7 +207,7 @@ FeeVoteImpl::doVoting(
         Serializer s;
         feeTx.add (s);
 
-        auto tItem = std::make_shared<SHAMapItem> (txID, s.peekData ());
+        auto tItem = make_shamapitem (txID, s);
 
         if (!initialPosition->addGiveItem (tItem, true, false))
         {
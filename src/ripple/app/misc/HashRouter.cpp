@@ -86,6 +86,31 @@ bool HashRouter::setFlags (uint256 const& key, int flags)
     return true;
 }
 
+std::vector<int>
+HashRouter::getFlags (std::vector<uint256> const& keys)
+{
+    std::vector<int> flags;
+    flags.reserve (keys.size ());
+
+    std::lock_guard <std::mutex> lock (mutex_);
+
+    for (auto const& key : keys)
+        flags.push_back (emplace(key).first.getFlags ());
+    return flags;
+}
+
+void
+HashRouter::setFlags (std::vector<std::pair<uint256, int>> const& flags)
+{
+    std::lock_guard <std::mutex> lock (mutex_);
+
+    for (auto const& f : flags)
+    {
+        assert (f.second != 0);
+        emplace(f.first).first.setFlags (f.second);
+    }
+}
+
 auto
 HashRouter::shouldRelay (uint256 const& key)
     -> boost::optional<std::set<PeerShortID>>
@@ -9,6 +9,8 @@
 #include <ripple/basics/UnorderedContainers.h>
 #include <ripple/beast/container/aged_unordered_map.h>
 #include <boost/optional.hpp>
+#include <utility>
+#include <vector>
 
 namespace ripple {
 
@@ -133,6 +135,12 @@ public:
 
     int getFlags (uint256 const& key);
 
+    /** Fetch the flags of several keys, taking the lock once. */
+    std::vector<int> getFlags (std::vector<uint256> const& keys);
+
+    /** Set flags on several keys, taking the lock once. */
+    void setFlags (std::vector<std::pair<uint256, int>> const& flags);
+
     
     boost::optional<std::set<PeerShortID>> shouldRelay(uint256 const& key);
 
@@ -16,6 +16,7 @@
 #include <ripple/app/main/LoadManager.h>
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/misc/LoadFeeTrack.h>
+#include <ripple/app/misc/SignatureBatch.h>
 #include <ripple/app/misc/Transaction.h>
 #include <ripple/app/misc/TxQ.h>
 #include <ripple/app/misc/ValidatorKeys.h>
@@ -35,6 +36,7 @@
 #include <ripple/overlay/Overlay.h>
 #include <ripple/overlay/predicates.h>
 #include <ripple/protocol/BuildInfo.h>
+#include <ripple/protocol/Feature.h>
 #include <ripple/resource/ResourceManager.h>
 #include <ripple/rpc/DeliveredAmount.h>
 #include <ripple/beast/rfc2616.h>
@@ -43,7 +45,10 @@
 #include <ripple/basics/make_lock.h>
 #include <boost/asio/steady_timer.hpp>
 #include <boost/asio/ip/host_name.hpp>
+#include <atomic>
+#include <condition_variable>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <utility>
 
@@ -122,6 +127,64 @@ class NetworkOPsImp final
         StateCountersJson json() const;
     };
 
+    
+    class ApplyAccounting
+    {
+        struct Stage
+        {
+            explicit Stage() = default;
+
+            std::chrono::microseconds last {0};
+            std::chrono::microseconds peak {0};
+            std::chrono::microseconds total {0};
+        };
+
+        mutable std::mutex mutex_;
+        std::uint64_t batches_ = 0;
+        std::uint64_t transactions_ = 0;
+        Stage preflight_;
+        Stage apply_;
+
+    public:
+        explicit ApplyAccounting() = default;
+
+        
+        void record (std::size_t count,
+            std::chrono::microseconds preflight,
+            std::chrono::microseconds apply);
+
+        
+        Json::Value json() const;
+    };
+
+    
+    struct PreflightBatch
+    {
+        std::vector<TransactionStatus> const& transactions;
+        Rules const rules;
+        NetClock::time_point const parentCloseTime;
+        beast::Journal const j;
+        std::vector<boost::optional<PreflightResult>> results;
+        std::atomic<std::size_t> next {0};
+        std::atomic<std::size_t> done {0};
+        std::mutex mutex;
+        std::condition_variable cond;
+
+        PreflightBatch (std::vector<TransactionStatus> const& t,
+                Rules const& r, NetClock::time_point closeTime,
+                beast::Journal journal)
+            : transactions (t)
+            , rules (r)
+            , parentCloseTime (closeTime)
+            , j (journal)
+            , results (t.size ())
+        {}
+
+        void run (Application& app);
+    };
+
+    static std::size_t constexpr preflightChunk = 16;
+
     struct ServerFeeSummary
     {
         ServerFeeSummary() = default;
@@ -208,6 +271,10 @@ public:
     
     void apply (std::unique_lock<std::mutex>& batchLock);
 
+    
+    std::shared_ptr<PreflightBatch> preflightBatch (
+        std::vector<TransactionStatus> const& transactions);
+
 
     Json::Value getOwnerInfo (
         std::shared_ptr<ReadView const> lpLedger,
@@ -302,6 +369,10 @@ public:
         bool descending, std::uint32_t offset, int limit,
         bool binary, bool count, bool bUnlimited);
 
+    static
+    std::uint32_t
+    accountTxLimit (int limit, bool binary, bool bUnlimited);
+
     using NetworkOPs::AccountTxs;
     AccountTxs getAccountTxs (
         AccountID const& account,
@@ -421,6 +492,13 @@ private:
         const STTx& stTxn, TER terResult, bool bValidated,
         std::shared_ptr<ReadView const> const& lpCurrent);
 
+    static std::string binaryTransaction (
+        STTx const& stTxn, TER terResult, bool bValidated,
+        ReadView const& view, Blob const& meta);
+
+    static std::string binaryLedger (
+        ReadView const& ledger, std::uint32_t txnCount);
+
     void pubValidatedTransaction (
         std::shared_ptr<ReadView const> const& alAccepted,
         const AcceptedLedgerTx& alTransaction);
@@ -496,6 +574,7 @@ private:
     std::vector <TransactionStatus> mTransactions;
 
     StateAccounting accounting_ {};
+    ApplyAccounting applyAccounting_ {};
 };
 
 
@@ -732,38 +811,38 @@ void NetworkOPsImp::submitTransaction (std::shared_ptr<STTx const> const& iTrans
         return;
     }
 
-    try
-    {
-        auto const validity = checkValidity(
-            app_.getHashRouter(), *trans,
-                m_ledgerMaster.getValidatedRules(),
-                    app_.config());
+    auto const rules = m_ledgerMaster.getValidatedRules();
 
-        if (validity.first != Validity::Valid)
-        {
-            JLOG(m_journal.warn()) <<
-                "Submitted transaction invalid: " <<
-                validity.second;
-            return;
-        }
-    }
-    catch (std::exception const&)
-    {
-        JLOG(m_journal.warn()) << "Exception checking transaction" << txid;
+    app_.getSignatureBatch().add (trans, rules,
+        [this, trans, txid, rules] () {
+            try
+            {
+                auto const validity = checkValidity(
+                    app_.getHashRouter(), *trans, rules,
+                        app_.config());
 
-        return;
-    }
+                if (validity.first != Validity::Valid)
+                {
+                    JLOG(m_journal.warn()) <<
+                        "Submitted transaction invalid: " <<
+                        validity.second;
+                    return;
+                }
+            }
+            catch (std::exception const&)
+            {
+                JLOG(m_journal.warn()) <<
+                    "Exception checking transaction" << txid;
 
-    std::string reason;
+                return;
+            }
 
-    auto tx = std::make_shared<Transaction> (
-        trans, reason, app_);
+            std::string reason;
 
-    m_job_queue.addJob (
-        jtTRANSACTION, "submitTxn",
-        [this, tx] (Job&) {
-            auto t = tx;
-            processTransaction(t, false, false, FailHard::no);
+            auto tx = std::make_shared<Transaction> (
+                trans, reason, app_);
+
+            processTransaction(tx, false, false, FailHard::no);
         });
 }
 
@@ -891,6 +970,12 @@ void NetworkOPsImp::apply (std::unique_lock<std::mutex>& batchLock)
     batchLock.unlock();
 
     {
+        using namespace std::chrono;
+
+        auto const preflightStart = steady_clock::now();
+        auto const preflighted = preflightBatch (transactions);
+        auto const applyStart = steady_clock::now();
+
         auto masterLock = make_lock(app_.getMasterMutex(), std::defer_lock);
         bool changed = false;
         {
@@ -900,15 +985,13 @@ void NetworkOPsImp::apply (std::unique_lock<std::mutex>& batchLock)
             app_.openLedger().modify(
                 [&](OpenView& view, beast::Journal j)
             {
-                for (TransactionStatus& e : transactions)
+                for (std::size_t i = 0; i < transactions.size(); ++i)
                 {
-                    ApplyFlags flags = tapNONE;
-                    if (e.admin)
-                        flags = flags | tapUNLIMITED;
+                    TransactionStatus& e = transactions[i];
 
                     auto const result = app_.getTxQ().apply(
                         app_, view, e.transaction->getSTransaction(),
-                        flags, j);
+                        *preflighted->results[i], j);
                     e.result = result.first;
                     e.applied = result.second;
                     changed = changed || result.second;
@@ -916,6 +999,12 @@ void NetworkOPsImp::apply (std::unique_lock<std::mutex>& batchLock)
                 return changed;
             });
         }
+
+        auto const applyEnd = steady_clock::now();
+        applyAccounting_.record (transactions.size(),
+            duration_cast<microseconds> (applyStart - preflightStart),
+            duration_cast<microseconds> (applyEnd - applyStart));
+
         if (changed)
             reportFeeChange();
 
@@ -1051,6 +1140,65 @@ void NetworkOPsImp::apply (std::unique_lock<std::mutex>& batchLock)
     mDispatchState = DispatchState::none;
 }
 
+std::shared_ptr<NetworkOPsImp::PreflightBatch>
+NetworkOPsImp::preflightBatch (
+    std::vector<TransactionStatus> const& transactions)
+{
+    auto const view = app_.openLedger().current();
+    auto batch = std::make_shared<PreflightBatch> (transactions,
+        view->rules(), view->info().parentCloseTime, m_journal);
+
+    auto const size = transactions.size();
+    auto const workers = std::min<std::size_t> (
+        std::max (1u, std::thread::hardware_concurrency()),
+        (size + preflightChunk - 1) / preflightChunk);
+
+    for (std::size_t i = 1; i < workers; ++i)
+    {
+        if (! m_job_queue.addJob (
+            jtTRANSACTION, "preflightBatch",
+            [&app = app_, batch] (Job&) { batch->run (app); }))
+        {
+            break;
+        }
+    }
+
+    batch->run (app_);
+
+    std::unique_lock<std::mutex> lock (batch->mutex);
+    batch->cond.wait (lock, [&] { return batch->done == size; });
+    return batch;
+}
+
+void NetworkOPsImp::PreflightBatch::run (Application& app)
+{
+    boost::optional<STAmountSO> saved;
+    if (rules.enabled (fix1513))
+        saved.emplace (parentCloseTime);
+
+    auto const size = results.size();
+    std::size_t completed = 0;
+
+    for (auto i = next++; i < size; i = next++)
+    {
+        auto const& e = transactions[i];
+
+        ApplyFlags flags = tapNONE;
+        if (e.admin)
+            flags = flags | tapUNLIMITED;
+
+        results[i].emplace (preflight (app, rules,
+            *e.transaction->getSTransaction(), flags, j));
+        ++completed;
+    }
+
+    if (completed != 0 && (done += completed) == size)
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        cond.notify_all();
+    }
+}
+
 
 Json::Value NetworkOPsImp::getOwnerInfo (
     std::shared_ptr<ReadView const> lpLedger, AccountID const& account)
@@ -1627,23 +1775,15 @@ void NetworkOPsImp::setMode (OperatingMode om)
 }
 
 
-std::string
-NetworkOPsImp::transactionsSQL (
-    std::string selection, AccountID const& account,
-    std::int32_t minLedger, std::int32_t maxLedger, bool descending,
-    std::uint32_t offset, int limit,
-    bool binary, bool count, bool bUnlimited)
+std::uint32_t
+NetworkOPsImp::accountTxLimit (int limit, bool binary, bool bUnlimited)
 {
     std::uint32_t NONBINARY_PAGE_LENGTH = 200;
     std::uint32_t BINARY_PAGE_LENGTH = 500;
 
     std::uint32_t numberOfResults;
 
-    if (count)
-    {
-        numberOfResults = 1000000000;
-    }
-    else if (limit < 0)
+    if (limit < 0)
     {
         numberOfResults = binary ? BINARY_PAGE_LENGTH : NONBINARY_PAGE_LENGTH;
     }
@@ -1658,6 +1798,19 @@ NetworkOPsImp::transactionsSQL (
         numberOfResults = limit;
     }
 
+    return numberOfResults;
+}
+
+std::string
+NetworkOPsImp::transactionsSQL (
+    std::string selection, AccountID const& account,
+    std::int32_t minLedger, std::int32_t maxLedger, bool descending,
+    std::uint32_t offset, int limit,
+    bool binary, bool count, bool bUnlimited)
+{
+    std::uint32_t const numberOfResults = count ?
+        1000000000 : accountTxLimit (limit, binary, bUnlimited);
+
     std::string maxClause = "";
     std::string minClause = "";
 
@@ -1718,6 +1871,26 @@ NetworkOPs::AccountTxs NetworkOPsImp::getAccountTxs (
 {
     AccountTxs ret;
 
+    if (auto const store = app_.getAccountTxStore ())
+    {
+        Application& app = app_;
+        accountTxOffset (app_.getTxnDB (), *store,
+            std::bind (saveLedgerAsync, std::ref (app_),
+                std::placeholders::_1),
+            [&ret, &app](
+                std::uint32_t ledger_index,
+                std::string const& status,
+                Blob const& rawTxn,
+                Blob const& rawMeta)
+            {
+                convertBlobsToTxResult (
+                    ret, ledger_index, status, rawTxn, rawMeta, app);
+            },
+            account, minLedger, maxLedger, descending, offset,
+            accountTxLimit (limit, false, bUnlimited));
+        return ret;
+    }
+
     std::string sql = transactionsSQL (
         "AccountTransactions.LedgerSeq,Status,RawTxn,TxnMeta", account,
         minLedger, maxLedger, descending, offset, limit, false, false,
@@ -1786,6 +1959,25 @@ std::vector<NetworkOPsImp::txnMetaLedgerType> NetworkOPsImp::getAccountTxsB (
 {
     std::vector<txnMetaLedgerType> ret;
 
+    if (auto const store = app_.getAccountTxStore ())
+    {
+        accountTxOffset (app_.getTxnDB (), *store,
+            std::bind (saveLedgerAsync, std::ref (app_),
+                std::placeholders::_1),
+            [&ret](
+                std::uint32_t ledgerIndex,
+                std::string const&,
+                Blob const& rawTxn,
+                Blob const& rawMeta)
+            {
+                ret.emplace_back (
+                    strHex (rawTxn), strHex (rawMeta), ledgerIndex);
+            },
+            account, minLedger, maxLedger, descending, offset,
+            accountTxLimit (limit, true, bUnlimited));
+        return ret;
+    }
+
     std::string sql = transactionsSQL (
         "AccountTransactions.LedgerSeq,Status,RawTxn,TxnMeta", account,
         minLedger, maxLedger, descending, offset, limit, true, false,
@@ -1848,6 +2040,16 @@ NetworkOPsImp::getTxsAccount (
             ret, ledger_index, status, rawTxn, rawMeta, app);
     };
 
+    if (auto const store = app_.getAccountTxStore ())
+    {
+        accountTxPage(app_.getTxnDB (), *store,
+            std::bind(saveLedgerAsync, std::ref(app_),
+                std::placeholders::_1), bound, account, minLedger,
+                    maxLedger, forward, token, limit, bUnlimited,
+                        page_length);
+        return ret;
+    }
+
     accountTxPage(app_.getTxnDB (), app_.accountIDCache(),
         std::bind(saveLedgerAsync, std::ref(app_),
             std::placeholders::_1), bound, account, minLedger,
@@ -1876,6 +2078,16 @@ NetworkOPsImp::getTxsAccountB (
         ret.emplace_back (strHex(rawTxn), strHex (rawMeta), ledgerIndex);
     };
 
+    if (auto const store = app_.getAccountTxStore ())
+    {
+        accountTxPage(app_.getTxnDB (), *store,
+            std::bind(saveLedgerAsync, std::ref(app_),
+                std::placeholders::_1), bound, account, minLedger,
+                    maxLedger, forward, token, limit, bUnlimited,
+                        page_length);
+        return ret;
+    }
+
     accountTxPage(app_.getTxnDB (), app_.accountIDCache(),
         std::bind(saveLedgerAsync, std::ref(app_),
             std::placeholders::_1), bound, account, minLedger,
@@ -2019,8 +2231,14 @@ Json::Value NetworkOPsImp::getServerInfo (bool human, bool admin, bool counters)
 
 
     if (admin)
+    {
         info[jss::load] = m_job_queue.getJson ();
 
+        auto& txApply = (info[jss::tx_apply] = applyAccounting_.json ());
+        std::lock_guard<std::mutex> lock (mMutex);
+        txApply[jss::queued] = static_cast<Json::UInt> (mTransactions.size ());
+    }
+
     auto const escalationMetrics = app_.getTxQ().getMetrics(
         *app_.openLedger().current());
 
@@ -2191,6 +2409,11 @@ void NetworkOPsImp::pubProposedTransaction (
     std::shared_ptr<STTx const> const& stTxn, TER terResult)
 {
     Json::Value jvObj   = transJson (*stTxn, terResult, false, lpCurrent);
+    InfoSubMessage const msg (jvObj, [&]
+    {
+        return binaryTransaction (
+            *stTxn, terResult, false, *lpCurrent, Blob ());
+    });
 
     {
         ScopedLockType sl (mSubLock);
@@ -2202,7 +2425,7 @@ void NetworkOPsImp::pubProposedTransaction (
 
             if (p)
             {
-                p->send (jvObj, true);
+                p->send (msg, true);
                 ++it;
             }
             else
@@ -2231,6 +2454,8 @@ void NetworkOPsImp::pubLedger (
             lpAccepted->info().hash, alpAccepted);
     }
 
+    app_.getOrderBookDB ().processLedger (lpAccepted, *alpAccepted);
+
     {
         ScopedLockType sl (mSubLock);
 
@@ -2258,13 +2483,19 @@ void NetworkOPsImp::pubLedger (
                         = app_.getLedgerMaster ().getCompleteLedgers ();
             }
 
+            InfoSubMessage const msg (jvObj, [&]
+            {
+                return binaryLedger (
+                    *lpAccepted, alpAccepted->getTxnCount ());
+            });
+
             auto it = mStreamMaps[sLedger].begin ();
             while (it != mStreamMaps[sLedger].end ())
             {
                 InfoSub::pointer p = it->second.lock ();
                 if (p)
                 {
-                    p->send (jvObj, true);
+                    p->send (msg, true);
                     ++it;
                 }
                 else
@@ -2344,6 +2575,43 @@ Json::Value NetworkOPsImp::transJson(
     return jvObj;
 }
 
+std::string NetworkOPsImp::binaryTransaction (
+    STTx const& stTxn, TER terResult, bool bValidated,
+    ReadView const& view, Blob const& meta)
+{
+    Serializer s;
+    s.add8 (InfoSubMessage::binaryVersion);
+    s.add8 (InfoSubMessage::binaryTransaction);
+    s.add8 (bValidated ? 1 : 0);
+    s.add32 (view.info().seq);
+    s.add256 (bValidated ? view.info().hash : uint256 ());
+    s.add32 (static_cast<std::uint32_t> (TERtoInt (terResult)));
+
+    Serializer tx;
+    stTxn.add (tx);
+    s.addVL (tx.slice ());
+    s.addVL (meta);
+
+    return s.getString ();
+}
+
+std::string NetworkOPsImp::binaryLedger (
+    ReadView const& ledger, std::uint32_t txnCount)
+{
+    Serializer s;
+    s.add8 (InfoSubMessage::binaryVersion);
+    s.add8 (InfoSubMessage::binaryLedger);
+    s.add256 (ledger.info().hash);
+    addRaw (ledger.info(), s);
+    s.add32 (txnCount);
+    s.add64 (ledger.fees().base);
+    s.add32 (ledger.fees().units);
+    s.add64 (ledger.fees().accountReserve(0).drops());
+    s.add64 (ledger.fees().increment);
+
+    return s.getString ();
+}
+
 void NetworkOPsImp::pubValidatedTransaction (
     std::shared_ptr<ReadView const> const& alAccepted,
     const AcceptedLedgerTx& alTx)
@@ -2359,6 +2627,12 @@ void NetworkOPsImp::pubValidatedTransaction (
             jvObj[jss::meta], *alAccepted, stTxn, *txMeta);
     }
 
+    InfoSubMessage const msg (jvObj, [&]
+    {
+        return binaryTransaction (*stTxn, alTx.getResult (), true,
+            *alAccepted, alTx.getRawMeta ());
+    });
+
     {
         ScopedLockType sl (mSubLock);
 
@@ -2369,7 +2643,7 @@ void NetworkOPsImp::pubValidatedTransaction (
 
             if (p)
             {
-                p->send (jvObj, true);
+                p->send (msg, true);
                 ++it;
             }
             else
@@ -2384,14 +2658,14 @@ void NetworkOPsImp::pubValidatedTransaction (
 
             if (p)
             {
-                p->send (jvObj, true);
+                p->send (msg, true);
                 ++it;
             }
             else
                 it = mStreamMaps[sRTTransactions].erase (it);
         }
     }
-    app_.getOrderBookDB ().processTxn (alAccepted, alTx, jvObj);
+    app_.getOrderBookDB ().processTxn (alAccepted, alTx, msg);
     pubAccountTransaction (alAccepted, alTx, true);
 }
 
@@ -2479,8 +2753,13 @@ void NetworkOPsImp::pubAccountTransaction (
             }
         }
 
+        InfoSubMessage const msg (jvObj, [&]
+        {
+            return binaryTransaction (*stTxn, alTx.getResult (), bAccepted,
+                *lpCurrent, alTx.getRawMeta ());
+        });
         for (InfoSub::ref isrListener : notify)
-            isrListener->send (jvObj, true);
+            isrListener->send (msg, true);
     }
 }
 
@@ -3114,6 +3393,46 @@ NetworkOPsImp::StateAccounting::json() const
     return {ret, std::to_string(current.count())};
 }
 
+void NetworkOPsImp::ApplyAccounting::record (std::size_t count,
+    std::chrono::microseconds preflight, std::chrono::microseconds apply)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    ++batches_;
+    transactions_ += count;
+
+    for (auto p : {std::make_pair (&preflight_, preflight),
+        std::make_pair (&apply_, apply)})
+    {
+        p.first->last = p.second;
+        p.first->peak = std::max (p.first->peak, p.second);
+        p.first->total += p.second;
+    }
+}
+
+Json::Value
+NetworkOPsImp::ApplyAccounting::json() const
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+
+    Json::Value ret = Json::objectValue;
+    ret[jss::batches] = std::to_string (batches_);
+    ret[jss::transactions] = std::to_string (transactions_);
+
+    auto stage = [this](Stage const& s)
+    {
+        Json::Value v = Json::objectValue;
+        v[jss::last] = std::to_string (s.last.count());
+        v[jss::peak] = std::to_string (s.peak.count());
+        v[jss::average] = std::to_string (
+            batches_ ? (s.total.count() / batches_) : 0);
+        return v;
+    };
+
+    ret[jss::preflight_us] = stage (preflight_);
+    ret[jss::apply_us] = stage (apply_);
+    return ret;
+}
+
 
 std::unique_ptr<NetworkOPs>
 make_NetworkOPs (Application& app, NetworkOPs::clock_type& clock,
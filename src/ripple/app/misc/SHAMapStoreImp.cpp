@@ -2,6 +2,7 @@
 
 
 #include <ripple/app/ledger/TransactionMaster.h>
+#include <ripple/app/misc/AccountTxStore.h>
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/app/misc/SHAMapStoreImp.h>
 #include <ripple/beast/core/CurrentThreadName.h>
@@ -714,6 +715,14 @@ SHAMapStoreImp::clearPrior (LedgerIndex lastRotated)
         "DELETE FROM AccountTransactions WHERE LedgerSeq < %u;");
     if (health())
         return;
+
+    if (auto const store = app_.getAccountTxStore())
+    {
+        // Segments wholly below lastRotated are removed here; compact()
+        // only rewrites those left mostly reclaimable.
+        store->deleteBefore(lastRotated);
+        store->compact();
+    }
 }
 
 SHAMapStoreImp::Health
@@ -0,0 +1,156 @@
+
+
+#ifndef RIPPLE_APP_MISC_SIGNATUREBATCH_H_INCLUDED
+#define RIPPLE_APP_MISC_SIGNATUREBATCH_H_INCLUDED
+
+#include <ripple/app/misc/HashRouter.h>
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/core/JobQueue.h>
+#include <ripple/ledger/ReadView.h>
+#include <ripple/protocol/STTx.h>
+#include <boost/asio/basic_waitable_timer.hpp>
+#include <boost/asio/io_service.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+
+/** Verifies transaction signatures in batches.
+
+    Transactions are collected for up to one window after the first
+    arrival, or until maxBatch are pending. The hash router is then
+    consulted once for the whole batch: signatures it already knows, and
+    repeats of a transaction within the batch, are not verified again.
+    The rest are verified in chunks across JobQueue workers and the
+    outcomes are recorded in the router in one pass, before any of the
+    callbacks run.
+*/
+class SignatureBatch
+{
+public:
+    using callback_type = std::function<void()>;
+
+    static std::size_t constexpr minChunk = 16;
+
+    static std::size_t constexpr maxBatch = 256;
+
+    SignatureBatch (HashRouter& router, JobQueue& jobQueue,
+        boost::asio::io_service& io_service, std::size_t workers,
+        std::chrono::microseconds window, beast::Journal journal);
+
+    ~SignatureBatch ();
+
+    SignatureBatch (SignatureBatch const&) = delete;
+    SignatureBatch& operator= (SignatureBatch const&) = delete;
+
+    /** Queue a transaction; the callback runs once its signature has
+        been checked and recorded in the hash router.
+    */
+    void
+    add (std::shared_ptr<STTx const> const& tx,
+        Rules const& rules, callback_type callback);
+
+    /** Number of transactions whose callback has not run yet. */
+    std::size_t
+    size () const
+    {
+        return queued_.load ();
+    }
+
+    std::uint64_t
+    getBatches () const
+    {
+        return batches_.load ();
+    }
+
+    /** Number of signatures actually verified, excluding those the
+        router already knew and repeats within a batch.
+    */
+    std::uint64_t
+    getVerified () const
+    {
+        return verified_.load ();
+    }
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<STTx const> tx;
+        Rules rules;
+        callback_type callback;
+    };
+
+    enum class Outcome : std::uint8_t
+    {
+        unknown,
+        good,
+        bad
+    };
+
+    struct Batch
+    {
+        std::vector<Entry> entries;
+        std::vector<uint256> ids;
+        // Entries whose signature must be verified, and the outcomes
+        std::vector<std::size_t> checks;
+        std::vector<Outcome> outcomes;
+        std::atomic<std::size_t> remaining {0};
+    };
+
+    using clock_type = std::chrono::steady_clock;
+
+    bool
+    schedule (std::lock_guard<std::mutex> const&);
+
+    void
+    onTimer (boost::system::error_code const& ec);
+
+    void
+    collect ();
+
+    void
+    dispatch (std::vector<Entry> entries);
+
+    void
+    verify (Batch& batch, std::size_t begin, std::size_t end);
+
+    void
+    finish (std::shared_ptr<Batch> const& batch);
+
+    void
+    complete (Batch& batch, std::size_t begin, std::size_t end);
+
+    template <class Function>
+    void
+    split (std::string const& name, std::size_t size,
+        Function const& f);
+
+    HashRouter& router_;
+    JobQueue& jobQueue_;
+    std::size_t const workers_;
+    std::chrono::microseconds const window_;
+    beast::Journal j_;
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::vector<Entry> pending_;
+    boost::asio::basic_waitable_timer<clock_type> timer_;
+    bool armed_ = false;
+    bool scheduled_ = false;
+    bool stopping_ = false;
+    std::size_t handlers_ = 0;
+
+    std::atomic<std::size_t> queued_ {0};
+    std::atomic<std::uint64_t> batches_ {0};
+    std::atomic<std::uint64_t> verified_ {0};
+};
+
+}
+
+#endif
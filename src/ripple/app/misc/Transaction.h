@@ -63,7 +63,7 @@ public:
     TransStatus
     sqlTransactionStatus(boost::optional<std::string> const& status);
 
-    std::shared_ptr<STTx const> const& getSTransaction ()
+    std::shared_ptr<STTx const> const& getSTransaction () const
     {
         return mTransaction;
     }
@@ -140,6 +140,9 @@ private:
     beast::Journal  j_;
 };
 
+std::size_t
+cacheBytes (Transaction const& transaction);
+
 } 
 
 #endif
@@ -106,6 +106,12 @@ public:
             ApplyFlags flags, beast::Journal j);
 
     
+    std::pair<TER, bool>
+    apply(Application& app, OpenView& view,
+        std::shared_ptr<STTx const> const& tx,
+            PreflightResult const& pfresult, beast::Journal j);
+
+    
     bool
     accept(Application& app, OpenView& view);
 
@@ -0,0 +1,1426 @@
+
+
+#include <ripple/app/misc/impl/AccountTxLog.h>
+#include <ripple/basics/contract.h>
+#include <ripple/basics/FileUtilities.h>
+#include <ripple/basics/Log.h>
+#include <ripple/beast/core/CurrentThreadName.h>
+#include <ripple/beast/hash/xxhasher.h>
+#include <ripple/protocol/jss.h>
+#include <boost/algorithm/string.hpp>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <tuple>
+
+namespace ripple {
+
+namespace {
+
+void
+put32(std::uint8_t* p, std::uint32_t v)
+{
+    for (int i = 0; i < 4; ++i)
+        p[i] = static_cast<std::uint8_t>(v >> (8 * i));
+}
+
+void
+put64(std::uint8_t* p, std::uint64_t v)
+{
+    for (int i = 0; i < 8; ++i)
+        p[i] = static_cast<std::uint8_t>(v >> (8 * i));
+}
+
+std::uint32_t
+get32(std::uint8_t const* p)
+{
+    std::uint32_t v {0};
+    for (int i = 3; i >= 0; --i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+std::uint64_t
+get64(std::uint8_t const* p)
+{
+    std::uint64_t v {0};
+    for (int i = 7; i >= 0; --i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+std::uint64_t
+checksum(std::uint8_t const* data, std::size_t size)
+{
+    beast::xxhasher h;
+    h(data, size);
+    return static_cast<std::size_t>(h);
+}
+
+// The index checksum covers its header and fences, which is all that is
+// read when the store opens
+std::uint64_t
+checksum(std::vector<std::uint8_t> const& header,
+    std::vector<std::uint8_t> const& fences)
+{
+    beast::xxhasher h;
+    h(header.data(), header.size());
+    h(fences.data(), fences.size());
+    return static_cast<std::size_t>(h);
+}
+
+template <class Key>
+bool
+keyLess(Key const& key, AccountID const& account, std::uint32_t ledgerSeq)
+{
+    return std::tie(key.account, key.ledgerSeq) <
+        std::tie(account, ledgerSeq);
+}
+
+template <class Key>
+bool
+keyGreater(Key const& key, AccountID const& account, std::uint32_t ledgerSeq)
+{
+    return std::tie(account, ledgerSeq) <
+        std::tie(key.account, key.ledgerSeq);
+}
+
+}
+
+AccountTxLog::Segment::Segment(boost::filesystem::path const& dir,
+        std::uint64_t id_, std::uint32_t version_)
+    : id(id_)
+    , version(version_)
+    , log(logPath(dir, id_, version_))
+    , index(indexPath(dir, id_, version_))
+{
+}
+
+AccountTxLog::Segment::~Segment()
+{
+    if (obsolete)
+    {
+        boost::system::error_code ec;
+        boost::filesystem::remove(log, ec);
+        boost::filesystem::remove(index, ec);
+    }
+}
+
+AccountTxLog::AccountTxLog(boost::filesystem::path const& dir,
+        beast::Journal j, std::uint64_t segmentBytes)
+    : dir_(dir)
+    , j_(j)
+    , segmentBytes_(std::max<std::uint64_t>(segmentBytes, 1))
+{
+    load();
+    sealer_ = std::thread(&AccountTxLog::sealLoop, this);
+}
+
+AccountTxLog::~AccountTxLog()
+{
+    {
+        std::lock_guard<std::mutex> lock(sealMutex_);
+        stop_ = true;
+    }
+    sealCond_.notify_all();
+    sealer_.join();
+}
+
+std::string
+AccountTxLog::getName() const
+{
+    return dir_.string();
+}
+
+boost::filesystem::path
+AccountTxLog::logPath(boost::filesystem::path const& dir,
+    std::uint64_t id, std::uint32_t version)
+{
+    return dir / (std::string(filePrefix) + "." + std::to_string(id) +
+        "." + std::to_string(version) + ".log");
+}
+
+boost::filesystem::path
+AccountTxLog::indexPath(boost::filesystem::path const& dir,
+    std::uint64_t id, std::uint32_t version)
+{
+    return dir / (std::string(filePrefix) + "." + std::to_string(id) +
+        "." + std::to_string(version) + ".index");
+}
+
+void
+AccountTxLog::insert(std::uint32_t ledgerSeq,
+    std::vector<Transaction> const& txns)
+{
+    std::map<AccountID,
+        std::vector<std::pair<std::uint32_t, uint256>>> accounts;
+    for (auto const& txn : txns)
+    {
+        for (auto const& account : txn.accounts)
+            accounts[account].emplace_back(txn.txnSeq, txn.id);
+    }
+
+    Record record {ledgerMagic, ledgerSeq, {}};
+    record.groups.reserve(accounts.size());
+    for (auto& account : accounts)
+    {
+        std::sort(account.second.begin(), account.second.end());
+        record.groups.push_back({account.first, 0, std::move(account.second)});
+    }
+    if (record.groups.empty())
+        return;
+
+    auto const data {serialize(record)};
+    SegmentPtr full;
+    {
+        std::lock_guard<std::mutex> wl(writeMutex_);
+        auto const base {append(data)};
+        {
+            std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+            apply(*active_, floor_, record, base, data.size());
+            active_->size += data.size();
+            highWater_ = std::max(highWater_, ledgerSeq);
+        }
+
+        if (active_->size >= segmentBytes_)
+        {
+            try
+            {
+                full = roll();
+            }
+            catch (std::exception const& e)
+            {
+                JLOG(j_.warn()) <<
+                    "account_tx log " << dir_.string() <<
+                    " unable to start a new segment: " << e.what();
+            }
+        }
+    }
+
+    if (full)
+    {
+        {
+            std::lock_guard<std::mutex> lock(sealMutex_);
+            sealQueue_.push_back(std::move(full));
+        }
+        sealCond_.notify_all();
+    }
+}
+
+std::vector<AccountTxStore::Entry>
+AccountTxLog::page(AccountID const& account, std::uint32_t minLedger,
+    std::uint32_t maxLedger, bool forward,
+        boost::optional<Marker>& marker, std::size_t limit)
+{
+    std::vector<Entry> result;
+    if (limit == 0)
+    {
+        marker.reset();
+        return result;
+    }
+
+    // A page spans at most limit + 2 ledgers: the marker's, which it may
+    // skip entirely, one per entry returned, and the one that sets the
+    // next marker. No segment has to supply more locations than that.
+    auto const bound {std::min(limit,
+        std::numeric_limits<std::size_t>::max() - 2) + 2};
+
+    auto const before = [forward](std::uint32_t a, std::uint32_t b)
+    {
+        return forward ? a < b : a > b;
+    };
+
+    struct Stream
+    {
+        SegmentPtr segment;
+        // The first ledger, in paging order, the segment may hold
+        std::uint32_t first;
+        bool loaded;
+        std::vector<Location> locations;
+        std::size_t next;
+    };
+
+    std::vector<Stream> streams;
+    std::uint32_t low;
+    std::uint32_t high;
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+        low = std::max(minLedger, floor_);
+        high = maxLedger;
+        if (marker && forward)
+            low = std::max(low, marker->ledgerSeq);
+        else if (marker)
+            high = std::min(high, marker->ledgerSeq);
+
+        for (auto const& segment : segments_)
+        {
+            if (low > high || segment->maxLedger < low ||
+                segment->minLedger > high)
+            {
+                continue;
+            }
+
+            Stream stream {segment, forward ?
+                segment->minLedger : segment->maxLedger,
+                    !segment->sealed, {}, 0};
+
+            // Locations still in memory are copied while the lock is held
+            if (!segment->sealed)
+            {
+                auto const it {segment->locations.find(account)};
+                if (it == segment->locations.end())
+                    continue;
+
+                auto const& locations {it->second};
+                if (forward)
+                {
+                    auto i {std::lower_bound(locations.begin(),
+                        locations.end(), low,
+                        [](Location const& location, std::uint32_t seq)
+                        {
+                            return location.ledgerSeq < seq;
+                        })};
+                    for (; i != locations.end() && i->ledgerSeq <= high &&
+                        stream.locations.size() < bound; ++i)
+                    {
+                        stream.locations.push_back(*i);
+                    }
+                }
+                else
+                {
+                    auto i {std::upper_bound(locations.begin(),
+                        locations.end(), high,
+                        [](std::uint32_t seq, Location const& location)
+                        {
+                            return seq < location.ledgerSeq;
+                        })};
+                    for (; i != locations.begin() &&
+                        std::prev(i)->ledgerSeq >= low &&
+                            stream.locations.size() < bound; --i)
+                    {
+                        stream.locations.push_back(*std::prev(i));
+                    }
+                }
+            }
+            streams.push_back(std::move(stream));
+        }
+    }
+
+    std::stable_sort(streams.begin(), streams.end(),
+        [&](Stream const& a, Stream const& b)
+        {
+            return before(a.first, b.first);
+        });
+
+    // Segments are merged in ledger order, and an indexed segment is only
+    // read once it may hold the next ledger of the page.
+    std::map<Segment const*, std::ifstream> logs;
+    std::vector<std::pair<std::uint32_t, uint256>> entries;
+    std::size_t opened {0};
+    for (;;)
+    {
+        boost::optional<std::uint32_t> best;
+        auto consider = [&](Stream const& stream)
+        {
+            if (stream.next < stream.locations.size())
+            {
+                auto const seq {stream.locations[stream.next].ledgerSeq};
+                if (!best || before(seq, *best))
+                    best = seq;
+            }
+        };
+
+        for (std::size_t i = 0; i < opened; ++i)
+            consider(streams[i]);
+        while (opened < streams.size() &&
+            (!best || !before(*best, streams[opened].first)))
+        {
+            auto& stream {streams[opened++]};
+            if (!stream.loaded)
+            {
+                collect(*stream.segment, account, low, high, forward,
+                    bound, stream.locations);
+                stream.loaded = true;
+            }
+            consider(stream);
+        }
+        if (!best)
+            break;
+
+        // The newest segment holds the current copy of a ledger
+        Stream* current {nullptr};
+        for (std::size_t i = 0; i < opened; ++i)
+        {
+            auto& stream {streams[i]};
+            if (stream.next < stream.locations.size() &&
+                stream.locations[stream.next].ledgerSeq == *best)
+            {
+                if (!current || stream.segment->id > current->segment->id)
+                    current = &stream;
+                ++stream.next;
+            }
+        }
+
+        auto const& segment {*current->segment};
+        auto const& location {current->locations[current->next - 1]};
+        auto& is {logs[&segment]};
+        if (!is.is_open())
+        {
+            is.open(segment.log.string(), std::ios::binary);
+            if (!is.is_open())
+            {
+                Throw<std::runtime_error>(
+                    "account_tx log: unable to open " + segment.log.string());
+            }
+        }
+        fetch(is, segment, location, entries);
+        if (!forward)
+            std::reverse(entries.begin(), entries.end());
+
+        for (auto const& e : entries)
+        {
+            if (marker && location.ledgerSeq == marker->ledgerSeq &&
+                (forward ? e.first < marker->txnSeq :
+                    e.first > marker->txnSeq))
+            {
+                continue;
+            }
+            if (result.size() == limit)
+            {
+                marker = Marker {location.ledgerSeq, e.first};
+                return result;
+            }
+            result.push_back({location.ledgerSeq, e.first, e.second});
+        }
+    }
+
+    marker.reset();
+    return result;
+}
+
+void
+AccountTxLog::deleteBefore(std::uint32_t ledgerSeq)
+{
+    // Dropped segments remove their files once released, after the locks
+    std::vector<SegmentPtr> dropped;
+
+    std::lock_guard<std::mutex> wl(writeMutex_);
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+        if (ledgerSeq <= floor_)
+            return;
+    }
+
+    Record record {floorMagic, ledgerSeq, {}};
+    auto const data {serialize(record)};
+    auto const base {append(data)};
+
+    std::uint64_t bytes {0};
+    {
+        std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+        apply(*active_, floor_, record, base, data.size());
+        active_->size += data.size();
+        floor_ = ledgerSeq;
+
+        for (auto it = segments_.begin(); it != segments_.end();)
+        {
+            auto const& segment {*it};
+            if (segment != active_ && segment->maxLedger < floor_)
+            {
+                segment->obsolete = true;
+                bytes += segment->size;
+                dropped.push_back(segment);
+                it = segments_.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    if (!dropped.empty())
+    {
+        reclaimed_ += bytes;
+        JLOG(j_.info()) <<
+            "account_tx log " << dir_.string() << " dropped " <<
+            dropped.size() << " segments, " << bytes <<
+            " bytes, below ledger " << ledgerSeq;
+    }
+}
+
+void
+AccountTxLog::compact()
+{
+    std::lock_guard<std::mutex> cl(compactMutex_);
+
+    std::vector<SegmentPtr> sealed;
+    std::uint32_t floor;
+    {
+        std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+        floor = floor_;
+        for (auto const& segment : segments_)
+        {
+            if (segment->sealed)
+                sealed.push_back(segment);
+        }
+    }
+
+    for (auto const& segment : sealed)
+        compact(segment, floor);
+}
+
+void
+AccountTxLog::compact(SegmentPtr const& segment, std::uint32_t floor)
+{
+    using namespace boost::filesystem;
+
+    // Most segments lie wholly above the floor and were written once
+    if (segment->minLedger >= floor && segment->dead * 2 < segment->size)
+        return;
+
+    auto const next {std::make_shared<Segment>(
+        dir_, segment->id, segment->version + 1)};
+    path const tmp {next->log.string() + ".tmp"};
+    try
+    {
+        std::vector<std::uint64_t> live;
+        {
+            std::ifstream is(segment->index.string(), std::ios::binary);
+            if (!is.is_open())
+            {
+                Throw<std::runtime_error>(
+                    "unable to open " + segment->index.string());
+            }
+
+            std::uint64_t reclaimable {segment->dead};
+            for (auto const& row : readRows(*segment, is, 0, segment->rows))
+            {
+                if (row.location.ledgerSeq < floor)
+                {
+                    reclaimable += groupBytes +
+                        row.location.count * entryBytes;
+                }
+                else
+                {
+                    live.push_back(row.location.offset);
+                }
+            }
+            if (reclaimable * 2 < segment->size)
+                return;
+        }
+        std::sort(live.begin(), live.end());
+
+        if (live.empty())
+        {
+            {
+                std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+                auto const it {std::find(
+                    segments_.begin(), segments_.end(), segment)};
+                if (it == segments_.end())
+                    return;
+                segments_.erase(it);
+                segment->obsolete = true;
+            }
+            reclaimed_ += segment->size;
+            ++compactions_;
+            JLOG(j_.info()) <<
+                "account_tx log segment " << segment->log.string() <<
+                " dropped, nothing in it is live";
+            return;
+        }
+
+        std::ofstream out(tmp.string(), std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+            Throw<std::runtime_error>("unable to create " + tmp.string());
+        std::ifstream in(segment->log.string(), std::ios::binary);
+        if (!in.is_open())
+        {
+            Throw<std::runtime_error>(
+                "unable to open " + segment->log.string());
+        }
+
+        auto emit = [&](Record& record)
+        {
+            auto const data {serialize(record)};
+            out.write(reinterpret_cast<char const*>(data.data()),
+                data.size());
+            apply(*next, 0, record, next->size, data.size());
+            next->size += data.size();
+        };
+
+        {
+            Record record {floorMagic, std::max(floor, segment->floor), {}};
+            if (record.ledgerSeq != 0)
+                emit(record);
+        }
+
+        Record record;
+        std::uint64_t offset {0};
+        std::uint64_t size;
+        while (offset < segment->size)
+        {
+            if (!read(in, offset, segment->size, record, size))
+            {
+                Throw<std::runtime_error>(
+                    "corrupt record at offset " + std::to_string(offset));
+            }
+            offset += size;
+            if (record.magic != ledgerMagic)
+                continue;
+
+            record.groups.erase(std::remove_if(
+                record.groups.begin(), record.groups.end(),
+                [&](Group const& group)
+                {
+                    return !std::binary_search(
+                        live.begin(), live.end(), group.offset);
+                }), record.groups.end());
+            if (!record.groups.empty())
+                emit(record);
+        }
+
+        out.flush();
+        if (!out)
+            Throw<std::runtime_error>("unable to write " + tmp.string());
+        out.close();
+
+        // The rewritten log must be durable before it replaces the original
+        boost::system::error_code ec;
+        syncFile(ec, tmp);
+        if (!ec)
+            rename(tmp, next->log, ec);
+        if (ec)
+            Throw<std::runtime_error>(ec.message());
+
+        std::vector<Row> rows;
+        for (auto const& account : next->locations)
+        {
+            for (auto const& location : account.second)
+                rows.push_back({account.first, location});
+        }
+        std::sort(rows.begin(), rows.end(),
+            [](Row const& a, Row const& b)
+            {
+                return keyLess(Fence {a.account, a.location.ledgerSeq},
+                    b.account, b.location.ledgerSeq);
+            });
+        next->fences = writeIndex(*next, rows);
+        next->rows = rows.size();
+        next->sealed = true;
+        Index {}.swap(next->locations);
+    }
+    catch (std::exception const& e)
+    {
+        // The original segment stays in place; whatever was written of
+        // the replacement is discarded, here or at the next start.
+        JLOG(j_.error()) <<
+            "account_tx log segment " << segment->log.string() <<
+            " compaction failed: " << e.what();
+        boost::system::error_code ec;
+        remove(tmp, ec);
+        remove(next->log, ec);
+        remove(next->index.string() + ".tmp", ec);
+        remove(next->index, ec);
+        return;
+    }
+
+    {
+        std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+        auto const it {std::find(segments_.begin(), segments_.end(), segment)};
+        if (it == segments_.end())
+        {
+            // Dropped by deleteBefore in the meantime
+            next->obsolete = true;
+            return;
+        }
+        *it = next;
+        segment->obsolete = true;
+    }
+
+    if (segment->size > next->size)
+        reclaimed_ += segment->size - next->size;
+    ++compactions_;
+
+    JLOG(j_.info()) <<
+        "account_tx log segment " << segment->log.string() <<
+        " compacted from " << segment->size << " to " <<
+        next->size << " bytes";
+}
+
+bool
+AccountTxLog::empty() const
+{
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    return std::none_of(segments_.begin(), segments_.end(),
+        [this](SegmentPtr const& segment)
+        {
+            return segment->entries != 0 && segment->maxLedger >= floor_;
+        });
+}
+
+std::uint32_t
+AccountTxLog::highWater() const
+{
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    if (floor_ == 0)
+        return highWater_;
+    return std::max(highWater_, floor_ - 1);
+}
+
+Json::Value
+AccountTxLog::getJson() const
+{
+    Json::Value ret(Json::objectValue);
+    ret[jss::type] = "log";
+    ret[jss::compactions] = std::to_string(compactions_.load());
+    ret[jss::reclaimed] = std::to_string(reclaimed_.load());
+
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    std::uint64_t size {0};
+    std::uint64_t entries {0};
+    for (auto const& segment : segments_)
+    {
+        size += segment->size;
+        entries += segment->entries;
+    }
+    ret[jss::file_size] = std::to_string(size);
+    ret[jss::segments] = static_cast<Json::UInt>(segments_.size());
+    ret[jss::entries] = std::to_string(entries);
+    ret[jss::min_ledger] = floor_;
+    ret[jss::max_ledger] = highWater_;
+    return ret;
+}
+
+std::uint64_t
+AccountTxLog::fileSize() const
+{
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    std::uint64_t size {0};
+    for (auto const& segment : segments_)
+        size += segment->size;
+    return size;
+}
+
+std::size_t
+AccountTxLog::segments() const
+{
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    return segments_.size();
+}
+
+void
+AccountTxLog::flush()
+{
+    std::unique_lock<std::mutex> lock(sealMutex_);
+    sealCond_.wait(lock, [this] { return sealQueue_.empty(); });
+}
+
+AccountTxLog::SegmentPtr
+AccountTxLog::roll()
+{
+    auto const id {active_ ? active_->id + 1 :
+        (segments_.empty() ? 1 : segments_.back()->id + 1)};
+    auto next {std::make_shared<Segment>(dir_, id, 0)};
+    {
+        std::ofstream create(next->log.string(),
+            std::ios::binary | std::ios::trunc);
+        if (!create.is_open())
+        {
+            Throw<std::runtime_error>(
+                "account_tx log: unable to create " + next->log.string());
+        }
+    }
+
+    boost::system::error_code ec;
+    syncDirectory(ec, dir_);
+    if (ec)
+    {
+        Throw<std::runtime_error>(
+            "account_tx log: unable to sync " + dir_.string());
+    }
+
+    std::ofstream writer(next->log.string(), std::ios::binary | std::ios::app);
+    if (!writer.is_open())
+    {
+        Throw<std::runtime_error>(
+            "account_tx log: unable to open " + next->log.string());
+    }
+    writer_ = std::move(writer);
+
+    std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+    segments_.push_back(next);
+    auto full {std::move(active_)};
+    active_ = std::move(next);
+    return full;
+}
+
+void
+AccountTxLog::seal(SegmentPtr const& segment)
+{
+    // A segment queued here is no longer written, so its locations can
+    // be read without the lock.
+    try
+    {
+        std::vector<Row> rows;
+        for (auto const& account : segment->locations)
+        {
+            for (auto const& location : account.second)
+                rows.push_back({account.first, location});
+        }
+        std::sort(rows.begin(), rows.end(),
+            [](Row const& a, Row const& b)
+            {
+                return keyLess(Fence {a.account, a.location.ledgerSeq},
+                    b.account, b.location.ledgerSeq);
+            });
+        auto fences {writeIndex(*segment, rows)};
+
+        Index locations;
+        {
+            std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+            segment->rows = rows.size();
+            segment->fences = std::move(fences);
+            segment->sealed = true;
+            locations.swap(segment->locations);
+        }
+
+        JLOG(j_.debug()) <<
+            "account_tx log segment " << segment->log.string() <<
+            " indexed with " << rows.size() << " locations";
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(j_.warn()) <<
+            "account_tx log segment " << segment->log.string() <<
+            " could not be indexed, it stays in memory until the next"
+            " start: " << e.what();
+    }
+}
+
+void
+AccountTxLog::sealLoop()
+{
+    beast::setCurrentThreadName("AccountTxLog");
+
+    std::unique_lock<std::mutex> lock(sealMutex_);
+    for (;;)
+    {
+        sealCond_.wait(lock, [this] { return stop_ || !sealQueue_.empty(); });
+        if (sealQueue_.empty())
+            return;
+
+        auto const segment {sealQueue_.front()};
+        lock.unlock();
+        seal(segment);
+        lock.lock();
+        sealQueue_.pop_front();
+        sealCond_.notify_all();
+    }
+}
+
+void
+AccountTxLog::load()
+{
+    using namespace boost::filesystem;
+
+    create_directories(dir_);
+
+    boost::system::error_code ec;
+    if (exists(dir_ / legacyFileName))
+    {
+        // The log of an unsegmented store becomes its first segment, and
+        // is indexed like any other
+        remove(dir_ / legacyIndexFileName, ec);
+        rename(dir_ / legacyFileName, logPath(dir_, 1, 0));
+        syncDirectory(ec, dir_);
+        JLOG(j_.info()) <<
+            "account_tx log " << dir_.string() <<
+            " converting " << legacyFileName << " to segments";
+    }
+
+    struct File
+    {
+        path file;
+        std::uint64_t id;
+        std::uint32_t version;
+        bool temporary;
+    };
+
+    std::vector<File> files;
+    std::map<std::uint64_t, std::uint32_t> latest;
+    auto const numeric = [](std::string const& s, std::size_t digits)
+    {
+        return !s.empty() && s.size() <= digits &&
+            std::all_of(s.begin(), s.end(),
+                [](char c) { return c >= '0' && c <= '9'; });
+    };
+    for (directory_iterator it(dir_), end; it != end; ++it)
+    {
+        auto const name {it->path().filename().string()};
+        std::vector<std::string> parts;
+        boost::split(parts, name, boost::is_any_of("."));
+        if (parts.size() < 4 || parts.size() > 5 ||
+            parts[0] != filePrefix || !numeric(parts[1], 19) ||
+                !numeric(parts[2], 9) ||
+                    (parts[3] != "log" && parts[3] != "index") ||
+                        (parts.size() == 5 && parts[4] != "tmp"))
+        {
+            continue;
+        }
+
+        File const file {it->path(), std::stoull(parts[1]),
+            static_cast<std::uint32_t>(std::stoul(parts[2])),
+                parts.size() == 5};
+        if (!file.temporary && parts[3] == "log")
+        {
+            auto const result {latest.emplace(file.id, file.version)};
+            if (!result.second)
+                result.first->second =
+                    std::max(result.first->second, file.version);
+        }
+        files.push_back(file);
+    }
+
+    // Older versions were replaced by a compaction that did not get to
+    // remove them, temporary files by work that did not finish
+    for (auto const& file : files)
+    {
+        auto const it {latest.find(file.id)};
+        if (file.temporary || it == latest.end() ||
+            it->second != file.version)
+        {
+            remove(file.file, ec);
+        }
+    }
+
+    std::vector<SegmentPtr> unsealed;
+    for (auto const& l : latest)
+    {
+        auto const segment {std::make_shared<Segment>(dir_, l.first, l.second)};
+        if (!loadIndex(*segment))
+        {
+            remove(segment->index, ec);
+            scan(*segment);
+            if (l.first != latest.rbegin()->first)
+                unsealed.push_back(segment);
+        }
+        floor_ = std::max(floor_, segment->floor);
+        highWater_ = std::max(highWater_, segment->maxLedger);
+        segments_.push_back(segment);
+    }
+
+    if (!segments_.empty() && !segments_.back()->sealed)
+        active_ = segments_.back();
+    if (!active_ || active_->size >= segmentBytes_)
+    {
+        if (auto full = roll())
+            unsealed.push_back(std::move(full));
+    }
+    else
+    {
+        writer_.open(active_->log.string(), std::ios::binary | std::ios::app);
+        if (!writer_.is_open())
+        {
+            Throw<std::runtime_error>(
+                "account_tx log: unable to open " + active_->log.string());
+        }
+    }
+
+    for (auto it = segments_.begin(); it != segments_.end();)
+    {
+        auto const& segment {*it};
+        if (segment != active_ && segment->maxLedger < floor_)
+        {
+            segment->obsolete = true;
+            unsealed.erase(std::remove(unsealed.begin(), unsealed.end(),
+                segment), unsealed.end());
+            it = segments_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    sealQueue_.assign(unsealed.begin(), unsealed.end());
+
+    JLOG(j_.debug()) <<
+        "account_tx log " << dir_.string() << " opened with " <<
+        segments_.size() << " segments, " << sealQueue_.size() <<
+        " to index";
+}
+
+void
+AccountTxLog::scan(Segment& segment)
+{
+    using namespace boost::filesystem;
+
+    auto const end {file_size(segment.log)};
+    std::uint64_t offset {0};
+    {
+        std::ifstream is(segment.log.string(), std::ios::binary);
+        Record record;
+        std::uint64_t size;
+        while (offset < end && read(is, offset, end, record, size))
+        {
+            apply(segment, 0, record, 0, size);
+            offset += size;
+        }
+    }
+
+    if (offset != end)
+    {
+        JLOG(j_.warn()) <<
+            "account_tx log " << segment.log.string() << ": discarding " <<
+            (end - offset) << " bytes after offset " << offset;
+        resize_file(segment.log, offset);
+    }
+    segment.size = offset;
+}
+
+bool
+AccountTxLog::loadIndex(Segment& segment)
+{
+    using namespace boost::filesystem;
+
+    boost::system::error_code ec;
+    if (!exists(segment.index, ec))
+        return false;
+
+    auto fail = [&](char const* reason)
+    {
+        JLOG(j_.warn()) <<
+            "account_tx log index " << segment.index.string() << " " <<
+            reason << ", scanning its segment";
+        return false;
+    };
+
+    auto const bytes {file_size(segment.index, ec)};
+    if (ec || bytes < indexHeaderBytes + checksumBytes)
+        return fail("is truncated");
+
+    std::ifstream is(segment.index.string(), std::ios::binary);
+    std::vector<std::uint8_t> header(indexHeaderBytes);
+    is.read(reinterpret_cast<char*>(header.data()), header.size());
+    if (!is)
+        return fail("is unreadable");
+    if (get32(&header[0]) != indexMagic || get32(&header[4]) != fenceStride)
+        return fail("is corrupt");
+
+    auto const rows {get64(&header[8])};
+    std::uint64_t const fences {get32(&header[52])};
+    if (rows > bytes / rowBytes ||
+        fences != (rows + fenceStride - 1) / fenceStride ||
+            bytes != indexHeaderBytes + rows * rowBytes +
+                fences * fenceBytes + checksumBytes)
+    {
+        return fail("is corrupt");
+    }
+
+    std::vector<std::uint8_t> data(fences * fenceBytes);
+    std::array<std::uint8_t, checksumBytes> sum;
+    is.seekg(indexHeaderBytes + rows * rowBytes);
+    is.read(reinterpret_cast<char*>(data.data()), data.size());
+    is.read(reinterpret_cast<char*>(sum.data()), sum.size());
+    if (!is)
+        return fail("is unreadable");
+    if (get64(sum.data()) != checksum(header, data))
+        return fail("is corrupt");
+
+    // The index must describe the log as it is
+    auto const logBytes {file_size(segment.log, ec)};
+    if (ec || logBytes != get64(&header[16]))
+        return fail("does not match its log");
+
+    segment.size = logBytes;
+    segment.dead = get64(&header[24]);
+    segment.entries = get64(&header[32]);
+    segment.minLedger = get32(&header[40]);
+    segment.maxLedger = get32(&header[44]);
+    segment.floor = get32(&header[48]);
+    segment.rows = rows;
+    segment.fences.reserve(fences);
+    for (std::size_t p = 0; p < data.size(); p += fenceBytes)
+    {
+        segment.fences.push_back(
+            {AccountID::fromVoid(&data[p]), get32(&data[p + 20])});
+    }
+    segment.sealed = true;
+    return true;
+}
+
+auto
+AccountTxLog::writeIndex(Segment const& segment,
+    std::vector<Row> const& rows) -> std::vector<Fence>
+{
+    using namespace boost::filesystem;
+
+    std::vector<Fence> fences;
+    for (std::size_t i = 0; i < rows.size(); i += fenceStride)
+        fences.push_back({rows[i].account, rows[i].location.ledgerSeq});
+
+    std::vector<std::uint8_t> header(indexHeaderBytes);
+    put32(&header[0], indexMagic);
+    put32(&header[4], fenceStride);
+    put64(&header[8], rows.size());
+    put64(&header[16], segment.size);
+    put64(&header[24], segment.dead);
+    put64(&header[32], segment.entries);
+    put32(&header[40], segment.minLedger);
+    put32(&header[44], segment.maxLedger);
+    put32(&header[48], segment.floor);
+    put32(&header[52], static_cast<std::uint32_t>(fences.size()));
+
+    std::vector<std::uint8_t> data(fences.size() * fenceBytes);
+    for (std::size_t i = 0; i < fences.size(); ++i)
+    {
+        std::memcpy(&data[i * fenceBytes], fences[i].account.data(),
+            fences[i].account.size());
+        put32(&data[i * fenceBytes + 20], fences[i].ledgerSeq);
+    }
+    std::array<std::uint8_t, checksumBytes> sum;
+    put64(sum.data(), checksum(header, data));
+
+    path const tmp {segment.index.string() + ".tmp"};
+    std::ofstream out(tmp.string(), std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+        Throw<std::runtime_error>("unable to create " + tmp.string());
+    out.write(reinterpret_cast<char const*>(header.data()), header.size());
+
+    std::vector<std::uint8_t> block(fenceStride * rowBytes);
+    for (std::size_t i = 0; i < rows.size(); i += fenceStride)
+    {
+        auto const count {std::min<std::size_t>(fenceStride, rows.size() - i)};
+        for (std::size_t j = 0; j < count; ++j)
+        {
+            auto const& row {rows[i + j]};
+            auto const p {&block[j * rowBytes]};
+            std::memcpy(p, row.account.data(), row.account.size());
+            put32(p + 20, row.location.ledgerSeq);
+            put32(p + 24, row.location.count);
+            put64(p + 28, row.location.offset);
+        }
+        out.write(reinterpret_cast<char const*>(block.data()),
+            count * rowBytes);
+    }
+
+    out.write(reinterpret_cast<char const*>(data.data()), data.size());
+    out.write(reinterpret_cast<char const*>(sum.data()), sum.size());
+    out.close();
+
+    boost::system::error_code ec;
+    if (!out)
+        ec = make_error_code(boost::system::errc::io_error);
+    if (!ec)
+        syncFile(ec, tmp);
+    if (!ec)
+        rename(tmp, segment.index, ec);
+    if (!ec)
+        syncDirectory(ec, dir_);
+    if (ec)
+    {
+        boost::system::error_code ignored;
+        remove(tmp, ignored);
+        Throw<std::runtime_error>(
+            "unable to write " + segment.index.string() + ": " + ec.message());
+    }
+    return fences;
+}
+
+auto
+AccountTxLog::readRows(Segment const& segment, std::istream& is,
+    std::uint64_t first, std::uint64_t count) const -> std::vector<Row>
+{
+    std::vector<std::uint8_t> data(count * rowBytes);
+    is.clear();
+    is.seekg(indexHeaderBytes + first * rowBytes);
+    is.read(reinterpret_cast<char*>(data.data()), data.size());
+    if (!is)
+    {
+        Throw<std::runtime_error>(
+            "account_tx log: unable to read " + segment.index.string());
+    }
+
+    std::vector<Row> rows;
+    rows.reserve(count);
+    for (std::size_t p = 0; p < data.size(); p += rowBytes)
+    {
+        rows.push_back({AccountID::fromVoid(&data[p]),
+            {get32(&data[p + 20]), get32(&data[p + 24]),
+                get64(&data[p + 28])}});
+    }
+    return rows;
+}
+
+void
+AccountTxLog::collect(Segment const& segment, AccountID const& account,
+    std::uint32_t low, std::uint32_t high, bool forward,
+        std::size_t limit, std::vector<Location>& locations) const
+{
+    if (segment.rows == 0)
+        return;
+
+    std::ifstream is(segment.index.string(), std::ios::binary);
+    if (!is.is_open())
+    {
+        Throw<std::runtime_error>(
+            "account_tx log: unable to open " + segment.index.string());
+    }
+
+    auto const key {forward ? low : high};
+    auto const blocks {segment.fences.size()};
+
+    // The block holding the last row not above the key
+    auto const fence {std::upper_bound(
+        segment.fences.begin(), segment.fences.end(), key,
+        [&](std::uint32_t seq, Fence const& f)
+        {
+            return keyGreater(f, account, seq);
+        })};
+    if (fence == segment.fences.begin() && !forward)
+        return;
+    std::size_t block = fence == segment.fences.begin() ?
+        0 : std::distance(segment.fences.begin(), fence) - 1;
+
+    auto readBlock = [&]
+    {
+        auto const first {std::uint64_t{block} * fenceStride};
+        return readRows(segment, is, first,
+            std::min<std::uint64_t>(fenceStride, segment.rows - first));
+    };
+    auto rows {readBlock()};
+
+    if (forward)
+    {
+        auto i {std::lower_bound(rows.begin(), rows.end(), key,
+            [&](Row const& row, std::uint32_t seq)
+            {
+                return keyLess(Fence {row.account, row.location.ledgerSeq},
+                    account, seq);
+            })};
+        while (locations.size() < limit)
+        {
+            if (i == rows.end())
+            {
+                if (++block == blocks)
+                    break;
+                rows = readBlock();
+                i = rows.begin();
+                continue;
+            }
+            if (i->account != account || i->location.ledgerSeq > high)
+                break;
+            locations.push_back(i->location);
+            ++i;
+        }
+    }
+    else
+    {
+        auto i {std::upper_bound(rows.begin(), rows.end(), key,
+            [&](std::uint32_t seq, Row const& row)
+            {
+                return keyGreater(Fence {row.account, row.location.ledgerSeq},
+                    account, seq);
+            })};
+        while (locations.size() < limit)
+        {
+            if (i == rows.begin())
+            {
+                if (block-- == 0)
+                    break;
+                rows = readBlock();
+                i = rows.end();
+                continue;
+            }
+            auto const& row {*std::prev(i)};
+            if (row.account != account || row.location.ledgerSeq < low)
+                break;
+            locations.push_back(row.location);
+            --i;
+        }
+    }
+}
+
+std::vector<std::uint8_t>
+AccountTxLog::serialize(Record& record)
+{
+    std::size_t payload {0};
+    for (auto const& group : record.groups)
+        payload += groupBytes + group.entries.size() * entryBytes;
+
+    std::vector<std::uint8_t> data(headerBytes + payload + checksumBytes);
+    put32(&data[0], record.magic);
+    put32(&data[4], static_cast<std::uint32_t>(payload));
+    put32(&data[8], record.ledgerSeq);
+    put32(&data[12], static_cast<std::uint32_t>(record.groups.size()));
+
+    auto p {headerBytes};
+    for (auto& group : record.groups)
+    {
+        std::memcpy(&data[p], group.account.data(), group.account.size());
+        put32(&data[p + 20], static_cast<std::uint32_t>(group.entries.size()));
+        p += groupBytes;
+        group.offset = p;
+        for (auto const& e : group.entries)
+        {
+            put32(&data[p], e.first);
+            std::memcpy(&data[p + 4], e.second.data(), e.second.size());
+            p += entryBytes;
+        }
+    }
+    put64(&data[p], checksum(data.data(), p));
+    return data;
+}
+
+bool
+AccountTxLog::read(std::istream& is, std::uint64_t offset,
+    std::uint64_t end, Record& record, std::uint64_t& size)
+{
+    if (end - offset < headerBytes + checksumBytes)
+        return false;
+
+    std::array<std::uint8_t, headerBytes> header;
+    is.clear();
+    is.seekg(offset);
+    is.read(reinterpret_cast<char*>(header.data()), header.size());
+    if (!is)
+        return false;
+
+    record.magic = get32(&header[0]);
+    if (record.magic != ledgerMagic && record.magic != floorMagic)
+        return false;
+    std::uint64_t const payload {get32(&header[4])};
+    if (payload > end - offset - headerBytes - checksumBytes)
+        return false;
+
+    std::vector<std::uint8_t> data(headerBytes + payload + checksumBytes);
+    std::memcpy(data.data(), header.data(), header.size());
+    is.read(reinterpret_cast<char*>(&data[headerBytes]),
+        payload + checksumBytes);
+    if (!is)
+        return false;
+
+    auto const last {headerBytes + payload};
+    if (get64(&data[last]) != checksum(data.data(), last))
+        return false;
+
+    record.ledgerSeq = get32(&header[8]);
+    auto const groups {get32(&header[12])};
+    record.groups.clear();
+    auto p {headerBytes};
+    for (std::uint32_t i = 0; i < groups; ++i)
+    {
+        if (last - p < groupBytes)
+            return false;
+        Group group;
+        group.account = AccountID::fromVoid(&data[p]);
+        std::uint64_t const count {get32(&data[p + 20])};
+        p += groupBytes;
+        if ((last - p) / entryBytes < count)
+            return false;
+        group.offset = offset + p;
+        group.entries.reserve(count);
+        for (std::uint64_t j = 0; j < count; ++j)
+        {
+            group.entries.emplace_back(
+                get32(&data[p]), uint256::fromVoid(&data[p + 4]));
+            p += entryBytes;
+        }
+        record.groups.push_back(std::move(group));
+    }
+    if (p != last)
+        return false;
+
+    size = data.size();
+    return true;
+}
+
+void
+AccountTxLog::apply(Segment& segment, std::uint32_t floor,
+    Record const& record, std::uint64_t base, std::uint64_t size)
+{
+    if (record.magic == floorMagic)
+    {
+        segment.floor = std::max(segment.floor, record.ledgerSeq);
+        return;
+    }
+    if (record.ledgerSeq < floor)
+    {
+        segment.dead += size;
+        return;
+    }
+
+    segment.minLedger = std::min(segment.minLedger, record.ledgerSeq);
+    segment.maxLedger = std::max(segment.maxLedger, record.ledgerSeq);
+    for (auto const& group : record.groups)
+    {
+        Location const location {record.ledgerSeq,
+            static_cast<std::uint32_t>(group.entries.size()),
+            base + group.offset};
+        auto& locations {segment.locations[group.account]};
+        auto it {std::lower_bound(locations.begin(), locations.end(),
+            location.ledgerSeq,
+            [](Location const& l, std::uint32_t seq)
+            {
+                return l.ledgerSeq < seq;
+            })};
+        if (it != locations.end() && it->ledgerSeq == location.ledgerSeq)
+        {
+            segment.entries -= it->count;
+            segment.dead += groupBytes + it->count * entryBytes;
+            *it = location;
+        }
+        else
+        {
+            locations.insert(it, location);
+        }
+        segment.entries += location.count;
+    }
+}
+
+std::uint64_t
+AccountTxLog::append(std::vector<std::uint8_t> const& data)
+{
+    auto const offset {active_->size};
+    writer_.write(reinterpret_cast<char const*>(data.data()), data.size());
+    writer_.flush();
+    if (!writer_)
+    {
+        Throw<std::runtime_error>(
+            "account_tx log: unable to write " + active_->log.string());
+    }
+
+    boost::system::error_code ec;
+    syncFile(ec, active_->log);
+    if (ec)
+    {
+        Throw<std::runtime_error>(
+            "account_tx log: unable to sync " + active_->log.string());
+    }
+    return offset;
+}
+
+void
+AccountTxLog::fetch(std::istream& is, Segment const& segment,
+    Location const& location,
+        std::vector<std::pair<std::uint32_t, uint256>>& entries) const
+{
+    std::vector<std::uint8_t> data(location.count * entryBytes);
+    is.clear();
+    is.seekg(location.offset);
+    is.read(reinterpret_cast<char*>(data.data()), data.size());
+    if (!is)
+    {
+        Throw<std::runtime_error>(
+            "account_tx log: unable to read " + segment.log.string());
+    }
+
+    entries.clear();
+    entries.reserve(location.count);
+    for (std::size_t p = 0; p < data.size(); p += entryBytes)
+        entries.emplace_back(get32(&data[p]), uint256::fromVoid(&data[p + 4]));
+}
+
+}
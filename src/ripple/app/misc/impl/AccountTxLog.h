@@ -0,0 +1,282 @@
+#ifndef RIPPLE_APP_MISC_ACCOUNTTXLOG_H_INCLUDED
+#define RIPPLE_APP_MISC_ACCOUNTTXLOG_H_INCLUDED
+
+#include <ripple/app/misc/AccountTxStore.h>
+#include <ripple/basics/UnorderedContainers.h>
+#include <boost/filesystem.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+
+namespace ripple {
+
+/** An append-only account transaction store split into segments.
+
+    Records are appended to the newest segment. Once it reaches the
+    segment size a new one is started, and a background thread writes the
+    full segment's locations, sorted by account and ledger, to an index
+    file beside it. Only the segment being written keeps its locations in
+    memory; for the others the store holds every fenceStride-th key of
+    the index, and a lookup reads one block of it.
+
+    A ledger written again replaces the earlier copy: within a segment
+    the index keeps the latest location, and across segments the newest
+    segment wins.
+*/
+class AccountTxLog : public AccountTxStore
+{
+public:
+    static constexpr auto filePrefix = "account_tx";
+
+    // The single log file written before the store was segmented
+    static constexpr auto legacyFileName = "account_tx.log";
+
+    static constexpr auto legacyIndexFileName = "account_tx.index";
+
+    static constexpr std::uint32_t ledgerMagic = 0x4c585441;
+
+    static constexpr std::uint32_t floorMagic = 0x46585441;
+
+    static constexpr std::uint32_t indexMagic = 0x53585441;
+
+    static constexpr std::size_t headerBytes = 16;
+
+    static constexpr std::size_t groupBytes = 24;
+
+    static constexpr std::size_t entryBytes = 36;
+
+    static constexpr std::size_t checksumBytes = 8;
+
+    static constexpr std::size_t indexHeaderBytes = 56;
+
+    static constexpr std::size_t rowBytes = 36;
+
+    static constexpr std::size_t fenceBytes = 24;
+
+    // Index rows per fence, which is also the most read by one lookup
+    static constexpr std::uint32_t fenceStride = 1024;
+
+    // Bytes appended to a segment before a new one is started, which
+    // bounds the part of the store that has to be scanned at startup.
+    static constexpr std::uint64_t defaultSegmentBytes = 64 * 1024 * 1024;
+
+    AccountTxLog(boost::filesystem::path const& dir, beast::Journal j,
+        std::uint64_t segmentBytes = defaultSegmentBytes);
+
+    ~AccountTxLog() override;
+
+    std::string
+    getName() const override;
+
+    void
+    insert(std::uint32_t ledgerSeq,
+        std::vector<Transaction> const& txns) override;
+
+    std::vector<Entry>
+    page(AccountID const& account, std::uint32_t minLedger,
+        std::uint32_t maxLedger, bool forward,
+            boost::optional<Marker>& marker, std::size_t limit) override;
+
+    /** Drop the history below a ledger.
+
+        Segments that hold nothing at or above it are removed at once;
+        the rest are left to compact().
+    */
+    void
+    deleteBefore(std::uint32_t ledgerSeq) override;
+
+    /** Rewrite indexed segments of which at least half is reclaimable. */
+    void
+    compact() override;
+
+    bool
+    empty() const override;
+
+    std::uint32_t
+    highWater() const override;
+
+    Json::Value
+    getJson() const override;
+
+    std::uint64_t
+    fileSize() const;
+
+    std::size_t
+    segments() const;
+
+    /** Wait until every full segment has its index written. */
+    void
+    flush();
+
+    static
+    boost::filesystem::path
+    logPath(boost::filesystem::path const& dir,
+        std::uint64_t id, std::uint32_t version);
+
+    static
+    boost::filesystem::path
+    indexPath(boost::filesystem::path const& dir,
+        std::uint64_t id, std::uint32_t version);
+
+private:
+    struct Location
+    {
+        std::uint32_t ledgerSeq;
+        std::uint32_t count;
+        std::uint64_t offset;
+    };
+
+    struct Row
+    {
+        AccountID account;
+        Location location;
+    };
+
+    struct Fence
+    {
+        AccountID account;
+        std::uint32_t ledgerSeq;
+    };
+
+    struct Group
+    {
+        AccountID account;
+        std::uint64_t offset;
+        std::vector<std::pair<std::uint32_t, uint256>> entries;
+    };
+
+    struct Record
+    {
+        std::uint32_t magic;
+        std::uint32_t ledgerSeq;
+        std::vector<Group> groups;
+    };
+
+    using Index = hash_map<AccountID, std::vector<Location>>;
+
+    struct Segment
+    {
+        Segment(boost::filesystem::path const& dir,
+            std::uint64_t id, std::uint32_t version);
+
+        Segment(Segment const&) = delete;
+        Segment& operator=(Segment const&) = delete;
+
+        // Removes the files of an obsolete segment
+        ~Segment();
+
+        std::uint64_t const id;
+        std::uint32_t const version;
+        boost::filesystem::path const log;
+        boost::filesystem::path const index;
+
+        std::uint64_t size {0};
+        // Bytes of groups replaced by a later copy in this segment
+        std::uint64_t dead {0};
+        std::uint64_t entries {0};
+        std::uint32_t minLedger {std::numeric_limits<std::uint32_t>::max()};
+        std::uint32_t maxLedger {0};
+        std::uint32_t floor {0};
+
+        // Until its index is written a segment's locations are in memory
+        Index locations;
+
+        bool sealed {false};
+        std::uint64_t rows {0};
+        std::vector<Fence> fences;
+
+        // Set once the segment is dropped or replaced; its files are
+        // removed when the last reader lets go of it.
+        std::atomic<bool> obsolete {false};
+    };
+
+    using SegmentPtr = std::shared_ptr<Segment>;
+
+    void
+    load();
+
+    void
+    scan(Segment& segment);
+
+    bool
+    loadIndex(Segment& segment);
+
+    std::vector<Fence>
+    writeIndex(Segment const& segment, std::vector<Row> const& rows);
+
+    std::vector<Row>
+    readRows(Segment const& segment, std::istream& is,
+        std::uint64_t first, std::uint64_t count) const;
+
+    void
+    collect(Segment const& segment, AccountID const& account,
+        std::uint32_t low, std::uint32_t high, bool forward,
+            std::size_t limit, std::vector<Location>& locations) const;
+
+    SegmentPtr
+    roll();
+
+    void
+    seal(SegmentPtr const& segment);
+
+    void
+    sealLoop();
+
+    void
+    compact(SegmentPtr const& segment, std::uint32_t floor);
+
+    static
+    std::vector<std::uint8_t>
+    serialize(Record& record);
+
+    static
+    bool
+    read(std::istream& is, std::uint64_t offset,
+        std::uint64_t end, Record& record, std::uint64_t& size);
+
+    static
+    void
+    apply(Segment& segment, std::uint32_t floor,
+        Record const& record, std::uint64_t base, std::uint64_t size);
+
+    std::uint64_t
+    append(std::vector<std::uint8_t> const& data);
+
+    void
+    fetch(std::istream& is, Segment const& segment,
+        Location const& location,
+            std::vector<std::pair<std::uint32_t, uint256>>& entries) const;
+
+    boost::filesystem::path const dir_;
+    beast::Journal j_;
+    std::uint64_t const segmentBytes_;
+
+    std::mutex compactMutex_;
+    std::mutex writeMutex_;
+    std::ofstream writer_;
+
+    std::shared_timed_mutex mutable mutex_;
+    // Ordered by id; the last one is the segment being written
+    std::vector<SegmentPtr> segments_;
+    SegmentPtr active_;
+    std::uint32_t floor_ {0};
+    std::uint32_t highWater_ {0};
+
+    std::mutex sealMutex_;
+    std::condition_variable sealCond_;
+    std::deque<SegmentPtr> sealQueue_;
+    bool stop_ {false};
+    std::thread sealer_;
+
+    std::atomic<std::uint64_t> compactions_ {0};
+    std::atomic<std::uint64_t> reclaimed_ {0};
+};
+
+}
+
+#endif
@@ -8,6 +8,7 @@
 #include <ripple/protocol/Serializer.h>
 #include <ripple/protocol/UintTypes.h>
 #include <boost/format.hpp>
+#include <limits>
 #include <memory>
 
 namespace ripple {
@@ -252,6 +253,162 @@ accountTxPage (
     return;
 }
 
+static
+void
+fetchAccountTxs (
+    DatabaseCon& connection,
+    std::vector<AccountTxStore::Entry> const& entries,
+    std::function<void (std::uint32_t)> const& onUnsavedLedger,
+    std::function<void (std::uint32_t,
+                        std::string const&,
+                        Blob const&,
+                        Blob const&)> const& onTransaction)
+{
+    if (entries.empty ())
+        return;
+
+    auto db (connection.checkoutDb());
+
+    Blob rawData;
+    Blob rawMeta;
+
+    std::string id;
+    boost::optional<std::string> status;
+    soci::blob txnData (*db);
+    soci::blob txnMeta (*db);
+    soci::indicator dataPresent, metaPresent;
+
+    soci::statement st = (db->prepare <<
+        "SELECT Status,RawTxn,TxnMeta FROM Transactions "
+        "WHERE TransID = :id;",
+        soci::into (status),
+        soci::into (txnData, dataPresent),
+        soci::into (txnMeta, metaPresent),
+        soci::use (id));
+
+    for (auto const& entry : entries)
+    {
+        id = to_string (entry.id);
+        if (! st.execute (true))
+        {
+            onUnsavedLedger (entry.ledgerSeq);
+            continue;
+        }
+
+        if (dataPresent == soci::i_ok)
+            convert (txnData, rawData);
+        else
+            rawData.clear ();
+
+        if (metaPresent == soci::i_ok)
+            convert (txnMeta, rawMeta);
+        else
+            rawMeta.clear ();
+
+        if (rawMeta.size() == 0)
+            onUnsavedLedger (entry.ledgerSeq);
+
+        onTransaction (entry.ledgerSeq, status.value_or (""),
+            rawData, rawMeta);
+    }
+}
+
+static
+std::uint32_t
+ledgerBound (std::int32_t ledger, std::uint32_t unbounded)
+{
+    return ledger < 0 ? unbounded : static_cast<std::uint32_t> (ledger);
+}
+
+void
+accountTxPage (
+    DatabaseCon& connection,
+    AccountTxStore& store,
+    std::function<void (std::uint32_t)> const& onUnsavedLedger,
+    std::function<void (std::uint32_t,
+                        std::string const&,
+                        Blob const&,
+                        Blob const&)> const& onTransaction,
+    AccountID const& account,
+    std::int32_t minLedger,
+    std::int32_t maxLedger,
+    bool forward,
+    Json::Value& token,
+    int limit,
+    bool bAdmin,
+    std::uint32_t page_length)
+{
+    std::uint32_t numberOfResults;
+
+    if (limit <= 0 || (limit > page_length && !bAdmin))
+        numberOfResults = page_length;
+    else
+        numberOfResults = limit;
+
+    boost::optional<AccountTxStore::Marker> marker;
+
+    if (token.isObject())
+    {
+        try
+        {
+            if (!token.isMember(jss::ledger) || !token.isMember(jss::seq))
+                return;
+            marker = AccountTxStore::Marker {
+                token[jss::ledger].asUInt(), token[jss::seq].asUInt()};
+        }
+        catch (std::exception const&)
+        {
+            return;
+        }
+    }
+
+    token = Json::nullValue;
+
+    auto const entries = store.page (account,
+        ledgerBound (minLedger, 0),
+        ledgerBound (maxLedger, std::numeric_limits<std::uint32_t>::max ()),
+        forward, marker, numberOfResults);
+
+    fetchAccountTxs (connection, entries, onUnsavedLedger, onTransaction);
+
+    if (marker)
+    {
+        token = Json::objectValue;
+        token[jss::ledger] = marker->ledgerSeq;
+        token[jss::seq] = marker->txnSeq;
+    }
+}
+
+void
+accountTxOffset (
+    DatabaseCon& connection,
+    AccountTxStore& store,
+    std::function<void (std::uint32_t)> const& onUnsavedLedger,
+    std::function<void (std::uint32_t,
+                        std::string const&,
+                        Blob const&,
+                        Blob const&)> const& onTransaction,
+    AccountID const& account,
+    std::int32_t minLedger,
+    std::int32_t maxLedger,
+    bool descending,
+    std::uint32_t offset,
+    std::uint32_t numberOfResults)
+{
+    boost::optional<AccountTxStore::Marker> marker;
+
+    auto entries = store.page (account,
+        ledgerBound (minLedger, 0),
+        ledgerBound (maxLedger, std::numeric_limits<std::uint32_t>::max ()),
+        ! descending, marker,
+        static_cast<std::size_t> (offset) + numberOfResults);
+
+    entries.erase (entries.begin (),
+        entries.begin () + std::min<std::size_t> (offset, entries.size ()));
+
+    fetchAccountTxs (connection, entries, onUnsavedLedger, onTransaction);
+}
+
 }
 
 
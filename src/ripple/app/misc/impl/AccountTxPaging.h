@@ -4,6 +4,7 @@
 #define RIPPLE_APP_MISC_IMPL_ACCOUNTTXPAGING_H_INCLUDED
 
 #include <ripple/core/DatabaseCon.h>
+#include <ripple/app/misc/AccountTxStore.h>
 #include <ripple/app/misc/NetworkOPs.h>
 #include <cstdint>
 #include <string>
@@ -43,6 +44,40 @@ accountTxPage (
     bool bAdmin,
     std::uint32_t pageLength);
 
+void
+accountTxPage (
+    DatabaseCon& database,
+    AccountTxStore& store,
+    std::function<void (std::uint32_t)> const& onUnsavedLedger,
+    std::function<void (std::uint32_t,
+                        std::string const&,
+                        Blob const&,
+                        Blob const&)> const&,
+    AccountID const& account,
+    std::int32_t minLedger,
+    std::int32_t maxLedger,
+    bool forward,
+    Json::Value& token,
+    int limit,
+    bool bAdmin,
+    std::uint32_t pageLength);
+
+void
+accountTxOffset (
+    DatabaseCon& database,
+    AccountTxStore& store,
+    std::function<void (std::uint32_t)> const& onUnsavedLedger,
+    std::function<void (std::uint32_t,
+                        std::string const&,
+                        Blob const&,
+                        Blob const&)> const&,
+    AccountID const& account,
+    std::int32_t minLedger,
+    std::int32_t maxLedger,
+    bool descending,
+    std::uint32_t offset,
+    std::uint32_t numberOfResults);
+
 }
 
 #endif
@@ -0,0 +1,206 @@
+
+
+#include <ripple/app/misc/AccountTxStore.h>
+#include <ripple/app/misc/impl/AccountTxLog.h>
+#include <ripple/basics/contract.h>
+#include <ripple/basics/Log.h>
+#include <ripple/basics/StringUtilities.h>
+#include <ripple/core/DatabaseCon.h>
+#include <ripple/core/SociDB.h>
+#include <ripple/ledger/TxMeta.h>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/optional.hpp>
+#include <map>
+
+namespace ripple {
+
+std::unique_ptr<AccountTxStore>
+make_AccountTxStore(Section const& section, beast::Journal journal)
+{
+    if (section.empty())
+        return nullptr;
+
+    auto const type {get<std::string>(section, "type", "log")};
+    if (!boost::iequals(type, "log"))
+    {
+        Throw<std::runtime_error>(
+            "Unknown [account_tx_store] type '" + type + "'");
+    }
+
+    auto const path {get<std::string>(section, "path")};
+    if (path.empty())
+        Throw<std::runtime_error>("Missing [account_tx_store] path");
+
+    return std::make_unique<AccountTxLog>(path, journal);
+}
+
+std::uint64_t
+importAccountTransactions(DatabaseCon& txnDB,
+    AccountTxStore& store, beast::Journal journal)
+{
+    std::uint64_t rows {0};
+    std::uint64_t ledgers {0};
+
+    std::uint32_t current {0};
+    std::map<uint256, AccountTxStore::Transaction> txns;
+
+    auto flush = [&]
+    {
+        if (txns.empty())
+            return;
+
+        std::vector<AccountTxStore::Transaction> batch;
+        batch.reserve(txns.size());
+        for (auto& txn : txns)
+            batch.push_back(std::move(txn.second));
+        store.insert(current, batch);
+        txns.clear();
+
+        if ((++ledgers % 100000) == 0)
+        {
+            JLOG(journal.info()) <<
+                "Imported account transactions through ledger " <<
+                current << ", " << rows << " rows";
+        }
+    };
+
+    {
+        auto db = txnDB.checkoutDb();
+
+        boost::optional<std::uint64_t> ledgerSeq;
+        boost::optional<std::uint32_t> txnSeq;
+        boost::optional<std::string> txnID;
+        boost::optional<std::string> account;
+
+        soci::statement st = (db->prepare <<
+            "SELECT LedgerSeq, TxnSeq, TransID, Account "
+            "FROM AccountTransactions ORDER BY LedgerSeq;",
+            soci::into(ledgerSeq),
+            soci::into(txnSeq),
+            soci::into(txnID),
+            soci::into(account));
+
+        st.execute();
+        while (st.fetch())
+        {
+            uint256 id;
+            auto const accountID {parseBase58<AccountID>(account.value_or(""))};
+            if (!ledgerSeq || !txnID || !id.SetHexExact(*txnID) || !accountID)
+            {
+                JLOG(journal.warn()) <<
+                    "Skipping malformed AccountTransactions row for " <<
+                    txnID.value_or("") << " in ledger " <<
+                    ledgerSeq.value_or(0);
+                continue;
+            }
+
+            auto const seq {rangeCheckedCast<std::uint32_t>(*ledgerSeq)};
+            if (seq != current)
+            {
+                flush();
+                current = seq;
+            }
+
+            auto& txn {txns[id]};
+            txn.txnSeq = txnSeq.value_or(0);
+            txn.id = id;
+            txn.accounts.push_back(*accountID);
+            ++rows;
+        }
+    }
+    flush();
+
+    JLOG(journal.warn()) <<
+        "Imported " << rows << " account transactions from " <<
+        ledgers << " ledgers into " << store.getName();
+    return rows;
+}
+
+std::uint64_t
+replayAccountTransactions(DatabaseCon& txnDB,
+    AccountTxStore& store, beast::Journal journal)
+{
+    auto const highWater {store.highWater()};
+    std::uint64_t rows {0};
+    std::uint64_t ledgers {0};
+
+    std::uint32_t current {0};
+    std::vector<AccountTxStore::Transaction> txns;
+
+    auto flush = [&]
+    {
+        if (txns.empty())
+            return;
+        store.insert(current, txns);
+        txns.clear();
+        ++ledgers;
+    };
+
+    {
+        auto db = txnDB.checkoutDb();
+
+        boost::optional<std::uint64_t> ledgerSeq;
+        boost::optional<std::string> txnID;
+        soci::blob sociTxnMetaBlob(*db);
+        soci::indicator tmi;
+        Blob txnMeta;
+
+        soci::statement st = (db->prepare <<
+            "SELECT LedgerSeq, TransID, TxnMeta FROM Transactions "
+            "WHERE LedgerSeq > :highWater ORDER BY LedgerSeq;",
+            soci::use(highWater),
+            soci::into(ledgerSeq),
+            soci::into(txnID),
+            soci::into(sociTxnMetaBlob, tmi));
+
+        st.execute();
+        while (st.fetch())
+        {
+            uint256 id;
+            if (!ledgerSeq || !txnID || !id.SetHexExact(*txnID) ||
+                tmi != soci::i_ok)
+            {
+                JLOG(journal.warn()) <<
+                    "Skipping malformed Transactions row for " <<
+                    txnID.value_or("") << " in ledger " <<
+                    ledgerSeq.value_or(0);
+                continue;
+            }
+
+            auto const seq {rangeCheckedCast<std::uint32_t>(*ledgerSeq)};
+            if (seq != current)
+            {
+                flush();
+                current = seq;
+            }
+
+            convert(sociTxnMetaBlob, txnMeta);
+            try
+            {
+                TxMeta const meta(id, seq, txnMeta);
+                auto const accounts {meta.getAffectedAccounts(journal)};
+                txns.push_back({meta.getIndex(), id,
+                    std::vector<AccountID>(accounts.begin(), accounts.end())});
+                ++rows;
+            }
+            catch (std::exception const& e)
+            {
+                JLOG(journal.warn()) <<
+                    "Skipping transaction " << id << " in ledger " <<
+                    seq << " with invalid metadata: " << e.what();
+            }
+        }
+    }
+    flush();
+
+    if (ledgers != 0)
+    {
+        JLOG(journal.warn()) <<
+            "Replayed " << rows << " transactions from " << ledgers <<
+            " ledgers after ledger " << highWater << " into " <<
+            store.getName();
+    }
+    return rows;
+}
+
+}
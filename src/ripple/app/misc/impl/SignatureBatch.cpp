@@ -0,0 +1,265 @@
+
+
+#include <ripple/app/misc/SignatureBatch.h>
+#include <ripple/app/tx/apply.h>
+#include <ripple/basics/Log.h>
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/protocol/Feature.h>
+#include <algorithm>
+
+namespace ripple {
+
+SignatureBatch::SignatureBatch (HashRouter& router, JobQueue& jobQueue,
+        boost::asio::io_service& io_service, std::size_t workers,
+        std::chrono::microseconds window, beast::Journal journal)
+    : router_ (router)
+    , jobQueue_ (jobQueue)
+    , workers_ (std::max<std::size_t> (workers, 1))
+    , window_ (window)
+    , j_ (journal)
+    , timer_ (io_service)
+{
+}
+
+SignatureBatch::~SignatureBatch ()
+{
+    std::unique_lock<std::mutex> lock (mutex_);
+    stopping_ = true;
+    if (armed_)
+    {
+        armed_ = false;
+        boost::system::error_code ec;
+        timer_.cancel (ec);
+    }
+    cond_.wait (lock, [this] { return handlers_ == 0; });
+}
+
+void
+SignatureBatch::add (std::shared_ptr<STTx const> const& tx,
+    Rules const& rules, callback_type callback)
+{
+    std::vector<Entry> stranded;
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+
+        pending_.push_back ({tx, rules, std::move (callback)});
+        ++queued_;
+
+        // A dispatch job is already queued and will take this entry
+        if (scheduled_)
+            return;
+
+        if (pending_.size () < maxBatch)
+        {
+            if (! armed_)
+            {
+                armed_ = true;
+                ++handlers_;
+                timer_.expires_from_now (window_);
+                timer_.async_wait (
+                    [this] (boost::system::error_code const& ec) {
+                        onTimer (ec);
+                    });
+            }
+            return;
+        }
+
+        if (schedule (lock))
+            return;
+
+        // The queue is stopping: nothing will ever dispatch what is
+        // pending, so check it here rather than strand it.
+        stranded.swap (pending_);
+    }
+
+    dispatch (std::move (stranded));
+}
+
+bool
+SignatureBatch::schedule (std::lock_guard<std::mutex> const&)
+{
+    if (armed_)
+    {
+        armed_ = false;
+        boost::system::error_code ec;
+        timer_.cancel (ec);
+    }
+
+    if (! jobQueue_.addJob (
+        jtTRANSACTION, "sigBatch",
+        [this] (Job&) { collect (); }))
+    {
+        return false;
+    }
+
+    scheduled_ = true;
+    return true;
+}
+
+void
+SignatureBatch::onTimer (boost::system::error_code const& ec)
+{
+    std::vector<Entry> stranded;
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        if (ec != boost::asio::error::operation_aborted &&
+            armed_ && ! scheduled_ && ! stopping_)
+        {
+            armed_ = false;
+            if (! schedule (lock))
+                stranded.swap (pending_);
+        }
+    }
+
+    dispatch (std::move (stranded));
+
+    std::lock_guard<std::mutex> lock (mutex_);
+    if (--handlers_ == 0)
+        cond_.notify_all ();
+}
+
+void
+SignatureBatch::collect ()
+{
+    std::vector<Entry> entries;
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        entries.swap (pending_);
+        scheduled_ = false;
+    }
+
+    dispatch (std::move (entries));
+}
+
+template <class Function>
+void
+SignatureBatch::split (std::string const& name, std::size_t size,
+    Function const& f)
+{
+    auto const chunks = std::min (workers_,
+        (size + minChunk - 1) / minChunk);
+    auto const chunkSize = (size + chunks - 1) / chunks;
+
+    for (std::size_t begin = chunkSize; begin < size; begin += chunkSize)
+    {
+        auto const end = std::min (size, begin + chunkSize);
+        if (! jobQueue_.addJob (
+            jtTRANSACTION, name,
+            [f, begin, end] (Job&) { f (begin, end); }))
+        {
+            f (begin, end);
+        }
+    }
+
+    f (0, std::min (size, chunkSize));
+}
+
+void
+SignatureBatch::dispatch (std::vector<Entry> entries)
+{
+    auto const size = entries.size ();
+    if (size == 0)
+        return;
+
+    auto batch = std::make_shared<Batch> ();
+    batch->entries = std::move (entries);
+    batch->ids.reserve (size);
+    for (auto const& entry : batch->entries)
+        batch->ids.push_back (entry.tx->getTransactionID ());
+
+    // One trip to the router for the whole batch
+    auto const flags = router_.getFlags (batch->ids);
+    hash_set<uint256> seen;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        if (flags[i] & (SF_SIGGOOD | SF_SIGBAD))
+            continue;
+        if (seen.insert (batch->ids[i]).second)
+            batch->checks.push_back (i);
+    }
+    batch->outcomes.assign (batch->checks.size (), Outcome::unknown);
+
+    ++batches_;
+    verified_ += batch->checks.size ();
+
+    JLOG (j_.debug()) << "Verifying " << batch->checks.size () <<
+        " of " << size << " signatures";
+
+    auto const checks = batch->checks.size ();
+    if (checks == 0)
+    {
+        finish (batch);
+        return;
+    }
+
+    batch->remaining = std::min (workers_,
+        (checks + minChunk - 1) / minChunk);
+    split ("sigBatch->verify", checks,
+        [this, batch] (std::size_t begin, std::size_t end) {
+            verify (*batch, begin, end);
+            if (--batch->remaining == 0)
+                finish (batch);
+        });
+}
+
+void
+SignatureBatch::verify (Batch& batch, std::size_t begin, std::size_t end)
+{
+    for (auto i = begin; i != end; ++i)
+    {
+        auto const& entry = batch.entries[batch.checks[i]];
+
+        try
+        {
+            auto const result = entry.tx->checkSign (
+                entry.rules.enabled (featureMultiSign));
+            batch.outcomes[i] = result.first ? Outcome::good : Outcome::bad;
+        }
+        catch (std::exception const& e)
+        {
+            // Left unknown: the callback's own check will retry it
+            JLOG (j_.warn()) << "Exception checking signature of " <<
+                batch.ids[batch.checks[i]] << ": " << e.what ();
+        }
+    }
+}
+
+void
+SignatureBatch::finish (std::shared_ptr<Batch> const& batch)
+{
+    std::vector<std::pair<uint256, int>> flags;
+    flags.reserve (batch->checks.size ());
+    for (std::size_t i = 0; i < batch->checks.size (); ++i)
+    {
+        if (batch->outcomes[i] != Outcome::unknown)
+        {
+            flags.emplace_back (batch->ids[batch->checks[i]],
+                batch->outcomes[i] == Outcome::good ?
+                    SF_SIGGOOD : SF_SIGBAD);
+        }
+    }
+    if (! flags.empty ())
+        router_.setFlags (flags);
+
+    split ("sigBatch->complete", batch->entries.size (),
+        [this, batch] (std::size_t begin, std::size_t end) {
+            complete (*batch, begin, end);
+        });
+}
+
+void
+SignatureBatch::complete (Batch& batch, std::size_t begin, std::size_t end)
+{
+    for (auto i = begin; i != end; ++i)
+    {
+        auto& entry = batch.entries[i];
+
+        --queued_;
+
+        auto callback = std::move (entry.callback);
+        entry.tx.reset ();
+        callback ();
+    }
+}
+
+}
@@ -144,6 +144,15 @@ Json::Value Transaction::getJson (JsonOptions options, bool binary) const
     return ret;
 }
 
+std::size_t
+cacheBytes (Transaction const& transaction)
+{
+    std::size_t bytes = sizeof (Transaction);
+    if (auto const& stx = transaction.getSTransaction ())
+        bytes += sizeof (STTx) + stx->getCount () * sizeof (detail::STVar);
+    return bytes;
+}
+
 } 
 
 
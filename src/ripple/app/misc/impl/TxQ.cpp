@@ -449,16 +449,37 @@ TxQ::apply(Application& app, OpenView& view,
     std::shared_ptr<STTx const> const& tx,
         ApplyFlags flags, beast::Journal j)
 {
+    boost::optional<STAmountSO> saved;
+    if (view.rules().enabled(fix1513))
+        saved.emplace(view.info().parentCloseTime);
+
+    return apply(app, view, tx,
+        preflight(app, view.rules(), *tx, flags, j), j);
+}
+
+std::pair<TER, bool>
+TxQ::apply(Application& app, OpenView& view,
+    std::shared_ptr<STTx const> const& tx,
+        PreflightResult const& pfresult, beast::Journal j)
+{
+    assert(&pfresult.tx == tx.get());
+
+    if (pfresult.rules != view.rules())
+    {
+        JLOG(j_.debug()) << "Queue: rules changed since preflight of " <<
+            tx->getTransactionID();
+        return apply(app, view, tx, pfresult.flags, j);
+    }
+
     auto const account = (*tx)[sfAccount];
     auto const transactionID = tx->getTransactionID();
     auto const tSeq = tx->getSequence();
+    auto flags = pfresult.flags;
 
     boost::optional<STAmountSO> saved;
     if (view.rules().enabled(fix1513))
         saved.emplace(view.info().parentCloseTime);
 
-    auto const pfresult = preflight(app, view.rules(),
-            *tx, flags, j);
     if (pfresult.ter != tesSUCCESS)
         return{ pfresult.ter, false };
 
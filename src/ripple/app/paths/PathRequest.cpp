@@ -120,10 +120,18 @@ bool PathRequest::needsUpdate (bool newOnly, LedgerIndex index)
         return false;
     }
 
+    mLastIndex = index;
     mInProgress = true;
     return true;
 }
 
+LedgerIndex PathRequest::lastIndex ()
+{
+    ScopedLockType sl (mIndexLock);
+
+    return mLastIndex;
+}
+
 bool PathRequest::hasCompletion ()
 {
     return bool (fCompletion);
@@ -436,7 +444,8 @@ PathRequest::getPathFinder(std::shared_ptr<RippleLineCache> const& cache,
 
 bool
 PathRequest::findPaths (std::shared_ptr<RippleLineCache> const& cache,
-    int const level, Json::Value& jvArray)
+    int const level, Json::Value& jvArray,
+        std::chrono::steady_clock::time_point deadline, bool& incomplete)
 {
     auto sourceCurrencies = sciSourceCurrencies;
     if (sourceCurrencies.empty ())
@@ -461,6 +470,16 @@ PathRequest::findPaths (std::shared_ptr<RippleLineCache> const& cache,
     hash_map<Currency, std::unique_ptr<Pathfinder>> currency_map;
     for (auto const& issue : sourceCurrencies)
     {
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            JLOG(m_journal.debug())
+                << iIdentifier
+                << " Deadline reached after " << jvArray.size()
+                << " alternatives";
+            incomplete = true;
+            break;
+        }
+
         JLOG(m_journal.debug())
             << iIdentifier
             << " Trying to find paths: "
@@ -573,7 +592,8 @@ PathRequest::findPaths (std::shared_ptr<RippleLineCache> const& cache,
 }
 
 Json::Value PathRequest::doUpdate(
-    std::shared_ptr<RippleLineCache> const& cache, bool fast)
+    std::shared_ptr<RippleLineCache> const& cache, bool fast,
+        std::chrono::steady_clock::time_point deadline)
 {
     using namespace std::chrono;
     JLOG(m_journal.debug()) << iIdentifier
@@ -638,10 +658,15 @@ Json::Value PathRequest::doUpdate(
         << " processing at level " << iLevel;
 
     Json::Value jvArray = Json::arrayValue;
-    if (findPaths(cache, iLevel, jvArray))
+    bool incomplete = false;
+    if (findPaths(cache, iLevel, jvArray, deadline, incomplete))
     {
         bLastSuccess = jvArray.size() != 0;
         newStatus[jss::alternatives] = std::move (jvArray);
+
+        // Tell the client these are only the currencies searched so far
+        if (incomplete)
+            newStatus[jss::incomplete] = true;
     }
     else
     {
@@ -654,7 +679,8 @@ Json::Value PathRequest::doUpdate(
         quick_reply_ = steady_clock::now();
         mOwner.reportFast(duration_cast<milliseconds>(quick_reply_ - created_));
     }
-    else if (! fast && full_reply_ == steady_clock::time_point{})
+    else if (! fast && ! incomplete &&
+        full_reply_ == steady_clock::time_point{})
     {
         full_reply_ = steady_clock::now();
         mOwner.reportFull(duration_cast<milliseconds>(full_reply_ - created_));
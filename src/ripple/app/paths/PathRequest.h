@@ -59,6 +59,9 @@ public:
     bool isNew ();
     bool needsUpdate (bool newOnly, LedgerIndex index);
 
+    
+    LedgerIndex lastIndex ();
+
     void updateComplete ();
 
     std::pair<bool, Json::Value> doCreate (
@@ -69,7 +72,9 @@ public:
     Json::Value doStatus (Json::Value const&);
 
     Json::Value doUpdate (
-        std::shared_ptr<RippleLineCache> const&, bool fast);
+        std::shared_ptr<RippleLineCache> const&, bool fast,
+        std::chrono::steady_clock::time_point deadline =
+            std::chrono::steady_clock::time_point::max ());
     InfoSub::pointer getSubscriber ();
     bool hasCompletion ();
 
@@ -86,7 +91,8 @@ private:
 
     
     bool
-    findPaths (std::shared_ptr<RippleLineCache> const&, int const, Json::Value&);
+    findPaths (std::shared_ptr<RippleLineCache> const&, int const, Json::Value&,
+        std::chrono::steady_clock::time_point deadline, bool& incomplete);
 
     int parseJson (Json::Value const&);
 
@@ -10,9 +10,12 @@
 #include <ripple/resource/Fees.h>
 #include <ripple/protocol/jss.h>
 #include <algorithm>
+#include <thread>
 
 namespace ripple {
 
+constexpr std::chrono::seconds PathRequests::passDeadline;
+constexpr std::chrono::seconds PathRequests::requestDeadline;
 
 std::shared_ptr<RippleLineCache>
 PathRequests::getLineCache (
@@ -61,68 +64,36 @@ void PathRequests::updateAll (std::shared_ptr <ReadView const> const& inLedger,
 
     do
     {
-        for (auto const& wr : requests)
-        {
-            if (shouldCancel())
-                break;
-
-            auto request = wr.lock ();
-            bool remove = true;
+        auto pass = std::make_shared<UpdatePass> ();
+        pass->cache = cache;
+        pass->seq = cache->getLedger()->seq();
+        pass->newOnly = newRequests;
+        pass->deadline = clock_type::now() + passDeadline;
 
-            if (request)
-            {
-                if (!request->needsUpdate (newRequests, cache->getLedger()->seq()))
-                    remove = false;
-                else
-                {
-                    if (auto ipSub = request->getSubscriber ())
-                    {
-                        if (!ipSub->getConsumer ().warn ())
-                        {
-                            Json::Value update = request->doUpdate (cache, false);
-                            request->updateComplete ();
-                            update[jss::type] = "path_find";
-                            ipSub->send (update, false);
-                            remove = false;
-                            ++processed;
-                        }
-                    }
-                    else if (request->hasCompletion ())
-                    {
-                        request->doUpdate (cache, false);
-                        request->updateComplete();
-                        ++processed;
-                    }
-                }
-            }
-
-            if (remove)
+        {
+            std::vector<std::pair<LedgerIndex, PathRequest::pointer>> live;
+            live.reserve (requests.size());
+            for (auto const& wr : requests)
             {
-                ScopedLockType sl (mLock);
-
-                auto ret = std::remove_if (
-                    requests_.begin(), requests_.end(),
-                    [&removed,&request](auto const& wl)
-                    {
-                        auto r = wl.lock();
-
-                        if (r && r != request)
-                            return false;
-                        ++removed;
-                        return true;
-                    });
-
-                requests_.erase (ret, requests_.end());
+                if (auto request = wr.lock ())
+                    live.emplace_back (request->lastIndex(), std::move (request));
             }
 
-            mustBreak = !newRequests &&
-                app_.getLedgerMaster().isNewPathRequest();
-
-            if (mustBreak)
-                break;
+            std::stable_sort (live.begin(), live.end(),
+                [](auto const& a, auto const& b)
+                {
+                    return a.first < b.first;
+                });
 
+            pass->requests.reserve (live.size());
+            for (auto& l : live)
+                pass->requests.push_back (std::move (l.second));
         }
 
+        removed += updatePass (pass, shouldCancel);
+        processed += pass->processed;
+        mustBreak = pass->interrupted;
+
         if (mustBreak)
         { 
             newRequests = true;
@@ -154,6 +125,178 @@ void PathRequests::updateAll (std::shared_ptr <ReadView const> const& inLedger,
         removed << " removed";
 }
 
+int PathRequests::updatePass (std::shared_ptr<UpdatePass> const& pass,
+                              Job::CancelCallback shouldCancel)
+{
+    auto const size = pass->requests.size();
+    auto const workers = std::min<std::size_t> (size,
+        std::max (1u, std::thread::hardware_concurrency()));
+
+    for (std::size_t i = 1; i < workers; ++i)
+    {
+        if (! app_.getJobQueue().addJob (
+            jtUPDATE_PF, "PathRequests::updatePass",
+            [this, pass] (Job&) { processPass (*pass, {}); }))
+        {
+            break;
+        }
+    }
+
+    processPass (*pass, shouldCancel);
+
+    std::unique_lock<std::mutex> lock (pass->mutex);
+    pass->cond.wait (lock, [&pass] { return pass->busy == 0; });
+
+    auto const deferred = size - std::min (pass->next, size);
+    if (deferred != 0)
+    {
+        JLOG (mJournal.debug()) <<
+            "updateAll deferred " << deferred << " of " << size <<
+            " requests at seq=" << pass->seq;
+    }
+
+    ScopedLockType sl (mLock);
+
+    mUpdates += pass->processed;
+    mDeferred += deferred;
+    if (pass->lagSamples != 0)
+    {
+        mLagSamples += pass->lagSamples;
+        mLagTotal += pass->lagTotal;
+        mLagLast = pass->lagLast;
+        mLagPeak = std::max (mLagPeak, pass->lagPeak);
+    }
+
+    int removed = 0;
+    auto const& remove = pass->remove;
+    auto ret = std::remove_if (
+        requests_.begin(), requests_.end(),
+        [&removed,&remove](auto const& wl)
+        {
+            auto r = wl.lock();
+
+            if (r && std::find (remove.begin(), remove.end(), r) ==
+                    remove.end())
+                return false;
+            ++removed;
+            return true;
+        });
+
+    requests_.erase (ret, requests_.end());
+    return removed;
+}
+
+void PathRequests::processPass (UpdatePass& pass,
+                                Job::CancelCallback shouldCancel)
+{
+    std::unique_lock<std::mutex> lock (pass.mutex);
+    auto const size = pass.requests.size();
+
+    while (! pass.stop && pass.next < size)
+    {
+        if ((shouldCancel && shouldCancel()) ||
+            clock_type::now() >= pass.deadline)
+        {
+            pass.stop = true;
+            break;
+        }
+
+        auto const request = pass.requests[pass.next++];
+        ++pass.busy;
+        lock.unlock();
+
+        auto const last = request->lastIndex();
+        auto const result = updateRequest (request, pass);
+        bool const interrupted = !pass.newOnly &&
+            app_.getLedgerMaster().isNewPathRequest();
+
+        lock.lock();
+        --pass.busy;
+
+        if (result == Update::remove)
+        {
+            pass.remove.push_back (request);
+        }
+        else if (result == Update::updated)
+        {
+            ++pass.processed;
+
+            if (last != 0 && pass.seq > last)
+            {
+                auto const lag = pass.seq - last;
+                ++pass.lagSamples;
+                pass.lagTotal += lag;
+                pass.lagLast = lag;
+                pass.lagPeak = std::max (pass.lagPeak, lag);
+            }
+        }
+
+        if (interrupted)
+        {
+            pass.interrupted = true;
+            pass.stop = true;
+        }
+    }
+
+    if (pass.busy == 0)
+        pass.cond.notify_all();
+}
+
+PathRequests::Update
+PathRequests::updateRequest (PathRequest::pointer const& request,
+                             UpdatePass const& pass)
+{
+    if (!request->needsUpdate (pass.newOnly, pass.seq))
+        return Update::skipped;
+
+    // Each request gets its own bound, so one expensive search cannot
+    // use up the time of every request queued behind it in the pass.
+    auto const deadline = std::min (pass.deadline,
+        clock_type::now() + requestDeadline);
+
+    if (auto ipSub = request->getSubscriber ())
+    {
+        if (!ipSub->getConsumer ().warn ())
+        {
+            Json::Value update = request->doUpdate (
+                pass.cache, false, deadline);
+            request->updateComplete ();
+            update[jss::type] = "path_find";
+            ipSub->send (update, false);
+            return Update::updated;
+        }
+    }
+    else if (request->hasCompletion ())
+    {
+        request->doUpdate (pass.cache, false, deadline);
+        request->updateComplete();
+        return Update::updated;
+    }
+
+    return Update::remove;
+}
+
+Json::Value PathRequests::getJson ()
+{
+    ScopedLockType sl (mLock);
+
+    Json::Value ret (Json::objectValue);
+    ret[jss::requests] = static_cast<Json::UInt> (requests_.size());
+    ret[jss::updates] = std::to_string (mUpdates);
+    ret[jss::deferred] = std::to_string (mDeferred);
+
+    if (mLineCache)
+        ret[jss::line_hit_rate] = mLineCache->getHitRate ();
+
+    Json::Value& lag = (ret[jss::lag_ledgers] = Json::objectValue);
+    lag[jss::last] = mLagLast;
+    lag[jss::peak] = mLagPeak;
+    lag[jss::average] = static_cast<Json::UInt> (
+        mLagSamples ? (mLagTotal / mLagSamples) : 0);
+
+    return ret;
+}
+
 void PathRequests::insertPathRequest (
     PathRequest::pointer const& req)
 {
@@ -8,6 +8,8 @@
 #include <ripple/app/paths/RippleLineCache.h>
 #include <ripple/core/Job.h>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
 #include <vector>
 
@@ -61,9 +63,61 @@ public:
         mFull.notify (ms);
     }
 
+    
+    Json::Value getJson ();
+
+    
+    static std::chrono::seconds constexpr passDeadline {5};
+
+    
+    static std::chrono::seconds constexpr requestDeadline {1};
+
 private:
+    using clock_type = std::chrono::steady_clock;
+
+    enum class Update
+    {
+        skipped,
+        updated,
+        remove
+    };
+
+    struct UpdatePass
+    {
+        std::shared_ptr<RippleLineCache> cache;
+        LedgerIndex seq;
+        bool newOnly;
+        clock_type::time_point deadline;
+        std::vector<PathRequest::pointer> requests;
+
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::size_t next = 0;
+        std::size_t busy = 0;
+        bool stop = false;
+        bool interrupted = false;
+
+        int processed = 0;
+        std::vector<PathRequest::pointer> remove;
+        std::uint64_t lagSamples = 0;
+        std::uint64_t lagTotal = 0;
+        LedgerIndex lagLast = 0;
+        LedgerIndex lagPeak = 0;
+    };
+
     void insertPathRequest (PathRequest::pointer const&);
 
+    
+    int updatePass (std::shared_ptr<UpdatePass> const& pass,
+        Job::CancelCallback shouldCancel);
+
+    
+    void processPass (UpdatePass& pass, Job::CancelCallback shouldCancel);
+
+    
+    Update updateRequest (PathRequest::pointer const& request,
+        UpdatePass const& pass);
+
     Application& app_;
     beast::Journal                   mJournal;
 
@@ -76,6 +130,13 @@ private:
 
     std::atomic<int>                 mLastIdentifier;
 
+    std::uint64_t                    mUpdates = 0;
+    std::uint64_t                    mDeferred = 0;
+    std::uint64_t                    mLagSamples = 0;
+    std::uint64_t                    mLagTotal = 0;
+    LedgerIndex                      mLagLast = 0;
+    LedgerIndex                      mLagPeak = 0;
+
     using ScopedLockType = std::lock_guard <std::recursive_mutex>;
     std::recursive_mutex mLock;
 
@@ -11,6 +11,7 @@
 #include <ripple/json/to_string.h>
 #include <ripple/core/JobQueue.h>
 #include <ripple/core/Config.h>
+#include <algorithm>
 #include <tuple>
 
 
@@ -650,6 +651,23 @@ void Pathfinder::addLinks (
     JLOG (j_.debug())
         << "addLink< on " << currentPaths.size ()
         << " source(s), flags=" << addFlags;
+
+    if (addFlags & afADD_ACCOUNTS)
+    {
+        std::vector<AccountID> accounts;
+        accounts.reserve (currentPaths.size ());
+        for (auto const& path: currentPaths)
+        {
+            auto const& pathEnd = path.empty() ? mSource : path.back ();
+            if (!pathEnd.getCurrency ().isZero ())
+                accounts.push_back (pathEnd.getAccountID ());
+        }
+        std::sort (accounts.begin (), accounts.end ());
+        accounts.erase (std::unique (accounts.begin (), accounts.end ()),
+            accounts.end ());
+        mRLCache->prefetch (accounts, app_.getJobQueue ());
+    }
+
     for (auto const& path: currentPaths)
         addLink (path, incompletePaths, addFlags);
 }
@@ -2,6 +2,7 @@
 
 #include <ripple/app/paths/RippleLineCache.h>
 #include <ripple/ledger/OpenView.h>
+#include <algorithm>
 
 namespace ripple {
 
@@ -11,21 +12,117 @@ RippleLineCache::RippleLineCache(
     mLedger = std::make_shared<OpenView>(&*ledger, ledger);
 }
 
+constexpr std::size_t RippleLineCache::stripeCount;
+constexpr std::size_t RippleLineCache::prefetchHelpers;
+
 std::vector<RippleState::pointer> const&
 RippleLineCache::getRippleLines (AccountID const& accountID)
 {
     AccountKey key (accountID, hasher_ (accountID));
+    auto& s = stripe (key);
+
+    {
+        std::lock_guard <std::mutex> sl (s.mutex);
+
+        auto it = s.lines.find (key);
+        if (it != s.lines.end ())
+        {
+            ++hits_;
+            return it->second;
+        }
+    }
+
+    return load (s, key);
+}
 
-    std::lock_guard <std::mutex> sl (mLock);
+void
+RippleLineCache::prefetch (
+    std::vector<AccountID> const& accounts, JobQueue& jobQueue)
+{
+    auto work = std::make_shared<Prefetch> ();
+    work->accounts.reserve (accounts.size ());
+    for (auto const& accountID : accounts)
+    {
+        AccountKey key (accountID, hasher_ (accountID));
+        auto& s = stripe (key);
+
+        std::lock_guard <std::mutex> sl (s.mutex);
+        if (! s.lines.count (key))
+            work->accounts.push_back (accountID);
+    }
+
+    if (work->accounts.empty ())
+        return;
+
+    auto const helpers = std::min (prefetchHelpers, work->accounts.size () - 1);
+    for (std::size_t i = 0; i < helpers; ++i)
+    {
+        if (! jobQueue.addJob (jtUPDATE_PF, "RippleLineCache::prefetch",
+            [self = shared_from_this (), work] (Job&)
+            {
+                self->prefetchSome (*work);
+            }))
+        {
+            break;
+        }
+    }
+
+    prefetchSome (*work);
+
+    std::unique_lock <std::mutex> lock (work->mutex);
+    work->cv.wait (lock, [&work] { return work->busy == 0; });
+}
 
-    auto it = lines_.emplace (key,
-        std::vector<RippleState::pointer>());
+void
+RippleLineCache::prefetchSome (Prefetch& work)
+{
+    for (;;)
+    {
+        {
+            std::lock_guard <std::mutex> lock (work.mutex);
+            ++work.busy;
+        }
+
+        auto const i = work.next++;
+        if (i < work.accounts.size ())
+        {
+            AccountKey key (work.accounts[i], hasher_ (work.accounts[i]));
+            auto& s = stripe (key);
+
+            bool cached;
+            {
+                std::lock_guard <std::mutex> sl (s.mutex);
+                cached = s.lines.count (key) != 0;
+            }
+
+            if (! cached)
+                load (s, key);
+        }
+
+        std::lock_guard <std::mutex> lock (work.mutex);
+        if (--work.busy == 0)
+            work.cv.notify_all ();
+        if (i >= work.accounts.size ())
+            return;
+    }
+}
+
+float
+RippleLineCache::getHitRate () const
+{
+    auto const total = static_cast<float> (hits_ + misses_);
+    return hits_ * (100.0f / std::max (1.0f, total));
+}
+
+std::vector<RippleState::pointer> const&
+RippleLineCache::load (Stripe& s, AccountKey const& key)
+{
+    ++misses_;
 
-    if (it.second)
-        it.first->second = getRippleStateItems (
-            accountID, *mLedger);
+    auto items = getRippleStateItems (key.account_, *mLedger);
 
-    return it.first->second;
+    std::lock_guard <std::mutex> sl (s.mutex);
+    return s.lines.emplace (key, std::move (items)).first->second;
 }
 
 } 
@@ -6,7 +6,12 @@
 #include <ripple/app/ledger/Ledger.h>
 #include <ripple/app/paths/RippleState.h>
 #include <ripple/basics/hardened_hash.h>
+#include <ripple/core/JobQueue.h>
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -14,6 +19,7 @@
 namespace ripple {
 
 class RippleLineCache
+    : public std::enable_shared_from_this <RippleLineCache>
 {
 public:
     explicit
@@ -29,9 +35,30 @@ public:
     std::vector<RippleState::pointer> const&
     getRippleLines (AccountID const& accountID);
 
-private:
-    std::mutex mLock;
+    
+    void
+    prefetch (std::vector<AccountID> const& accounts, JobQueue& jobQueue);
+
+    float
+    getHitRate () const;
 
+    std::uint64_t
+    getHits () const
+    {
+        return hits_;
+    }
+
+    std::uint64_t
+    getMisses () const
+    {
+        return misses_;
+    }
+
+    static std::size_t constexpr stripeCount = 16;
+
+    static std::size_t constexpr prefetchHelpers = 4;
+
+private:
     ripple::hardened_hash<> hasher_;
     std::shared_ptr <ReadView const> mLedger;
 
@@ -73,10 +100,42 @@ private:
         };
     };
 
-    hash_map <
-        AccountKey,
-        std::vector <RippleState::pointer>,
-        AccountKey::Hash> lines_;
+    struct Stripe
+    {
+        std::mutex mutex;
+
+        hash_map <
+            AccountKey,
+            std::vector <RippleState::pointer>,
+            AccountKey::Hash> lines;
+    };
+
+    Stripe&
+    stripe (AccountKey const& key)
+    {
+        return stripes_[key.get_hash () % stripeCount];
+    }
+
+    struct Prefetch
+    {
+        std::vector<AccountID> accounts;
+        std::atomic<std::size_t> next {0};
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::size_t busy = 0;
+    };
+
+    std::vector<RippleState::pointer> const&
+    load (Stripe& stripe, AccountKey const& key);
+
+    void
+    prefetchSome (Prefetch& work);
+
+    std::array<Stripe, stripeCount> stripes_;
+
+    std::atomic<std::uint64_t> hits_ {0};
+    std::atomic<std::uint64_t> misses_ {0};
 };
 
 } 
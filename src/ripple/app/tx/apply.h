@@ -16,6 +16,10 @@ namespace ripple {
 class Application;
 class HashRouter;
 
+// HashRouter flags recording the outcome of a signature check
+#define SF_SIGBAD      SF_PRIVATE1
+#define SF_SIGGOOD     SF_PRIVATE2
+
 
 enum class Validity
 {
@@ -25,6 +29,11 @@ enum class Validity
 };
 
 
+std::pair<Validity, std::string>
+checkSignature(HashRouter& router,
+    STTx const& tx, Rules const& rules);
+
+
 std::pair<Validity, std::string>
 checkValidity(HashRouter& router,
     STTx const& tx, Rules const& rules,
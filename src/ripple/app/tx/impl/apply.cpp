@@ -8,20 +8,14 @@
 
 namespace ripple {
 
-#define SF_SIGBAD      SF_PRIVATE1    
-#define SF_SIGGOOD     SF_PRIVATE2    
 #define SF_LOCALBAD    SF_PRIVATE3    
 #define SF_LOCALGOOD   SF_PRIVATE4    
 
 
 std::pair<Validity, std::string>
-checkValidity(HashRouter& router,
-    STTx const& tx, Rules const& rules,
-        Config const& config)
+checkSignature(HashRouter& router,
+    STTx const& tx, Rules const& rules)
 {
-    auto const allowMultiSign =
-        rules.enabled(featureMultiSign);
-
     auto const id = tx.getTransactionID();
     auto const flags = router.getFlags(id);
     if (flags & SF_SIGBAD)
@@ -29,7 +23,8 @@ checkValidity(HashRouter& router,
 
     if (!(flags & SF_SIGGOOD))
     {
-        auto const sigVerify = tx.checkSign(allowMultiSign);
+        auto const sigVerify = tx.checkSign(
+            rules.enabled(featureMultiSign));
         if (! sigVerify.first)
         {
             router.setFlags(id, SF_SIGBAD);
@@ -37,6 +32,20 @@ checkValidity(HashRouter& router,
         }
         router.setFlags(id, SF_SIGGOOD);
     }
+    return {Validity::SigGoodOnly, ""};
+}
+
+std::pair<Validity, std::string>
+checkValidity(HashRouter& router,
+    STTx const& tx, Rules const& rules,
+        Config const& config)
+{
+    auto const sigValid = checkSignature(router, tx, rules);
+    if (sigValid.first == Validity::SigBad)
+        return sigValid;
+
+    auto const id = tx.getTransactionID();
+    auto const flags = router.getFlags(id);
 
     if (flags & SF_LOCALBAD)
         return {Validity::SigGoodOnly, "Local checks failed."};
@@ -15,6 +15,17 @@ std::string getFileContents(boost::system::error_code& ec,
     boost::filesystem::path const& sourcePath,
     boost::optional<std::size_t> maxSize = boost::none);
 
+/** Flush a file's contents to stable storage. */
+void syncFile(boost::system::error_code& ec,
+    boost::filesystem::path const& path);
+
+/** Flush a directory's entries, such as a rename, to stable storage.
+
+    This is a no-op on platforms that do not support it.
+*/
+void syncDirectory(boost::system::error_code& ec,
+    boost::filesystem::path const& path);
+
 }
 
 #endif
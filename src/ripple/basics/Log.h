@@ -7,10 +7,15 @@
 #include <boost/beast/core/string.hpp>
 #include <ripple/beast/utility/Journal.h>
 #include <boost/filesystem.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <thread>
 #include <utility>
+#include <vector>
 
 namespace ripple {
 
@@ -82,6 +87,9 @@ private:
         */
         void writeln (char const* text);
 
+        /** Flush buffered output to the system file. */
+        void flush ();
+
         /** Write to the log file using std::string. */
         /** @{ */
         void write (std::string const& str)
@@ -108,13 +116,35 @@ private:
     File file_;
     bool silent_ = false;
 
+public:
+    /** What a full asynchronous queue does with a new message. */
+    enum class Overflow
+    {
+        drop,
+        block
+    };
+
+private:
+    std::mutex mutable queueMutex_;
+    std::condition_variable workCond_;
+    std::condition_variable spaceCond_;
+    std::vector<std::string> queue_;
+    std::size_t capacity_ = 0;
+    Overflow overflow_ = Overflow::drop;
+    std::atomic<bool> async_ {false};
+    bool stop_ = false;
+    bool writing_ = false;
+    std::uint64_t dropped_ = 0;
+    std::uint64_t reported_ = 0;
+    std::thread writer_;
+
 public:
     Logs(beast::severities::Severity level);
 
     Logs (Logs const&) = delete;
     Logs& operator= (Logs const&) = delete;
 
-    virtual ~Logs() = default;
+    virtual ~Logs();
 
     bool
     open (boost::filesystem::path const& pathToLogFile);
@@ -144,6 +174,29 @@ public:
     std::string
     rotate();
 
+    /** Hand formatted messages to a background writer thread.
+
+        Up to `capacity` messages are queued and written in batches with
+        a single flush. When the queue is full, new messages are either
+        dropped and counted or the caller waits, depending on `overflow`.
+        A fatal message is written by the caller, together with anything
+        still queued, before it returns.
+    */
+    void
+    startAsync (std::size_t capacity, Overflow overflow);
+
+    /** Write out any queued messages and return to synchronous writes. */
+    void
+    stopAsync ();
+
+    /** Block until every queued message has been written. */
+    void
+    flush ();
+
+    /** Number of messages dropped because the queue was full. */
+    std::uint64_t
+    dropped () const;
+
     /**
      * Set flag to write logs to stderr (false) or not (true).
      *
@@ -183,6 +236,12 @@ private:
         maximumMessageCharacters = 12 * 1024
     };
 
+    void
+    run ();
+
+    void
+    writeLines (std::vector<std::string> const& lines);
+
     static
     void
     format (std::string& output, std::string const& message,
@@ -0,0 +1,81 @@
+
+
+#ifndef RIPPLE_BASICS_MEMORYGOVERNOR_H_INCLUDED
+#define RIPPLE_BASICS_MEMORYGOVERNOR_H_INCLUDED
+
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/json/json_value.h>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ripple {
+
+
+class MemoryGovernor
+{
+public:
+    struct Cache
+    {
+        std::function<std::uint64_t()> bytes;
+        std::function<std::uint64_t()> takeMarginalHits;
+        std::function<std::uint64_t(std::uint64_t)> evict;
+    };
+
+    MemoryGovernor (std::uint64_t budget, beast::Journal journal);
+
+    MemoryGovernor (MemoryGovernor const&) = delete;
+    MemoryGovernor& operator= (MemoryGovernor const&) = delete;
+
+    
+    template <class C>
+    void
+    add (std::string const& name, C& cache)
+    {
+        add (name, Cache {
+            [&cache] { return cache.getBytes (); },
+            [&cache] { return cache.takeMarginalHits (); },
+            [&cache] (std::uint64_t bytes) { return cache.evictBytes (bytes); }});
+    }
+
+    
+    void
+    add (std::string const& name, Cache cache);
+
+    std::uint64_t
+    getBudget () const
+    {
+        return budget_;
+    }
+
+    
+    std::uint64_t
+    govern ();
+
+    Json::Value
+    getJson () const;
+
+private:
+    struct Member
+    {
+        std::string name;
+        Cache cache;
+        std::uint64_t marginalHits = 0;
+        std::uint64_t evicted = 0;
+    };
+
+    std::uint64_t const budget_;
+    beast::Journal j_;
+
+    std::mutex mutable mutex_;
+    std::vector<Member> members_;
+    std::uint64_t passes_ = 0;
+    std::uint64_t overBudget_ = 0;
+    std::uint64_t evicted_ = 0;
+};
+
+}
+
+#endif
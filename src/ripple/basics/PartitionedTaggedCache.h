@@ -0,0 +1,285 @@
+
+
+#ifndef RIPPLE_BASICS_PARTITIONEDTAGGEDCACHE_H_INCLUDED
+#define RIPPLE_BASICS_PARTITIONEDTAGGEDCACHE_H_INCLUDED
+
+#include <ripple/basics/TaggedCache.h>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace ripple {
+
+
+template <
+    class Key,
+    class T,
+    class Hash = hardened_hash <>,
+    class KeyEqual = std::equal_to <Key>
+>
+class PartitionedTaggedCache
+{
+public:
+    using partition_type = TaggedCache <Key, T, Hash, KeyEqual, std::mutex>;
+    using key_type = Key;
+    using mapped_type = T;
+    using weak_mapped_ptr = std::weak_ptr <mapped_type>;
+    using mapped_ptr = std::shared_ptr <mapped_type>;
+    using clock_type = beast::abstract_clock <std::chrono::steady_clock>;
+
+    static std::size_t constexpr defaultPartitions = 16;
+
+public:
+    PartitionedTaggedCache (std::string const& name, int size,
+        clock_type::duration expiration, clock_type& clock, beast::Journal journal,
+            beast::insight::Collector::ptr const& collector = beast::insight::NullCollector::New (),
+                std::size_t partitions = defaultPartitions)
+        : m_journal (journal)
+        , m_clock (clock)
+        , m_name (name)
+        , m_target_size (size)
+        , m_target_age (expiration)
+        , m_partitions (makePartitions (name, size, expiration, clock, journal, partitions))
+        , m_stats (name,
+            std::bind (&PartitionedTaggedCache::collect_metrics, this),
+                collector)
+    {
+    }
+
+public:
+    clock_type& clock ()
+    {
+        return m_clock;
+    }
+
+    std::size_t partitions () const
+    {
+        return m_partitions.size ();
+    }
+
+    int getTargetSize () const
+    {
+        return m_target_size;
+    }
+
+    void setTargetSize (int s)
+    {
+        m_target_size = s;
+        for (auto& p : m_partitions)
+            p->setTargetSize (partitionSize (s, m_partitions.size ()));
+
+        JLOG(m_journal.debug()) <<
+            m_name << " target size set to " << s;
+    }
+
+    clock_type::duration getTargetAge () const
+    {
+        return m_target_age.load ();
+    }
+
+    void setTargetAge (clock_type::duration s)
+    {
+        m_target_age = s;
+        for (auto& p : m_partitions)
+            p->setTargetAge (s);
+    }
+
+    int getCacheSize () const
+    {
+        int size = 0;
+        for (auto const& p : m_partitions)
+            size += p->getCacheSize ();
+        return size;
+    }
+
+    int getTrackSize () const
+    {
+        int size = 0;
+        for (auto const& p : m_partitions)
+            size += p->getTrackSize ();
+        return size;
+    }
+
+    float getHitRate ()
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        for (auto const& p : m_partitions)
+        {
+            hits += p->getHits ();
+            misses += p->getMisses ();
+        }
+        auto const total = static_cast<float> (hits + misses);
+        return hits * (100.0f / std::max (1.0f, total));
+    }
+
+    std::uint64_t getBytes () const
+    {
+        std::uint64_t bytes = 0;
+        for (auto const& p : m_partitions)
+            bytes += p->getBytes ();
+        return bytes;
+    }
+
+    std::uint64_t takeMarginalHits ()
+    {
+        std::uint64_t hits = 0;
+        for (auto& p : m_partitions)
+            hits += p->takeMarginalHits ();
+        return hits;
+    }
+
+    
+    std::uint64_t evictBytes (std::uint64_t bytes)
+    {
+        std::vector <std::uint64_t> sizes;
+        sizes.reserve (m_partitions.size ());
+        std::uint64_t total = 0;
+        for (auto const& p : m_partitions)
+        {
+            sizes.push_back (p->getBytes ());
+            total += sizes.back ();
+        }
+        if (bytes == 0 || total == 0)
+            return 0;
+
+        std::uint64_t freed = 0;
+        for (std::size_t i = 0; i < m_partitions.size (); ++i)
+        {
+            auto const share = (bytes >= total) ? sizes[i] :
+                static_cast<std::uint64_t> (std::ceil (
+                    static_cast<double> (sizes[i]) * bytes / total));
+            freed += m_partitions[i]->evictBytes (share);
+        }
+        return freed;
+    }
+
+    void clear ()
+    {
+        for (auto& p : m_partitions)
+            p->clear ();
+    }
+
+    void reset ()
+    {
+        for (auto& p : m_partitions)
+            p->reset ();
+    }
+
+    void sweep ()
+    {
+        for (auto& p : m_partitions)
+            p->sweep ();
+    }
+
+    bool del (const key_type& key, bool valid)
+    {
+        return partition (key).del (key, valid);
+    }
+
+    bool canonicalize (const key_type& key, std::shared_ptr<T>& data, bool replace = false)
+    {
+        return partition (key).canonicalize (key, data, replace);
+    }
+
+    std::shared_ptr<T> fetch (const key_type& key)
+    {
+        return partition (key).fetch (key);
+    }
+
+    bool insert (key_type const& key, T const& value)
+    {
+        return partition (key).insert (key, value);
+    }
+
+    bool retrieve (const key_type& key, T& data)
+    {
+        return partition (key).retrieve (key, data);
+    }
+
+    bool refreshIfPresent (const key_type& key)
+    {
+        return partition (key).refreshIfPresent (key);
+    }
+
+    std::vector <key_type> getKeys () const
+    {
+        std::vector <key_type> v;
+        for (auto const& p : m_partitions)
+        {
+            auto keys = p->getKeys ();
+            v.insert (v.end (), keys.begin (), keys.end ());
+        }
+        return v;
+    }
+
+private:
+    static std::vector <std::unique_ptr <partition_type>>
+    makePartitions (std::string const& name, int size,
+        clock_type::duration expiration, clock_type& clock, beast::Journal journal,
+            std::size_t partitions)
+    {
+        assert (partitions > 0);
+        std::vector <std::unique_ptr <partition_type>> v;
+        v.reserve (partitions);
+        for (std::size_t i = 0; i < partitions; ++i)
+            v.emplace_back (std::make_unique <partition_type> (
+                name, partitionSize (size, partitions), expiration, clock, journal));
+        return v;
+    }
+
+    static int partitionSize (int size, std::size_t partitions)
+    {
+        if (size <= 0)
+            return size;
+        return static_cast<int> ((size + partitions - 1) / partitions);
+    }
+
+    partition_type& partition (key_type const& key)
+    {
+        return *m_partitions[m_hash (key) % m_partitions.size ()];
+    }
+
+    void collect_metrics ()
+    {
+        m_stats.size.set (getCacheSize ());
+        m_stats.hit_rate.set (
+            static_cast<beast::insight::Gauge::value_type> (getHitRate ()));
+    }
+
+private:
+    struct Stats
+    {
+        template <class Handler>
+        Stats (std::string const& prefix, Handler const& handler,
+            beast::insight::Collector::ptr const& collector)
+            : hook (collector->make_hook (handler))
+            , size (collector->make_gauge (prefix, "size"))
+            , hit_rate (collector->make_gauge (prefix, "hit_rate"))
+            { }
+
+        beast::insight::Hook hook;
+        beast::insight::Gauge size;
+        beast::insight::Gauge hit_rate;
+    };
+
+    beast::Journal m_journal;
+    clock_type& m_clock;
+    Hash m_hash;
+
+    std::string m_name;
+
+    std::atomic<int> m_target_size;
+
+    std::atomic<clock_type::duration> m_target_age;
+
+    std::vector <std::unique_ptr <partition_type>> const m_partitions;
+
+    Stats m_stats;
+};
+
+}
+
+#endif
@@ -0,0 +1,110 @@
+
+
+#ifndef RIPPLE_BASICS_SLABALLOCATOR_H_INCLUDED
+#define RIPPLE_BASICS_SLABALLOCATOR_H_INCLUDED
+
+#include <ripple/basics/ByteUtilities.h>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+
+
+class SlabAllocator
+{
+public:
+    static std::size_t constexpr alignment = 16;
+
+    struct Stats
+    {
+        std::size_t size;
+        std::size_t count;
+        std::size_t reserved;
+    };
+
+    explicit
+    SlabAllocator (std::size_t itemSize,
+            std::size_t slabSize = kilobytes(256))
+        : itemSize_ ((itemSize + alignment - 1) & ~(alignment - 1))
+        , itemsPerSlab_ (std::max<std::size_t> (slabSize / itemSize_, 1))
+    {
+    }
+
+    SlabAllocator (SlabAllocator const&) = delete;
+    SlabAllocator& operator= (SlabAllocator const&) = delete;
+
+    std::size_t
+    size () const
+    {
+        return itemSize_;
+    }
+
+    void*
+    allocate ()
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+
+        ++count_;
+
+        if (free_ != nullptr)
+        {
+            auto const p = free_;
+            free_ = *reinterpret_cast<void**> (p);
+            return p;
+        }
+
+        if (remain_ == 0)
+        {
+            slabs_.emplace_back (
+                new std::uint8_t[itemSize_ * itemsPerSlab_]);
+            next_ = slabs_.back ().get ();
+            remain_ = itemsPerSlab_;
+        }
+
+        auto const p = next_;
+        next_ += itemSize_;
+        --remain_;
+        return p;
+    }
+
+    void
+    deallocate (void* p)
+    {
+        assert (p != nullptr);
+
+        std::lock_guard<std::mutex> lock (mutex_);
+
+        assert (count_ != 0);
+        --count_;
+
+        *reinterpret_cast<void**> (p) = free_;
+        free_ = p;
+    }
+
+    Stats
+    getStats () const
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        return {itemSize_, count_, slabs_.size () * itemSize_ * itemsPerSlab_};
+    }
+
+private:
+    std::size_t const itemSize_;
+    std::size_t const itemsPerSlab_;
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<std::uint8_t[]>> slabs_;
+    std::uint8_t* next_ = nullptr;
+    std::size_t remain_ = 0;
+    void* free_ = nullptr;
+    std::size_t count_ = 0;
+};
+
+}
+
+#endif
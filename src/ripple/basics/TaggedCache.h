@@ -8,6 +8,8 @@
 #include <ripple/basics/UnorderedContainers.h>
 #include <ripple/beast/clock/abstract_clock.h>
 #include <ripple/beast/insight/Insight.h>
+#include <algorithm>
+#include <cmath>
 #include <functional>
 #include <mutex>
 #include <vector>
@@ -17,6 +19,14 @@ namespace ripple {
 struct TaggedCacheLog;
 
 
+template <class T>
+std::size_t
+cacheBytes (T const&)
+{
+    return sizeof (T);
+}
+
+
 template <
     class Key,
     class T,
@@ -49,8 +59,10 @@ public:
         , m_target_size (size)
         , m_target_age (expiration)
         , m_cache_count (0)
+        , m_bytes (0)
         , m_hits (0)
         , m_misses (0)
+        , m_marginal_hits (0)
     {
     }
 
@@ -112,11 +124,40 @@ public:
         return m_hits * (100.0f / std::max (1.0f, total));
     }
 
+    std::uint64_t getHits () const
+    {
+        lock_guard lock (m_mutex);
+        return m_hits;
+    }
+
+    std::uint64_t getMisses () const
+    {
+        lock_guard lock (m_mutex);
+        return m_misses;
+    }
+
+    
+    std::uint64_t getBytes () const
+    {
+        lock_guard lock (m_mutex);
+        return m_bytes;
+    }
+
+    
+    std::uint64_t takeMarginalHits ()
+    {
+        lock_guard lock (m_mutex);
+        auto const hits = m_marginal_hits;
+        m_marginal_hits = 0;
+        return hits;
+    }
+
     void clear ()
     {
         lock_guard lock (m_mutex);
         m_cache.clear ();
         m_cache_count = 0;
+        m_bytes = 0;
     }
 
     void reset ()
@@ -124,15 +165,58 @@ public:
         lock_guard lock (m_mutex);
         m_cache.clear();
         m_cache_count = 0;
+        m_bytes = 0;
         m_hits = 0;
         m_misses = 0;
+        m_marginal_hits = 0;
+    }
+
+    
+    std::uint64_t evictBytes (std::uint64_t bytes)
+    {
+        if (bytes == 0)
+            return 0;
+
+        std::vector <mapped_ptr> stuffToSweep;
+        std::uint64_t freed = 0;
+        int cacheRemovals = 0;
+        int mapRemovals = 0;
+
+        clock_type::time_point when_expire = clock_type::time_point::max ();
+        {
+            lock_guard lock (m_mutex);
+            if (bytes < m_bytes)
+                when_expire = evictionCutoff (bytes);
+        }
+
+        // Walk the buckets a chunk at a time so that lookups are not held
+        // up behind a pass over the whole map. Buckets that move because
+        // of a rehash in between are picked up by the next pass.
+        for (std::size_t bucket = 0;; )
+        {
+            lock_guard lock (m_mutex);
+            auto const buckets = m_cache.bucket_count ();
+            if (bucket >= buckets)
+                break;
+            auto const last = std::min (buckets, bucket + evictionChunkSize);
+            for (; bucket < last; ++bucket)
+            {
+                freed += expireBucket (bucket, when_expire,
+                    stuffToSweep, cacheRemovals, mapRemovals);
+            }
+        }
+
+        JLOG(m_journal.debug()) <<
+            m_name << " evicted " << cacheRemovals << " entries, " <<
+                freed << " of " << bytes << " bytes requested";
+
+        return freed;
     }
 
     void sweep ()
     {
         int cacheRemovals = 0;
         int mapRemovals = 0;
-        int cc = 0;
 
         std::vector <mapped_ptr> stuffToSweep;
 
@@ -161,46 +245,7 @@ public:
                         " aging at " << (now - when_expire).count() << " of " << m_target_age.count();
             }
 
-            stuffToSweep.reserve (m_cache.size ());
-
-            cache_iterator cit = m_cache.begin ();
-
-            while (cit != m_cache.end ())
-            {
-                if (cit->second.isWeak ())
-                {
-                    if (cit->second.isExpired ())
-                    {
-                        ++mapRemovals;
-                        cit = m_cache.erase (cit);
-                    }
-                    else
-                    {
-                        ++cit;
-                    }
-                }
-                else if (cit->second.last_access <= when_expire)
-                {
-                    --m_cache_count;
-                    ++cacheRemovals;
-                    if (cit->second.ptr.unique ())
-                    {
-                        stuffToSweep.push_back (cit->second.ptr);
-                        ++mapRemovals;
-                        cit = m_cache.erase (cit);
-                    }
-                    else
-                    {
-                        cit->second.ptr.reset ();
-                        ++cit;
-                    }
-                }
-                else
-                {
-                    ++cc;
-                    ++cit;
-                }
-            }
+            expire (when_expire, stuffToSweep, cacheRemovals, mapRemovals);
         }
 
         if (mapRemovals || cacheRemovals)
@@ -228,6 +273,7 @@ public:
         if (entry.isCached ())
         {
             --m_cache_count;
+            m_bytes -= entry.bytes;
             entry.ptr.reset ();
             ret = true;
         }
@@ -247,9 +293,11 @@ public:
 
         if (cit == m_cache.end ())
         {
-            m_cache.emplace (std::piecewise_construct,
+            cit = m_cache.emplace (std::piecewise_construct,
                 std::forward_as_tuple(key),
-                std::forward_as_tuple(m_clock.now(), data));
+                std::forward_as_tuple(m_clock.now(), data)).first;
+            cit->second.bytes = entryBytes (data);
+            m_bytes += cit->second.bytes;
             ++m_cache_count;
             return false;
         }
@@ -261,8 +309,11 @@ public:
         {
             if (replace)
             {
+                m_bytes -= entry.bytes;
                 entry.ptr = data;
                 entry.weak_ptr = data;
+                entry.bytes = entryBytes (data);
+                m_bytes += entry.bytes;
             }
             else
             {
@@ -280,6 +331,7 @@ public:
             {
                 entry.ptr = data;
                 entry.weak_ptr = data;
+                entry.bytes = entryBytes (data);
             }
             else
             {
@@ -287,12 +339,15 @@ public:
                 data = cachedData;
             }
 
+            m_bytes += entry.bytes;
             ++m_cache_count;
             return true;
         }
 
         entry.ptr = data;
         entry.weak_ptr = data;
+        entry.bytes = entryBytes (data);
+        m_bytes += entry.bytes;
         ++m_cache_count;
 
         return false;
@@ -311,18 +366,23 @@ public:
         }
 
         Entry& entry = cit->second;
-        entry.touch (m_clock.now());
+        auto const now = m_clock.now();
 
         if (entry.isCached ())
         {
             ++m_hits;
+            if (now - entry.last_access > m_target_age / 2)
+                ++m_marginal_hits;
+            entry.touch (now);
             return entry.ptr;
         }
 
+        entry.touch (now);
         entry.ptr = entry.lock ();
 
         if (entry.isCached ())
         {
+            m_bytes += entry.bytes;
             ++m_cache_count;
             return entry.ptr;
         }
@@ -370,6 +430,7 @@ public:
 
                 if (entry.isCached ())
                 {
+                    m_bytes += entry.bytes;
                     ++m_cache_count;
                     entry.touch (m_clock.now());
                     found = true;
@@ -412,6 +473,150 @@ public:
     }
 
 private:
+    static std::size_t constexpr evictionSampleSize = 1024;
+
+    static std::size_t constexpr evictionChunkSize = 4096;
+
+    std::vector <std::pair <clock_type::time_point, std::size_t>>
+    sampleCached (std::size_t stride) const
+    {
+        std::vector <std::pair <clock_type::time_point, std::size_t>> sample;
+        sample.reserve (std::min <std::size_t> (m_cache_count, evictionSampleSize));
+        auto const buckets = m_cache.bucket_count ();
+        for (std::size_t b = 0; b < buckets; b += stride)
+        {
+            for (auto it = m_cache.begin (b); it != m_cache.end (b); ++it)
+            {
+                if (it->second.isCached ())
+                    sample.emplace_back (it->second.last_access, it->second.bytes);
+            }
+        }
+        return sample;
+    }
+
+    clock_type::time_point evictionCutoff (std::uint64_t bytes) const
+    {
+        auto const stride = std::max <std::size_t> (
+            1, m_cache.bucket_count () / evictionSampleSize);
+        auto sample = sampleCached (stride);
+
+        // A mostly weak cache can leave the sampled buckets without any
+        // cached entry. The few cached entries are then all looked at.
+        if (sample.empty () && stride > 1)
+            sample = sampleCached (1);
+        if (sample.empty ())
+            return clock_type::time_point::min ();
+
+        std::sort (sample.begin (), sample.end ());
+        std::uint64_t sampleBytes = 0;
+        for (auto const& entry : sample)
+            sampleBytes += entry.second;
+
+        auto const target = static_cast<std::uint64_t> (std::ceil (
+            static_cast<double> (sampleBytes) * bytes / m_bytes));
+        std::uint64_t total = 0;
+        for (auto const& entry : sample)
+        {
+            total += entry.second;
+            if (total >= target)
+                return entry.first;
+        }
+        return sample.back ().first;
+    }
+
+    static std::size_t entryBytes (mapped_ptr const& data)
+    {
+        std::size_t bytes = sizeof (typename cache_type::value_type);
+        if (data)
+            bytes += cacheBytes (*data);
+        return bytes;
+    }
+
+    void expire (clock_type::time_point const& when_expire,
+        std::vector <mapped_ptr>& stuffToSweep,
+            int& cacheRemovals, int& mapRemovals)
+    {
+        stuffToSweep.reserve (m_cache.size ());
+
+        cache_iterator cit = m_cache.begin ();
+
+        while (cit != m_cache.end ())
+        {
+            if (cit->second.isWeak ())
+            {
+                if (cit->second.isExpired ())
+                {
+                    ++mapRemovals;
+                    cit = m_cache.erase (cit);
+                }
+                else
+                {
+                    ++cit;
+                }
+            }
+            else if (cit->second.last_access <= when_expire)
+            {
+                --m_cache_count;
+                m_bytes -= cit->second.bytes;
+                ++cacheRemovals;
+                if (cit->second.ptr.unique ())
+                {
+                    stuffToSweep.push_back (cit->second.ptr);
+                    ++mapRemovals;
+                    cit = m_cache.erase (cit);
+                }
+                else
+                {
+                    cit->second.ptr.reset ();
+                    ++cit;
+                }
+            }
+            else
+            {
+                ++cit;
+            }
+        }
+    }
+
+    std::uint64_t expireBucket (std::size_t bucket,
+        clock_type::time_point const& when_expire,
+            std::vector <mapped_ptr>& stuffToSweep,
+                int& cacheRemovals, int& mapRemovals)
+    {
+        auto const before = m_bytes;
+        std::vector <key_type> erased;
+
+        for (auto it = m_cache.begin (bucket); it != m_cache.end (bucket); ++it)
+        {
+            auto& entry = it->second;
+            if (entry.isWeak ())
+            {
+                if (entry.isExpired ())
+                    erased.push_back (it->first);
+            }
+            else if (entry.last_access <= when_expire)
+            {
+                --m_cache_count;
+                m_bytes -= entry.bytes;
+                ++cacheRemovals;
+                if (entry.ptr.unique ())
+                {
+                    stuffToSweep.push_back (entry.ptr);
+                    erased.push_back (it->first);
+                }
+                else
+                {
+                    entry.ptr.reset ();
+                }
+            }
+        }
+
+        for (auto const& key : erased)
+            m_cache.erase (key);
+        mapRemovals += static_cast<int> (erased.size ());
+        return before - m_bytes;
+    }
+
     void collect_metrics ()
     {
         m_stats.size.set (getCacheSize ());
@@ -450,6 +655,7 @@ private:
         mapped_ptr ptr;
         weak_mapped_ptr weak_ptr;
         clock_type::time_point last_access;
+        std::size_t bytes = 0;
 
         Entry (clock_type::time_point const& last_access_,
             mapped_ptr const& ptr_)
@@ -482,9 +688,11 @@ private:
     clock_type::duration m_target_age;
 
     int m_cache_count;
+    std::uint64_t m_bytes;
     cache_type m_cache;  
     std::uint64_t m_hits;
     std::uint64_t m_misses;
+    std::uint64_t m_marginal_hits;
 };
 
 }
@@ -2,9 +2,54 @@
 
 #include <ripple/basics/FileUtilities.h>
 
+#ifdef _MSC_VER
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 namespace ripple
 {
 
+namespace {
+
+void
+syncPath(boost::system::error_code& ec,
+    boost::filesystem::path const& path, bool directory)
+{
+    using namespace boost::system;
+
+#ifdef _MSC_VER
+    if (directory)
+        return;
+    auto const h = CreateFileW(path.c_str(), GENERIC_WRITE,
+        FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (h == INVALID_HANDLE_VALUE)
+    {
+        ec = error_code(GetLastError(), system_category());
+        return;
+    }
+    if (!FlushFileBuffers(h))
+        ec = error_code(GetLastError(), system_category());
+    CloseHandle(h);
+#else
+    auto const fd = ::open(path.c_str(),
+        directory ? O_RDONLY | O_DIRECTORY : O_RDONLY);
+    if (fd == -1)
+    {
+        ec = error_code(errno, generic_category());
+        return;
+    }
+    if (::fsync(fd) == -1)
+        ec = error_code(errno, generic_category());
+    ::close(fd);
+#endif
+}
+
+}
+
 std::string getFileContents(boost::system::error_code& ec,
     boost::filesystem::path const& sourcePath,
     boost::optional<std::size_t> maxSize)
@@ -43,6 +88,18 @@ std::string getFileContents(boost::system::error_code& ec,
     return result;
 }
 
+void syncFile(boost::system::error_code& ec,
+    boost::filesystem::path const& path)
+{
+    syncPath(ec, path, false);
+}
+
+void syncDirectory(boost::system::error_code& ec,
+    boost::filesystem::path const& path)
+{
+    syncPath(ec, path, true);
+}
+
 }
 
 
@@ -3,6 +3,7 @@
 #include <ripple/basics/chrono.h>
 #include <ripple/basics/Log.h>
 #include <ripple/basics/contract.h>
+#include <ripple/beast/core/CurrentThreadName.h>
 #include <boost/algorithm/string.hpp>
 #include <cassert>
 #include <fstream>
@@ -89,12 +90,23 @@ void Logs::File::writeln (char const* text)
     }
 }
 
+void Logs::File::flush ()
+{
+    if (m_stream != nullptr)
+        m_stream->flush ();
+}
+
 
 Logs::Logs(beast::severities::Severity thresh)
     : thresh_ (thresh) 
 {
 }
 
+Logs::~Logs ()
+{
+    stopAsync ();
+}
+
 bool
 Logs::open (boost::filesystem::path const& pathToLogFile)
 {
@@ -155,12 +167,171 @@ Logs::write (beast::severities::Severity level, std::string const& partition,
 {
     std::string s;
     format (s, text, level, partition);
+
+    if (async_)
+    {
+        std::unique_lock <std::mutex> lock (queueMutex_);
+        bool const fatal = level >= beast::severities::kFatal;
+
+        if (async_ && fatal)
+        {
+            // Take over whatever is queued and write it here, rather
+            // than wait for a queue that other threads keep refilling.
+            std::vector<std::string> lines;
+            lines.swap (queue_);
+            queue_.reserve (capacity_);
+            spaceCond_.notify_all ();
+            lock.unlock ();
+
+            lines.push_back (std::move (s));
+            writeLines (lines);
+            return;
+        }
+
+        if (async_ && queue_.size () >= capacity_)
+        {
+            if (overflow_ == Overflow::drop)
+            {
+                ++dropped_;
+                return;
+            }
+
+            spaceCond_.wait (lock, [this]
+            {
+                return ! async_ || queue_.size () < capacity_;
+            });
+        }
+
+        if (async_)
+        {
+            queue_.push_back (std::move (s));
+            if (queue_.size () == 1)
+                workCond_.notify_one ();
+            return;
+        }
+    }
+
     std::lock_guard <std::mutex> lock (mutex_);
     file_.writeln (s);
     if (! silent_)
         std::cerr << s << '\n';
 }
 
+void
+Logs::startAsync (std::size_t capacity, Overflow overflow)
+{
+    std::lock_guard <std::mutex> lock (queueMutex_);
+
+    if (async_ || capacity == 0)
+        return;
+
+    capacity_ = capacity;
+    overflow_ = overflow;
+    queue_.reserve (capacity_);
+    stop_ = false;
+    async_ = true;
+    writer_ = std::thread (&Logs::run, this);
+}
+
+void
+Logs::stopAsync ()
+{
+    {
+        std::lock_guard <std::mutex> lock (queueMutex_);
+        if (! writer_.joinable ())
+            return;
+        stop_ = true;
+        workCond_.notify_one ();
+    }
+
+    writer_.join ();
+}
+
+void
+Logs::flush ()
+{
+    std::unique_lock <std::mutex> lock (queueMutex_);
+    spaceCond_.wait (lock, [this]
+    {
+        return queue_.empty () && ! writing_;
+    });
+}
+
+std::uint64_t
+Logs::dropped () const
+{
+    std::lock_guard <std::mutex> lock (queueMutex_);
+    return dropped_;
+}
+
+void
+Logs::run ()
+{
+    beast::setCurrentThreadName ("Logs");
+
+    std::vector<std::string> batch;
+    batch.reserve (capacity_);
+
+    std::unique_lock <std::mutex> lock (queueMutex_);
+
+    while (true)
+    {
+        workCond_.wait (lock, [this]
+        {
+            return stop_ || ! queue_.empty ();
+        });
+
+        if (queue_.empty ())
+        {
+            async_ = false;
+            spaceCond_.notify_all ();
+            return;
+        }
+
+        batch.swap (queue_);
+        auto const dropped = dropped_ - reported_;
+        reported_ = dropped_;
+        writing_ = true;
+        spaceCond_.notify_all ();
+        lock.unlock ();
+
+        if (dropped != 0)
+        {
+            std::string s;
+            format (s, std::to_string (dropped) +
+                " messages dropped by a full log queue",
+                beast::severities::kWarning, "Logs");
+            batch.push_back (std::move (s));
+        }
+
+        writeLines (batch);
+        batch.clear ();
+
+        lock.lock ();
+        writing_ = false;
+        spaceCond_.notify_all ();
+    }
+}
+
+void
+Logs::writeLines (std::vector<std::string> const& lines)
+{
+    std::lock_guard <std::mutex> lock (mutex_);
+
+    for (auto const& line : lines)
+    {
+        file_.write (line);
+        file_.write ("\n");
+    }
+    file_.flush ();
+
+    if (! silent_)
+    {
+        for (auto const& line : lines)
+            std::cerr << line << '\n';
+    }
+}
+
 std::string
 Logs::rotate()
 {
@@ -0,0 +1,116 @@
+
+
+#include <ripple/basics/MemoryGovernor.h>
+#include <ripple/basics/Log.h>
+#include <ripple/protocol/jss.h>
+#include <algorithm>
+#include <numeric>
+
+namespace ripple {
+
+MemoryGovernor::MemoryGovernor (std::uint64_t budget, beast::Journal journal)
+    : budget_ (budget)
+    , j_ (journal)
+{
+}
+
+void
+MemoryGovernor::add (std::string const& name, Cache cache)
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    members_.push_back ({name, std::move (cache)});
+}
+
+std::uint64_t
+MemoryGovernor::govern ()
+{
+    std::lock_guard<std::mutex> lock (mutex_);
+    ++passes_;
+
+    std::vector<std::uint64_t> bytes;
+    bytes.reserve (members_.size ());
+    std::uint64_t total = 0;
+    for (auto& m : members_)
+    {
+        bytes.push_back (m.cache.bytes ());
+        m.marginalHits = m.cache.takeMarginalHits ();
+        total += bytes.back ();
+    }
+
+    if (budget_ == 0 || total <= budget_)
+        return 0;
+
+    ++overBudget_;
+    auto const excess = total - budget_;
+
+    std::vector<std::size_t> order (members_.size ());
+    std::iota (order.begin (), order.end (), 0);
+    std::sort (order.begin (), order.end (),
+        [&](std::size_t a, std::size_t b)
+        {
+            auto const ra = members_[a].marginalHits /
+                std::max (1.0, static_cast<double> (bytes[a]));
+            auto const rb = members_[b].marginalHits /
+                std::max (1.0, static_cast<double> (bytes[b]));
+            if (ra != rb)
+                return ra < rb;
+            return bytes[a] > bytes[b];
+        });
+
+    std::vector<std::uint64_t> taken (members_.size (), 0);
+    std::uint64_t freed = 0;
+    for (auto const divisor : {2, 1})
+    {
+        for (auto const i : order)
+        {
+            if (freed >= excess)
+                break;
+
+            auto const limit = bytes[i] / divisor;
+            if (taken[i] >= limit)
+                continue;
+
+            auto const want = std::min (excess - freed, limit - taken[i]);
+            auto const got = members_[i].cache.evict (want);
+            taken[i] += got;
+            members_[i].evicted += got;
+            freed += got;
+        }
+    }
+    evicted_ += freed;
+
+    JLOG(j_.warn()) <<
+        "Cache memory " << total << " exceeds budget " << budget_ <<
+            ", evicted " << freed << " bytes";
+
+    return freed;
+}
+
+Json::Value
+MemoryGovernor::getJson () const
+{
+    Json::Value ret (Json::objectValue);
+    std::lock_guard<std::mutex> lock (mutex_);
+
+    std::uint64_t total = 0;
+    Json::Value& caches = (ret[jss::caches] = Json::objectValue);
+    for (auto const& m : members_)
+    {
+        auto const bytes = m.cache.bytes ();
+        total += bytes;
+
+        Json::Value& jv = (caches[m.name] = Json::objectValue);
+        jv[jss::bytes] = std::to_string (bytes);
+        jv[jss::marginal_hits] = std::to_string (m.marginalHits);
+        jv[jss::evicted] = std::to_string (m.evicted);
+    }
+
+    ret[jss::budget] = std::to_string (budget_);
+    ret[jss::bytes] = std::to_string (total);
+    ret[jss::passes] = std::to_string (passes_);
+    ret[jss::over_budget] = std::to_string (overBudget_);
+    ret[jss::evicted] = std::to_string (evicted_);
+    return ret;
+}
+
+}
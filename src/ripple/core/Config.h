@@ -79,6 +79,7 @@ public:
     bool doImport = false;
     bool nodeToShard = false;
     bool validateShards = false;
+    bool importAccountTx = false;
     bool ELB_SUPPORT = false;
 
     std::vector<std::string>    IPS;                    
@@ -107,6 +108,8 @@ public:
     bool                        PEER_PRIVATE = false;           
     std::size_t                 PEERS_MAX = 0;
 
+    bool                        COMPRESSION = true;
+
     std::chrono::seconds        WEBSOCKET_PING_FREQ = std::chrono::minutes {5};
 
     int                         PATH_SEARCH_OLD = 7;
@@ -131,6 +134,8 @@ public:
 
     std::size_t                 WORKERS = 0;
 
+    std::uint64_t               MEMORY_BUDGET = 0;
+
     boost::optional<beast::IP::Endpoint> rpc_ip;
 
     std::unordered_set<uint256, beast::uhash<>> features;
@@ -14,11 +14,14 @@ struct ConfigSection
     static std::string nodeDatabase ()       { return "node_db"; }
     static std::string shardDatabase ()      { return "shard_db"; }
     static std::string importNodeDatabase () { return "import_db"; }
+    static std::string accountTxStore ()     { return "account_tx_store"; }
 };
 
 #define SECTION_AMENDMENTS              "amendments"
 #define SECTION_CLUSTER_NODES           "cluster_nodes"
+#define SECTION_COMPRESSION             "compression"
 #define SECTION_DEBUG_LOGFILE           "debug_logfile"
+#define SECTION_DEBUG_LOG_QUEUE         "debug_log_queue"
 #define SECTION_ELB_SUPPORT             "elb_support"
 #define SECTION_FEE_DEFAULT             "fee_default"
 #define SECTION_FEE_OFFER               "fee_offer"
@@ -26,6 +29,7 @@ struct ConfigSection
 #define SECTION_FEE_OWNER_RESERVE       "fee_owner_reserve"
 #define SECTION_FETCH_DEPTH             "fetch_depth"
 #define SECTION_LEDGER_HISTORY          "ledger_history"
+#define SECTION_MEMORY_BUDGET           "memory_budget"
 #define SECTION_INSIGHT                 "insight"
 #define SECTION_IPS                     "ips"
 #define SECTION_IPS_FIXED               "ips_fixed"
@@ -11,6 +11,10 @@
 #include <ripple/core/impl/Workers.h>
 #include <ripple/json/json_value.h>
 #include <boost/coroutine/all.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
 
 namespace ripple {
 
@@ -139,12 +143,24 @@ private:
 
     beast::Journal m_journal;
     mutable std::mutex m_mutex;
-    std::uint64_t m_lastJob;
-    std::set <Job> m_jobSet;
+    std::atomic <std::uint64_t> m_lastJob;
     JobDataMap m_jobData;
     JobTypeData m_invalidJobData;
 
-    int m_processCount;
+    
+    std::vector <JobTypeData*> m_lanes;
+
+    std::atomic <int> m_jobCount;
+    std::atomic <int> m_processCount;
+
+    
+    std::atomic <bool> m_closed;
+
+    
+    std::atomic <std::uint64_t> m_laneVersion;
+    std::atomic <int> m_idleWorkers;
+    std::mutex m_idleMutex;
+    std::condition_variable m_idleCond;
 
     int nSuspend_ = 0;
 
@@ -168,11 +184,14 @@ private:
     bool addRefCountedJob (
         JobType type, std::string const& name, JobFunction const& func);
 
-    void queueJob (Job const& job, std::lock_guard <std::mutex> const& lock);
+    void queueJob (JobTypeData& data,
+        std::lock_guard <std::mutex> const& lock);
+
+    JobTypeData& getNextJob (Job& job);
 
-    void getNextJob (Job& job);
+    void finishJob (JobTypeData& data);
 
-    void finishJob (JobType type);
+    void wakeIdle ();
 
     void processTask (int instance) override;
 
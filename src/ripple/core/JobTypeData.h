@@ -4,8 +4,12 @@
 #define RIPPLE_CORE_JOBTYPEDATA_H_INCLUDED
 
 #include <ripple/basics/Log.h>
+#include <ripple/core/Job.h>
 #include <ripple/core/JobTypeInfo.h>
 #include <ripple/beast/insight/Collector.h>
+#include <atomic>
+#include <deque>
+#include <mutex>
 
 namespace ripple
 {
@@ -23,7 +27,13 @@ public:
     JobTypeInfo const& info;
 
     
-    int waiting;
+    std::mutex mutable mutex;
+
+    
+    std::deque<Job> jobs;
+
+    
+    std::atomic<int> waiting;
 
     
     int running;
@@ -2,6 +2,7 @@
 
 #include <ripple/core/Config.h>
 #include <ripple/core/ConfigSections.h>
+#include <ripple/basics/ByteUtilities.h>
 #include <ripple/basics/contract.h>
 #include <ripple/basics/FileUtilities.h>
 #include <ripple/basics/Log.h>
@@ -295,6 +296,9 @@ void Config::loadFromString (std::string const& fileContents)
     if (getSingleSection (secConfig, SECTION_ELB_SUPPORT, strTemp, j_))
         ELB_SUPPORT         = beast::lexicalCastThrow <bool> (strTemp);
 
+    if (getSingleSection (secConfig, SECTION_COMPRESSION, strTemp, j_))
+        COMPRESSION         = beast::lexicalCastThrow <bool> (strTemp);
+
     if (getSingleSection (secConfig, SECTION_WEBSOCKET_PING_FREQ, strTemp, j_))
         WEBSOCKET_PING_FREQ = std::chrono::seconds{beast::lexicalCastThrow <int>(strTemp)};
 
@@ -362,6 +366,10 @@ void Config::loadFromString (std::string const& fileContents)
     if (getSingleSection (secConfig, SECTION_WORKERS, strTemp, j_))
         WORKERS      = beast::lexicalCastThrow <std::size_t> (strTemp);
 
+    if (getSingleSection (secConfig, SECTION_MEMORY_BUDGET, strTemp, j_))
+        MEMORY_BUDGET = megabytes (
+            beast::lexicalCastThrow <std::uint64_t> (strTemp));
+
     if (! RUN_STANDALONE)
     {
         boost::filesystem::path validatorsFile;
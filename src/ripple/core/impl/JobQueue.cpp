@@ -3,6 +3,7 @@
 #include <ripple/core/JobQueue.h>
 #include <ripple/basics/contract.h>
 #include <ripple/basics/PerfLog.h>
+#include <thread>
 
 namespace ripple {
 
@@ -13,7 +14,11 @@ JobQueue::JobQueue (beast::insight::Collector::ptr const& collector,
     , m_journal (journal)
     , m_lastJob (0)
     , m_invalidJobData (JobTypes::instance().getInvalid (), collector, logs)
+    , m_jobCount (0)
     , m_processCount (0)
+    , m_closed (false)
+    , m_laneVersion (0)
+    , m_idleWorkers (0)
     , m_workers (*this, perfLog, "JobQueue", 0)
     , m_cancelCallback (std::bind (&Stoppable::isStopping, this))
     , perfLog_ (perfLog)
@@ -35,6 +40,12 @@ JobQueue::JobQueue (beast::insight::Collector::ptr const& collector,
             assert (result.second == true);
             (void) result.second;
         }
+
+        for (auto iter = m_jobData.rbegin (); iter != m_jobData.rend (); ++iter)
+        {
+            if (! iter->second.info.special ())
+                m_lanes.push_back (&iter->second);
+        }
     }
 }
 
@@ -46,8 +57,7 @@ JobQueue::~JobQueue ()
 void
 JobQueue::collect ()
 {
-    std::lock_guard <std::mutex> lock (m_mutex);
-    job_count = m_jobSet.size ();
+    job_count = m_jobCount;
 }
 
 bool
@@ -65,44 +75,52 @@ JobQueue::addRefCountedJob (JobType type, std::string const& name,
 
     assert (type == jtCLIENT || m_workers.getNumberOfThreads () > 0);
 
+    // Count the job before looking at m_closed. checkStopped sets the
+    // flag before it looks at the count, so one of the two always sees
+    // the other and no job is queued once the queue reports stopped.
+    ++m_jobCount;
+    if (m_closed)
     {
         std::lock_guard <std::mutex> lock (m_mutex);
+        --m_jobCount;
+        cv_.notify_all ();
+        checkStopped (lock);
+        return false;
+    }
+
+    assert (! isStopped());
 
-        assert (! isStopped() && (
-            m_processCount>0 ||
-            ! m_jobSet.empty () ||
-            ! areChildrenStopped()));
+    Job job (type, name, ++m_lastJob, data.load (), func, m_cancelCallback);
 
-        std::pair <std::set <Job>::iterator, bool> result (
-            m_jobSet.insert (Job (type, name, ++m_lastJob,
-                data.load (), func, m_cancelCallback)));
-        queueJob (*result.first, lock);
+    {
+        std::lock_guard <std::mutex> lock (data.mutex);
+        data.jobs.push_back (std::move (job));
+        queueJob (data, lock);
     }
+    wakeIdle ();
     return true;
 }
 
 int
 JobQueue::getJobCount (JobType t) const
 {
-    std::lock_guard <std::mutex> lock (m_mutex);
-
     JobDataMap::const_iterator c = m_jobData.find (t);
 
     return (c == m_jobData.end ())
         ? 0
-        : c->second.waiting;
+        : c->second.waiting.load ();
 }
 
 int
 JobQueue::getJobCountTotal (JobType t) const
 {
-    std::lock_guard <std::mutex> lock (m_mutex);
-
     JobDataMap::const_iterator c = m_jobData.find (t);
 
-    return (c == m_jobData.end ())
-        ? 0
-        : (c->second.waiting + c->second.running);
+    if (c == m_jobData.end ())
+        return 0;
+
+    std::lock_guard <std::mutex> lock (c->second.mutex);
+    return c->second.waiting + c->second.running;
 }
 
 int
@@ -110,8 +128,6 @@ JobQueue::getJobCountGE (JobType t) const
 {
     int ret = 0;
 
-    std::lock_guard <std::mutex> lock (m_mutex);
-
     for (auto const& x : m_jobData)
     {
         if (x.first >= t)
@@ -192,8 +208,6 @@ JobQueue::getJson (int c)
 
     Json::Value priorities = Json::arrayValue;
 
-    std::lock_guard <std::mutex> lock (m_mutex);
-
     for (auto& x : m_jobData)
     {
         assert (x.first != jtINVALID);
@@ -205,8 +219,13 @@ JobQueue::getJson (int c)
 
         LoadMonitor::Stats stats (data.stats ());
 
-        int waiting (data.waiting);
-        int running (data.running);
+        int waiting;
+        int running;
+        {
+            std::lock_guard <std::mutex> lock (data.mutex);
+            waiting = data.waiting;
+            running = data.running;
+        }
 
         if ((stats.count != 0) || (waiting != 0) ||
             (stats.latencyPeak != 0ms) || (running != 0))
@@ -247,7 +266,7 @@ JobQueue::rendezvous()
     cv_.wait(lock, [&]
     {
         return m_processCount == 0 &&
-            m_jobSet.empty();
+            m_jobCount == 0;
     });
 }
 
@@ -274,89 +293,124 @@ JobQueue::checkStopped (std::lock_guard <std::mutex> const& lock)
     if (isStopping() &&
         areChildrenStopped() &&
         (m_processCount == 0) &&
-        m_jobSet.empty() &&
         nSuspend_ == 0)
     {
-        stopped();
+        m_closed = true;
+        if (m_jobCount == 0)
+        {
+            stopped();
+            return;
+        }
+        m_closed = false;
     }
 }
 
 void
-JobQueue::queueJob (Job const& job, std::lock_guard <std::mutex> const& lock)
+JobQueue::queueJob (JobTypeData& data,
+    std::lock_guard <std::mutex> const& lock)
 {
-    JobType const type (job.getType ());
+    JobType const type (data.type ());
     assert (type != jtINVALID);
-    assert (m_jobSet.find (job) != m_jobSet.end ());
+    assert (! data.jobs.empty ());
     perfLog_.jobQueue(type);
 
-    JobTypeData& data (getJobTypeData (type));
+    bool const runnable =
+        data.waiting + data.running < getJobLimit (type);
 
-    if (data.waiting + data.running < getJobLimit (type))
-    {
+    ++data.waiting;
+
+    if (runnable)
         m_workers.addTask ();
-    }
     else
-    {
         ++data.deferred;
-    }
-    ++data.waiting;
 }
 
-void
+JobTypeData&
 JobQueue::getNextJob (Job& job)
 {
-    assert (! m_jobSet.empty ());
+    assert (m_jobCount > 0);
 
-    std::set <Job>::const_iterator iter;
-    for (iter = m_jobSet.begin (); iter != m_jobSet.end (); ++iter)
+    while (true)
     {
-        JobTypeData& data (getJobTypeData (iter->getType ()));
+        auto const version = m_laneVersion.load ();
 
-        assert (data.running <= getJobLimit (data.type ()));
-
-        if (data.running < getJobLimit (data.type ()))
+        for (auto data : m_lanes)
         {
-            assert (data.waiting > 0);
-            break;
-        }
-    }
+            if (data->waiting == 0)
+                continue;
 
-    assert (iter != m_jobSet.end ());
+            std::lock_guard <std::mutex> lock (data->mutex);
 
-    JobType const type = iter->getType ();
-    JobTypeData& data (getJobTypeData (type));
+            assert (data->running <= getJobLimit (data->type ()));
 
-    assert (type != jtINVALID);
+            if (data->jobs.empty () ||
+                data->running >= getJobLimit (data->type ()))
+            {
+                continue;
+            }
 
-    job = *iter;
-    m_jobSet.erase (iter);
+            assert (data->type () != jtINVALID);
 
-    --data.waiting;
-    ++data.running;
+            job = std::move (data->jobs.front ());
+            data->jobs.pop_front ();
+
+            ++m_processCount;
+            --m_jobCount;
+            --data->waiting;
+            ++data->running;
+            return *data;
+        }
+
+        // The scan is not atomic across lanes, so it can miss a job that
+        // was queued or freed by a limit while it ran. Sleep until any
+        // lane changes and look again.
+        std::unique_lock <std::mutex> lock (m_idleMutex);
+        ++m_idleWorkers;
+        m_idleCond.wait (lock, [this, version]
+            {
+                return m_laneVersion.load () != version;
+            });
+        --m_idleWorkers;
+    }
 }
 
 void
-JobQueue::finishJob (JobType type)
+JobQueue::wakeIdle ()
 {
-    assert(type != jtINVALID);
+    ++m_laneVersion;
+    if (m_idleWorkers.load () != 0)
+    {
+        std::lock_guard <std::mutex> lock (m_idleMutex);
+        m_idleCond.notify_all ();
+    }
+}
 
-    JobTypeData& data = getJobTypeData (type);
+void
+JobQueue::finishJob (JobTypeData& data)
+{
+    assert(data.type () != jtINVALID);
 
-    if (data.deferred > 0)
     {
-        assert (data.running + data.waiting >= getJobLimit (type));
+        std::lock_guard <std::mutex> lock (data.mutex);
 
-        --data.deferred;
-        m_workers.addTask ();
-    }
+        if (data.deferred > 0)
+        {
+            assert (data.running + data.waiting >= getJobLimit (data.type ()));
 
-    --data.running;
+            --data.deferred;
+            m_workers.addTask ();
+        }
+
+        --data.running;
+    }
+    wakeIdle ();
 }
 
 void
 JobQueue::processTask (int instance)
 {
     JobType type;
+    JobTypeData* data;
 
     {
         using namespace std::chrono;
@@ -364,36 +418,31 @@ JobQueue::processTask (int instance)
             Job::clock_type::now());
         {
             Job job;
-            {
-                std::lock_guard <std::mutex> lock (m_mutex);
-                getNextJob (job);
-                ++m_processCount;
-            }
+            data = &getNextJob (job);
             type = job.getType();
-            JobTypeData& data(getJobTypeData(type));
-            JLOG(m_journal.trace()) << "Doing " << data.name () << " job";
+            JLOG(m_journal.trace()) << "Doing " << data->name () << " job";
             auto const us = date::ceil<microseconds>(
                 start_time - job.queue_time());
             perfLog_.jobStart(type, us, start_time, instance);
             if (us >= 10ms)
-                getJobTypeData(type).dequeue.notify(us);
+                data->dequeue.notify(us);
             job.doJob ();
         }
         auto const us (
             date::ceil<microseconds>(Job::clock_type::now() - start_time));
         perfLog_.jobFinish(type, us, instance);
         if (us >= 10ms)
-            getJobTypeData(type).execute.notify(us);
+            data->execute.notify(us);
     }
 
+    finishJob (*data);
+
+    if ((--m_processCount == 0 && m_jobCount == 0) || isStopping ())
     {
         std::lock_guard <std::mutex> lock (m_mutex);
-        finishJob (type);
-        if(--m_processCount == 0 && m_jobSet.empty())
-            cv_.notify_all();
+        cv_.notify_all();
         checkStopped (lock);
     }
-
 }
 
 int
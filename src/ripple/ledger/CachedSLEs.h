@@ -50,6 +50,8 @@ public:
             if (iter != map_.end())
             {
                 ++hit_;
+                if (map_.clock().now() - iter.when() > timeToLive_ / 2)
+                    ++marginal_;
                 map_.touch(iter);
                 return iter->second;
             }
@@ -63,7 +65,9 @@ public:
         auto const result =
             map_.emplace(
                 digest, std::move(sle));
-        if (! result.second)
+        if (result.second)
+            bytes_ += entryBytes(*result.first->second);
+        else
             map_.touch(result.first);
         return  result.first->second;
     }
@@ -72,9 +76,27 @@ public:
     double
     rate() const;
 
+    
+    std::uint64_t
+    getBytes() const;
+
+    
+    std::uint64_t
+    takeMarginalHits();
+
+    
+    std::uint64_t
+    evictBytes(std::uint64_t bytes);
+
 private:
+    static
+    std::size_t
+    entryBytes(SLE const& sle);
+
     std::size_t hit_ = 0;
     std::size_t miss_ = 0;
+    std::size_t marginal_ = 0;
+    std::uint64_t bytes_ = 0;
     std::mutex mutable mutex_;
     Stopwatch::duration timeToLive_;
     beast::aged_unordered_map <digest_type,
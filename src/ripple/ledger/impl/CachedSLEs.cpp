@@ -22,6 +22,7 @@ CachedSLEs::expire()
                 break;
             if (iter->second.unique())
             {
+                bytes_ -= entryBytes(*iter->second);
                 trash.emplace_back(
                     std::move(iter->second));
                 iter = map_.erase(iter);
@@ -30,6 +31,62 @@ CachedSLEs::expire()
     }
 }
 
+std::uint64_t
+CachedSLEs::getBytes() const
+{
+    std::lock_guard<
+        std::mutex> lock(mutex_);
+    return bytes_;
+}
+
+std::uint64_t
+CachedSLEs::takeMarginalHits()
+{
+    std::lock_guard<
+        std::mutex> lock(mutex_);
+    auto const hits = marginal_;
+    marginal_ = 0;
+    return hits;
+}
+
+std::uint64_t
+CachedSLEs::evictBytes(std::uint64_t bytes)
+{
+    std::vector<
+        std::shared_ptr<void const>> trash;
+    std::uint64_t freed = 0;
+    {
+        std::lock_guard<
+            std::mutex> lock(mutex_);
+        auto iter = map_.chronological.begin();
+        while (freed < bytes &&
+            iter != map_.chronological.end())
+        {
+            if (iter->second.unique())
+            {
+                auto const size = entryBytes(*iter->second);
+                bytes_ -= size;
+                freed += size;
+                trash.emplace_back(
+                    std::move(iter->second));
+                iter = map_.erase(iter);
+            }
+            else
+            {
+                ++iter;
+            }
+        }
+    }
+    return freed;
+}
+
+std::size_t
+CachedSLEs::entryBytes(SLE const& sle)
+{
+    return sizeof(digest_type) + sizeof(value_type) +
+        sizeof(SLE) + sle.getCount() * sizeof(detail::STVar);
+}
+
 double
 CachedSLEs::rate() const
 {
@@ -9,7 +9,12 @@
 #include <ripple/resource/Consumer.h>
 #include <ripple/protocol/Book.h>
 #include <ripple/core/Stoppable.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <string>
 
 namespace ripple {
 
@@ -17,6 +22,74 @@ namespace ripple {
 class PathRequest;
 
 
+class InfoSubMessage
+{
+public:
+    struct Stats
+    {
+        std::uint64_t rendered;
+        std::uint64_t renderedBytes;
+        std::uint64_t shared;
+        std::uint64_t bytesAvoided;
+    };
+
+    
+    static std::uint8_t constexpr binaryVersion = 1;
+
+    enum BinaryType : std::uint8_t
+    {
+        binaryTransaction = 1,
+        binaryLedger = 2
+    };
+
+    explicit
+    InfoSubMessage (Json::Value const& jvObj)
+        : jvObj_ (jvObj)
+    {
+    }
+
+    
+    InfoSubMessage (Json::Value const& jvObj,
+            std::function<std::string ()> makeBinary)
+        : jvObj_ (jvObj)
+        , makeBinary_ (std::move (makeBinary))
+    {
+    }
+
+    InfoSubMessage (InfoSubMessage const&) = delete;
+    InfoSubMessage& operator= (InfoSubMessage const&) = delete;
+
+    Json::Value const&
+    json () const
+    {
+        return jvObj_;
+    }
+
+    std::shared_ptr<std::string const> const&
+    serialized () const;
+
+    bool
+    hasBinary () const
+    {
+        return static_cast<bool> (makeBinary_);
+    }
+
+    
+    std::shared_ptr<std::string const> const&
+    binary () const;
+
+    static
+    Stats
+    getStats ();
+
+private:
+    Json::Value const& jvObj_;
+    mutable std::shared_ptr<std::string const> serialized_;
+    std::function<std::string ()> makeBinary_;
+    mutable std::shared_ptr<std::string const> binary_;
+};
+
+
 class InfoSub
     : public CountedObject <InfoSub>
 {
@@ -94,6 +167,8 @@ public:
 
     virtual void send (Json::Value const& jvObj, bool broadcast) = 0;
 
+    virtual void send (InfoSubMessage const& msg, bool broadcast);
+
     std::uint64_t getSeq ();
 
     void onSendEmpty ();
@@ -112,6 +187,17 @@ public:
 
     std::shared_ptr <PathRequest> const& getPathRequest ();
 
+    
+    void setBinary (bool binary)
+    {
+        binary_ = binary;
+    }
+
+    bool getBinary () const
+    {
+        return binary_;
+    }
+
 protected:
     using LockType = std::mutex;
     using ScopedLockType = std::lock_guard <LockType>;
@@ -124,6 +210,7 @@ private:
     hash_set <AccountID> normalSubscriptions_;
     std::shared_ptr <PathRequest> mPathRequest;
     std::uint64_t                 mSeq;
+    std::atomic<bool>             binary_ {false};
 
     static
     int
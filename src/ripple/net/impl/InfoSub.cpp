@@ -1,10 +1,59 @@
 
 
 #include <ripple/net/InfoSub.h>
+#include <ripple/json/json_writer.h>
 #include <atomic>
 
 namespace ripple {
 
+namespace {
+
+std::atomic<std::uint64_t> messagesRendered {0};
+std::atomic<std::uint64_t> messageBytesRendered {0};
+std::atomic<std::uint64_t> messagesShared {0};
+std::atomic<std::uint64_t> messageBytesAvoided {0};
+
+}
+
+std::shared_ptr<std::string const> const&
+InfoSubMessage::serialized () const
+{
+    if (serialized_)
+    {
+        ++messagesShared;
+        messageBytesAvoided += serialized_->size ();
+        return serialized_;
+    }
+
+    auto s = std::make_shared<std::string> ();
+    Json::stream (jvObj_,
+        [&s](void const* data, std::size_t n)
+        {
+            s->append (static_cast<char const*> (data), n);
+        });
+
+    ++messagesRendered;
+    messageBytesRendered += s->size ();
+    serialized_ = std::move (s);
+    return serialized_;
+}
+
+constexpr std::uint8_t InfoSubMessage::binaryVersion;
+
+std::shared_ptr<std::string const> const&
+InfoSubMessage::binary () const
+{
+    if (! binary_)
+        binary_ = std::make_shared<std::string const> (makeBinary_ ());
+    return binary_;
+}
+
+InfoSubMessage::Stats
+InfoSubMessage::getStats ()
+{
+    return {messagesRendered.load (), messageBytesRendered.load (),
+        messagesShared.load (), messageBytesAvoided.load ()};
+}
 
 
 
@@ -51,6 +100,11 @@ Resource::Consumer& InfoSub::getConsumer()
     return m_consumer;
 }
 
+void InfoSub::send (InfoSubMessage const& msg, bool broadcast)
+{
+    send (msg.json (), broadcast);
+}
+
 std::uint64_t InfoSub::getSeq ()
 {
     return mSeq;
@@ -52,6 +52,8 @@ public:
 
     ~RPCSubImp() = default;
 
+    using InfoSub::send;
+
     void send (Json::Value const& jvObj, bool broadcast) override
     {
         ScopedLockType sl (mLock);
@@ -3,7 +3,7 @@
 #ifndef RIPPLE_NODESTORE_DATABASE_H_INCLUDED
 #define RIPPLE_NODESTORE_DATABASE_H_INCLUDED
 
-#include <ripple/basics/TaggedCache.h>
+#include <ripple/basics/PartitionedTaggedCache.h>
 #include <ripple/basics/KeyCache.h>
 #include <ripple/core/Stoppable.h>
 #include <ripple/nodestore/Backend.h>
@@ -86,6 +86,21 @@ public:
     getCacheHitRate() = 0;
 
     
+    virtual
+    std::uint64_t
+    getCacheBytes() = 0;
+
+    
+    virtual
+    std::uint64_t
+    takeCacheMarginalHits() = 0;
+
+    
+    virtual
+    std::uint64_t
+    evictCache(std::uint64_t bytes) = 0;
+
+    
     virtual
     void
     tune(int size, std::chrono::seconds age) = 0;
@@ -142,23 +157,32 @@ protected:
 
     void
     asyncFetch(uint256 const& hash, std::uint32_t seq,
-        std::shared_ptr<TaggedCache<uint256, NodeObject>> const& pCache,
+        std::shared_ptr<PartitionedTaggedCache<uint256, NodeObject>> const& pCache,
             std::shared_ptr<KeyCache<uint256>> const& nCache);
 
     std::shared_ptr<NodeObject>
     fetchInternal(uint256 const& hash, Backend& srcBackend);
 
+    std::vector<std::shared_ptr<NodeObject>>
+    fetchBatchInternal(std::vector<uint256> const& hashes,
+        Backend& srcBackend);
+
     void
     importInternal(Backend& dstBackend, Database& srcDB);
 
     std::shared_ptr<NodeObject>
     doFetch(uint256 const& hash, std::uint32_t seq,
-        TaggedCache<uint256, NodeObject>& pCache,
+        PartitionedTaggedCache<uint256, NodeObject>& pCache,
             KeyCache<uint256>& nCache, bool isAsync);
 
+    void
+    doFetchBatch(std::vector<uint256> const& hashes, std::uint32_t seq,
+        PartitionedTaggedCache<uint256, NodeObject>& pCache,
+            KeyCache<uint256>& nCache);
+
     bool
     copyLedger(Backend& dstBackend, Ledger const& srcLedger,
-        std::shared_ptr<TaggedCache<uint256, NodeObject>> const& pCache,
+        std::shared_ptr<PartitionedTaggedCache<uint256, NodeObject>> const& pCache,
             std::shared_ptr<KeyCache<uint256>> const& nCache,
                 std::shared_ptr<Ledger const> const& srcNext);
 
@@ -174,7 +198,7 @@ private:
     std::condition_variable readGenCondVar_;
 
     std::map<uint256, std::tuple<std::uint32_t,
-        std::weak_ptr<TaggedCache<uint256, NodeObject>>,
+        std::weak_ptr<PartitionedTaggedCache<uint256, NodeObject>>,
             std::weak_ptr<KeyCache<uint256>>>> read_;
 
     uint256 readLastHash_;
@@ -190,6 +214,10 @@ private:
     std::shared_ptr<NodeObject>
     fetchFrom(uint256 const& hash, std::uint32_t seq) = 0;
 
+    virtual
+    std::vector<std::shared_ptr<NodeObject>>
+    fetchBatchFrom(std::vector<uint256> const& hashes, std::uint32_t seq);
+
     
     virtual
     void
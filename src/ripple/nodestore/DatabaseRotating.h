@@ -24,7 +24,7 @@ public:
     {}
 
     virtual
-    TaggedCache<uint256, NodeObject> const&
+    PartitionedTaggedCache<uint256, NodeObject> const&
     getPositiveCache() = 0;
 
     virtual std::mutex& peekMutex() const = 0;
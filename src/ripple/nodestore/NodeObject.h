@@ -64,6 +64,9 @@ private:
     Blob mData;
 };
 
+std::size_t
+cacheBytes (NodeObject const& object);
+
 }
 
 #endif
@@ -10,11 +10,14 @@
 #include <nudb/nudb.hpp>
 #include <boost/filesystem.hpp>
 #include <cassert>
+#include <algorithm>
 #include <chrono>
 #include <cstdio>
 #include <cstdint>
+#include <cstring>
 #include <exception>
 #include <memory>
+#include <numeric>
 
 namespace ripple {
 namespace NodeStore {
@@ -159,14 +162,46 @@ public:
     bool
     canFetchBatch() override
     {
-        return false;
+        return true;
     }
 
     std::vector<std::shared_ptr<NodeObject>>
     fetchBatch (std::size_t n, void const* const* keys) override
     {
-        Throw<std::runtime_error> ("pure virtual called");
-        return {};
+        std::vector<std::size_t> order (n);
+        std::iota (order.begin(), order.end(), 0);
+        std::sort (order.begin(), order.end(),
+            [this, keys](std::size_t lhs, std::size_t rhs)
+            {
+                return std::memcmp (keys[lhs], keys[rhs], keyBytes_) < 0;
+            });
+
+        std::vector<std::shared_ptr<NodeObject>> results (n);
+        nudb::detail::buffer bf;
+        for (auto const i : order)
+        {
+            void const* const key = keys[i];
+            nudb::error_code ec;
+            db_.fetch (key,
+                [this, key, &bf, &result = results[i]](
+                    void const* data, std::size_t size)
+                {
+                    auto const decompressed =
+                        nodeobject_decompress(data, size, bf);
+                    DecodedBlob decoded (key,
+                        decompressed.first, decompressed.second);
+                    if (! decoded.wasOk ())
+                    {
+                        JLOG(j_.fatal()) <<
+                            "Corrupt NodeObject #" << uint256::fromVoid (key);
+                        return;
+                    }
+                    result = decoded.createObject();
+                }, ec);
+            if(ec && ec != nudb::error::key_not_found)
+                Throw<nudb::system_error>(ec);
+        }
+        return results;
     }
 
     void
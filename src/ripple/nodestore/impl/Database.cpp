@@ -72,7 +72,7 @@ Database::stopThreads()
 
 void
 Database::asyncFetch(uint256 const& hash, std::uint32_t seq,
-    std::shared_ptr<TaggedCache<uint256, NodeObject>> const& pCache,
+    std::shared_ptr<PartitionedTaggedCache<uint256, NodeObject>> const& pCache,
         std::shared_ptr<KeyCache<uint256>> const& nCache)
 {
     std::lock_guard <std::mutex> lock(readLock_);
@@ -117,6 +117,59 @@ Database::fetchInternal(uint256 const& hash, Backend& srcBackend)
     return nObj;
 }
 
+std::vector<std::shared_ptr<NodeObject>>
+Database::fetchBatchInternal(std::vector<uint256> const& hashes,
+    Backend& srcBackend)
+{
+    std::vector<std::shared_ptr<NodeObject>> nObjs;
+    if (! srcBackend.canFetchBatch())
+    {
+        nObjs.reserve(hashes.size());
+        for (auto const& hash : hashes)
+            nObjs.emplace_back(fetchInternal(hash, srcBackend));
+        return nObjs;
+    }
+
+    std::vector<void const*> keys;
+    keys.reserve(hashes.size());
+    for (auto const& hash : hashes)
+        keys.push_back(hash.begin());
+
+    try
+    {
+        nObjs = srcBackend.fetchBatch(keys.size(), keys.data());
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(j_.fatal()) <<
+            "Exception, " << e.what();
+        Rethrow();
+    }
+    assert(nObjs.size() == hashes.size());
+    nObjs.resize(hashes.size());
+
+    for (auto const& nObj : nObjs)
+    {
+        if (nObj)
+        {
+            ++fetchHitCount_;
+            fetchSz_ += nObj->getData().size();
+        }
+    }
+    return nObjs;
+}
+
+std::vector<std::shared_ptr<NodeObject>>
+Database::fetchBatchFrom(std::vector<uint256> const& hashes,
+    std::uint32_t seq)
+{
+    std::vector<std::shared_ptr<NodeObject>> nObjs;
+    nObjs.reserve(hashes.size());
+    for (auto const& hash : hashes)
+        nObjs.emplace_back(fetchFrom(hash, seq));
+    return nObjs;
+}
+
 void
 Database::importInternal(Backend& dstBackend, Database& srcDB)
 {
@@ -146,7 +199,7 @@ Database::importInternal(Backend& dstBackend, Database& srcDB)
 
 std::shared_ptr<NodeObject>
 Database::doFetch(uint256 const& hash, std::uint32_t seq,
-    TaggedCache<uint256, NodeObject>& pCache,
+    PartitionedTaggedCache<uint256, NodeObject>& pCache,
         KeyCache<uint256>& nCache, bool isAsync)
 {
     FetchReport report;
@@ -183,9 +236,73 @@ Database::doFetch(uint256 const& hash, std::uint32_t seq,
     return nObj;
 }
 
+void
+Database::doFetchBatch(std::vector<uint256> const& hashes, std::uint32_t seq,
+    PartitionedTaggedCache<uint256, NodeObject>& pCache,
+        KeyCache<uint256>& nCache)
+{
+    FetchReport report;
+    report.isAsync = true;
+
+    using namespace std::chrono;
+    auto const before = steady_clock::now();
+
+    std::vector<uint256> missing;
+    missing.reserve(hashes.size());
+    for (auto const& hash : hashes)
+    {
+        if (pCache.fetch(hash))
+        {
+            report.wentToDisk = false;
+            report.wasFound = true;
+            report.elapsed = milliseconds{0};
+            scheduler_.onFetch(report);
+        }
+        else if (nCache.touch_if_exists(hash))
+        {
+            report.wentToDisk = false;
+            report.wasFound = false;
+            report.elapsed = milliseconds{0};
+            scheduler_.onFetch(report);
+        }
+        else
+        {
+            missing.push_back(hash);
+        }
+    }
+    if (missing.empty())
+        return;
+
+    auto nObjs = fetchBatchFrom(missing, seq);
+    fetchTotalCount_ += missing.size();
+
+    report.wentToDisk = true;
+    report.elapsed = duration_cast<milliseconds>(
+        steady_clock::now() - before) / missing.size();
+    for (std::size_t i = 0; i < missing.size(); ++i)
+    {
+        auto& nObj = nObjs[i];
+        if (! nObj)
+        {
+            nObj = pCache.fetch(missing[i]);
+            if (! nObj)
+                nCache.insert(missing[i]);
+        }
+        else
+        {
+            pCache.canonicalize(missing[i], nObj);
+
+            JLOG(j_.trace()) <<
+                "HOS: " << missing[i] << " fetch: in db";
+        }
+        report.wasFound = static_cast<bool>(nObj);
+        scheduler_.onFetch(report);
+    }
+}
+
 bool
 Database::copyLedger(Backend& dstBackend, Ledger const& srcLedger,
-    std::shared_ptr<TaggedCache<uint256, NodeObject>> const& pCache,
+    std::shared_ptr<PartitionedTaggedCache<uint256, NodeObject>> const& pCache,
         std::shared_ptr<KeyCache<uint256>> const& nCache,
             std::shared_ptr<Ledger const> const& srcNext)
 {
@@ -306,10 +423,10 @@ Database::threadEntry()
     beast::setCurrentThreadName("prefetch");
     while (true)
     {
-        uint256 lastHash;
-        std::uint32_t lastSeq;
-        std::shared_ptr<TaggedCache<uint256, NodeObject>> lastPcache;
-        std::shared_ptr<KeyCache<uint256>> lastNcache;
+        std::vector<uint256> hashes;
+        std::uint32_t seq;
+        std::shared_ptr<PartitionedTaggedCache<uint256, NodeObject>> pCache;
+        std::shared_ptr<KeyCache<uint256>> nCache;
         {
             std::unique_lock<std::mutex> lock(readLock_);
             while (! readShut_ && read_.empty())
@@ -327,16 +444,22 @@ Database::threadEntry()
                 ++readGen_;
                 readGenCondVar_.notify_all();
             }
-            lastHash = it->first;
-            lastSeq = std::get<0>(it->second);
-            lastPcache = std::get<1>(it->second).lock();
-            lastNcache = std::get<2>(it->second).lock();
-            read_.erase(it);
-            readLastHash_ = lastHash;
+            seq = std::get<0>(it->second);
+            pCache = std::get<1>(it->second).lock();
+            nCache = std::get<2>(it->second).lock();
+
+            hashes.reserve(readBatchSize);
+            while (it != read_.end() && hashes.size() < readBatchSize &&
+                std::get<1>(it->second).lock() == pCache)
+            {
+                hashes.push_back(it->first);
+                it = read_.erase(it);
+            }
+            readLastHash_ = hashes.back();
         }
 
-        if (lastPcache && lastPcache)
-            doFetch(lastHash, lastSeq, *lastPcache, *lastNcache, true);
+        if (pCache && nCache)
+            doFetchBatch(hashes, seq, *pCache, *nCache);
     }
 }
 
@@ -25,7 +25,7 @@ public:
         Section const& config,
         beast::Journal j)
         : Database(name, parent, scheduler, readThreads, config, j)
-        , pCache_(std::make_shared<TaggedCache<uint256, NodeObject>>(
+        , pCache_(std::make_shared<PartitionedTaggedCache<uint256, NodeObject>>(
             name, cacheTargetSize, cacheTargetAge, stopwatch(), j))
         , nCache_(std::make_shared<KeyCache<uint256>>(
             name, stopwatch(), cacheTargetSize, cacheTargetAge))
@@ -87,6 +87,18 @@ public:
     float
     getCacheHitRate() override {return pCache_->getHitRate();}
 
+    std::uint64_t
+    getCacheBytes() override {return pCache_->getBytes();}
+
+    std::uint64_t
+    takeCacheMarginalHits() override {return pCache_->takeMarginalHits();}
+
+    std::uint64_t
+    evictCache(std::uint64_t bytes) override
+    {
+        return pCache_->evictBytes(bytes);
+    }
+
     void
     tune(int size, std::chrono::seconds age) override;
 
@@ -94,7 +106,7 @@ public:
     sweep() override;
 
 private:
-    std::shared_ptr<TaggedCache<uint256, NodeObject>> pCache_;
+    std::shared_ptr<PartitionedTaggedCache<uint256, NodeObject>> pCache_;
 
     std::shared_ptr<KeyCache<uint256>> nCache_;
 
@@ -106,6 +118,13 @@ private:
         return fetchInternal(hash, *backend_);
     }
 
+    std::vector<std::shared_ptr<NodeObject>>
+    fetchBatchFrom(std::vector<uint256> const& hashes,
+        std::uint32_t seq) override
+    {
+        return fetchBatchInternal(hashes, *backend_);
+    }
+
     void
     for_each(std::function<void(std::shared_ptr<NodeObject>)> f) override
     {
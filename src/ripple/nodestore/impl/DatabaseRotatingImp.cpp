@@ -17,7 +17,7 @@ DatabaseRotatingImp::DatabaseRotatingImp(
     Section const& config,
     beast::Journal j)
     : DatabaseRotating(name, parent, scheduler, readThreads, config, j)
-    , pCache_(std::make_shared<TaggedCache<uint256, NodeObject>>(
+    , pCache_(std::make_shared<PartitionedTaggedCache<uint256, NodeObject>>(
         name, cacheTargetSize, cacheTargetAge, stopwatch(), j))
     , nCache_(std::make_shared<KeyCache<uint256>>(
         name, stopwatch(), cacheTargetSize, cacheTargetAge))
@@ -98,6 +98,39 @@ DatabaseRotatingImp::fetchFrom(uint256 const& hash, std::uint32_t seq)
     return nObj;
 }
 
+std::vector<std::shared_ptr<NodeObject>>
+DatabaseRotatingImp::fetchBatchFrom(
+    std::vector<uint256> const& hashes, std::uint32_t seq)
+{
+    Backends b = getBackends();
+    auto nObjs = fetchBatchInternal(hashes, *b.writableBackend);
+
+    std::vector<uint256> missing;
+    std::vector<std::size_t> index;
+    for (std::size_t i = 0; i < nObjs.size(); ++i)
+    {
+        if (! nObjs[i])
+        {
+            missing.push_back(hashes[i]);
+            index.push_back(i);
+        }
+    }
+    if (missing.empty())
+        return nObjs;
+
+    auto archived = fetchBatchInternal(missing, *b.archiveBackend);
+    for (std::size_t i = 0; i < archived.size(); ++i)
+    {
+        if (archived[i])
+        {
+            getWritableBackend()->store(archived[i]);
+            nCache_->erase(missing[i]);
+            nObjs[index[i]] = std::move(archived[i]);
+        }
+    }
+    return nObjs;
+}
+
 } 
 } 
 
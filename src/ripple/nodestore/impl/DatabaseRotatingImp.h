@@ -89,17 +89,29 @@ public:
     float
     getCacheHitRate() override {return pCache_->getHitRate();}
 
+    std::uint64_t
+    getCacheBytes() override {return pCache_->getBytes();}
+
+    std::uint64_t
+    takeCacheMarginalHits() override {return pCache_->takeMarginalHits();}
+
+    std::uint64_t
+    evictCache(std::uint64_t bytes) override
+    {
+        return pCache_->evictBytes(bytes);
+    }
+
     void
     tune(int size, std::chrono::seconds age) override;
 
     void
     sweep() override;
 
-    TaggedCache<uint256, NodeObject> const&
+    PartitionedTaggedCache<uint256, NodeObject> const&
     getPositiveCache() override {return *pCache_;}
 
 private:
-    std::shared_ptr<TaggedCache<uint256, NodeObject>> pCache_;
+    std::shared_ptr<PartitionedTaggedCache<uint256, NodeObject>> pCache_;
 
     std::shared_ptr<KeyCache<uint256>> nCache_;
 
@@ -121,6 +133,9 @@ private:
     std::shared_ptr<NodeObject> fetchFrom(
         uint256 const& hash, std::uint32_t seq) override;
 
+    std::vector<std::shared_ptr<NodeObject>> fetchBatchFrom(
+        std::vector<uint256> const& hashes, std::uint32_t seq) override;
+
     void
     for_each(std::function <void(std::shared_ptr<NodeObject>)> f) override
     {
@@ -6,11 +6,13 @@
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/basics/chrono.h>
 #include <ripple/basics/random.h>
+#include <ripple/core/JobQueue.h>
 #include <ripple/nodestore/DummyScheduler.h>
 #include <ripple/nodestore/Manager.h>
 #include <ripple/overlay/Overlay.h>
 #include <ripple/overlay/predicates.h>
 #include <ripple/protocol/HashPrefix.h>
+#include <cmath>
 
 namespace ripple {
 namespace NodeStore {
@@ -37,6 +39,7 @@ DatabaseShardImp::DatabaseShardImp(
         config, "ledgers_per_shard", ledgersPerShardDefault))
     , earliestShardIndex_(seqToShardIndex(earliestSeq()))
     , avgShardSz_(ledgersPerShard_ * (192 * 1024))
+    , map_(get<bool>(config, "mapped", true))
 {
     ctx_->start();
 }
@@ -139,7 +142,7 @@ DatabaseShardImp::init()
                 continue;
             }
 
-            auto shard {std::make_unique<Shard>(
+            auto shard {std::make_shared<Shard>(
                 *this, shardIndex, cacheSz_, cacheAge_, j_)};
             if (!shard->open(config_, scheduler_, *ctx_))
                 return false;
@@ -179,6 +182,7 @@ DatabaseShardImp::init()
     else
         updateStats(lock);
     init_ = true;
+    scheduleMapping(lock);
     return true;
 }
 
@@ -220,7 +224,7 @@ DatabaseShardImp::prepareLedger(std::uint32_t validLedgerSeq)
     app_.shardFamily()->reset();
     int const sz {std::max(shardCacheSz, cacheSz_ / std::max(
         1, static_cast<int>(complete_.size() + 1)))};
-    incomplete_ = std::make_unique<Shard>(
+    incomplete_ = std::make_shared<Shard>(
         *this, *shardIndex, sz, cacheAge_, j_);
     if (!incomplete_->open(config_, scheduler_, *ctx_))
     {
@@ -384,7 +388,7 @@ DatabaseShardImp::importShard(std::uint32_t shardIndex,
     if (!move(srcDir, dstDir))
         return false;
 
-    auto shard {std::make_unique<Shard>(
+    auto shard {std::make_shared<Shard>(
         *this, shardIndex, cacheSz_, cacheAge_, j_)};
     auto fail = [&](std::string msg)
     {
@@ -412,6 +416,9 @@ DatabaseShardImp::importShard(std::uint32_t shardIndex,
         return fail(e.what());
     }
 
+    // Never resume validation from state that predates the import
+    shard->removeCheckpoint();
+
     if (validate)
     {
         it->second = shard.get();
@@ -550,7 +557,7 @@ void
 DatabaseShardImp::validate()
 {
     {
-        std::lock_guard<std::mutex> lock(m_);
+        std::unique_lock<std::mutex> lock(m_);
         assert(init_);
         if (complete_.empty() && !incomplete_)
         {
@@ -558,6 +565,8 @@ DatabaseShardImp::validate()
                 "No shards to validate";
             return;
         }
+        validating_ = true;
+        mapCond_.wait(lock, [this] { return !mapping_; });
 
         std::string s {"Found shards "};
         for (auto& e : complete_)
@@ -569,17 +578,73 @@ DatabaseShardImp::validate()
         JLOG(j_.debug()) << s;
     }
 
+    std::vector<std::shared_ptr<Shard>> shards;
+    std::uint64_t total {0};
     for (auto& e : complete_)
+        shards.push_back(e.second);
+    if (incomplete_)
+        shards.push_back(incomplete_);
+    for (auto const& shard : shards)
     {
-        app_.shardFamily()->reset();
-        e.second->validate(app_);
+        total += lastLedgerSeq(shard->index()) -
+            firstLedgerSeq(shard->index()) + 1;
     }
-    if (incomplete_)
+
+    using namespace std::chrono;
+    auto const parallel {std::max(1u, std::thread::hardware_concurrency())};
+    auto const start {steady_clock::now()};
+    std::mutex reportMutex;
+    auto reported {start};
+    std::uint64_t validated {0};
+    std::size_t valid {0};
+    std::size_t invalid {0};
+    auto progress = [&](std::uint32_t count)
+    {
+        std::lock_guard<std::mutex> lock(reportMutex);
+        validated += count;
+        auto const now {steady_clock::now()};
+        if (now - reported < 10s)
+            return !isStopping();
+        reported = now;
+        auto const elapsed {std::max<std::int64_t>(1,
+            duration_cast<seconds>(now - start).count())};
+        JLOG(j_.info()) <<
+            "Validated " << validated << " of " << total << " ledgers, " <<
+            (valid + invalid) << " of " << shards.size() << " shards done (" <<
+            valid << " valid, " << invalid << " invalid), " <<
+            (validated / elapsed) << " ledgers/s";
+        return !isStopping();
+    };
+
+    for (auto const& shard : shards)
     {
+        if (isStopping())
+            break;
         app_.shardFamily()->reset();
-        incomplete_->validate(app_);
+        auto const ok {shard->validate(app_, parallel, progress)};
+        std::lock_guard<std::mutex> lock(reportMutex);
+        ++(ok ? valid : invalid);
     }
     app_.shardFamily()->reset();
+
+    JLOG(j_.info()) <<
+        "Validated " << shards.size() << " shards (" <<
+        valid << " valid, " << invalid << " invalid) in " <<
+        duration_cast<seconds>(steady_clock::now() - start).count() << "s";
+
+    std::lock_guard<std::mutex> lock(m_);
+    validating_ = false;
+    scheduleMapping(lock);
+}
+
+void
+DatabaseShardImp::onStop()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_);
+        mapCond_.wait(lock, [this] { return !mapping_; });
+    }
+    Database::onStop();
 }
 
 void
@@ -697,7 +762,7 @@ DatabaseShardImp::import(Database& source)
 
         app_.shardFamily()->reset();
         auto const shardDir {dir_ / std::to_string(shardIndex)};
-        auto shard = std::make_unique<Shard>(
+        auto shard = std::make_shared<Shard>(
             *this, shardIndex, shardCacheSz, cacheAge_, j_);
         if (!shard->open(config_, scheduler_, *ctx_))
         {
@@ -814,7 +879,7 @@ DatabaseShardImp::fetch(uint256 const& hash, std::uint32_t seq)
     auto cache {selectCache(seq)};
     if (cache.first)
         return doFetch(hash, seq, *cache.first, *cache.second, false);
-    return {};
+    return fetchFrom(hash, seq);
 }
 
 bool
@@ -828,8 +893,10 @@ DatabaseShardImp::asyncFetch(uint256 const& hash,
         if (object || cache.second->touch_if_exists(hash))
             return true;
         Database::asyncFetch(hash, seq, cache.first, cache.second);
+        return false;
     }
-    return false;
+    object = fetchFrom(hash, seq);
+    return true;
 }
 
 bool
@@ -879,7 +946,7 @@ DatabaseShardImp::getDesiredAsyncReadCount(std::uint32_t seq)
         std::lock_guard<std::mutex> lock(m_);
         assert(init_);
         auto it = complete_.find(shardIndex);
-        if (it != complete_.end())
+        if (it != complete_.end() && !it->second->mapped())
             return it->second->pCache()->getTargetSize() / asyncDivider;
         if (incomplete_ && incomplete_->index() == shardIndex)
             return incomplete_->pCache()->getTargetSize() / asyncDivider;
@@ -894,9 +961,14 @@ DatabaseShardImp::getCacheHitRate()
     {
         std::lock_guard<std::mutex> lock(m_);
         assert(init_);
-        sz = complete_.size();
+        sz = 0;
         for (auto const& c : complete_)
+        {
+            if (c.second->mapped())
+                continue;
             f += c.second->pCache()->getHitRate();
+            ++sz;
+        }
         if (incomplete_)
         {
             f += incomplete_->pCache()->getHitRate();
@@ -906,6 +978,66 @@ DatabaseShardImp::getCacheHitRate()
     return f / std::max(1.0f, sz);
 }
 
+std::vector<std::shared_ptr<PCache>>
+DatabaseShardImp::getCaches()
+{
+    std::vector<std::shared_ptr<PCache>> caches;
+    std::lock_guard<std::mutex> lock(m_);
+    assert(init_);
+    for (auto const& c : complete_)
+    {
+        if (!c.second->mapped())
+            caches.push_back(c.second->pCache());
+    }
+    if (incomplete_)
+        caches.push_back(incomplete_->pCache());
+    return caches;
+}
+
+std::uint64_t
+DatabaseShardImp::getCacheBytes()
+{
+    std::uint64_t bytes {0};
+    for (auto const& cache : getCaches())
+        bytes += cache->getBytes();
+    return bytes;
+}
+
+std::uint64_t
+DatabaseShardImp::takeCacheMarginalHits()
+{
+    std::uint64_t hits {0};
+    for (auto const& cache : getCaches())
+        hits += cache->takeMarginalHits();
+    return hits;
+}
+
+std::uint64_t
+DatabaseShardImp::evictCache(std::uint64_t bytes)
+{
+    auto const caches {getCaches()};
+    std::vector<std::uint64_t> sizes;
+    sizes.reserve(caches.size());
+    std::uint64_t total {0};
+    for (auto const& cache : caches)
+    {
+        sizes.push_back(cache->getBytes());
+        total += sizes.back();
+    }
+    if (bytes == 0 || total == 0)
+        return 0;
+
+    std::uint64_t freed {0};
+    for (std::size_t i = 0; i < caches.size(); ++i)
+    {
+        auto const share {bytes >= total ? sizes[i] :
+            static_cast<std::uint64_t>(std::ceil(
+                static_cast<double>(sizes[i]) * bytes / total))};
+        freed += caches[i]->evictBytes(share);
+    }
+    return freed;
+}
+
 void
 DatabaseShardImp::tune(int size, std::chrono::seconds age)
 {
@@ -916,6 +1048,8 @@ DatabaseShardImp::tune(int size, std::chrono::seconds age)
     int const sz {calcTargetCacheSz(lock)};
     for (auto const& c : complete_)
     {
+        if (c.second->mapped())
+            continue;
         c.second->pCache()->setTargetSize(sz);
         c.second->pCache()->setTargetAge(cacheAge_);
         c.second->nCache()->setTargetSize(sz);
@@ -938,6 +1072,8 @@ DatabaseShardImp::sweep()
     int const sz {calcTargetCacheSz(lock)};
     for (auto const& c : complete_)
     {
+        if (c.second->mapped())
+            continue;
         c.second->pCache()->sweep();
         c.second->nCache()->sweep();
         if (c.second->pCache()->getTargetSize() > sz)
@@ -950,6 +1086,7 @@ DatabaseShardImp::sweep()
         if (incomplete_->pCache()->getTargetSize() > sz)
             incomplete_->pCache()->setTargetSize(sz);
     }
+    scheduleMapping(lock);
 }
 
 std::shared_ptr<NodeObject>
@@ -962,8 +1099,9 @@ DatabaseShardImp::fetchFrom(uint256 const& hash, std::uint32_t seq)
         auto it = complete_.find(shardIndex);
         if (it != complete_.end())
         {
+            auto const backend {it->second->getBackend()};
             lock.unlock();
-            return fetchInternal(hash, *it->second->getBackend());
+            return fetchInternal(hash, *backend);
         }
     }
     if (incomplete_ && incomplete_->index() == shardIndex)
@@ -981,6 +1119,37 @@ DatabaseShardImp::fetchFrom(uint256 const& hash, std::uint32_t seq)
     return {};
 }
 
+std::vector<std::shared_ptr<NodeObject>>
+DatabaseShardImp::fetchBatchFrom(std::vector<uint256> const& hashes,
+    std::uint32_t seq)
+{
+    auto const shardIndex {seqToShardIndex(seq)};
+    std::unique_lock<std::mutex> lock(m_);
+    assert(init_);
+    {
+        auto it = complete_.find(shardIndex);
+        if (it != complete_.end())
+        {
+            auto const backend {it->second->getBackend()};
+            lock.unlock();
+            return fetchBatchInternal(hashes, *backend);
+        }
+    }
+    if (incomplete_ && incomplete_->index() == shardIndex)
+    {
+        lock.unlock();
+        return fetchBatchInternal(hashes, *incomplete_->getBackend());
+    }
+
+    auto it = preShards_.find(shardIndex);
+    if (it != preShards_.end() && it->second)
+    {
+        lock.unlock();
+        return fetchBatchInternal(hashes, *it->second->getBackend());
+    }
+    return std::vector<std::shared_ptr<NodeObject>>(hashes.size());
+}
+
 boost::optional<std::uint32_t>
 DatabaseShardImp::findShardIndexToAdd(
     std::uint32_t validLedgerSeq, std::lock_guard<std::mutex>&)
@@ -1083,6 +1252,83 @@ DatabaseShardImp::updateStats(std::lock_guard<std::mutex>&)
     }
 }
 
+void
+DatabaseShardImp::scheduleMapping(std::lock_guard<std::mutex>&)
+{
+    if (!map_ || !backed_ || mapping_ || validating_ || isStopping())
+        return;
+
+    auto const cutoff {std::chrono::steady_clock::now() - shardMapDelay};
+    if (std::none_of(complete_.begin(), complete_.end(),
+        [&](auto const& c) { return c.second->mappable(cutoff); }))
+    {
+        return;
+    }
+
+    mapping_ = app_.getJobQueue().addJob(
+        jtWRITE, "DatabaseShard::map", [this](Job&) { mapShards(); });
+}
+
+void
+DatabaseShardImp::mapShards()
+{
+    auto const stopping = [this] { return isStopping(); };
+    while (true)
+    {
+        std::shared_ptr<Shard> shard;
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            auto const cutoff {
+                std::chrono::steady_clock::now() - shardMapDelay};
+            if (!isStopping() && !validating_)
+            {
+                for (auto const& c : complete_)
+                {
+                    if (c.second->mappable(cutoff))
+                    {
+                        shard = c.second;
+                        break;
+                    }
+                }
+            }
+            if (!shard)
+            {
+                mapping_ = false;
+                mapCond_.notify_all();
+                return;
+            }
+        }
+
+        auto map {shard->makeMap(stopping)};
+        std::shared_ptr<Backend> old;
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            old = shard->setMap(std::move(map));
+        }
+        if (!old)
+        {
+            JLOG(j_.warn()) <<
+                "shard " << shard->index() << " not mapped";
+            continue;
+        }
+
+        shard->retireBackend(std::move(old));
+
+        std::lock_guard<std::mutex> lock(m_);
+        auto const before {shard->fileSize()};
+        shard->updateFileSize();
+        auto const after {shard->fileSize()};
+        if (after > before)
+            usedDiskSpace_ += (after - before);
+        else if (after < before)
+            usedDiskSpace_ -= std::min(before - after, usedDiskSpace_);
+        updateStats(lock);
+
+        JLOG(j_.info()) <<
+            "shard " << shard->index() << " mapped";
+    }
+}
+
 std::pair<std::shared_ptr<PCache>, std::shared_ptr<NCache>>
 DatabaseShardImp::selectCache(std::uint32_t seq)
 {
@@ -5,6 +5,8 @@
 
 #include <ripple/nodestore/DatabaseShard.h>
 #include <ripple/nodestore/impl/Shard.h>
+#include <algorithm>
+#include <condition_variable>
 
 namespace ripple {
 namespace NodeStore {
@@ -63,6 +65,9 @@ public:
     void
     validate() override;
 
+    void
+    onStop() override;
+
     std::uint32_t
     ledgersPerShard() const override
     {
@@ -137,6 +142,15 @@ public:
     float
     getCacheHitRate() override;
 
+    std::uint64_t
+    getCacheBytes() override;
+
+    std::uint64_t
+    takeCacheMarginalHits() override;
+
+    std::uint64_t
+    evictCache(std::uint64_t bytes) override;
+
     void
     tune(int size, std::chrono::seconds age) override;
 
@@ -150,9 +164,9 @@ private:
 
     std::unique_ptr<nudb::context> ctx_;
 
-    std::map<std::uint32_t, std::unique_ptr<Shard>> complete_;
+    std::map<std::uint32_t, std::shared_ptr<Shard>> complete_;
 
-    std::unique_ptr<Shard> incomplete_;
+    std::shared_ptr<Shard> incomplete_;
 
     std::map<std::uint32_t, Shard*> preShards_;
 
@@ -180,11 +194,23 @@ private:
     int cacheSz_ {shardCacheSz};
     std::chrono::seconds cacheAge_ {shardCacheAge};
 
+    bool const map_;
+
+    bool mapping_ {false};
+
+    bool validating_ {false};
+
+    std::condition_variable mapCond_;
+
     static constexpr auto importMarker_ = "import";
 
     std::shared_ptr<NodeObject>
     fetchFrom(uint256 const& hash, std::uint32_t seq) override;
 
+    std::vector<std::shared_ptr<NodeObject>>
+    fetchBatchFrom(std::vector<uint256> const& hashes,
+        std::uint32_t seq) override;
+
     void
     for_each(std::function <void(std::shared_ptr<NodeObject>)> f) override
     {
@@ -201,13 +227,24 @@ private:
     std::pair<std::shared_ptr<PCache>, std::shared_ptr<NCache>>
     selectCache(std::uint32_t seq);
 
+    std::vector<std::shared_ptr<PCache>>
+    getCaches();
+
     int
     calcTargetCacheSz(std::lock_guard<std::mutex>&) const
     {
+        auto const cached {std::count_if(complete_.begin(), complete_.end(),
+            [](auto const& c) { return !c.second->mapped(); })};
         return std::max(shardCacheSz, cacheSz_ / std::max(
-            1, static_cast<int>(complete_.size() + (incomplete_ ? 1 : 0))));
+            1, static_cast<int>(cached + (incomplete_ ? 1 : 0))));
     }
 
+    void
+    scheduleMapping(std::lock_guard<std::mutex>&);
+
+    void
+    mapShards();
+
     std::uint64_t
     available() const;
 };
@@ -45,6 +45,12 @@ NodeObject::getData () const
     return mData;
 }
 
+std::size_t
+cacheBytes (NodeObject const& object)
+{
+    return sizeof (NodeObject) + object.getData ().capacity ();
+}
+
 }
 
 
@@ -2,8 +2,12 @@
 
 #include <ripple/nodestore/impl/Shard.h>
 #include <ripple/app/ledger/InboundLedger.h>
+#include <ripple/basics/FileUtilities.h>
+#include <ripple/core/JobQueue.h>
 #include <ripple/nodestore/impl/DatabaseShardImp.h>
+#include <ripple/nodestore/impl/ShardMap.h>
 #include <ripple/nodestore/Manager.h>
+#include <boost/serialization/string.hpp>
 
 #include <fstream>
 
@@ -25,6 +29,8 @@ Shard::Shard(DatabaseShard const& db, std::uint32_t index,
         stopwatch(), cacheSz, cacheAge))
     , dir_(db.getRootDir() / std::to_string(index_))
     , control_(dir_ / controlFileName)
+    , checkpoint_(db.getRootDir() / checkpointDirName /
+        std::to_string(index_))
     , j_(j)
 {
     if (index_ < db.earliestShardIndex())
@@ -57,9 +63,57 @@ Shard::open(Section config, Scheduler& scheduler, nudb::context& ctx)
         return false;
     }
 
+    if (preexist && is_regular_file(dir_ / ShardMap::fileName))
+    {
+        try
+        {
+            auto map {std::make_shared<ShardMap>(dir_, j_)};
+            map->open(false);
+            complete_ = true;
+            setMap(std::move(map));
+            removeBackendFiles();
+            updateFileSize();
+            return true;
+        }
+        catch (std::exception const& e)
+        {
+            JLOG(j_.error()) <<
+                "shard " << index_ <<
+                ": unable to open map, " << e.what();
+            complete_ = false;
+            backend_.reset();
+            mapped_ = false;
+            if (!is_regular_file(dir_ / "nudb.dat"))
+                return false;
+            removeAll(dir_ / ShardMap::fileName, j_);
+        }
+    }
+
     config.set("path", dir_.string());
-    backend_ = factory->createInstance(
-        NodeObject::keyBytes, config, scheduler, ctx, j_);
+    {
+        auto backend {factory->createInstance(
+            NodeObject::keyBytes, config, scheduler, ctx, j_)};
+        auto const released {std::make_shared<Released>()};
+        backend_.reset(backend.release(),
+            [released, j = j_](Backend* b)
+            {
+                try
+                {
+                    b->close();
+                }
+                catch (std::exception const& e)
+                {
+                    JLOG(j.warn()) <<
+                        "exception: " << e.what();
+                }
+                delete b;
+
+                std::lock_guard<std::mutex> lock(released->mutex);
+                released->done = true;
+                released->cond.notify_all();
+            });
+        released_ = released;
+    }
 
     auto fail = [&](std::string msg)
     {
@@ -164,6 +218,7 @@ Shard::setStored(std::shared_ptr<Ledger const> const& l)
             fileSize_ = sz;
         }
         complete_ = true;
+        completed_ = std::chrono::steady_clock::now();
         storedSeqs_.clear();
 
         JLOG(j_.debug()) <<
@@ -206,7 +261,117 @@ Shard::contains(std::uint32_t seq) const
 }
 
 bool
-Shard::validate(Application& app)
+Shard::mappable(std::chrono::steady_clock::time_point cutoff) const
+{
+    return complete_ && !mapped_ && !mapFailed_ &&
+        backend_ && backend_->backed() && completed_ <= cutoff;
+}
+
+std::shared_ptr<Backend>
+Shard::makeMap(std::function<bool()> const& stopping)
+{
+    if (!ShardMap::create(dir_, stopping, j_))
+        return {};
+
+    try
+    {
+        auto map {std::make_shared<ShardMap>(dir_, j_)};
+        map->open(false);
+        map->verify();
+        return map;
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(j_.error()) <<
+            "shard " << index_ <<
+            ": invalid map, " << e.what();
+    }
+    removeAll(dir_ / ShardMap::fileName, j_);
+    return {};
+}
+
+std::shared_ptr<Backend>
+Shard::setMap(std::shared_ptr<Backend> map)
+{
+    if (!map)
+    {
+        mapFailed_ = true;
+        return {};
+    }
+
+    std::swap(backend_, map);
+    pCache_.reset();
+    nCache_.reset();
+    mapped_ = true;
+    return map;
+}
+
+void
+Shard::retireBackend(std::shared_ptr<Backend> old)
+{
+    assert(mapped_);
+    old.reset();
+    if (released_)
+    {
+        std::unique_lock<std::mutex> lock(released_->mutex);
+        released_->cond.wait(lock, [this] { return released_->done; });
+    }
+    released_.reset();
+    removeBackendFiles();
+}
+
+void
+Shard::removeBackendFiles()
+{
+    // The map replaces the NuDB files, so it must be durable first
+    boost::system::error_code ec;
+    syncFile(ec, dir_ / ShardMap::fileName);
+    if (!ec)
+        syncDirectory(ec, dir_);
+    if (ec)
+    {
+        JLOG(j_.warn()) <<
+            "shard " << index_ << ": unable to sync map, " << ec.message();
+        return;
+    }
+
+    for (auto const& name : {std::string("nudb.dat"),
+        std::string("nudb.key"), std::string("nudb.log"),
+        std::string(ShardMap::fileName) + ".tmp"})
+    {
+        boost::system::error_code ec;
+        boost::filesystem::remove(dir_ / name, ec);
+        if (ec)
+        {
+            JLOG(j_.warn()) <<
+                "shard " << index_ << ": " << ec.message();
+        }
+    }
+}
+
+void
+Shard::updateFileSize()
+{
+    using namespace boost::filesystem;
+    std::uint64_t sz {0};
+    try
+    {
+        for (auto const& p : recursive_directory_iterator(dir_))
+            if (!is_directory(p))
+                sz += file_size(p);
+    }
+    catch (const filesystem_error& e)
+    {
+        JLOG(j_.error()) <<
+            "exception: " << e.what();
+        return;
+    }
+    fileSize_ = sz;
+}
+
+bool
+Shard::validate(Application& app, std::size_t parallel,
+    std::function<bool(std::uint32_t)> const& progress)
 {
     uint256 hash;
     std::uint32_t seq;
@@ -253,11 +418,14 @@ Shard::validate(Application& app)
         " ledgers " << firstSeq_ <<
         "-" << lastSeq_;
 
-    auto const savedAge {pCache_->getTargetAge()};
     using namespace std::chrono_literals;
-    pCache_->setTargetAge(1s);
+    auto const savedAge {pCache_ ? pCache_->getTargetAge() : 0s};
+    if (pCache_)
+        pCache_->setTargetAge(1s);
 
-    std::shared_ptr<Ledger const> next;
+    auto pass {std::make_shared<ValidatePass>()};
+    pass->hashes.resize(lastSeq_ - firstSeq_ + 1);
+    pass->progress = progress;
     while (seq >= firstSeq_)
     {
         auto nObj = valFetch(hash);
@@ -274,50 +442,90 @@ Shard::validate(Application& app)
                 " cannot be a ledger";
             break;
         }
-        l->stateMap().setLedgerSeq(seq);
-        l->txMap().setLedgerSeq(seq);
-        l->setImmutable(app.config());
-        if (!l->stateMap().fetchRoot(
-            SHAMapHash {l->info().accountHash}, nullptr))
+        pass->hashes[seq - firstSeq_] = hash;
+        hash = l->info().parentHash;
+        --seq;
+    }
+    l.reset();
+
+    if (seq >= firstSeq_)
+        pass->failed = seq;
+
+    loadValidated(*pass);
+    pass->validated = pass->done;
+    if (progress && !pass->done.empty() &&
+        !progress(boost::icl::length(pass->done)))
+    {
+        pass->stop = true;
+    }
+
+    if (seq < lastSeq_)
+    {
+        auto const low {seq + 1};
+        auto const segments {std::max<std::uint32_t>(1, std::min<std::uint32_t>(
+            parallel, (lastSeq_ - low + 1) / validateSegment))};
+        auto const length {(lastSeq_ - low + segments) / segments};
+        for (auto high = lastSeq_; high >= low; high -= length)
         {
-            JLOG(j_.error()) <<
-                "ledger seq " << seq <<
-                " missing Account State root";
-            break;
+            pass->segments.emplace_back(
+                high - std::min(length - 1, high - low), high);
+            if (high - low < length)
+                break;
         }
-        if (l->info().txHash.isNonZero())
+
+        // A queued job may outlive the shard once validate returns
+        std::weak_ptr<Shard> weak = shared_from_this();
+        for (std::size_t i = 1; i < pass->segments.size(); ++i)
         {
-            if (!l->txMap().fetchRoot(
-                SHAMapHash {l->info().txHash}, nullptr))
+            if (!app.getJobQueue().addJob(
+                jtSWEEP, "Shard::validate",
+                [weak, &app, pass](Job&)
+                {
+                    if (auto shard = weak.lock())
+                        shard->valSegments(app, *pass);
+                }))
             {
-                JLOG(j_.error()) <<
-                    "ledger seq " << seq <<
-                    " missing TX root";
                 break;
             }
         }
-        if (!valLedger(l, next))
-            break;
-        hash = l->info().parentHash;
-        --seq;
-        next = l;
-        if (seq % 128 == 0)
-            pCache_->sweep();
+
+        valSegments(app, *pass);
+
+        std::unique_lock<std::mutex> lock(pass->mutex);
+        pass->cond.wait(lock, [&pass] { return pass->busy == 0; });
     }
 
-    pCache_->reset();
-    nCache_->reset();
-    pCache_->setTargetAge(savedAge);
+    if (pCache_)
+    {
+        pCache_->reset();
+        nCache_->reset();
+        pCache_->setTargetAge(savedAge);
+    }
 
-    if (seq >= firstSeq_)
+    std::lock_guard<std::mutex> lock(pass->mutex);
+    if (pass->failed)
     {
+        if (complete_)
+            removeCheckpoint();
+
         JLOG(j_.error()) <<
             "shard " << index_ <<
             (complete_ ? " is invalid, failed" : " is incomplete, stopped") <<
-            " at seq " << seq <<
-            " hash " << hash;
+            " at seq " << *pass->failed <<
+            " hash " << (*pass->failed == seq ? hash :
+                pass->hashes[*pass->failed - firstSeq_]);
         return false;
     }
+    if (pass->stop)
+    {
+        JLOG(j_.info()) <<
+            "shard " << index_ <<
+            " validation stopped, " << boost::icl::length(pass->validated) <<
+            " ledgers validated";
+        return false;
+    }
+
+    removeCheckpoint();
 
     JLOG(j_.debug()) <<
         "shard " << index_ <<
@@ -325,6 +533,200 @@ Shard::validate(Application& app)
     return true;
 }
 
+void
+Shard::valSegments(Application& app, ValidatePass& pass)
+{
+    std::unique_lock<std::mutex> lock(pass.mutex);
+    while (!pass.stop && pass.next < pass.segments.size())
+    {
+        auto const segment = pass.segments[pass.next++];
+        ++pass.busy;
+        lock.unlock();
+
+        std::shared_ptr<Ledger const> next;
+        std::uint32_t high {0};
+        std::uint32_t count {0};
+        boost::optional<std::uint32_t> failed;
+
+        auto checkpoint = [&](std::uint32_t low)
+        {
+            if (count == 0)
+                return;
+            std::lock_guard<std::mutex> lock(pass.mutex);
+            pass.validated.insert(range(low, high));
+            saveValidated(pass);
+            if (pass.progress && !pass.progress(count))
+                pass.stop = true;
+            count = 0;
+        };
+
+        auto seq {segment.second};
+        for (; seq >= segment.first && !pass.stop; --seq)
+        {
+            if (boost::icl::contains(pass.done, seq))
+            {
+                checkpoint(seq + 1);
+                next.reset();
+                continue;
+            }
+
+            auto const ledger {valLoad(app, seq,
+                pass.hashes[seq - firstSeq_])};
+            if (!ledger || !valLedger(ledger, next))
+            {
+                failed = seq;
+                break;
+            }
+            next = ledger;
+
+            if (count++ == 0)
+                high = seq;
+            if (count == validateSegment)
+                checkpoint(seq);
+
+            if (seq % 128 == 0)
+            {
+                if (pCache_)
+                    pCache_->sweep();
+                app.shardFamily()->treecache().sweep();
+            }
+        }
+        checkpoint(seq + 1);
+
+        lock.lock();
+        --pass.busy;
+        if (failed)
+        {
+            pass.stop = true;
+            if (!pass.failed || *pass.failed < *failed)
+                pass.failed = failed;
+        }
+    }
+
+    if (pass.busy == 0)
+        pass.cond.notify_all();
+}
+
+std::shared_ptr<Ledger>
+Shard::valLoad(Application& app, std::uint32_t seq, uint256 const& hash)
+{
+    auto nObj = valFetch(hash);
+    if (!nObj)
+        return {};
+    auto l = std::make_shared<Ledger>(
+        InboundLedger::deserializeHeader(makeSlice(nObj->getData()),
+            true), app.config(), *app.shardFamily());
+    if (l->info().hash != hash || l->info().seq != seq)
+    {
+        JLOG(j_.error()) <<
+            "ledger seq " << seq <<
+            " hash " << hash <<
+            " cannot be a ledger";
+        return {};
+    }
+    l->stateMap().setLedgerSeq(seq);
+    l->txMap().setLedgerSeq(seq);
+    l->setImmutable(app.config());
+    if (!l->stateMap().fetchRoot(
+        SHAMapHash {l->info().accountHash}, nullptr))
+    {
+        JLOG(j_.error()) <<
+            "ledger seq " << seq <<
+            " missing Account State root";
+        return {};
+    }
+    if (l->info().txHash.isNonZero())
+    {
+        if (!l->txMap().fetchRoot(
+            SHAMapHash {l->info().txHash}, nullptr))
+        {
+            JLOG(j_.error()) <<
+                "ledger seq " << seq <<
+                " missing TX root";
+            return {};
+        }
+    }
+    return l;
+}
+
+void
+Shard::removeCheckpoint()
+{
+    removeAll(checkpoint_, j_);
+    removeAll(dir_ / validateFileName, j_);
+}
+
+void
+Shard::loadValidated(ValidatePass& pass)
+{
+    auto const& lastHash {pass.hashes.back()};
+    if (lastHash.isZero() || !boost::filesystem::is_regular_file(checkpoint_))
+        return;
+
+    auto& validated {pass.done};
+    std::string hash;
+    try
+    {
+        std::ifstream ifs(checkpoint_.string());
+        boost::archive::text_iarchive ar(ifs);
+        ar & hash;
+        ar & validated;
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(j_.warn()) <<
+            "shard " << index_ <<
+            " ignoring validation checkpoint: " << e.what();
+        validated.clear();
+        return;
+    }
+
+    // Only resume a pass over the same ledgers this node looked up
+    if (hash != to_string(lastHash))
+    {
+        JLOG(j_.warn()) <<
+            "shard " << index_ <<
+            " ignoring validation checkpoint for last ledger " << hash;
+        validated.clear();
+        return;
+    }
+
+    if (!validated.empty() &&
+        (boost::icl::first(validated) < firstSeq_ ||
+            boost::icl::last(validated) > lastSeq_))
+    {
+        JLOG(j_.warn()) <<
+            "shard " << index_ <<
+            " ignoring invalid validation checkpoint";
+        validated.clear();
+        return;
+    }
+
+    JLOG(j_.info()) <<
+        "shard " << index_ <<
+        " resuming validation, " << boost::icl::length(validated) <<
+        " ledgers already validated";
+}
+
+void
+Shard::saveValidated(ValidatePass const& pass)
+{
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(checkpoint_.parent_path(), ec);
+    std::ofstream ofs {checkpoint_.string(), std::ios::trunc};
+    if (ec || !ofs.is_open())
+    {
+        JLOG(j_.warn()) <<
+            "shard " << index_ <<
+            " unable to save validation checkpoint";
+        return;
+    }
+    auto const hash {to_string(pass.hashes.back())};
+    boost::archive::text_oarchive ar(ofs);
+    ar & hash;
+    ar & pass.validated;
+}
+
 bool
 Shard::valLedger(std::shared_ptr<Ledger const> const& l,
     std::shared_ptr<Ledger const> const& next)
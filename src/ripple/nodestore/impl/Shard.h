@@ -14,6 +14,13 @@
 #include <boost/serialization/map.hpp>
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace ripple {
 namespace NodeStore {
@@ -35,12 +42,13 @@ removeAll(boost::filesystem::path const& path, beast::Journal& j)
     return true;
 }
 
-using PCache = TaggedCache<uint256, NodeObject>;
+using PCache = PartitionedTaggedCache<uint256, NodeObject>;
 using NCache = KeyCache<uint256>;
 class DatabaseShard;
 
 
 class Shard
+    : public std::enable_shared_from_this<Shard>
 {
 public:
     Shard(DatabaseShard const& db, std::uint32_t index, int cacheSz,
@@ -58,8 +66,18 @@ public:
     bool
     contains(std::uint32_t seq) const;
 
+    /** Verify every ledger in the shard.
+
+        Progress is reported as ledgers are verified; returning false from
+        the callback stops the pass, leaving a checkpoint to resume from.
+    */
     bool
-    validate(Application& app);
+    validate(Application& app, std::size_t parallel = 1,
+        std::function<bool(std::uint32_t)> const& progress = {});
+
+    /** Discard any validation checkpoint for this shard. */
+    void
+    removeCheckpoint();
 
     std::uint32_t
     index() const {return index_;}
@@ -93,6 +111,34 @@ public:
     std::shared_ptr<Ledger const>
     lastStored() {return lastStored_;}
 
+    bool
+    mapped() const {return mapped_;}
+
+    
+    bool
+    mappable(std::chrono::steady_clock::time_point cutoff) const;
+
+    
+    std::shared_ptr<Backend>
+    makeMap(std::function<bool()> const& stopping);
+
+    
+    std::shared_ptr<Backend>
+    setMap(std::shared_ptr<Backend> map);
+
+    /** Release the backend replaced by setMap and remove its files.
+
+        Blocks until every reader has released the old backend.
+    */
+    void
+    retireBackend(std::shared_ptr<Backend> old);
+
+    void
+    removeBackendFiles();
+
+    void
+    updateFileSize();
+
 private:
     friend class boost::serialization::access;
     template<class Archive>
@@ -103,6 +149,38 @@ private:
 
     static constexpr auto controlFileName = "control.txt";
 
+    // Checkpoints were once kept in the shard directory, where an imported
+    // archive could supply one. They are now kept under the shard root.
+    static constexpr auto validateFileName = "validate.txt";
+
+    static constexpr auto checkpointDirName = "validation";
+
+    static constexpr std::uint32_t validateSegment = 256;
+
+    // Signalled once the NuDB backend has been closed and destroyed
+    struct Released
+    {
+        std::mutex mutex;
+        std::condition_variable cond;
+        bool done {false};
+    };
+
+    struct ValidatePass
+    {
+        std::vector<uint256> hashes;
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> segments;
+        RangeSet<std::uint32_t> done;
+        std::function<bool(std::uint32_t)> progress;
+
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::size_t next {0};
+        std::size_t busy {0};
+        std::atomic<bool> stop {false};
+        RangeSet<std::uint32_t> validated;
+        boost::optional<std::uint32_t> failed;
+    };
+
     std::uint32_t const index_;
 
     std::uint32_t const firstSeq_;
@@ -119,12 +197,20 @@ private:
 
     boost::filesystem::path const control_;
 
+    boost::filesystem::path const checkpoint_;
+
     std::uint64_t fileSize_ {0};
     std::shared_ptr<Backend> backend_;
+    std::shared_ptr<Released> released_;
     beast::Journal j_;
 
     bool complete_ {false};
 
+    bool mapped_ {false};
+    bool mapFailed_ {false};
+
+    std::chrono::steady_clock::time_point completed_;
+
     RangeSet<std::uint32_t> storedSeqs_;
 
     std::shared_ptr<Ledger const> lastStored_;
@@ -136,8 +222,17 @@ private:
     std::shared_ptr<NodeObject>
     valFetch(uint256 const& hash);
 
+    std::shared_ptr<Ledger>
+    valLoad(Application& app, std::uint32_t seq, uint256 const& hash);
+
     void
-    updateFileSize();
+    valSegments(Application& app, ValidatePass& pass);
+
+    void
+    loadValidated(ValidatePass& pass);
+
+    void
+    saveValidated(ValidatePass const& pass);
 
     bool
     saveControl();
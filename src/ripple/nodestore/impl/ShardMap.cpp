@@ -0,0 +1,439 @@
+
+
+#include <ripple/nodestore/impl/ShardMap.h>
+#include <ripple/basics/contract.h>
+#include <ripple/basics/FileUtilities.h>
+#include <ripple/basics/Log.h>
+#include <ripple/nodestore/impl/codec.h>
+#include <ripple/nodestore/impl/DecodedBlob.h>
+#include <nudb/nudb.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+namespace ripple {
+namespace NodeStore {
+
+namespace {
+
+char constexpr magic[] = "SHARDMAP";
+
+std::uint32_t constexpr maxBucketBits = 24;
+
+void
+put32(std::uint8_t* p, std::uint32_t v)
+{
+    for (int i = 0; i < 4; ++i)
+        p[i] = static_cast<std::uint8_t>(v >> (8 * i));
+}
+
+void
+put64(std::uint8_t* p, std::uint64_t v)
+{
+    for (int i = 0; i < 8; ++i)
+        p[i] = static_cast<std::uint8_t>(v >> (8 * i));
+}
+
+std::uint32_t
+get32(std::uint8_t const* p)
+{
+    std::uint32_t v {0};
+    for (int i = 3; i >= 0; --i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+std::uint64_t
+get64(std::uint8_t const* p)
+{
+    std::uint64_t v {0};
+    for (int i = 7; i >= 0; --i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+std::uint64_t
+bucketOf(void const* key, std::uint32_t bits)
+{
+    if (bits == 0)
+        return 0;
+    auto const k = static_cast<std::uint8_t const*>(key);
+    std::uint32_t const prefix {(std::uint32_t{k[0]} << 24) |
+        (std::uint32_t{k[1]} << 16) | (std::uint32_t{k[2]} << 8) | k[3]};
+    return prefix >> (32 - bits);
+}
+
+bool
+validType(std::uint8_t type)
+{
+    return type == hotUNKNOWN || type == hotLEDGER ||
+        type == hotACCOUNT_NODE || type == hotTRANSACTION_NODE;
+}
+
+}
+
+ShardMap::ShardMap(boost::filesystem::path const& dir, beast::Journal j)
+    : path_(dir / fileName)
+    , j_(j)
+{
+}
+
+ShardMap::~ShardMap()
+{
+    close();
+}
+
+bool
+ShardMap::create(boost::filesystem::path const& dir,
+    std::function<bool()> const& stopping, beast::Journal j)
+{
+    using namespace boost::filesystem;
+
+    struct Entry
+    {
+        uint256 key;
+        std::uint64_t offset;
+        std::uint32_t size;
+    };
+
+    auto const tmp {dir / (std::string(fileName) + ".tmp")};
+    std::vector<Entry> entries;
+
+    auto fail = [&](std::string const& msg)
+    {
+        if (!msg.empty())
+        {
+            JLOG(j.error()) <<
+                "shard map " << dir.string() << ": " << msg;
+        }
+        boost::system::error_code ec;
+        remove(tmp, ec);
+        return false;
+    };
+
+    try
+    {
+        std::ofstream ofs(tmp.string(), std::ios::binary | std::ios::trunc);
+        if (!ofs.is_open())
+            return fail("unable to create " + tmp.string());
+
+        std::array<std::uint8_t, headerBytes> header {};
+        ofs.write(reinterpret_cast<char const*>(header.data()),
+            header.size());
+
+        std::uint64_t dataBytes {0};
+        nudb::error_code ec;
+        nudb::visit((dir / "nudb.dat").string(),
+            [&](void const* key, std::size_t,
+                void const* data, std::size_t size,
+                nudb::error_code& vec)
+            {
+                if (stopping())
+                {
+                    vec = boost::system::errc::make_error_code(
+                        boost::system::errc::operation_canceled);
+                    return;
+                }
+                nudb::detail::buffer bf;
+                auto const result = nodeobject_decompress(data, size, bf);
+                DecodedBlob decoded(key, result.first, result.second);
+                if (!decoded.wasOk())
+                {
+                    vec = make_error_code(nudb::error::missing_value);
+                    return;
+                }
+                // Skip the unused prefix and copy the type byte and the
+                // object data straight from the decompression buffer.
+                auto const bytes {static_cast<std::uint32_t>(
+                    result.second - 8)};
+                ofs.write(static_cast<char const*>(result.first) + 8, bytes);
+                entries.push_back({uint256::fromVoid(key), dataBytes, bytes});
+                dataBytes += bytes;
+            }, nudb::no_progress{}, ec);
+        if (stopping())
+            return fail({});
+        if (ec)
+            Throw<nudb::system_error>(ec);
+
+        std::sort(entries.begin(), entries.end(),
+            [](Entry const& lhs, Entry const& rhs)
+            {
+                return lhs.key < rhs.key;
+            });
+        entries.erase(std::unique(entries.begin(), entries.end(),
+            [](Entry const& lhs, Entry const& rhs)
+            {
+                return lhs.key == rhs.key;
+            }), entries.end());
+
+        std::uint32_t bits {0};
+        while (bits < maxBucketBits &&
+            (std::uint64_t{8} << bits) < entries.size())
+        {
+            ++bits;
+        }
+
+        std::uint64_t const buckets {std::uint64_t{1} << bits};
+        std::vector<std::uint8_t> buf((buckets + 1) * 8);
+        std::size_t i {0};
+        for (std::uint64_t b = 0; b <= buckets; ++b)
+        {
+            while (i < entries.size() &&
+                bucketOf(entries[i].key.data(), bits) < b)
+            {
+                ++i;
+            }
+            put64(&buf[b * 8], i);
+        }
+        ofs.write(reinterpret_cast<char const*>(buf.data()), buf.size());
+
+        std::array<std::uint8_t, entryBytes> entry {};
+        for (auto const& e : entries)
+        {
+            std::memcpy(entry.data(), e.key.data(), e.key.size());
+            put64(entry.data() + 32, e.offset);
+            put32(entry.data() + 40, e.size);
+            ofs.write(reinterpret_cast<char const*>(entry.data()),
+                entry.size());
+        }
+
+        std::memcpy(header.data(), magic, 8);
+        put32(header.data() + 8, currentVersion);
+        put32(header.data() + 12, bits);
+        put64(header.data() + 16, entries.size());
+        put64(header.data() + 24, dataBytes);
+        ofs.seekp(0);
+        ofs.write(reinterpret_cast<char const*>(header.data()),
+            header.size());
+        ofs.flush();
+        if (!ofs)
+            return fail("unable to write " + tmp.string());
+        ofs.close();
+
+        // The map must be durable before it is published, and the rename
+        // must be durable before the caller removes the NuDB files.
+        syncFile(ec, tmp);
+        if (ec)
+            return fail("unable to sync " + tmp.string());
+        rename(tmp, dir / fileName);
+        syncDirectory(ec, dir);
+        if (ec)
+        {
+            remove(dir / fileName, ec);
+            return fail("unable to sync " + dir.string());
+        }
+    }
+    catch (std::exception const& e)
+    {
+        return fail(e.what());
+    }
+
+    JLOG(j.debug()) <<
+        "shard map " << dir.string() <<
+        " created with " << entries.size() << " objects";
+    return true;
+}
+
+std::string
+ShardMap::getName()
+{
+    return path_.string();
+}
+
+void
+ShardMap::open(bool)
+{
+    using namespace boost::interprocess;
+    if (base_)
+    {
+        assert(false);
+        JLOG(j_.error()) <<
+            "shard map is already open";
+        return;
+    }
+
+    {
+        file_mapping file(path_.string().c_str(), read_only);
+        mapped_region region(file, read_only);
+        region_.swap(region);
+    }
+
+    auto const size {static_cast<std::uint64_t>(region_.get_size())};
+    auto const base {static_cast<std::uint8_t const*>(region_.get_address())};
+    if (size < headerBytes || std::memcmp(base, magic, 8) != 0)
+        Throw<std::runtime_error>("shard map: invalid header");
+    if (get32(base + 8) != currentVersion)
+        Throw<std::runtime_error>("shard map: unknown version");
+
+    bucketBits_ = get32(base + 12);
+    count_ = get64(base + 16);
+    dataBytes_ = get64(base + 24);
+    if (bucketBits_ > maxBucketBits ||
+        dataBytes_ > size || count_ > size / entryBytes)
+    {
+        Throw<std::runtime_error>("shard map: invalid header");
+    }
+
+    auto const bucketBytes {((std::uint64_t{1} << bucketBits_) + 1) * 8};
+    if (headerBytes + dataBytes_ + bucketBytes +
+        (count_ * entryBytes) != size)
+    {
+        Throw<std::runtime_error>("shard map: invalid size");
+    }
+
+    buckets_ = base + headerBytes + dataBytes_;
+    index_ = buckets_ + bucketBytes;
+    if (get64(buckets_ + bucketBytes - 8) != count_)
+        Throw<std::runtime_error>("shard map: invalid bucket table");
+
+    region_.advise(mapped_region::advice_random);
+    base_ = base;
+}
+
+void
+ShardMap::close()
+{
+    base_ = nullptr;
+    buckets_ = nullptr;
+    index_ = nullptr;
+    boost::interprocess::mapped_region region;
+    region_.swap(region);
+}
+
+Status
+ShardMap::fetch(void const* key, std::shared_ptr<NodeObject>* pObject)
+{
+    pObject->reset();
+    if (!base_)
+        Throw<std::runtime_error>("shard map is not open");
+
+    auto const entry {find(key)};
+    if (!entry)
+        return notFound;
+    *pObject = decode(entry);
+    return *pObject ? ok : dataCorrupt;
+}
+
+std::vector<std::shared_ptr<NodeObject>>
+ShardMap::fetchBatch(std::size_t n, void const* const* keys)
+{
+    if (!base_)
+        Throw<std::runtime_error>("shard map is not open");
+
+    std::vector<std::shared_ptr<NodeObject>> results(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (auto const entry = find(keys[i]))
+        {
+            results[i] = decode(entry);
+            if (!results[i])
+            {
+                JLOG(j_.fatal()) <<
+                    "Corrupt NodeObject #" << uint256::fromVoid(keys[i]);
+            }
+        }
+    }
+    return results;
+}
+
+void
+ShardMap::store(std::shared_ptr<NodeObject> const&)
+{
+    Throw<std::runtime_error>("shard map is read only");
+}
+
+void
+ShardMap::storeBatch(Batch const&)
+{
+    Throw<std::runtime_error>("shard map is read only");
+}
+
+void
+ShardMap::for_each(std::function<void(std::shared_ptr<NodeObject>)> f)
+{
+    if (!base_)
+        Throw<std::runtime_error>("shard map is not open");
+
+    for (std::uint64_t i = 0; i < count_; ++i)
+    {
+        auto object {decode(index_ + i * entryBytes)};
+        if (!object)
+            Throw<std::runtime_error>("shard map: corrupt object");
+        f(std::move(object));
+    }
+}
+
+void
+ShardMap::verify()
+{
+    if (!base_)
+        Throw<std::runtime_error>("shard map is not open");
+
+    for (std::uint64_t b = 0; b < (std::uint64_t{1} << bucketBits_); ++b)
+    {
+        auto const first {get64(buckets_ + b * 8)};
+        auto const last {get64(buckets_ + (b + 1) * 8)};
+        if (first > last || last > count_)
+            Throw<std::runtime_error>("shard map: invalid bucket table");
+        for (auto i = first; i < last; ++i)
+        {
+            auto const entry {index_ + i * entryBytes};
+            if (bucketOf(entry, bucketBits_) != b ||
+                (i != 0 && std::memcmp(
+                    entry - entryBytes, entry, NodeObject::keyBytes) >= 0))
+            {
+                Throw<std::runtime_error>("shard map: invalid index");
+            }
+            if (!decode(entry))
+                Throw<std::runtime_error>("shard map: corrupt object");
+        }
+    }
+}
+
+std::uint8_t const*
+ShardMap::find(void const* key) const
+{
+    auto const b {bucketOf(key, bucketBits_)};
+    auto first {get64(buckets_ + b * 8)};
+    auto last {get64(buckets_ + (b + 1) * 8)};
+    if (first > last || last > count_)
+        return nullptr;
+
+    while (first < last)
+    {
+        auto const mid {first + (last - first) / 2};
+        auto const entry {index_ + mid * entryBytes};
+        auto const cmp {std::memcmp(entry, key, NodeObject::keyBytes)};
+        if (cmp < 0)
+            first = mid + 1;
+        else if (cmp > 0)
+            last = mid;
+        else
+            return entry;
+    }
+    return nullptr;
+}
+
+std::shared_ptr<NodeObject>
+ShardMap::decode(std::uint8_t const* entry) const
+{
+    auto const offset {get64(entry + 32)};
+    auto const size {get32(entry + 40)};
+    if (size == 0 || offset > dataBytes_ || size > dataBytes_ - offset)
+        return {};
+
+    auto const data {base_ + headerBytes + offset};
+    if (!validType(data[0]))
+        return {};
+
+    // NodeObject owns its data, so the object is copied out of the mapped
+    // page once. There is no decompression or intermediate buffer.
+    return NodeObject::createObject(static_cast<NodeObjectType>(data[0]),
+        Blob(data + 1, data + size), uint256::fromVoid(entry));
+}
+
+}
+}
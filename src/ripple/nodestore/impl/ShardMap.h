@@ -0,0 +1,116 @@
+
+
+#ifndef RIPPLE_NODESTORE_SHARDMAP_H_INCLUDED
+#define RIPPLE_NODESTORE_SHARDMAP_H_INCLUDED
+
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/nodestore/Backend.h>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <cstdint>
+#include <functional>
+
+namespace ripple {
+namespace NodeStore {
+
+
+class ShardMap : public Backend
+{
+public:
+    static constexpr auto fileName = "shard.map";
+
+    static constexpr std::uint32_t currentVersion = 1;
+
+    static constexpr std::size_t headerBytes = 64;
+
+    static constexpr std::size_t entryBytes = 48;
+
+    ShardMap(boost::filesystem::path const& dir, beast::Journal j);
+
+    ~ShardMap() override;
+
+    
+    static
+    bool
+    create(boost::filesystem::path const& dir,
+        std::function<bool()> const& stopping, beast::Journal j);
+
+    std::string
+    getName() override;
+
+    void
+    open(bool createIfMissing) override;
+
+    void
+    close() override;
+
+    Status
+    fetch(void const* key, std::shared_ptr<NodeObject>* pObject) override;
+
+    bool
+    canFetchBatch() override
+    {
+        return true;
+    }
+
+    std::vector<std::shared_ptr<NodeObject>>
+    fetchBatch(std::size_t n, void const* const* keys) override;
+
+    void
+    store(std::shared_ptr<NodeObject> const& object) override;
+
+    void
+    storeBatch(Batch const& batch) override;
+
+    void
+    for_each(std::function<void(std::shared_ptr<NodeObject>)> f) override;
+
+    int
+    getWriteLoad() override
+    {
+        return 0;
+    }
+
+    void
+    setDeletePath() override
+    {
+    }
+
+    void
+    verify() override;
+
+    
+    int
+    fdlimit() const override
+    {
+        return 1;
+    }
+
+    std::uint64_t
+    size() const
+    {
+        return count_;
+    }
+
+private:
+    std::uint8_t const*
+    find(void const* key) const;
+
+    std::shared_ptr<NodeObject>
+    decode(std::uint8_t const* entry) const;
+
+    boost::filesystem::path const path_;
+    beast::Journal j_;
+    boost::interprocess::mapped_region region_;
+    std::uint8_t const* base_ {nullptr};
+    std::uint64_t count_ {0};
+    std::uint64_t dataBytes_ {0};
+    std::uint32_t bucketBits_ {0};
+    std::uint8_t const* buckets_ {nullptr};
+    std::uint8_t const* index_ {nullptr};
+};
+
+}
+}
+
+#endif
@@ -15,7 +15,9 @@ enum
 
 std::chrono::seconds constexpr cacheTargetAge = std::chrono::minutes{5};
 auto constexpr shardCacheSz = 16384;
+std::size_t constexpr readBatchSize = 64;
 std::chrono::seconds constexpr shardCacheAge = std::chrono::minutes{1};
+std::chrono::seconds constexpr shardMapDelay = std::chrono::seconds{30};
 
 }
 }
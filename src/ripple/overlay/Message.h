@@ -10,7 +10,9 @@
 #include <cstdint>
 #include <iterator>
 #include <memory>
+#include <mutex>
 #include <type_traits>
+#include <vector>
 
 namespace ripple {
 
@@ -28,12 +30,25 @@ public:
     
     static std::size_t constexpr kMaxMessageSize = 64 * 1024 * 1024;
 
+    
+    static std::uint8_t constexpr kCompressedFlag = 0x80;
+
+    
+    static std::size_t constexpr kCompressThreshold = 1024;
+
     Message (::google::protobuf::Message const& message, int type);
 
     
     std::vector <uint8_t> const&
-    getBuffer () const
+    getBuffer (bool compressed = false) const
     {
+        if (compressed &&
+            mBuffer.size () >= kHeaderBytes + kCompressThreshold)
+        {
+            std::call_once (mCompressOnce, [this] { compress (); });
+            if (! mCompressed.empty ())
+                return mCompressed;
+        }
         return mBuffer;
     }
 
@@ -61,7 +76,7 @@ public:
                 Message::kHeaderBytes)
             return 0;
         std::size_t n;
-        n  = std::size_t{*first++} << 24;
+        n  = std::size_t(*first++ & ~kCompressedFlag & 0xFF) << 24;
         n += std::size_t{*first++} << 16;
         n += std::size_t{*first++} <<  8;
         n += std::size_t{*first};
@@ -78,6 +93,27 @@ public:
     }
     
 
+    template <class FwdIter>
+    static
+    std::enable_if_t<std::is_same<typename
+        FwdIter::value_type, std::uint8_t>::value, bool>
+    compressed (FwdIter first, FwdIter last)
+    {
+        if (std::distance(first, last) <
+                Message::kHeaderBytes)
+            return false;
+        return (*first & kCompressedFlag) != 0;
+    }
+
+    template <class BufferSequence>
+    static
+    bool
+    compressed (BufferSequence const& buffers)
+    {
+        return compressed(buffers_begin(buffers),
+            buffers_end(buffers));
+    }
+
     
     
     static int getType (std::vector <uint8_t> const& buf);
@@ -126,8 +162,13 @@ private:
 
     void encodeHeader (unsigned size, int type);
 
+    void compress () const;
+
     std::vector <uint8_t> mBuffer;
 
+    mutable std::once_flag mCompressOnce;
+    mutable std::vector <uint8_t> mCompressed;
+
     std::size_t mCategory;
 };
 
@@ -50,6 +50,7 @@ public:
         beast::IP::Address public_ip;
         int ipLimit = 0;
         std::uint32_t crawlOptions = 0;
+        bool reduceRelay = false;
     };
 
     using PeerSequence = std::vector <std::shared_ptr<Peer>>;
@@ -128,7 +129,7 @@ public:
     virtual
     void
     relay (protocol::TMValidation& m,
-        uint256 const& uid) = 0;
+        uint256 const& uid, PublicKey const& validator) = 0;
 
     
     template <typename UnaryFunc>
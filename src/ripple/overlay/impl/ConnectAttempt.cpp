@@ -195,6 +195,7 @@ ConnectAttempt::onHandshake (error_code ec)
         *sharedValue,
         overlay_.setup().public_ip,
         beast::IPAddressConversion::from_asio(remote_endpoint_),
+        overlay_.setup().reduceRelay,
         app_);
     appendHello (req_, hello);
 
@@ -3,6 +3,7 @@
 #include <ripple/basics/safe_cast.h>
 #include <ripple/overlay/Message.h>
 #include <ripple/overlay/impl/TrafficCount.h>
+#include <lz4.h>
 #include <cstdint>
 
 namespace ripple {
@@ -36,7 +37,7 @@ unsigned Message::getLength (std::vector <uint8_t> const& buf)
 
     if (buf.size () >= Message::kHeaderBytes)
     {
-        result = buf [0];
+        result = buf [0] & ~kCompressedFlag & 0xFF;
         result <<= 8;
         result |= buf [1];
         result <<= 8;
@@ -63,6 +64,40 @@ int Message::getType (std::vector<uint8_t> const& buf)
     return ret;
 }
 
+void Message::compress () const
+{
+    auto const payloadBytes = mBuffer.size () - kHeaderBytes;
+    auto const bound = LZ4_compressBound (static_cast<int> (payloadBytes));
+    if (bound <= 0)
+        return;
+
+    std::vector <uint8_t> buf (kHeaderBytes + 4 + bound);
+    auto const compressedBytes = LZ4_compress_default (
+        reinterpret_cast<char const*> (&mBuffer[kHeaderBytes]),
+        reinterpret_cast<char*> (&buf[kHeaderBytes + 4]),
+        static_cast<int> (payloadBytes), bound);
+    if (compressedBytes <= 0 ||
+        kHeaderBytes + 4 + compressedBytes >= mBuffer.size ())
+    {
+        return;
+    }
+    buf.resize (kHeaderBytes + 4 + compressedBytes);
+
+    auto const size = static_cast<unsigned> (4 + compressedBytes);
+    buf[0] = static_cast<std::uint8_t> (((size >> 24) & 0xFF) | kCompressedFlag);
+    buf[1] = static_cast<std::uint8_t> ((size >> 16) & 0xFF);
+    buf[2] = static_cast<std::uint8_t> ((size >> 8) & 0xFF);
+    buf[3] = static_cast<std::uint8_t> (size & 0xFF);
+    buf[4] = mBuffer[4];
+    buf[5] = mBuffer[5];
+    buf[6] = static_cast<std::uint8_t> ((payloadBytes >> 24) & 0xFF);
+    buf[7] = static_cast<std::uint8_t> ((payloadBytes >> 16) & 0xFF);
+    buf[8] = static_cast<std::uint8_t> ((payloadBytes >> 8) & 0xFF);
+    buf[9] = static_cast<std::uint8_t> (payloadBytes & 0xFF);
+
+    mCompressed = std::move (buf);
+}
+
 void Message::encodeHeader (unsigned size, int type)
 {
     assert (mBuffer.size () >= Message::kHeaderBytes);
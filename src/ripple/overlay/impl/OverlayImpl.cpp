@@ -104,6 +104,7 @@ OverlayImpl::Timer::on_timer (error_code ec)
     overlay_.m_peerFinder->once_per_second();
     overlay_.sendEndpoints();
     overlay_.autoConnect();
+    overlay_.deleteIdlePeers();
 
     if ((++overlay_.timer_count_ % Tuning::checkSeconds) == 0)
         overlay_.check();
@@ -138,6 +139,7 @@ OverlayImpl::OverlayImpl (
     , m_resolver (resolver)
     , next_id_(1)
     , timer_count_(0)
+    , slots_(*this)
 {
     beast::PropertyStream::Source::add (m_peerFinder.get());
 }
@@ -542,7 +544,44 @@ OverlayImpl::onWrite (beast::PropertyStream::Map& stream)
             item["messages_in"] = std::to_string(i.messagesIn.load());
             item["bytes_out"] = std::to_string(i.bytesOut.load());
             item["messages_out"] = std::to_string(i.messagesOut.load());
+            if (i.compressedIn || i.compressedOut)
+            {
+                item["compressed_in"] =
+                    std::to_string(i.compressedIn.load());
+                item["uncompressed_in"] =
+                    std::to_string(i.uncompressedIn.load());
+                item["compressed_out"] =
+                    std::to_string(i.compressedOut.load());
+                item["uncompressed_out"] =
+                    std::to_string(i.uncompressedOut.load());
+            }
+        }
+    }
+
+    {
+        beast::PropertyStream::Map item ("send_queue", stream);
+        auto const writes = writes_.load();
+        auto const messages = writeMessages_.load();
+        item["writes"] = std::to_string(writes);
+        item["messages"] = std::to_string(messages);
+        if (writes != 0)
+        {
+            item["messages_per_write"] = std::to_string(
+                static_cast<double>(messages) / writes);
+        }
+    }
+
+    if (setup_.reduceRelay)
+    {
+        beast::PropertyStream::Map item ("reduce_relay", stream);
+        {
+            std::lock_guard <std::mutex> lock (slotsMutex_);
+            item["validators"] = std::to_string(slots_.size());
         }
+        item["squelches"] = std::to_string(squelchesSent_.load());
+        item["unsquelches"] = std::to_string(unsquelchesSent_.load());
+        item["squelched_relays"] = std::to_string(squelchedRelays_.load());
+        item["duplicates"] = std::to_string(duplicates_.load());
     }
 }
 
@@ -573,8 +612,16 @@ OverlayImpl::activate (std::shared_ptr<PeerImp> const& peer)
 void
 OverlayImpl::onPeerDeactivate (Peer::id_t id)
 {
-    std::lock_guard <decltype(mutex_)> lock (mutex_);
-    ids_.erase(id);
+    {
+        std::lock_guard <decltype(mutex_)> lock (mutex_);
+        ids_.erase(id);
+    }
+
+    if (setup_.reduceRelay)
+    {
+        std::lock_guard <std::mutex> lock (slotsMutex_);
+        slots_.deletePeer (id);
+    }
 }
 
 void
@@ -656,9 +703,10 @@ void
 OverlayImpl::reportTraffic (
     TrafficCount::category cat,
     bool isInbound,
-    int number)
+    int number,
+    int uncompressed)
 {
-    m_traffic.addCount (cat, isInbound, number);
+    m_traffic.addCount (cat, isInbound, number, uncompressed);
 }
 
 Json::Value
@@ -1045,16 +1093,27 @@ OverlayImpl::relay (protocol::TMProposeSet& m, uint256 const& uid)
     if (auto const toSkip = app_.getHashRouter().shouldRelay(uid))
     {
         auto const sm = std::make_shared<Message>(m, protocol::mtPROPOSE_LEDGER);
+        auto const slice = makeSlice(m.nodepubkey());
+        boost::optional<PublicKey> validator;
+        if (setup_.reduceRelay && publicKeyType(slice))
+            validator.emplace(slice);
         for_each([&](std::shared_ptr<PeerImp>&& p)
         {
-            if (toSkip->find(p->id()) == toSkip->end())
-                p->send(sm);
+            if (toSkip->find(p->id()) != toSkip->end())
+                return;
+            if (validator && p->squelched(*validator))
+            {
+                ++squelchedRelays_;
+                return;
+            }
+            p->send(sm);
         });
     }
 }
 
 void
-OverlayImpl::relay (protocol::TMValidation& m, uint256 const& uid)
+OverlayImpl::relay (protocol::TMValidation& m,
+    uint256 const& uid, PublicKey const& validator)
 {
     if (m.has_hops() && m.hops() >= maxTTL)
         return;
@@ -1063,12 +1122,68 @@ OverlayImpl::relay (protocol::TMValidation& m, uint256 const& uid)
         auto const sm = std::make_shared<Message>(m, protocol::mtVALIDATION);
         for_each([&](std::shared_ptr<PeerImp>&& p)
         {
-            if (toSkip->find(p->id()) == toSkip->end())
-                p->send(sm);
+            if (toSkip->find(p->id()) != toSkip->end())
+                return;
+            if (setup_.reduceRelay && p->squelched(validator))
+            {
+                ++squelchedRelays_;
+                return;
+            }
+            p->send(sm);
         });
     }
 }
 
+void
+OverlayImpl::updateSlot (PublicKey const& validator, Peer::id_t id)
+{
+    if (! setup_.reduceRelay)
+        return;
+    std::lock_guard <std::mutex> lock (slotsMutex_);
+    slots_.update (validator, id, clock_type::now());
+}
+
+void
+OverlayImpl::deleteIdlePeers ()
+{
+    if (! setup_.reduceRelay)
+        return;
+    std::lock_guard <std::mutex> lock (slotsMutex_);
+    slots_.deleteIdlePeers (clock_type::now());
+}
+
+void
+OverlayImpl::squelch (PublicKey const& validator, Peer::id_t id,
+    std::chrono::seconds duration)
+{
+    auto const peer = std::dynamic_pointer_cast<PeerImp>(
+        findPeerByShortID (id));
+    if (peer && peer->reduceRelay ())
+    {
+        protocol::TMSquelch m;
+        m.set_squelch (true);
+        m.set_validatorpubkey (validator.data(), validator.size());
+        m.set_squelchduration (static_cast<std::uint32_t>(duration.count()));
+        peer->send (std::make_shared<Message>(m, protocol::mtSQUELCH));
+        ++squelchesSent_;
+    }
+}
+
+void
+OverlayImpl::unsquelch (PublicKey const& validator, Peer::id_t id)
+{
+    auto const peer = std::dynamic_pointer_cast<PeerImp>(
+        findPeerByShortID (id));
+    if (peer && peer->reduceRelay ())
+    {
+        protocol::TMSquelch m;
+        m.set_squelch (false);
+        m.set_validatorpubkey (validator.data(), validator.size());
+        peer->send (std::make_shared<Message>(m, protocol::mtSQUELCH));
+        ++unsquelchesSent_;
+    }
+}
+
 
 void
 OverlayImpl::remove (Child& child)
@@ -1152,6 +1267,7 @@ setup_Overlay (BasicConfig const& config)
         auto const& section = config.section("overlay");
         setup.context = make_SSLContext("");
         setup.expire = get<bool>(section, "expire", false);
+        setup.reduceRelay = get<bool>(section, "reduce_relay", false);
 
         set(setup.ipLimit, "ip_limit", section);
         if (setup.ipLimit < 0)
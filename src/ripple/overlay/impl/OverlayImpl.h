@@ -6,6 +6,7 @@
 #include <ripple/app/main/Application.h>
 #include <ripple/core/Job.h>
 #include <ripple/overlay/Overlay.h>
+#include <ripple/overlay/impl/Squelch.h>
 #include <ripple/overlay/impl/TrafficCount.h>
 #include <ripple/server/Handoff.h>
 #include <ripple/rpc/ServerHandler.h>
@@ -36,7 +37,9 @@ class BasicConfig;
 
 constexpr std::uint32_t maxTTL = 2;
 
-class OverlayImpl : public Overlay
+class OverlayImpl
+    : public Overlay
+    , public squelch::SquelchHandler
 {
 public:
     class Child
@@ -109,6 +112,15 @@ private:
     std::condition_variable csCV_;
     std::set<std::uint32_t> csIDs_;
 
+    std::mutex slotsMutex_;
+    squelch::Slots<clock_type> slots_;
+    std::atomic <uint64_t> squelchesSent_ {0};
+    std::atomic <uint64_t> unsquelchesSent_ {0};
+    std::atomic <uint64_t> squelchedRelays_ {0};
+    std::atomic <uint64_t> duplicates_ {0};
+    std::atomic <uint64_t> writes_ {0};
+    std::atomic <uint64_t> writeMessages_ {0};
+
 
 public:
     OverlayImpl (Application& app, Setup const& setup, Stoppable& parent,
@@ -189,7 +201,24 @@ public:
 
     void
     relay (protocol::TMValidation& m,
-        uint256 const& uid) override;
+        uint256 const& uid, PublicKey const& validator) override;
+
+    
+    void
+    updateSlot (PublicKey const& validator, Peer::id_t id);
+
+    void
+    onDuplicate ()
+    {
+        ++duplicates_;
+    }
+
+    void
+    squelch (PublicKey const& validator, Peer::id_t id,
+        std::chrono::seconds duration) override;
+
+    void
+    unsquelch (PublicKey const& validator, Peer::id_t id) override;
 
 
     void
@@ -289,7 +318,15 @@ public:
     reportTraffic (
         TrafficCount::category cat,
         bool isInbound,
-        int bytes);
+        int bytes,
+        int uncompressed = 0);
+
+    void
+    reportWrite (std::size_t messages)
+    {
+        ++writes_;
+        writeMessages_ += messages;
+    }
 
     void
     incJqTransOverflow() override
@@ -398,6 +435,9 @@ private:
 
     void
     sendEndpoints();
+
+    void
+    deleteIdlePeers();
 };
 
 } 
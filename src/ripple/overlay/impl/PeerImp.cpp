@@ -9,6 +9,7 @@
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/misc/LoadFeeTrack.h>
 #include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/app/misc/SignatureBatch.h>
 #include <ripple/app/misc/Transaction.h>
 #include <ripple/app/misc/ValidatorList.h>
 #include <ripple/app/tx/apply.h>
@@ -31,6 +32,8 @@
 
 using namespace std::chrono_literals;
 
+#define SF_VERIFIED     SF_PRIVATE1
+
 namespace ripple {
 
 PeerImp::PeerImp (Application& app, id_t id, endpoint_type remote_endpoint,
@@ -163,9 +166,12 @@ PeerImp::send (Message::pointer const& m)
     if(detaching_)
         return;
 
+    auto const& buffer = m->getBuffer(compression());
+    auto const& original = m->getBuffer();
     overlay_.reportTraffic (
         safe_cast<TrafficCount::category>(m->getCategory()),
-        false, static_cast<int>(m->getBuffer().size()));
+        false, static_cast<int>(buffer.size()),
+        &buffer == &original ? 0 : static_cast<int>(original.size()));
 
     auto sendq_size = send_queue_.size();
 
@@ -184,12 +190,18 @@ PeerImp::send (Message::pointer const& m)
 
     send_queue_.push(m);
 
-    if(sendq_size != 0)
+    if(send_queue_.writing())
         return;
 
+    writeSendQueue();
+}
+
+void
+PeerImp::writeSendQueue()
+{
     boost::asio::async_write(
         stream_,
-        boost::asio::buffer(send_queue_.front()->getBuffer()),
+        send_queue_.prepare(compression()),
         bind_executor(
             strand_,
             std::bind(
@@ -685,7 +697,8 @@ PeerImp::makeResponse (bool crawl,
     resp.insert("Server", BuildInfo::getFullVersionString());
     resp.insert("Crawl", crawl ? "public" : "private");
     protocol::TMHello hello = buildHello(sharedValue,
-        overlay_.setup().public_ip, remote, app_);
+        overlay_.setup().public_ip, remote,
+        overlay_.setup().reduceRelay, app_);
     appendHello(resp, hello);
     return resp;
 }
@@ -825,21 +838,10 @@ PeerImp::onWriteMessage (error_code ec, std::size_t bytes_transferred)
             stream << "onWriteMessage";
     }
 
-    assert(! send_queue_.empty());
-    send_queue_.pop();
+    assert(send_queue_.writing());
+    overlay_.reportWrite(send_queue_.consume());
     if (! send_queue_.empty())
-    {
-        return boost::asio::async_write(
-            stream_,
-            boost::asio::buffer(send_queue_.front()->getBuffer()),
-            bind_executor(
-                strand_,
-                std::bind(
-                    &PeerImp::onWriteMessage,
-                    shared_from_this(),
-                    std::placeholders::_1,
-                    std::placeholders::_2)));
-    }
+        return writeSendQueue();
 
     if (gracefulClose_)
     {
@@ -860,16 +862,24 @@ PeerImp::onMessageUnknown (std::uint16_t type)
     return ec;
 }
 
+void
+PeerImp::onMessageCorrupt (std::uint16_t type)
+{
+    JLOG(p_journal_.warn()) <<
+        "Compressed message of type " << type << " does not decompress";
+    charge (Resource::feeBadData);
+}
+
 PeerImp::error_code
 PeerImp::onMessageBegin (std::uint16_t type,
     std::shared_ptr <::google::protobuf::Message> const& m,
-    std::size_t size)
+    std::size_t size, std::size_t uncompressedSize)
 {
     load_event_ = app_.getJobQueue ().makeLoadEvent (
         jtPEER, protocolMessageName(type));
     fee_ = Resource::feeLightPeer;
     overlay_.reportTraffic (TrafficCount::categorize (*m, type, true),
-        true, static_cast<int>(size));
+        true, static_cast<int>(size), static_cast<int>(uncompressedSize));
     return error_code{};
 }
 
@@ -1383,7 +1393,8 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMTransaction> const& m)
         }
 
         constexpr int max_transactions = 250;
-        if (app_.getJobQueue().getJobCount(jtTRANSACTION) > max_transactions)
+        if (app_.getJobQueue().getJobCount(jtTRANSACTION) +
+            app_.getSignatureBatch().size() > max_transactions)
         {
             overlay_.incJqTransOverflow();
             JLOG(p_journal_.info()) << "Transaction queue is full";
@@ -1392,6 +1403,16 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMTransaction> const& m)
         {
             JLOG(p_journal_.trace()) << "No new transactions until synchronized";
         }
+        else if (checkSignature)
+        {
+            app_.getSignatureBatch ().add (stx,
+                app_.getLedgerMaster().getValidatedRules(),
+                [weak = std::weak_ptr<PeerImp>(shared_from_this()),
+                flags, stx] () {
+                    if (auto peer = weak.lock())
+                        peer->checkTransaction(flags, true, stx);
+                });
+        }
         else
         {
             app_.getJobQueue ().addJob (
@@ -1518,14 +1539,20 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMProposeSet> const& m)
         proposeHash, prevLedger, set.proposeseq(),
         closeTime, publicKey.slice(), sig);
 
+    auto const isTrusted = app_.validators().trusted (publicKey);
+
     if (! app_.getHashRouter ().addSuppressionPeer (suppression, id_))
     {
         JLOG(p_journal_.trace()) << "Proposal: duplicate";
+        overlay_.onDuplicate ();
+        if (isTrusted &&
+            (app_.getHashRouter ().getFlags (suppression) & SF_VERIFIED))
+        {
+            overlay_.updateSlot (publicKey, id_);
+        }
         return;
     }
 
-    auto const isTrusted = app_.validators().trusted (publicKey);
-
     if (!isTrusted)
     {
         if (sanity_.load() == Sanity::insane)
@@ -1876,16 +1903,22 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMValidation> const& m)
             return;
         }
 
-        if (! app_.getHashRouter ().addSuppressionPeer(
-            sha512Half(makeSlice(m->validation())), id_))
+        auto const isTrusted =
+            app_.validators().trusted(val->getSignerPublic ());
+
+        auto const suppression = sha512Half(makeSlice(m->validation()));
+        if (! app_.getHashRouter ().addSuppressionPeer(suppression, id_))
         {
             JLOG(p_journal_.trace()) << "Validation: duplicate";
+            overlay_.onDuplicate ();
+            if (isTrusted &&
+                (app_.getHashRouter ().getFlags (suppression) & SF_VERIFIED))
+            {
+                overlay_.updateSlot (val->getSignerPublic (), id_);
+            }
             return;
         }
 
-        auto const isTrusted =
-            app_.validators().trusted(val->getSignerPublic ());
-
         if (!isTrusted && (sanity_.load () == Sanity::insane))
         {
             JLOG(p_journal_.debug()) <<
@@ -2163,6 +2196,54 @@ PeerImp::checkTransaction (int flags,
     }
 }
 
+void
+PeerImp::onMessage (std::shared_ptr <protocol::TMSquelch> const& m)
+{
+    if (! reduceRelay ())
+    {
+        JLOG(p_journal_.debug()) << "Squelch: not negotiated";
+        fee_ = Resource::feeUnwantedData;
+        return;
+    }
+
+    auto const slice = makeSlice (m->validatorpubkey ());
+    if (! publicKeyType (slice))
+    {
+        JLOG(p_journal_.debug()) << "Squelch: malformed";
+        fee_ = Resource::feeBadData;
+        return;
+    }
+
+    PublicKey const validator {slice};
+    std::lock_guard<std::mutex> lock (squelchMutex_);
+    if (! m->squelch ())
+    {
+        squelched_.erase (validator);
+        return;
+    }
+
+    std::chrono::seconds const duration {std::min<std::uint32_t> (
+        m->has_squelchduration () ? m->squelchduration () : 0,
+        squelch::maxSquelchDuration.count ())};
+    if (duration == std::chrono::seconds::zero ())
+        squelched_.erase (validator);
+    else
+        squelched_[validator] = clock_type::now () + duration;
+}
+
+bool
+PeerImp::squelched (PublicKey const& validator)
+{
+    std::lock_guard<std::mutex> lock (squelchMutex_);
+    auto const it = squelched_.find (validator);
+    if (it == squelched_.end ())
+        return false;
+    if (it->second > clock_type::now ())
+        return true;
+    squelched_.erase (it);
+    return false;
+}
+
 void
 PeerImp::checkPropose (Job& job,
     std::shared_ptr <protocol::TMProposeSet> const& packet,
@@ -2186,6 +2267,8 @@ PeerImp::checkPropose (Job& job,
 
     if (isTrusted)
     {
+        app_.getHashRouter ().setFlags (peerPos.suppressionID (), SF_VERIFIED);
+        overlay_.updateSlot (peerPos.publicKey (), id_);
         app_.getOPs ().processTrustedProposal (peerPos, packet);
     }
     else
@@ -2219,12 +2302,19 @@ PeerImp::checkValidation (STValidation::pointer val,
             return;
         }
 
+        if (app_.validators().trusted(val->getSignerPublic ()))
+        {
+            app_.getHashRouter ().setFlags (
+                sha512Half(makeSlice(packet->validation())), SF_VERIFIED);
+            overlay_.updateSlot (val->getSignerPublic (), id_);
+        }
+
         if (app_.getOPs ().recvValidation(val, std::to_string(id())) ||
             cluster())
         {
             auto const suppression = sha512Half(
                 makeSlice(val->getSerialized()));
-            overlay_.relay(*packet, suppression);
+            overlay_.relay(*packet, suppression, val->getSignerPublic());
         }
     }
     catch (std::exception const&)
@@ -9,6 +9,7 @@
 #include <ripple/beast/asio/waitable_timer.h>
 #include <ripple/beast/utility/WrappedSink.h>
 #include <ripple/overlay/impl/ProtocolMessage.h>
+#include <ripple/overlay/impl/SendQueue.h>
 #include <ripple/overlay/impl/OverlayImpl.h>
 #include <ripple/peerfinder/PeerfinderManager.h>
 #include <ripple/protocol/Protocol.h>
@@ -130,7 +131,7 @@ private:
     http_response_type response_;
     boost::beast::http::fields const& headers_;
     boost::beast::multi_buffer write_buffer_;
-    std::queue<Message::pointer> send_queue_;
+    SendQueue send_queue_;
     bool gracefulClose_ = false;
     int large_sendq_ = 0;
     int no_ping_ = 0;
@@ -139,6 +140,9 @@ private:
     std::mutex mutable shardInfoMutex_;
     hash_map<PublicKey, ShardInfo> shardInfo_;
 
+    std::mutex mutable squelchMutex_;
+    hash_map<PublicKey, clock_type::time_point> squelched_;
+
     friend class OverlayImpl;
 
 public:
@@ -220,6 +224,26 @@ public:
         return slot_->cluster();
     }
 
+    
+    bool
+    squelched(PublicKey const& validator);
+
+    
+    bool
+    reduceRelay() const
+    {
+        return overlay_.setup().reduceRelay &&
+            hello_.has_reducerelay() && hello_.reducerelay();
+    }
+
+    
+    bool
+    compression() const
+    {
+        return app_.config().COMPRESSION &&
+            hello_.has_compression() && hello_.compression();
+    }
+
     void
     check();
 
@@ -341,6 +365,9 @@ private:
     void
     onReadMessage (error_code ec, std::size_t bytes_transferred);
 
+    void
+    writeSendQueue();
+
     void
     onWriteMessage (error_code ec, std::size_t bytes_transferred);
 
@@ -357,10 +384,13 @@ public:
     error_code
     onMessageUnknown (std::uint16_t type);
 
+    void
+    onMessageCorrupt (std::uint16_t type);
+
     error_code
     onMessageBegin (std::uint16_t type,
         std::shared_ptr <::google::protobuf::Message> const& m,
-        std::size_t size);
+        std::size_t size, std::size_t uncompressedSize);
 
     void
     onMessageEnd (std::uint16_t type,
@@ -385,6 +415,7 @@ public:
     void onMessage (std::shared_ptr <protocol::TMHaveTransactionSet> const& m);
     void onMessage (std::shared_ptr <protocol::TMValidation> const& m);
     void onMessage (std::shared_ptr <protocol::TMGetObjectByHash> const& m);
+    void onMessage (std::shared_ptr <protocol::TMSquelch> const& m);
 
 private:
     State state() const
@@ -9,6 +9,8 @@
 #include <boost/asio/buffer.hpp>
 #include <boost/asio/buffers_iterator.hpp>
 #include <boost/system/error_code.hpp>
+#include <lz4.h>
+#include <array>
 #include <cassert>
 #include <cstdint>
 #include <memory>
@@ -44,6 +46,7 @@ protocolMessageName (int type)
     case protocol::mtHAVE_SET:              return "have_set";
     case protocol::mtVALIDATION:            return "validation";
     case protocol::mtGET_OBJECTS:           return "get_objects";
+    case protocol::mtSQUELCH:               return "squelch";
     default:
         break;
     };
@@ -57,7 +60,7 @@ std::enable_if_t<std::is_base_of<
     ::google::protobuf::Message, T>::value,
         boost::system::error_code>
 invoke (int type, Buffers const& buffers,
-    Handler& handler)
+    Handler& handler, std::size_t size, std::size_t uncompressedSize)
 {
     ZeroCopyInputStream<Buffers> stream(buffers);
     stream.Skip(Message::kHeaderBytes);
@@ -65,8 +68,7 @@ invoke (int type, Buffers const& buffers,
     if (! m->ParseFromZeroCopyStream(&stream))
         return boost::system::errc::make_error_code(
             boost::system::errc::invalid_argument);
-    auto ec = handler.onMessageBegin (type, m,
-       Message::kHeaderBytes + Message::size (buffers));
+    auto ec = handler.onMessageBegin (type, m, size, uncompressedSize);
     if (! ec)
     {
         handler.onMessage (m);
@@ -75,6 +77,78 @@ invoke (int type, Buffers const& buffers,
     return ec;
 }
 
+template <class Buffers, class Handler>
+boost::system::error_code
+dispatch (int type, Buffers const& buffers, Handler& handler,
+    std::size_t size, std::size_t uncompressedSize)
+{
+    boost::system::error_code ec;
+    switch (type)
+    {
+    case protocol::mtHELLO:                 ec = invoke<protocol::TMHello> (type, buffers, handler, size, uncompressedSize); break;
+    case protocol::mtMANIFESTS:             ec = invoke<protocol::TMManifests> (type, buffers, handler, size, uncompressedSize); break;
+    case protocol::mtPING:                  ec = invoke<protocol::TMPing> (type, buffers, handler, size, uncompressedSize); break;
+    case protocol::mtCLUSTER:               ec = invoke<protocol::TMCluster> (type, buffers, handler, size, uncompressedSize); break;
+    case protocol::mtGET_SHARD_INFO:        ec = invoke<protocol::TMGetShardInfo> (type, buffers, handler, size, uncompressedSize); break;
+    case protocol::mtSHARD_INFO:            ec = invoke<protocol::TMShardInfo>(type, buffers, handler, size, uncompressedSize); break;
+    case protocol::mtGET_PEER_SHARD_INFO:   ec = invoke<protocol::TMGetPeerShardInfo> (type, buffers, handler, size, uncompressedSize); break;
+    case protocol::mtPEER_SHARD_INFO:       ec = invoke<protocol::TMPeerShardInfo>(type, buffers, handler, size, uncompressedSize); break;
+    case protocol::mtGET_PEERS:             ec = invoke<protocol::TMGetPeers> (type, buffers, handler, size, uncompressedSize); break;
+    case protocol::mtPEERS:                 ec = invoke<protocol::TMPeers> (type, buffers, handler, size, uncompressedSize); break;
+    case protocol::mtENDPOINTS:             ec = invoke<protocol::TMEndpoints> (type, buffers, handler, size, uncompressedSize); break;
+    case protocol::mtTRANSACTION:           ec = invoke<protocol::TMTransaction> (type, buffers, handler, size, uncompressedSize); break;
+    case protocol::mtGET_LEDGER:            ec = invoke<protocol::TMGetLedger> (type, buffers, handler, size, uncompressedSize); break;
+    case protocol::mtLEDGER_DATA:           ec = invoke<protocol::TMLedgerData> (type, buffers, handler, size, uncompressedSize); break;
+    case protocol::mtPROPOSE_LEDGER:        ec = invoke<protocol::TMProposeSet> (type, buffers, handler, size, uncompressedSize); break;
+    case protocol::mtSTATUS_CHANGE:         ec = invoke<protocol::TMStatusChange> (type, buffers, handler, size, uncompressedSize); break;
+    case protocol::mtHAVE_SET:              ec = invoke<protocol::TMHaveTransactionSet> (type, buffers, handler, size, uncompressedSize); break;
+    case protocol::mtVALIDATION:            ec = invoke<protocol::TMValidation> (type, buffers, handler, size, uncompressedSize); break;
+    case protocol::mtGET_OBJECTS:           ec = invoke<protocol::TMGetObjectByHash> (type, buffers, handler, size, uncompressedSize); break;
+    case protocol::mtSQUELCH:               ec = invoke<protocol::TMSquelch> (type, buffers, handler, size, uncompressedSize); break;
+    default:
+        ec = handler.onMessageUnknown (type);
+        break;
+    }
+    return ec;
+}
+
+
+// LZ4 cannot expand a block by more than this, so a larger declared size
+// is a lie and must not be allocated.
+std::size_t constexpr maxCompressionRatio = 255;
+
+template <class Buffers>
+bool
+decompress (Buffers const& buffers, std::size_t size,
+    std::vector<std::uint8_t>& payload)
+{
+    if (size < Message::kHeaderBytes + 4)
+        return false;
+
+    std::vector<std::uint8_t> in (size);
+    boost::asio::buffer_copy(boost::asio::buffer(in), buffers);
+    auto const p = in.data() + Message::kHeaderBytes;
+    auto const compressedBytes = size - Message::kHeaderBytes - 4;
+
+    std::size_t const payloadBytes =
+        (std::size_t{p[0]} << 24) | (std::size_t{p[1]} << 16) |
+        (std::size_t{p[2]} << 8) | std::size_t{p[3]};
+    if (payloadBytes == 0 ||
+        payloadBytes + Message::kHeaderBytes > Message::kMaxMessageSize ||
+        payloadBytes > compressedBytes * maxCompressionRatio)
+    {
+        return false;
+    }
+
+    payload.resize (Message::kHeaderBytes + payloadBytes);
+    auto const n = LZ4_decompress_safe (
+        reinterpret_cast<char const*>(p + 4),
+        reinterpret_cast<char*>(payload.data() + Message::kHeaderBytes),
+        static_cast<int>(compressedBytes),
+        static_cast<int>(payloadBytes));
+    return n >= 0 && static_cast<std::size_t>(n) == payloadBytes;
+}
+
 }
 
 
@@ -103,30 +177,24 @@ invokeProtocolMessage (Buffers const& buffers, Handler& handler)
 
     auto const type = Message::type(buffers);
 
-    switch (type)
+    if (Message::compressed(buffers))
     {
-    case protocol::mtHELLO:                 ec = detail::invoke<protocol::TMHello> (type, buffers, handler); break;
-    case protocol::mtMANIFESTS:             ec = detail::invoke<protocol::TMManifests> (type, buffers, handler); break;
-    case protocol::mtPING:                  ec = detail::invoke<protocol::TMPing> (type, buffers, handler); break;
-    case protocol::mtCLUSTER:               ec = detail::invoke<protocol::TMCluster> (type, buffers, handler); break;
-    case protocol::mtGET_SHARD_INFO:        ec = detail::invoke<protocol::TMGetShardInfo> (type, buffers, handler); break;
-    case protocol::mtSHARD_INFO:            ec = detail::invoke<protocol::TMShardInfo>(type, buffers, handler); break;
-    case protocol::mtGET_PEER_SHARD_INFO:   ec = detail::invoke<protocol::TMGetPeerShardInfo> (type, buffers, handler); break;
-    case protocol::mtPEER_SHARD_INFO:       ec = detail::invoke<protocol::TMPeerShardInfo>(type, buffers, handler); break;
-    case protocol::mtGET_PEERS:             ec = detail::invoke<protocol::TMGetPeers> (type, buffers, handler); break;
-    case protocol::mtPEERS:                 ec = detail::invoke<protocol::TMPeers> (type, buffers, handler); break;
-    case protocol::mtENDPOINTS:             ec = detail::invoke<protocol::TMEndpoints> (type, buffers, handler); break;
-    case protocol::mtTRANSACTION:           ec = detail::invoke<protocol::TMTransaction> (type, buffers, handler); break;
-    case protocol::mtGET_LEDGER:            ec = detail::invoke<protocol::TMGetLedger> (type, buffers, handler); break;
-    case protocol::mtLEDGER_DATA:           ec = detail::invoke<protocol::TMLedgerData> (type, buffers, handler); break;
-    case protocol::mtPROPOSE_LEDGER:        ec = detail::invoke<protocol::TMProposeSet> (type, buffers, handler); break;
-    case protocol::mtSTATUS_CHANGE:         ec = detail::invoke<protocol::TMStatusChange> (type, buffers, handler); break;
-    case protocol::mtHAVE_SET:              ec = detail::invoke<protocol::TMHaveTransactionSet> (type, buffers, handler); break;
-    case protocol::mtVALIDATION:            ec = detail::invoke<protocol::TMValidation> (type, buffers, handler); break;
-    case protocol::mtGET_OBJECTS:           ec = detail::invoke<protocol::TMGetObjectByHash> (type, buffers, handler); break;
-    default:
-        ec = handler.onMessageUnknown (type);
-        break;
+        std::vector<std::uint8_t> payload;
+        if (! detail::decompress(buffers, size, payload))
+        {
+            handler.onMessageCorrupt (type);
+            ec = boost::system::errc::make_error_code(
+                boost::system::errc::invalid_argument);
+            return result;
+        }
+        std::array<boost::asio::const_buffer, 1> const decompressed {{
+            boost::asio::buffer(payload)}};
+        ec = detail::dispatch(type, decompressed, handler,
+            size, payload.size());
+    }
+    else
+    {
+        ec = detail::dispatch(type, buffers, handler, size, 0);
     }
     if (! ec)
         result.first = size;
@@ -0,0 +1,73 @@
+
+
+#include <ripple/overlay/impl/SendQueue.h>
+#include <ripple/overlay/impl/TrafficCount.h>
+#include <ripple/overlay/impl/Tuning.h>
+#include <cassert>
+
+namespace ripple {
+
+void
+SendQueue::push (Message::pointer const& m)
+{
+    if (priority (*m))
+        priority_.push_back (m);
+    else
+        bulk_.push_back (m);
+}
+
+boost::asio::const_buffer
+SendQueue::prepare (bool compressed)
+{
+    assert (! writing ());
+    assert (! priority_.empty () || ! bulk_.empty ());
+
+    {
+        auto& q = next ();
+        auto const& buffer = q.front ()->getBuffer (compressed);
+        if (buffer.size () >= Tuning::sendBatchBytes)
+        {
+            writing_.push_back (q.front ());
+            q.pop_front ();
+            return boost::asio::buffer (buffer);
+        }
+    }
+
+    buffer_.clear ();
+    while (writing_.size () < Tuning::sendBatchMessages &&
+        (! priority_.empty () || ! bulk_.empty ()))
+    {
+        auto& q = next ();
+        auto const& buffer = q.front ()->getBuffer (compressed);
+        if (buffer_.size () + buffer.size () > Tuning::sendBatchBytes)
+            break;
+        buffer_.insert (buffer_.end (), buffer.begin (), buffer.end ());
+        writing_.push_back (q.front ());
+        q.pop_front ();
+    }
+    return boost::asio::buffer (buffer_);
+}
+
+std::size_t
+SendQueue::consume ()
+{
+    auto const n = writing_.size ();
+    writing_.clear ();
+    return n;
+}
+
+bool
+SendQueue::priority (Message const& m)
+{
+    auto const category = m.getCategory ();
+    return category == TrafficCount::category::proposal ||
+        category == TrafficCount::category::validation;
+}
+
+std::deque<Message::pointer>&
+SendQueue::next ()
+{
+    return priority_.empty () ? bulk_ : priority_;
+}
+
+}
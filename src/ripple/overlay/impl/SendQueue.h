@@ -0,0 +1,71 @@
+
+
+#ifndef RIPPLE_OVERLAY_SENDQUEUE_H_INCLUDED
+#define RIPPLE_OVERLAY_SENDQUEUE_H_INCLUDED
+
+#include <ripple/overlay/Message.h>
+#include <boost/asio/buffer.hpp>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace ripple {
+
+
+class SendQueue
+{
+public:
+    SendQueue () = default;
+    SendQueue (SendQueue const&) = delete;
+    SendQueue& operator= (SendQueue const&) = delete;
+
+    
+    void
+    push (Message::pointer const& m);
+
+    
+    std::size_t
+    size () const
+    {
+        return priority_.size () + bulk_.size () + writing_.size ();
+    }
+
+    bool
+    empty () const
+    {
+        return size () == 0;
+    }
+
+    
+    bool
+    writing () const
+    {
+        return ! writing_.empty ();
+    }
+
+    
+    boost::asio::const_buffer
+    prepare (bool compressed);
+
+    
+    std::size_t
+    consume ();
+
+    
+    static
+    bool
+    priority (Message const& m);
+
+private:
+    std::deque<Message::pointer>&
+    next ();
+
+    std::deque<Message::pointer> priority_;
+    std::deque<Message::pointer> bulk_;
+    std::vector<Message::pointer> writing_;
+    std::vector<std::uint8_t> buffer_;
+};
+
+}
+
+#endif
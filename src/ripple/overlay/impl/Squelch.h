@@ -0,0 +1,313 @@
+
+
+#ifndef RIPPLE_OVERLAY_SQUELCH_H_INCLUDED
+#define RIPPLE_OVERLAY_SQUELCH_H_INCLUDED
+
+#include <ripple/basics/random.h>
+#include <ripple/overlay/Peer.h>
+#include <ripple/protocol/PublicKey.h>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <unordered_map>
+
+namespace ripple {
+namespace squelch {
+
+std::size_t constexpr maxSelectedPeers = 5;
+
+
+std::size_t constexpr messageThreshold = 20;
+
+
+std::chrono::seconds constexpr idled {8};
+
+
+std::chrono::seconds constexpr minSquelchDuration {300};
+std::chrono::seconds constexpr maxSquelchDuration {600};
+
+
+class SquelchHandler
+{
+public:
+    virtual ~SquelchHandler() = default;
+
+    virtual
+    void
+    squelch (PublicKey const& validator, Peer::id_t id,
+        std::chrono::seconds duration) = 0;
+
+    virtual
+    void
+    unsquelch (PublicKey const& validator, Peer::id_t id) = 0;
+};
+
+
+template <class clock_type>
+class Slot
+{
+public:
+    using time_point = typename clock_type::time_point;
+
+    explicit
+    Slot (SquelchHandler& handler)
+        : handler_ (handler)
+    {
+    }
+
+
+    void
+    update (PublicKey const& validator, Peer::id_t id, time_point now);
+
+
+    void
+    deleteIdlePeers (PublicKey const& validator, time_point now);
+
+
+    void
+    deletePeer (PublicKey const& validator, Peer::id_t id);
+
+    std::set<Peer::id_t>
+    getSelected () const;
+
+    bool
+    empty () const
+    {
+        return peers_.empty ();
+    }
+
+private:
+    enum class State
+    {
+        counting,
+        selected,
+        squelched
+    };
+
+    struct PeerInfo
+    {
+        State state;
+        std::size_t count;
+        time_point expire;
+        time_point lastMessage;
+    };
+
+    void
+    squelch (PublicKey const& validator, Peer::id_t id,
+        PeerInfo& peer, time_point now);
+
+    void
+    reset (PublicKey const& validator);
+
+    SquelchHandler& handler_;
+    std::unordered_map<Peer::id_t, PeerInfo> peers_;
+    std::set<Peer::id_t> considered_;
+    bool selected_ {false};
+};
+
+template <class clock_type>
+void
+Slot<clock_type>::update (
+    PublicKey const& validator, Peer::id_t id, time_point now)
+{
+    auto it = peers_.find (id);
+    if (it == peers_.end ())
+        it = peers_.emplace (id, PeerInfo {State::counting, 0, now, now}).first;
+
+    auto& peer = it->second;
+    peer.lastMessage = now;
+
+    if (peer.state == State::squelched)
+    {
+        if (now < peer.expire)
+            return;
+        peer.state = State::counting;
+        peer.count = 0;
+    }
+
+    if (selected_)
+    {
+        if (peer.state == State::counting)
+            squelch (validator, id, peer, now);
+        return;
+    }
+
+    if (++peer.count < messageThreshold)
+        return;
+
+    considered_.insert (id);
+    if (considered_.size () < maxSelectedPeers)
+        return;
+
+    for (auto& p : peers_)
+    {
+        if (considered_.count (p.first))
+            p.second.state = State::selected;
+        else
+            squelch (validator, p.first, p.second, now);
+    }
+    considered_.clear ();
+    selected_ = true;
+}
+
+template <class clock_type>
+void
+Slot<clock_type>::deleteIdlePeers (
+    PublicKey const& validator, time_point now)
+{
+    bool reselect {false};
+    for (auto it = peers_.begin (); it != peers_.end ();)
+    {
+        auto& peer = it->second;
+        if (peer.state == State::squelched)
+        {
+            if (now >= peer.expire)
+            {
+                peer.state = State::counting;
+                peer.count = 0;
+                peer.lastMessage = now;
+            }
+            ++it;
+            continue;
+        }
+
+        if (now - peer.lastMessage <= idled)
+        {
+            ++it;
+            continue;
+        }
+
+        if (peer.state == State::selected)
+            reselect = true;
+        considered_.erase (it->first);
+        it = peers_.erase (it);
+    }
+
+    if (reselect)
+        reset (validator);
+}
+
+template <class clock_type>
+void
+Slot<clock_type>::deletePeer (PublicKey const& validator, Peer::id_t id)
+{
+    auto const it = peers_.find (id);
+    if (it == peers_.end ())
+        return;
+
+    auto const wasSelected = it->second.state == State::selected;
+    considered_.erase (id);
+    peers_.erase (it);
+
+    if (wasSelected)
+        reset (validator);
+}
+
+template <class clock_type>
+std::set<Peer::id_t>
+Slot<clock_type>::getSelected () const
+{
+    std::set<Peer::id_t> selected;
+    for (auto const& p : peers_)
+    {
+        if (p.second.state == State::selected)
+            selected.insert (p.first);
+    }
+    return selected;
+}
+
+template <class clock_type>
+void
+Slot<clock_type>::squelch (PublicKey const& validator, Peer::id_t id,
+    PeerInfo& peer, time_point now)
+{
+    std::chrono::seconds const duration {rand_int (
+        minSquelchDuration.count (), maxSquelchDuration.count ())};
+    peer.state = State::squelched;
+    peer.count = 0;
+    peer.expire = now + duration;
+    handler_.squelch (validator, id, duration);
+}
+
+template <class clock_type>
+void
+Slot<clock_type>::reset (PublicKey const& validator)
+{
+    for (auto& p : peers_)
+    {
+        if (p.second.state == State::squelched)
+            handler_.unsquelch (validator, p.first);
+        p.second.state = State::counting;
+        p.second.count = 0;
+    }
+    considered_.clear ();
+    selected_ = false;
+}
+
+
+template <class clock_type>
+class Slots
+{
+public:
+    using time_point = typename clock_type::time_point;
+
+    explicit
+    Slots (SquelchHandler& handler)
+        : handler_ (handler)
+    {
+    }
+
+    void
+    update (PublicKey const& validator, Peer::id_t id, time_point now)
+    {
+        auto it = slots_.find (validator);
+        if (it == slots_.end ())
+            it = slots_.emplace (validator, Slot<clock_type> (handler_)).first;
+        it->second.update (validator, id, now);
+    }
+
+    void
+    deleteIdlePeers (time_point now)
+    {
+        for (auto it = slots_.begin (); it != slots_.end ();)
+        {
+            it->second.deleteIdlePeers (it->first, now);
+            if (it->second.empty ())
+                it = slots_.erase (it);
+            else
+                ++it;
+        }
+    }
+
+    void
+    deletePeer (Peer::id_t id)
+    {
+        for (auto& slot : slots_)
+            slot.second.deletePeer (slot.first, id);
+    }
+
+    std::set<Peer::id_t>
+    getSelected (PublicKey const& validator) const
+    {
+        auto const it = slots_.find (validator);
+        if (it == slots_.end ())
+            return {};
+        return it->second.getSelected ();
+    }
+
+    std::size_t
+    size () const
+    {
+        return slots_.size ();
+    }
+
+private:
+    SquelchHandler& handler_;
+    std::map<PublicKey, Slot<clock_type>> slots_;
+};
+
+}
+}
+
+#endif
@@ -66,6 +66,7 @@ buildHello (
     uint256 const& sharedValue,
     beast::IP::Address public_ip,
     beast::IP::Endpoint remote,
+    bool reduceRelay,
     Application& app)
 {
     protocol::TMHello h;
@@ -95,6 +96,12 @@ buildHello (
 
     h.set_nodeprivate (true);
 
+    if (app.config().COMPRESSION)
+        h.set_compression (true);
+
+    if (reduceRelay)
+        h.set_reducerelay (true);
+
     auto const closedLedger = app.getLedgerMaster().getClosedLedger();
 
     assert(! closedLedger->open());
@@ -138,6 +145,12 @@ appendHello (boost::beast::http::fields& h,
 
     if (hello.has_remote_ip())
         h.insert ("Remote-IP", hello.remote_ip_str());
+
+    if (hello.has_compression() && hello.compression())
+        h.insert ("Compression", "lz4");
+
+    if (hello.has_reducerelay() && hello.reducerelay())
+        h.insert ("Reduce-Relay", "1");
 }
 
 std::vector<ProtocolVersion>
@@ -287,6 +300,24 @@ parseHello (bool request, boost::beast::http::fields const& h, beast::Journal jo
         }
     }
 
+    {
+        auto const iter = h.find ("Compression");
+        if (iter != h.end())
+        {
+            for (auto const& s : beast::rfc2616::split_commas(iter->value()))
+            {
+                if (s == "lz4")
+                    hello.set_compression (true);
+            }
+        }
+    }
+
+    {
+        auto const iter = h.find ("Reduce-Relay");
+        if (iter != h.end() && iter->value() == "1")
+            hello.set_reducerelay (true);
+    }
+
     return hello;
 }
 
@@ -28,7 +28,7 @@ makeSharedValue (SSL* ssl, beast::Journal journal);
 protocol::TMHello
 buildHello (uint256 const& sharedValue,
     beast::IP::Address public_ip,
-    beast::IP::Endpoint remote, Application& app);
+    beast::IP::Endpoint remote, bool reduceRelay, Application& app);
 
 
 void
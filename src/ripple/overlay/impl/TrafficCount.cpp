@@ -21,7 +21,8 @@ TrafficCount::category TrafficCount::categorize (
 
     if ((type == protocol::mtENDPOINTS) ||
             (type == protocol::mtPEERS) ||
-            (type == protocol::mtGET_PEERS))
+            (type == protocol::mtGET_PEERS) ||
+            (type == protocol::mtSQUELCH))
         return TrafficCount::category::overlay;
 
     if ((type == protocol::mtGET_SHARD_INFO) ||
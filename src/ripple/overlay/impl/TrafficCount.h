@@ -25,6 +25,11 @@ public:
         std::atomic<std::uint64_t> messagesIn {0};
         std::atomic<std::uint64_t> messagesOut {0};
 
+        std::atomic<std::uint64_t> compressedIn {0};
+        std::atomic<std::uint64_t> compressedOut {0};
+        std::atomic<std::uint64_t> uncompressedIn {0};
+        std::atomic<std::uint64_t> uncompressedOut {0};
+
         TrafficStats(char const* n)
             : name (n)
         {
@@ -36,6 +41,10 @@ public:
             , bytesOut (ts.bytesOut.load())
             , messagesIn (ts.messagesIn.load())
             , messagesOut (ts.messagesOut.load())
+            , compressedIn (ts.compressedIn.load())
+            , compressedOut (ts.compressedOut.load())
+            , uncompressedIn (ts.uncompressedIn.load())
+            , uncompressedOut (ts.uncompressedOut.load())
         {
         }
 
@@ -114,7 +123,8 @@ public:
         int type, bool inbound);
 
     
-    void addCount (category cat, bool inbound, int bytes)
+    void addCount (category cat, bool inbound, int bytes,
+        int uncompressed = 0)
     {
         assert (cat <= category::unknown);
 
@@ -122,11 +132,21 @@ public:
         {
             counts_[cat].bytesIn += bytes;
             ++counts_[cat].messagesIn;
+            if (uncompressed != 0)
+            {
+                counts_[cat].compressedIn += bytes;
+                counts_[cat].uncompressedIn += uncompressed;
+            }
         }
         else
         {
             counts_[cat].bytesOut += bytes;
             ++counts_[cat].messagesOut;
+            if (uncompressed != 0)
+            {
+                counts_[cat].compressedOut += bytes;
+                counts_[cat].uncompressedOut += uncompressed;
+            }
         }
     }
 
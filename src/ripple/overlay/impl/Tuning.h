@@ -50,6 +50,12 @@ enum
 
     
     sendQueueLogFreq    =    64,
+
+    
+    sendBatchMessages   =    32,
+
+    
+    sendBatchBytes      = 16384,
 };
 
 
@@ -80,6 +80,7 @@ JSS ( account_hash );
 JSS ( account_id );                 
 JSS ( account_objects );            
 JSS ( account_root );               
+JSS ( account_tx_store );           
 JSS ( accounts );                   
 JSS ( accounts_proposed );          
 JSS ( action );
@@ -91,30 +92,38 @@ JSS ( alternatives );
 JSS ( amendment_blocked );          
 JSS ( amendments );                 
 JSS ( amount );                     
+JSS ( apply_us );                   
 JSS ( asks );                       
 JSS ( assets );                     
 JSS ( authorized );                 
 JSS ( auth_change );                
 JSS ( auth_change_queued );         
 JSS ( available );                  
+JSS ( average );                    
 JSS ( balance );                    
 JSS ( balances );                   
 JSS ( base );                       
 JSS ( base_fee );                   
 JSS ( base_fee_xrp );               
+JSS ( batches );                    
 JSS ( bids );                       
 JSS ( binary );                     
 JSS ( books );                      
 JSS ( both );                       
 JSS ( both_sides );                 
+JSS ( budget );                     
 JSS ( build_path );                 
 JSS ( build_version );              
+JSS ( bytes );                      
+JSS ( bytes_avoided );              
+JSS ( caches );                     
 JSS ( cancel_after );               
 JSS ( can_delete );                 
 JSS ( channel_id );                 
 JSS ( channels );                   
 JSS ( check );                      
 JSS ( check_nodes );                
+JSS ( chunks );                     
 JSS ( clear );                      
 JSS ( close_flags );                
 JSS ( close_time );                 
@@ -127,6 +136,7 @@ JSS ( closed_ledger );
 JSS ( cluster );                    
 JSS ( code );                       
 JSS ( command );                    
+JSS ( compactions );                
 JSS ( complete );                   
 JSS ( complete_ledgers );           
 JSS ( complete_shards );            
@@ -146,6 +156,7 @@ JSS ( dbKBLedger );
 JSS ( dbKBTotal );                  
 JSS ( dbKBTransaction );            
 JSS ( debug_signing );              
+JSS ( deferred );                   
 JSS ( delivered_amount );           
 JSS ( deposit_authorized );         
 JSS ( deposit_preauth );            
@@ -165,12 +176,14 @@ JSS ( enabled );
 JSS ( engine_result );              
 JSS ( engine_result_code );         
 JSS ( engine_result_message );      
+JSS ( entries );                    
 JSS ( error );                      
 JSS ( errored );
 JSS ( error_code );                 
 JSS ( error_exception );            
 JSS ( error_message );              
 JSS ( escrow );                     
+JSS ( evicted );                    
 JSS ( expand );                     
 JSS ( expected_ledger_size );       
 JSS ( expiration );                 
@@ -185,6 +198,7 @@ JSS ( fee_level );
 JSS ( fee_mult_max );               
 JSS ( fee_ref );                    
 JSS ( fetch_pack );                 
+JSS ( file_size );                  
 JSS ( first );                      
 JSS ( finished );
 JSS ( fix_txns );                   
@@ -202,6 +216,8 @@ JSS ( hashes );
 JSS ( have_header );                
 JSS ( have_state );                 
 JSS ( have_transactions );          
+JSS ( heap_bytes );                 
+JSS ( heap_count );                 
 JSS ( highest_sequence );           
 JSS ( historical_perminute );       
 JSS ( hostid );                     
@@ -210,12 +226,14 @@ JSS ( id );
 JSS ( ident );                      
 JSS ( inLedger );                   
 JSS ( inbound );                    
+JSS ( incomplete );                 
 JSS ( index );                      
 JSS ( info );                       
 JSS ( internal_command );           
 JSS ( io_latency_ms );              
 JSS ( ip );                         
 JSS ( issuer );                     
+JSS ( item_size );                  
 JSS ( job );
 JSS ( job_queue );
 JSS ( jobs );
@@ -223,15 +241,18 @@ JSS ( jsonrpc );
 JSS ( jq_trans_overflow );          
 JSS ( key );                        
 JSS ( key_type );                   
+JSS ( lag_ledgers );                
 JSS ( latency );                    
 JSS ( last );                       
 JSS ( last_close );                 
 JSS ( last_refresh_time );          
 JSS ( last_refresh_status );        
 JSS ( last_refresh_message );       
+JSS ( latency_ms );                 
 JSS ( ledger );                     
 JSS ( ledger_current_index );       
 JSS ( ledger_data );                
+JSS ( ledger_db_writer );           
 JSS ( ledger_hash );                
 JSS ( ledger_hit_rate );            
 JSS ( ledger_index );               
@@ -240,9 +261,11 @@ JSS ( ledger_index_min );
 JSS ( ledger_max );                 
 JSS ( ledger_min );                 
 JSS ( ledger_time );                
+JSS ( ledgers );                    
 JSS ( levels );                     
 JSS ( limit );                      
 JSS ( limit_peer );                 
+JSS ( line_hit_rate );              
 JSS ( lines );                      
 JSS ( list );                       
 JSS ( load );                       
@@ -257,21 +280,25 @@ JSS ( load_factor_net );
 JSS ( load_factor_server );         
 JSS ( load_fee );                   
 JSS ( local );                      
+JSS ( local_nodes );                
 JSS ( local_txs );                  
 JSS ( local_static_keys );          
 JSS ( lowest_sequence );            
 JSS ( majority );                   
+JSS ( marginal_hits );              
 JSS ( marker );                     
 JSS ( master_key );                 
 JSS ( master_seed );                
 JSS ( master_seed_hex );            
 JSS ( master_signature );           
+JSS ( max_batch );                  
 JSS ( max_ledger );                 
 JSS ( max_queue_size );             
 JSS ( max_spend_drops );            
 JSS ( max_spend_drops_total );      
 JSS ( median_fee );                 
 JSS ( median_level );               
+JSS ( memory_governor );            
 JSS ( message );                    
 JSS ( meta );                       
 JSS ( metaData );
@@ -287,6 +314,7 @@ JSS ( name );
 JSS ( needed_state_hashes );        
 JSS ( needed_transaction_hashes );  
 JSS ( network_ledger );             
+JSS ( network_nodes );              
 JSS ( next_refresh_time );          
 JSS ( no_ripple );                  
 JSS ( no_ripple_peer );             
@@ -307,18 +335,22 @@ JSS ( offset );
 JSS ( open );                       
 JSS ( open_ledger_fee );            
 JSS ( open_ledger_level );          
+JSS ( over_budget );                
 JSS ( owner );                      
 JSS ( owner_funds );                
 JSS ( params );                     
 JSS ( parent_close_time );          
 JSS ( parent_hash );                
 JSS ( partition );                  
+JSS ( passes );                     
 JSS ( passphrase );                 
 JSS ( password );                   
+JSS ( path_requests );              
 JSS ( paths );                      
 JSS ( paths_canonical );            
 JSS ( paths_computed );             
 JSS ( payment_channel );            
+JSS ( peak );                       
 JSS ( peer );                       
 JSS ( peer_authorized );            
 JSS ( peer_id );                    
@@ -326,6 +358,7 @@ JSS ( peers );
 JSS ( peer_disconnects );           
 JSS ( peer_disconnects_resources ); 
 JSS ( port );                       
+JSS ( preflight_us );               
 JSS ( previous_ledger );            
 JSS ( proof );                      
 JSS ( propose_seq );                
@@ -349,15 +382,21 @@ JSS ( queued_duration_us );
 JSS ( random );                     
 JSS ( raw_meta );                   
 JSS ( receive_currencies );         
+JSS ( reclaimed );                  
+JSS ( reference_ledger );           
 JSS ( reference_level );            
 JSS ( refresh_interval_min );       
 JSS ( regular_seed );               
 JSS ( remote );                     
+JSS ( rendered );                   
+JSS ( rendered_bytes );             
 JSS ( request );                    
+JSS ( requests );                   
 JSS ( reserve_base );               
 JSS ( reserve_base_xrp );           
 JSS ( reserve_inc );                
 JSS ( reserve_inc_xrp );            
+JSS ( reserved_bytes );             
 JSS ( response );                   
 JSS ( result );                     
 JSS ( ripple_lines );               
@@ -372,6 +411,7 @@ JSS ( search_depth );
 JSS ( secret );                     
 JSS ( seed );                       
 JSS ( seed_hex );                   
+JSS ( segments );                   
 JSS ( send_currencies );            
 JSS ( send_max );                   
 JSS ( seq );                        
@@ -381,7 +421,9 @@ JSS ( server_state_duration_us );
 JSS ( server_status );              
 JSS ( settle_delay );               
 JSS ( severity );                   
+JSS ( shamap_items );               
 JSS ( shards );                     
+JSS ( shared );                     
 JSS ( signature );                  
 JSS ( signature_verified );         
 JSS ( signing_key );                
@@ -389,6 +431,7 @@ JSS ( signing_keys );
 JSS ( signing_time );               
 JSS ( signer_list );                
 JSS ( signer_lists );               
+JSS ( slabs );                      
 JSS ( snapshot );                   
 JSS ( source_account );             
 JSS ( source_amount );              
@@ -402,6 +445,8 @@ JSS ( state_accounting );
 JSS ( state_now );                  
 JSS ( status );                     
 JSS ( stop );                       
+JSS ( stream );                     
+JSS ( stream_messages );            
 JSS ( streams );                    
 JSS ( strict );                     
 JSS ( sub_index );                  
@@ -433,6 +478,7 @@ JSS ( treenode_track_size );
 JSS ( trusted );                    
 JSS ( trusted_validator_keys );     
 JSS ( tx );                         
+JSS ( tx_apply );                   
 JSS ( tx_blob );                    
 JSS ( tx_hash );                    
 JSS ( tx_json );                    
@@ -444,6 +490,7 @@ JSS ( type );
 JSS ( type_hex );                   
 JSS ( unl );                        
 JSS ( unlimited);                   
+JSS ( updates );                    
 JSS ( uptime );                     
 JSS ( uri );                        
 JSS ( url );                        
@@ -2,19 +2,25 @@
 
 #include <ripple/app/ledger/AcceptedLedger.h>
 #include <ripple/app/ledger/InboundLedgers.h>
+#include <ripple/app/ledger/LedgerDBWriter.h>
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/main/Application.h>
+#include <ripple/app/misc/AccountTxStore.h>
 #include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/app/paths/PathRequests.h>
+#include <ripple/basics/MemoryGovernor.h>
 #include <ripple/basics/UptimeClock.h>
 #include <ripple/core/DatabaseCon.h>
 #include <ripple/json/json_value.h>
 #include <ripple/ledger/CachedSLEs.h>
+#include <ripple/net/InfoSub.h>
 #include <ripple/net/RPCErr.h>
 #include <ripple/nodestore/Database.h>
 #include <ripple/nodestore/DatabaseShard.h>
 #include <ripple/protocol/ErrorCodes.h>
 #include <ripple/protocol/jss.h>
 #include <ripple/rpc/Context.h>
+#include <ripple/shamap/SHAMapItem.h>
 
 namespace ripple {
 
@@ -86,6 +92,36 @@ Json::Value getCountsJson(Application& app, int minObjectCount)
     ret[jss::treenode_cache_size] = app.family().treecache().getCacheSize();
     ret[jss::treenode_track_size] = app.family().treecache().getTrackSize();
 
+    {
+        auto const stats = getSHAMapItemStats ();
+        Json::Value& items = (ret[jss::shamap_items] = Json::objectValue);
+        Json::Value& slabs = (items[jss::slabs] = Json::arrayValue);
+        for (auto const& slab : stats.slabs)
+        {
+            Json::Value& jv = slabs.append (Json::objectValue);
+            jv[jss::item_size] = static_cast<Json::UInt> (slab.size);
+            jv[jss::count] = static_cast<Json::UInt> (slab.count);
+            jv[jss::reserved_bytes] = std::to_string (slab.reserved);
+        }
+        items[jss::heap_count] = static_cast<Json::UInt> (stats.heapCount);
+        items[jss::heap_bytes] = std::to_string (stats.heapBytes);
+    }
+
+    {
+        auto const stats = InfoSubMessage::getStats ();
+        Json::Value& msgs = (ret[jss::stream_messages] = Json::objectValue);
+        msgs[jss::rendered] = std::to_string (stats.rendered);
+        msgs[jss::rendered_bytes] = std::to_string (stats.renderedBytes);
+        msgs[jss::shared] = std::to_string (stats.shared);
+        msgs[jss::bytes_avoided] = std::to_string (stats.bytesAvoided);
+    }
+
+    ret[jss::ledger_db_writer] = app.getLedgerDBWriter ().getJson ();
+    if (auto const store = app.getAccountTxStore ())
+        ret[jss::account_tx_store] = store->getJson ();
+    ret[jss::path_requests] = app.getPathRequests ().getJson ();
+    ret[jss::memory_governor] = app.getMemoryGovernor ().getJson ();
+
     std::string uptime;
     auto s = UptimeClock::now();
     using namespace std::chrono_literals;
@@ -2,16 +2,134 @@
 
 #include <ripple/app/ledger/LedgerToJson.h>
 #include <ripple/ledger/ReadView.h>
+#include <ripple/net/RPCErr.h>
 #include <ripple/protocol/ErrorCodes.h>
 #include <ripple/protocol/jss.h>
 #include <ripple/protocol/LedgerFormats.h>
 #include <ripple/rpc/impl/RPCHelpers.h>
 #include <ripple/rpc/impl/Tuning.h>
+#include <ripple/rpc/impl/WSInfoSub.h>
 #include <ripple/rpc/Context.h>
 #include <ripple/rpc/Role.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
 
 namespace ripple {
 
+static
+void
+addEntry (Json::Value& nodes, SLE const& sle, bool isBinary)
+{
+    if (isBinary)
+    {
+        Json::Value& entry = nodes.append (Json::objectValue);
+        entry[jss::data] = serializeHex(sle);
+        entry[jss::index] = to_string(sle.key());
+    }
+    else
+    {
+        Json::Value& entry = nodes.append (sle.getJson (JsonOptions::none));
+        entry[jss::index] = to_string(sle.key());
+    }
+}
+
+
+// Suspends the coroutine until the session's send queue falls below
+// window.  The session resumes it from its write completion (or close)
+// path, so no job thread is held while the client catches up.  A client
+// that stops reading is closed by the session's ping timeout, which also
+// resumes the walk.
+static
+bool
+waitForDrain (RPC::Context& context, WSInfoSub const& ws, std::size_t window)
+{
+    auto closed = std::make_shared<std::atomic<bool>> (false);
+    while (ws.queued () >= window)
+    {
+        auto const resume = [coro = context.coro, closed] (bool c)
+        {
+            *closed = c;
+            if (! coro->post ())
+                coro->resume ();
+        };
+        if (! ws.whenDrained (window, resume))
+            return false;
+        context.coro->yield ();
+        if (*closed)
+            return false;
+    }
+
+    return ! ws.closed ();
+}
+
+static
+Json::Value
+streamLedgerData (RPC::Context& context, ReadView const& ledger,
+    ReadView::key_type key, LedgerEntryType type, bool isBinary, int limit,
+    Json::Value jvResult)
+{
+    auto ws = std::dynamic_pointer_cast<WSInfoSub> (context.infoSub);
+    if (! ws || ! context.coro)
+        return rpcError (rpcNOT_SUPPORTED);
+
+    auto const window = std::max<std::size_t> (1, ws->queueLimit () / 2);
+    auto const hash = to_string (ledger.info().hash);
+
+    Json::Value chunk;
+    std::uint32_t chunks = 0;
+    int count = 0;
+
+    auto e = ledger.sles.end();
+    auto i = ledger.sles.upper_bound(key);
+    for (; i != e; ++i)
+    {
+        auto const sle = *i;
+        key = sle->key();
+
+        if (count == 0)
+        {
+            chunk = Json::objectValue;
+            chunk[jss::type] = "ledger_data";
+            chunk[jss::ledger_hash] = hash;
+            chunk[jss::ledger_index] = ledger.info().seq;
+            chunk[jss::state] = Json::arrayValue;
+        }
+
+        if (type == ltINVALID || sle->getType () == type)
+            addEntry (chunk[jss::state], *sle, isBinary);
+
+        if (++count < limit)
+            continue;
+
+        chunk[jss::marker] = to_string (key);
+        ws->send (chunk, true);
+        ++chunks;
+        count = 0;
+
+        if (! waitForDrain (context, *ws, window))
+        {
+            ++i;
+            break;
+        }
+    }
+
+    if (count != 0)
+    {
+        chunk[jss::marker] = to_string (key);
+        ws->send (chunk, true);
+        ++chunks;
+    }
+
+    JLOG (context.j.debug()) << "ledger_data streamed " << chunks <<
+        " chunks of ledger " << ledger.info().seq;
+
+    jvResult[jss::chunks] = chunks;
+    if (i != e)
+        jvResult[jss::marker] = to_string (key);
+    return jvResult;
+}
+
 Json::Value doLedgerData (RPC::Context& context)
 {
     std::shared_ptr<ReadView const> lpLedger;
@@ -32,6 +150,16 @@ Json::Value doLedgerData (RPC::Context& context)
 
     bool const isBinary = params[jss::binary].asBool();
 
+    bool isStream = false;
+    if (params.isMember (jss::stream))
+    {
+        Json::Value const& jStream = params[jss::stream];
+        if (! jStream.isBool ())
+            return RPC::expected_field_error (jss::stream, "boolean");
+
+        isStream = jStream.asBool ();
+    }
+
     int limit = -1;
     if (params.isMember (jss::limit))
     {
@@ -63,12 +191,19 @@ Json::Value doLedgerData (RPC::Context& context)
         type.first.inject(jvResult);
         return jvResult;
     }
+
+    if (isStream)
+    {
+        return streamLedgerData (context, *lpLedger, key, type.second,
+            isBinary, std::max (limit, 1), std::move (jvResult));
+    }
+
     Json::Value& nodes = jvResult[jss::state];
 
     auto e = lpLedger->sles.end();
     for (auto i = lpLedger->sles.upper_bound(key); i != e; ++i)
     {
-        auto sle = lpLedger->read(keylet::unchecked((*i)->key()));
+        auto const sle = *i;
         if (limit-- <= 0)
         {
             auto k = sle->key();
@@ -77,19 +212,7 @@ Json::Value doLedgerData (RPC::Context& context)
         }
 
         if (type.second == ltINVALID || sle->getType () == type.second)
-        {
-            if (isBinary)
-            {
-                Json::Value& entry = nodes.append (Json::objectValue);
-                entry[jss::data] = serializeHex(*sle);
-                entry[jss::index] = to_string(sle->key());
-            }
-            else
-            {
-                Json::Value& entry = nodes.append (sle->getJson (JsonOptions::none));
-                entry[jss::index] = to_string(sle->key());
-            }
-        }
+            addEntry (nodes, *sle, isBinary);
     }
 
     return jvResult;
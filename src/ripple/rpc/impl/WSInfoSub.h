@@ -9,6 +9,7 @@
 #include <ripple/json/json_writer.h>
 #include <ripple/rpc/Role.h>
 #include <boost/utility/string_view.hpp>
+#include <functional>
 #include <memory>
 #include <string>
 
@@ -48,6 +49,41 @@ public:
         return fwdfor_;
     }
 
+    bool
+    closed() const
+    {
+        return ws_.expired();
+    }
+
+    std::size_t
+    queued() const
+    {
+        auto sp = ws_.lock();
+        return sp ? sp->queued() : 0;
+    }
+
+    /** Call f once fewer than `below` messages are queued.
+
+        f receives `true` if the session closed instead. Returns false,
+        without calling f, if the session is already gone.
+    */
+    bool
+    whenDrained(std::size_t below, std::function<void(bool)> f) const
+    {
+        auto sp = ws_.lock();
+        if (! sp)
+            return false;
+        sp->whenDrained(below, std::move(f));
+        return true;
+    }
+
+    std::size_t
+    queueLimit() const
+    {
+        auto sp = ws_.lock();
+        return sp ? sp->port().ws_queue_limit : 0;
+    }
+
     void
     send(Json::Value const& jv, bool) override
     {
@@ -66,6 +102,18 @@ public:
                 std::move(sb));
         sp->send(m);
     }
+
+    void
+    send(InfoSubMessage const& msg, bool) override
+    {
+        auto sp = ws_.lock();
+        if(! sp)
+            return;
+        if (getBinary() && msg.hasBinary())
+            sp->send(std::make_shared<SharedBufferWSMsg>(msg.binary(), true));
+        else
+            sp->send(std::make_shared<SharedBufferWSMsg>(msg.serialized()));
+    }
 };
 
 } 
@@ -13,6 +13,7 @@
 #include <algorithm>
 #include <functional>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -32,6 +33,14 @@ public:
         std::vector<boost::asio::const_buffer>>
     prepare(std::size_t bytes,
         std::function<void(void)> resume) = 0;
+
+    
+    virtual
+    bool
+    binary() const
+    {
+        return false;
+    }
 };
 
 template<class Streambuf>
@@ -73,6 +82,52 @@ public:
     }
 };
 
+class SharedBufferWSMsg : public WSMsg
+{
+    std::shared_ptr<std::string const> buf_;
+    std::size_t pos_ = 0;
+    std::size_t n_ = 0;
+    bool binary_;
+
+public:
+    explicit
+    SharedBufferWSMsg(std::shared_ptr<std::string const> buf,
+            bool binary = false)
+        : buf_(std::move(buf))
+        , binary_(binary)
+    {
+    }
+
+    bool
+    binary() const override
+    {
+        return binary_;
+    }
+
+    std::pair<boost::tribool,
+        std::vector<boost::asio::const_buffer>>
+    prepare(std::size_t bytes,
+        std::function<void(void)>) override
+    {
+        if (buf_->empty())
+            return{true, {}};
+        pos_ += n_;
+        auto const remain = buf_->size() - pos_;
+        boost::tribool done;
+        if (bytes < remain)
+        {
+            n_ = bytes;
+            done = false;
+        }
+        else
+        {
+            n_ = remain;
+            done = true;
+        }
+        return{done, {boost::asio::const_buffer(buf_->data() + pos_, n_)}};
+    }
+};
+
 struct WSSession
 {
     std::shared_ptr<void> appDefined;
@@ -103,6 +158,20 @@ struct WSSession
     void
     send(std::shared_ptr<WSMsg> w) = 0;
 
+    
+    virtual
+    std::size_t
+    queued() const = 0;
+
+    /** Call f once queued() falls below the given level.
+
+        If the session closes first, f is called with `true`. It runs on
+        the thread that completes the write, and must not block.
+    */
+    virtual
+    void
+    whenDrained(std::size_t below, std::function<void(bool)> f) = 0;
+
     virtual void
     close() = 0;
 
@@ -12,8 +12,10 @@
 #include <boost/beast/websocket.hpp>
 #include <boost/beast/core/multi_buffer.hpp>
 #include <boost/beast/http/message.hpp>
+#include <atomic>
 #include <cassert>
 #include <functional>
+#include <mutex>
 
 namespace ripple {
 
@@ -37,6 +39,11 @@ private:
     boost::beast::multi_buffer rb_;
     boost::beast::multi_buffer wb_;
     std::list<std::shared_ptr<WSMsg>> wq_;
+    std::atomic<std::size_t> queued_ {0};
+    std::mutex drainMutex_;
+    std::size_t drainBelow_ = 0;
+    std::function<void(bool)> onDrained_;
+    bool drainClosed_ = false;
     bool do_close_ = false;
     boost::beast::websocket::close_reason cr_;
     waitable_timer timer_;
@@ -56,6 +63,8 @@ public:
         boost::beast::http::request<Body, Headers>&& request,
         beast::Journal journal);
 
+    ~BaseWSPeer();
+
     void
     run() override;
 
@@ -81,6 +90,15 @@ public:
     void
     send(std::shared_ptr<WSMsg> w) override;
 
+    std::size_t
+    queued() const override
+    {
+        return queued_.load();
+    }
+
+    void
+    whenDrained(std::size_t below, std::function<void(bool)> f) override;
+
     void
     close() override;
 
@@ -100,6 +118,9 @@ protected:
     void
     on_ws_handshake(error_code const& ec);
 
+    void
+    do_send(std::shared_ptr<WSMsg> w);
+
     void
     do_write();
 
@@ -109,6 +130,9 @@ protected:
     void
     on_write_fin(error_code const& ec);
 
+    void
+    notify_drained(bool closing);
+
     void
     do_read();
 
@@ -162,6 +186,13 @@ BaseWSPeer<Handler, Impl>::BaseWSPeer(
 {
 }
 
+template<class Handler, class Impl>
+BaseWSPeer<Handler, Impl>::
+~BaseWSPeer()
+{
+    notify_drained(true);
+}
+
 template<class Handler, class Impl>
 void
 BaseWSPeer<Handler, Impl>::
@@ -196,20 +227,35 @@ void
 BaseWSPeer<Handler, Impl>::
 send(std::shared_ptr<WSMsg> w)
 {
+    ++queued_;
     if(! strand_.running_in_this_thread())
         return post(
             strand_,
             std::bind(
-                &BaseWSPeer::send, impl().shared_from_this(), std::move(w)));
+                &BaseWSPeer::do_send, impl().shared_from_this(), std::move(w)));
+    do_send(std::move(w));
+}
+
+template<class Handler, class Impl>
+void
+BaseWSPeer<Handler, Impl>::
+do_send(std::shared_ptr<WSMsg> w)
+{
     if(do_close_)
+    {
+        --queued_;
+        notify_drained(false);
         return;
+    }
     if(wq_.size() > port().ws_queue_limit)
     {
         cr_.code = safe_cast<decltype(cr_.code)>
                       (boost::beast::websocket::close_code::policy_error);
         cr_.reason = "Policy error: client is too slow.";
         JLOG(this->j_.info()) << cr_.reason;
+        queued_ -= wq_.size();
         wq_.erase(std::next(wq_.begin()), wq_.end());
+        notify_drained(false);
         close(cr_);
         return;
     }
@@ -218,6 +264,42 @@ send(std::shared_ptr<WSMsg> w)
         on_write({});
 }
 
+template<class Handler, class Impl>
+void
+BaseWSPeer<Handler, Impl>::
+whenDrained(std::size_t below, std::function<void(bool)> f)
+{
+    {
+        std::lock_guard<std::mutex> lock(drainMutex_);
+        assert(! onDrained_);
+        drainBelow_ = below;
+        onDrained_ = std::move(f);
+    }
+    // The write may have completed before the callback was stored.
+    notify_drained(false);
+}
+
+template<class Handler, class Impl>
+void
+BaseWSPeer<Handler, Impl>::
+notify_drained(bool closing)
+{
+    std::function<void(bool)> f;
+    bool closed;
+    {
+        std::lock_guard<std::mutex> lock(drainMutex_);
+        if(closing)
+            drainClosed_ = true;
+        if(! onDrained_ ||
+            (! drainClosed_ && queued_.load() >= drainBelow_))
+            return;
+        f = std::move(onDrained_);
+        onDrained_ = nullptr;
+        closed = drainClosed_;
+    }
+    f(closed);
+}
+
 template <class Handler, class Impl>
 void
 BaseWSPeer<Handler, Impl>::close()
@@ -301,6 +383,7 @@ on_write(error_code const& ec)
     if(boost::indeterminate(result.first))
         return;
     start_timer();
+    impl().ws_.binary(w.binary());
     if(! result.first)
         impl().ws_.async_write_some(
             static_cast<bool>(result.first),
@@ -331,6 +414,8 @@ on_write_fin(error_code const& ec)
     if(ec)
         return fail(ec, "write_fin");
     wq_.pop_front();
+    --queued_;
+    notify_drained(false);
     if(do_close_)
         impl().ws_.async_close(
             cr_,
@@ -387,6 +472,7 @@ BaseWSPeer<Handler, Impl>::
 on_close(error_code const& ec)
 {
     cancel_timer();
+    notify_drained(true);
 }
 
 template<class Handler, class Impl>
@@ -498,6 +584,7 @@ fail(error_code ec, String const& what)
     assert(strand_.running_in_this_thread());
 
     cancel_timer();
+    notify_drained(true);
     if(! ec_ &&
         ec != boost::asio::error::operation_aborted)
     {
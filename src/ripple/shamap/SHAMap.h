@@ -20,6 +20,7 @@
 #include <boost/thread/shared_lock_guard.hpp>
 #include <boost/thread/shared_mutex.hpp>
 #include <cassert>
+#include <functional>
 #include <stack>
 #include <vector>
 
@@ -51,6 +52,8 @@ private:
     bool                            backed_ = true; 
     bool                            full_ = false; 
 
+    static constexpr int            parallelFlushDepth = 2;
+
 public:
     class version
     {
@@ -64,8 +67,8 @@ public:
             {return !(x == y);}
     };
 
-    using DeltaItem = std::pair<std::shared_ptr<SHAMapItem const>,
-                                std::shared_ptr<SHAMapItem const>>;
+    using DeltaItem = std::pair<boost::intrusive_ptr<SHAMapItem const>,
+                                boost::intrusive_ptr<SHAMapItem const>>;
     using Delta     = std::map<uint256, DeltaItem>;
 
     ~SHAMap ();
@@ -115,18 +118,17 @@ public:
 
     bool hasItem (uint256 const& id) const;
     bool delItem (uint256 const& id);
-    bool addItem (SHAMapItem&& i, bool isTransaction, bool hasMeta);
     SHAMapHash getHash () const;
 
-    bool updateGiveItem (std::shared_ptr<SHAMapItem const> const&,
+    bool updateGiveItem (boost::intrusive_ptr<SHAMapItem const> const&,
                          bool isTransaction, bool hasMeta);
-    bool addGiveItem (std::shared_ptr<SHAMapItem const> const&,
+    bool addGiveItem (boost::intrusive_ptr<SHAMapItem const> const&,
                       bool isTransaction, bool hasMeta);
 
-    std::shared_ptr<SHAMapItem const> const& peekItem (uint256 const& id) const;
-    std::shared_ptr<SHAMapItem const> const&
+    boost::intrusive_ptr<SHAMapItem const> const& peekItem (uint256 const& id) const;
+    boost::intrusive_ptr<SHAMapItem const> const&
         peekItem (uint256 const& id, SHAMapHash& hash) const;
-    std::shared_ptr<SHAMapItem const> const&
+    boost::intrusive_ptr<SHAMapItem const> const&
         peekItem (uint256 const& id, SHAMapTreeNode::TNType & type) const;
 
     const_iterator upper_bound(uint256 const& id) const;
@@ -141,12 +143,19 @@ public:
 
     
     void visitLeaves(std::function<void (
-        std::shared_ptr<SHAMapItem const> const&)> const&) const;
+        boost::intrusive_ptr<SHAMapItem const> const&)> const&) const;
 
 
-    
+    /** Find nodes this map still needs.
+
+        Subtrees that `have` also holds are marked full below instead of
+        being walked. `have` must use the same Family as this map, since
+        only its node store can serve those subtrees; a reference map from
+        another Family is ignored.
+    */
     std::vector<std::pair<SHAMapNodeID, uint256>>
-    getMissingNodes (int maxNodes, SHAMapSyncFilter *filter);
+    getMissingNodes (int maxNodes, SHAMapSyncFilter *filter,
+        SHAMap const* have = nullptr, int* localNodes = nullptr);
 
     bool getNodeFat (SHAMapNodeID node,
         std::vector<SHAMapNodeID>& nodeIDs,
@@ -170,7 +179,13 @@ public:
     bool compare (SHAMap const& otherMap,
                   Delta& differences, int maxCount) const;
 
+    using FlushScheduler = std::function<bool(std::function<void()>)>;
+
     int flushDirty (NodeObjectType t, std::uint32_t seq);
+
+    
+    int flushDirty (NodeObjectType t, std::uint32_t seq,
+        int helpers, FlushScheduler const& schedule);
     void walkMap (std::vector<SHAMapMissingNode>& missingNodes, int maxMissing) const;
     bool deepCompare (SHAMap & other) const;  
 
@@ -192,8 +207,8 @@ public:
 private:
     using SharedPtrNodeStack =
         std::stack<std::pair<std::shared_ptr<SHAMapAbstractNode>, SHAMapNodeID>>;
-    using DeltaRef = std::pair<std::shared_ptr<SHAMapItem const> const&,
-                               std::shared_ptr<SHAMapItem const> const&>;
+    using DeltaRef = std::pair<boost::intrusive_ptr<SHAMapItem const> const&,
+                               boost::intrusive_ptr<SHAMapItem const> const&>;
 
     std::shared_ptr<SHAMapAbstractNode> getCache (SHAMapHash const& hash) const;
     void canonicalize (SHAMapHash const& hash, std::shared_ptr<SHAMapAbstractNode>&) const;
@@ -252,7 +267,7 @@ private:
         descendNoStore (std::shared_ptr<SHAMapInnerNode> const&, int branch) const;
 
     
-    std::shared_ptr<SHAMapItem const> const& onlyBelow (SHAMapAbstractNode*) const;
+    boost::intrusive_ptr<SHAMapItem const> const& onlyBelow (SHAMapAbstractNode*) const;
 
     bool hasInnerNode (SHAMapNodeID const& nodeID, SHAMapHash const& hash) const;
     bool hasLeafNode (uint256 const& tag, SHAMapHash const& hash) const;
@@ -260,9 +275,20 @@ private:
     SHAMapTreeNode const* peekFirstItem(SharedPtrNodeStack& stack) const;
     SHAMapTreeNode const* peekNextItem(uint256 const& id, SharedPtrNodeStack& stack) const;
     bool walkBranch (SHAMapAbstractNode* node,
-                     std::shared_ptr<SHAMapItem const> const& otherMapItem,
+                     boost::intrusive_ptr<SHAMapItem const> const& otherMapItem,
                      bool isFirstMap, Delta & differences, int & maxCount) const;
-    int walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq);
+    int walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq,
+        int helpers, FlushScheduler const* schedule);
+    int walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq,
+        std::shared_ptr<SHAMapInnerNode>& node) const;
+    int walkSubTreeParallel (bool doWrite, NodeObjectType t, std::uint32_t seq,
+        int helpers, FlushScheduler const& schedule,
+            std::shared_ptr<SHAMapInnerNode>& root) const;
+    int flushLeaf (bool doWrite, NodeObjectType t, std::uint32_t seq,
+        SHAMapInnerNode& parent, int branch,
+            std::shared_ptr<SHAMapAbstractNode> leaf) const;
+    int flushInner (bool doWrite, NodeObjectType t, std::uint32_t seq,
+        std::shared_ptr<SHAMapInnerNode>& node) const;
     bool isInconsistentNode(std::shared_ptr<SHAMapAbstractNode> const& node) const;
 
     struct MissingNodes
@@ -275,6 +301,8 @@ private:
         SHAMapSyncFilter* filter_;
         int const         maxDefer_;
         std::uint32_t     generation_;
+        SHAMap const*     have_;
+        int*              localNodes_;
 
         std::vector<std::pair<SHAMapNodeID, uint256>> missingNodes_;
         std::set <SHAMapHash>                         missingHashes_;
@@ -294,9 +322,11 @@ private:
 
         MissingNodes (
             int max, SHAMapSyncFilter* filter,
-            int maxDefer, std::uint32_t generation) :
+            int maxDefer, std::uint32_t generation,
+            SHAMap const* have, int* localNodes) :
                 max_(max), filter_(filter),
-                maxDefer_(maxDefer), generation_(generation)
+                maxDefer_(maxDefer), generation_(generation),
+                have_(have), localNodes_(localNodes)
         {
             missingNodes_.reserve (max);
             deferredReads_.reserve(maxDefer);
@@ -304,6 +334,8 @@ private:
     };
 
     void gmn_ProcessNodes (MissingNodes&, MissingNodes::StackEntry& node);
+    bool gmn_Shared (MissingNodes&, SHAMapNodeID const& nodeID,
+        SHAMapHash const& hash);
     void gmn_ProcessDeferredReads (MissingNodes&);
 };
 
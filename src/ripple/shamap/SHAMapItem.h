@@ -1,59 +1,105 @@
-
-
 #ifndef RIPPLE_SHAMAP_SHAMAPITEM_H_INCLUDED
 #define RIPPLE_SHAMAP_SHAMAPITEM_H_INCLUDED
 
 #include <ripple/basics/base_uint.h>
 #include <ripple/basics/Blob.h>
+#include <ripple/basics/SlabAllocator.h>
 #include <ripple/basics/Slice.h>
 #include <ripple/protocol/Serializer.h>
 #include <ripple/beast/utility/Journal.h>
+#include <boost/intrusive_ptr.hpp>
 
+#include <atomic>
 #include <cstddef>
+#include <vector>
 
 namespace ripple {
 
 class SHAMapItem
 {
 private:
-    uint256    tag_;
-    Blob       data_;
+    uint256 const                         tag_;
+    std::uint32_t const                   size_;
+    mutable std::atomic<std::uint32_t>    refcount_;
+
+    SHAMapItem (uint256 const& tag, Slice data);
+
+    friend
+    boost::intrusive_ptr<SHAMapItem const>
+    make_shamapitem (uint256 const& tag, Slice data);
+
+    friend void intrusive_ptr_add_ref (SHAMapItem const* x);
+    friend void intrusive_ptr_release (SHAMapItem const* x);
 
 public:
-    SHAMapItem (uint256 const& tag, Blob const & data);
-    SHAMapItem (uint256 const& tag, Serializer const& s);
-    SHAMapItem (uint256 const& tag, Serializer&& s);
+    SHAMapItem (SHAMapItem const&) = delete;
+    SHAMapItem& operator= (SHAMapItem const&) = delete;
 
     Slice slice() const;
 
     uint256 const& key() const;
 
-    Blob const& peekData() const;
-
     std::size_t size() const;
     void const* data() const;
 };
 
+struct SHAMapItemStats
+{
+    std::vector<SlabAllocator::Stats> slabs;
+    std::size_t heapCount;
+    std::size_t heapBytes;
+};
+
+
+boost::intrusive_ptr<SHAMapItem const>
+make_shamapitem (uint256 const& tag, Slice data);
+
+inline
+boost::intrusive_ptr<SHAMapItem const>
+make_shamapitem (uint256 const& tag, Serializer const& s)
+{
+    return make_shamapitem (tag, s.slice ());
+}
+
+inline
+boost::intrusive_ptr<SHAMapItem const>
+make_shamapitem (uint256 const& tag, Blob const& data)
+{
+    return make_shamapitem (tag, makeSlice (data));
+}
+
+SHAMapItemStats
+getSHAMapItemStats ();
+
+inline
+void
+intrusive_ptr_add_ref (SHAMapItem const* x)
+{
+    x->refcount_.fetch_add (1, std::memory_order_relaxed);
+}
+
+void
+intrusive_ptr_release (SHAMapItem const* x);
 
 inline
 Slice
 SHAMapItem::slice() const
 {
-    return {data_.data(), data_.size()};
+    return {data(), size_};
 }
 
 inline
 std::size_t
 SHAMapItem::size() const
 {
-    return data_.size();
+    return size_;
 }
 
 inline
 void const*
 SHAMapItem::data() const
 {
-    return data_.data();
+    return this + 1;
 }
 
 inline
@@ -63,13 +109,6 @@ SHAMapItem::key() const
     return tag_;
 }
 
-inline
-Blob const&
-SHAMapItem::peekData() const
-{
-    return data_;
-}
-
 } 
 
 #endif
@@ -8,9 +8,11 @@
 #include <ripple/basics/TaggedCache.h>
 #include <ripple/beast/utility/Journal.h>
 
+#include <array>
+#include <atomic>
+#include <bitset>
 #include <cstdint>
 #include <memory>
-#include <mutex>
 #include <string>
 
 namespace ripple {
@@ -111,6 +113,8 @@ public:
     virtual std::shared_ptr<SHAMapAbstractNode> clone(std::uint32_t seq) const = 0;
     virtual uint256 const& key() const = 0;
     virtual void invariants(bool is_v2, bool is_root = false) const = 0;
+    
+    virtual std::size_t getBytes () const = 0;
 
     static std::shared_ptr<SHAMapAbstractNode>
         make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat format,
@@ -123,12 +127,23 @@ class SHAMapInnerNodeV2;
 class SHAMapInnerNode
     : public SHAMapAbstractNode
 {
-    std::array<SHAMapHash, 16>          mHashes;
-    std::shared_ptr<SHAMapAbstractNode> mChildren[16];
-    int                             mIsBranch = 0;
+    std::unique_ptr<SHAMapHash[]>                          mHashes;
+    std::unique_ptr<std::shared_ptr<SHAMapAbstractNode>[]> mChildren;
+    std::uint16_t                   mIsBranch = 0;
+    std::atomic<std::uint16_t>      mPublished {0};
+    std::uint8_t                    mCapacity = 0;
+    std::atomic_flag                mLock = ATOMIC_FLAG_INIT;
     std::uint32_t                   mFullBelowGen = 0;
 
-    static std::mutex               childLock;
+    static int constexpr denseCapacity = 16;
+
+    static int capacityFor (int count);
+    int slot (int m) const;
+    void resize (int capacity);
+    void setHashes (std::array<SHAMapHash, 16> const& hashes);
+    void copyBranches (SHAMapInnerNode& to) const;
+    void insertBranch (int m, std::shared_ptr<SHAMapAbstractNode> const& child);
+    void removeBranch (int m);
 public:
     SHAMapInnerNode(std::uint32_t seq);
     std::shared_ptr<SHAMapAbstractNode> clone(std::uint32_t seq) const override;
@@ -154,6 +169,7 @@ public:
     std::string getString (SHAMapNodeID const&) const override;
     uint256 const& key() const override;
     void invariants(bool is_v2, bool is_root = false) const override;
+    std::size_t getBytes () const override;
 
     friend std::shared_ptr<SHAMapAbstractNode>
         SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq,
@@ -188,6 +204,7 @@ public:
     std::shared_ptr<SHAMapAbstractNode>
         canonicalizeChild (int branch, std::shared_ptr<SHAMapAbstractNode> node) override;
     void invariants(bool is_v2, bool is_root = false) const override;
+    std::size_t getBytes () const override;
 
     friend std::shared_ptr<SHAMapAbstractNode>
         SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq,
@@ -199,35 +216,43 @@ class SHAMapTreeNode
     : public SHAMapAbstractNode
 {
 private:
-    std::shared_ptr<SHAMapItem const> mItem;
+    boost::intrusive_ptr<SHAMapItem const> mItem;
 
 public:
     SHAMapTreeNode (const SHAMapTreeNode&) = delete;
     SHAMapTreeNode& operator= (const SHAMapTreeNode&) = delete;
 
-    SHAMapTreeNode (std::shared_ptr<SHAMapItem const> const& item,
+    SHAMapTreeNode (boost::intrusive_ptr<SHAMapItem const> const& item,
                     TNType type, std::uint32_t seq);
-    SHAMapTreeNode(std::shared_ptr<SHAMapItem const> const& item, TNType type,
+    SHAMapTreeNode(boost::intrusive_ptr<SHAMapItem const> const& item, TNType type,
                    std::uint32_t seq, SHAMapHash const& hash);
     std::shared_ptr<SHAMapAbstractNode> clone(std::uint32_t seq) const override;
 
     void addRaw (Serializer&, SHANodeFormat format) const override;
     uint256 const& key() const override;
     void invariants(bool is_v2, bool is_root = false) const override;
+    std::size_t getBytes () const override;
 
 public:  
 
     bool isInnerNode () const;
 
     bool hasItem () const;
-    std::shared_ptr<SHAMapItem const> const& peekItem () const;
-    bool setItem (std::shared_ptr<SHAMapItem const> const& i, TNType type);
+    boost::intrusive_ptr<SHAMapItem const> const& peekItem () const;
+    bool setItem (boost::intrusive_ptr<SHAMapItem const> const& i, TNType type);
 
     std::string getString (SHAMapNodeID const&) const override;
     bool updateHash () override;
 };
 
 
+inline
+std::size_t
+cacheBytes (SHAMapAbstractNode const& node)
+{
+    return node.getBytes ();
+}
+
 inline
 SHAMapAbstractNode::SHAMapAbstractNode(TNType type, std::uint32_t seq)
     : mType(type)
@@ -315,12 +340,25 @@ SHAMapInnerNode::isEmptyBranch (int m) const
     return (mIsBranch & (1 << m)) == 0;
 }
 
+inline
+int
+SHAMapInnerNode::slot (int m) const
+{
+    if (mCapacity == denseCapacity)
+        return m;
+    return static_cast<int>(
+        std::bitset<16>(mIsBranch & ((1u << m) - 1)).count());
+}
+
 inline
 SHAMapHash const&
 SHAMapInnerNode::getChildHash (int m) const
 {
     assert ((m >= 0) && (m < 16) && (getType() == tnINNER));
-    return mHashes[m];
+    static SHAMapHash const zero;
+    if (isEmptyBranch (m))
+        return zero;
+    return mHashes[slot (m)];
 }
 
 inline
@@ -381,7 +419,7 @@ SHAMapTreeNode::hasItem () const
 }
 
 inline
-std::shared_ptr<SHAMapItem const> const&
+boost::intrusive_ptr<SHAMapItem const> const&
 SHAMapTreeNode::peekItem () const
 {
     return mItem;
@@ -5,12 +5,13 @@
 
 #include <ripple/shamap/TreeNodeCache.h>
 #include <ripple/shamap/SHAMapTreeNode.h>
+#include <ripple/basics/PartitionedTaggedCache.h>
 
 namespace ripple {
 
 class SHAMapAbstractNode;
 
-using TreeNodeCache = TaggedCache <uint256, SHAMapAbstractNode>;
+using TreeNodeCache = PartitionedTaggedCache <uint256, SHAMapAbstractNode>;
 
 } 
 
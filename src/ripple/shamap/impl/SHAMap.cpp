@@ -2,6 +2,11 @@
 
 #include <ripple/basics/contract.h>
 #include <ripple/shamap/SHAMap.h>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
 
 namespace ripple {
 
@@ -549,9 +554,9 @@ SHAMap::firstBelow(std::shared_ptr<SHAMapAbstractNode> node,
     return nullptr;
 }
 
-static const std::shared_ptr<SHAMapItem const> no_item;
+static const boost::intrusive_ptr<SHAMapItem const> no_item;
 
-std::shared_ptr<SHAMapItem const> const&
+boost::intrusive_ptr<SHAMapItem const> const&
 SHAMap::onlyBelow (SHAMapAbstractNode* node) const
 {
 
@@ -585,9 +590,6 @@ SHAMap::onlyBelow (SHAMapAbstractNode* node) const
     return leaf->peekItem ();
 }
 
-static std::shared_ptr<
-    SHAMapItem const> const nullConstSHAMapItem;
-
 SHAMapTreeNode const*
 SHAMap::peekFirstItem(SharedPtrNodeStack& stack) const
 {
@@ -631,7 +633,7 @@ SHAMap::peekNextItem(uint256 const& id, SharedPtrNodeStack& stack) const
     return nullptr;
 }
 
-std::shared_ptr<SHAMapItem const> const&
+boost::intrusive_ptr<SHAMapItem const> const&
 SHAMap::peekItem (uint256 const& id) const
 {
     SHAMapTreeNode* leaf = findKey(id);
@@ -642,7 +644,7 @@ SHAMap::peekItem (uint256 const& id) const
     return leaf->peekItem ();
 }
 
-std::shared_ptr<SHAMapItem const> const&
+boost::intrusive_ptr<SHAMapItem const> const&
 SHAMap::peekItem (uint256 const& id, SHAMapTreeNode::TNType& type) const
 {
     SHAMapTreeNode* leaf = findKey(id);
@@ -654,7 +656,7 @@ SHAMap::peekItem (uint256 const& id, SHAMapTreeNode::TNType& type) const
     return leaf->peekItem ();
 }
 
-std::shared_ptr<SHAMapItem const> const&
+boost::intrusive_ptr<SHAMapItem const> const&
 SHAMap::peekItem (uint256 const& id, SHAMapHash& hash) const
 {
     SHAMapTreeNode* leaf = findKey(id);
@@ -829,7 +831,7 @@ prefix(unsigned depth, uint256 const& key)
 }
 
 bool
-SHAMap::addGiveItem (std::shared_ptr<SHAMapItem const> const& item,
+SHAMap::addGiveItem (boost::intrusive_ptr<SHAMapItem const> const& item,
                      bool isTransaction, bool hasMeta)
 {
     uint256 tag = item->key();
@@ -914,7 +916,7 @@ SHAMap::addGiveItem (std::shared_ptr<SHAMapItem const> const& item,
         else
         {
             auto leaf = std::static_pointer_cast<SHAMapTreeNode>(node);
-            std::shared_ptr<SHAMapItem const> otherItem = leaf->peekItem ();
+            boost::intrusive_ptr<SHAMapItem const> otherItem = leaf->peekItem ();
             assert (otherItem && (tag != otherItem->key()));
 
             node = std::make_shared<SHAMapInnerNode>(node->getSeq());
@@ -948,13 +950,6 @@ SHAMap::addGiveItem (std::shared_ptr<SHAMapItem const> const& item,
     return true;
 }
 
-bool
-SHAMap::addItem(SHAMapItem&& i, bool isTransaction, bool hasMetaData)
-{
-    return addGiveItem(std::make_shared<SHAMapItem const>(std::move(i)),
-                                                          isTransaction, hasMetaData);
-}
-
 SHAMapHash
 SHAMap::getHash () const
 {
@@ -968,7 +963,7 @@ SHAMap::getHash () const
 }
 
 bool
-SHAMap::updateGiveItem (std::shared_ptr<SHAMapItem const> const& item,
+SHAMap::updateGiveItem (boost::intrusive_ptr<SHAMapItem const> const& item,
                         bool isTransaction, bool hasMeta)
 {
     uint256 tag = item->key();
@@ -1073,23 +1068,27 @@ SHAMap::preFlushNode (std::shared_ptr<Node> node) const
 
 int SHAMap::unshare ()
 {
-    return walkSubTree (false, hotUNKNOWN, 0);
+    return walkSubTree (false, hotUNKNOWN, 0, 0, nullptr);
 }
 
 
 int SHAMap::flushDirty (NodeObjectType t, std::uint32_t seq)
 {
-    return walkSubTree (true, t, seq);
+    return walkSubTree (true, t, seq, 0, nullptr);
 }
 
-int
-SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
+int SHAMap::flushDirty (NodeObjectType t, std::uint32_t seq,
+    int helpers, FlushScheduler const& schedule)
 {
-    int flushed = 0;
-    Serializer s;
+    return walkSubTree (true, t, seq, helpers, &schedule);
+}
 
+int
+SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq,
+    int helpers, FlushScheduler const* schedule)
+{
     if (!root_ || (root_->getSeq() == 0))
-        return flushed;
+        return 0;
 
     if (root_->isLeaf())
     { 
@@ -1113,11 +1112,29 @@ SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
         return 1;
     }
 
+    node = preFlushNode(std::move(node));
+
+    int flushed;
+    if (helpers > 0 && schedule && *schedule)
+        flushed = walkSubTreeParallel (doWrite, t, seq, helpers, *schedule,
+            node);
+    else
+        flushed = walkSubTree (doWrite, t, seq, node);
+
+    root_ = std::move (node);
+
+    return flushed;
+}
+
+int
+SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq,
+    std::shared_ptr<SHAMapInnerNode>& node) const
+{
+    int flushed = 0;
+
     using StackEntry = std::pair <std::shared_ptr<SHAMapInnerNode>, int>;
     std::stack <StackEntry, std::vector<StackEntry>> stack;
 
-    node = preFlushNode(std::move(node));
-
     int pos = 0;
 
     while (1)
@@ -1148,31 +1165,14 @@ SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
                     }
                     else
                     {
-                        ++flushed;
-
-                        assert (node->getSeq() == seq_);
-                        child->updateHash();
-
-                        if (doWrite && backed_)
-                            child = writeNode(t, seq, std::move(child));
-                        else
-                            child->setSeq (0);
-
-                        node->shareChild (branch, child);
+                        flushed += flushLeaf (doWrite, t, seq, *node, branch,
+                            std::move (child));
                     }
                 }
             }
         }
 
-        node->updateHashDeep();
-
-        if (doWrite && backed_)
-            node = std::static_pointer_cast<SHAMapInnerNode>(writeNode(t, seq,
-                                                                       std::move(node)));
-        else
-            node->setSeq (0);
-
-        ++flushed;
+        flushed += flushInner (doWrite, t, seq, node);
 
         if (stack.empty ())
            break;
@@ -1188,11 +1188,176 @@ SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
         ++pos;
     }
 
-    root_ = std::move (node);
-
     return flushed;
 }
 
+int
+SHAMap::walkSubTreeParallel (bool doWrite, NodeObjectType t, std::uint32_t seq,
+    int helpers, FlushScheduler const& schedule,
+        std::shared_ptr<SHAMapInnerNode>& root) const
+{
+    struct Dirty
+    {
+        std::shared_ptr<SHAMapInnerNode> parent;
+        int branch;
+        std::shared_ptr<SHAMapInnerNode> node;
+        bool split;
+        int flushed;
+    };
+
+    // Shared with the helper jobs, which may start only after the
+    // caller has already finished every subtree on its own.
+    struct Work
+    {
+        std::vector<Dirty> dirty;
+        std::atomic<std::size_t> next {0};
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::size_t busy = 0;
+        std::exception_ptr error;
+    };
+
+    int flushed = 0;
+    auto work = std::make_shared<Work> ();
+    auto& dirty = work->dirty;
+    std::size_t subtrees = 0;
+
+    std::function<void(std::shared_ptr<SHAMapInnerNode> const&, int)> split =
+        [&](std::shared_ptr<SHAMapInnerNode> const& node, int depth)
+    {
+        for (int branch = 0; branch < 16; ++branch)
+        {
+            if (node->isEmptyBranch (branch))
+                continue;
+
+            auto child = node->getChild(branch);
+            if (!child || (child->getSeq() == 0))
+                continue;
+
+            child = preFlushNode(std::move(child));
+
+            if (child->isInner ())
+            {
+                auto inner = std::static_pointer_cast<SHAMapInnerNode>(
+                    std::move(child));
+                bool const deeper = depth + 1 < parallelFlushDepth;
+                dirty.push_back ({node, branch, inner, deeper, 0});
+                if (deeper)
+                    split (inner, depth + 1);
+                else
+                    ++subtrees;
+            }
+            else
+            {
+                flushed += flushLeaf (doWrite, t, seq, *node, branch,
+                    std::move (child));
+            }
+        }
+    };
+    split (root, 0);
+
+    if (subtrees != 0)
+    {
+        // A helper that starts after the caller is done claims nothing
+        // and never touches the map.
+        auto flushSome = [this, doWrite, t, seq] (Work& w)
+        {
+            for (;;)
+            {
+                {
+                    std::lock_guard<std::mutex> lock (w.mutex);
+                    ++w.busy;
+                }
+
+                auto const i = w.next++;
+                if (i < w.dirty.size ())
+                {
+                    try
+                    {
+                        auto& d = w.dirty[i];
+                        if (! d.split)
+                            d.flushed = walkSubTree (doWrite, t, seq, d.node);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock (w.mutex);
+                        if (! w.error)
+                            w.error = std::current_exception ();
+                        w.next = w.dirty.size ();
+                    }
+                }
+
+                std::lock_guard<std::mutex> lock (w.mutex);
+                if (--w.busy == 0)
+                    w.cv.notify_all ();
+                if (i >= w.dirty.size ())
+                    return;
+            }
+        };
+
+        auto const count = std::min<std::size_t> (helpers, subtrees - 1);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (! schedule ([work, flushSome] { flushSome (*work); }))
+                break;
+        }
+
+        flushSome (*work);
+
+        std::unique_lock<std::mutex> lock (work->mutex);
+        work->cv.wait (lock, [&work] { return work->busy == 0; });
+
+        if (work->error)
+            std::rethrow_exception (work->error);
+    }
+
+    for (auto it = dirty.rbegin(); it != dirty.rend(); ++it)
+    {
+        if (it->split)
+            flushed += flushInner (doWrite, t, seq, it->node);
+        else
+            flushed += it->flushed;
+
+        assert (it->parent->getSeq() == seq_);
+        it->parent->shareChild (it->branch, it->node);
+    }
+
+    return flushed + flushInner (doWrite, t, seq, root);
+}
+
+int
+SHAMap::flushLeaf (bool doWrite, NodeObjectType t, std::uint32_t seq,
+    SHAMapInnerNode& parent, int branch,
+        std::shared_ptr<SHAMapAbstractNode> leaf) const
+{
+    assert (parent.getSeq() == seq_);
+    leaf->updateHash();
+
+    if (doWrite && backed_)
+        leaf = writeNode(t, seq, std::move(leaf));
+    else
+        leaf->setSeq (0);
+
+    parent.shareChild (branch, leaf);
+    return 1;
+}
+
+int
+SHAMap::flushInner (bool doWrite, NodeObjectType t, std::uint32_t seq,
+    std::shared_ptr<SHAMapInnerNode>& node) const
+{
+    node->updateHashDeep();
+
+    if (doWrite && backed_)
+        node = std::static_pointer_cast<SHAMapInnerNode>(writeNode(t, seq,
+                                                                   std::move(node)));
+    else
+        node->setSeq (0);
+
+    return 1;
+}
+
 void SHAMap::dump (bool hash) const
 {
     int leafCount = 0;
@@ -7,7 +7,7 @@ namespace ripple {
 
 
 bool SHAMap::walkBranch (SHAMapAbstractNode* node,
-                         std::shared_ptr<SHAMapItem const> const& otherMapItem,
+                         boost::intrusive_ptr<SHAMapItem const> const& otherMapItem,
                          bool isFirstMap,Delta& differences, int& maxCount) const
 {
     std::stack <SHAMapAbstractNode*, std::vector<SHAMapAbstractNode*>> nodeStack;
@@ -35,15 +35,15 @@ bool SHAMap::walkBranch (SHAMapAbstractNode* node,
             {
                 if (isFirstMap)
                     differences.insert (std::make_pair (item->key(),
-                        DeltaRef (item, std::shared_ptr<SHAMapItem const> ())));
+                        DeltaRef (item, boost::intrusive_ptr<SHAMapItem const> ())));
                 else
                     differences.insert (std::make_pair (item->key(),
-                        DeltaRef (std::shared_ptr<SHAMapItem const> (), item)));
+                        DeltaRef (boost::intrusive_ptr<SHAMapItem const> (), item)));
 
                 if (--maxCount <= 0)
                     return false;
             }
-            else if (item->peekData () != otherMapItem->peekData ())
+            else if (item->slice () != otherMapItem->slice ())
             {
                 if (isFirstMap)
                     differences.insert (std::make_pair (item->key(),
@@ -68,11 +68,11 @@ bool SHAMap::walkBranch (SHAMapAbstractNode* node,
     {
         if (isFirstMap) 
             differences.insert(std::make_pair(otherMapItem->key(),
-                                              DeltaRef(std::shared_ptr<SHAMapItem const>(),
+                                              DeltaRef(boost::intrusive_ptr<SHAMapItem const>(),
                                                        otherMapItem)));
         else
             differences.insert(std::make_pair(otherMapItem->key(),
-                DeltaRef(otherMapItem, std::shared_ptr<SHAMapItem const>())));
+                DeltaRef(otherMapItem, boost::intrusive_ptr<SHAMapItem const>())));
 
         if (--maxCount <= 0)
             return false;
@@ -113,7 +113,7 @@ SHAMap::compare (SHAMap const& otherMap,
             auto other = static_cast<SHAMapTreeNode*>(otherNode);
             if (ours->peekItem()->key() == other->peekItem()->key())
             {
-                if (ours->peekItem()->peekData () != other->peekItem()->peekData ())
+                if (ours->peekItem()->slice () != other->peekItem()->slice ())
                 {
                     differences.insert (std::make_pair (ours->peekItem()->key(),
                                                  DeltaRef (ours->peekItem (),
@@ -126,12 +126,12 @@ SHAMap::compare (SHAMap const& otherMap,
             {
                 differences.insert (std::make_pair(ours->peekItem()->key(),
                                                    DeltaRef(ours->peekItem(),
-                                                   std::shared_ptr<SHAMapItem const>())));
+                                                   boost::intrusive_ptr<SHAMapItem const>())));
                 if (--maxCount <= 0)
                     return false;
 
                 differences.insert(std::make_pair(other->peekItem()->key(),
-                    DeltaRef(std::shared_ptr<SHAMapItem const>(), other->peekItem ())));
+                    DeltaRef(boost::intrusive_ptr<SHAMapItem const>(), other->peekItem ())));
                 if (--maxCount <= 0)
                     return false;
             }
@@ -163,7 +163,7 @@ SHAMap::compare (SHAMap const& otherMap,
                     {
                         SHAMapAbstractNode* iNode = descendThrow (ours, i);
                         if (!walkBranch (iNode,
-                                         std::shared_ptr<SHAMapItem const> (), true,
+                                         boost::intrusive_ptr<SHAMapItem const> (), true,
                                          differences, maxCount))
                             return false;
                     }
@@ -172,7 +172,7 @@ SHAMap::compare (SHAMap const& otherMap,
                         SHAMapAbstractNode* iNode =
                             otherMap.descendThrow(other, i);
                         if (!otherMap.walkBranch (iNode,
-                                                   std::shared_ptr<SHAMapItem const>(),
+                                                   boost::intrusive_ptr<SHAMapItem const>(),
                                                    false, differences, maxCount))
                             return false;
                     }
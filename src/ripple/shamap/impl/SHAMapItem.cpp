@@ -1,28 +1,117 @@
 
 
-#include <ripple/protocol/Serializer.h>
 #include <ripple/shamap/SHAMapItem.h>
+#include <cstring>
+#include <new>
 
 namespace ripple {
 
-class SHAMap;
+namespace detail {
 
-SHAMapItem::SHAMapItem (uint256 const& tag, Blob const& data)
-    : tag_(tag)
-    , data_(data)
+class SHAMapItemSlabs
 {
+private:
+    std::vector<std::unique_ptr<SlabAllocator>> slabs_;
+    std::atomic<std::size_t> heapCount_ {0};
+    std::atomic<std::size_t> heapBytes_ {0};
+
+    SlabAllocator*
+    find (std::size_t bytes)
+    {
+        for (auto const& slab : slabs_)
+        {
+            if (bytes <= slab->size ())
+                return slab.get ();
+        }
+        return nullptr;
+    }
+
+public:
+    SHAMapItemSlabs ()
+    {
+        for (std::size_t size : {64, 96, 128, 160, 192, 224, 256,
+                320, 384, 448, 512, 640, 768, 1024})
+            slabs_.emplace_back (std::make_unique<SlabAllocator> (size));
+    }
+
+    void*
+    allocate (std::size_t bytes)
+    {
+        if (auto slab = find (bytes))
+            return slab->allocate ();
+
+        ++heapCount_;
+        heapBytes_ += bytes;
+        return ::operator new (bytes);
+    }
+
+    void
+    deallocate (void* p, std::size_t bytes)
+    {
+        if (auto slab = find (bytes))
+            return slab->deallocate (p);
+
+        --heapCount_;
+        heapBytes_ -= bytes;
+        ::operator delete (p);
+    }
+
+    SHAMapItemStats
+    getStats () const
+    {
+        SHAMapItemStats stats;
+        stats.slabs.reserve (slabs_.size ());
+        for (auto const& slab : slabs_)
+            stats.slabs.push_back (slab->getStats ());
+        stats.heapCount = heapCount_.load ();
+        stats.heapBytes = heapBytes_.load ();
+        return stats;
+    }
+};
+
+static
+SHAMapItemSlabs&
+slabs ()
+{
+    static auto const instance = new SHAMapItemSlabs;
+    return *instance;
+}
+
 }
 
-SHAMapItem::SHAMapItem (uint256 const& tag, const Serializer& data)
+SHAMapItem::SHAMapItem (uint256 const& tag, Slice data)
     : tag_ (tag)
-    , data_(data.peekData())
+    , size_ (static_cast<std::uint32_t> (data.size ()))
+    , refcount_ (0)
 {
+    if (size_ != 0)
+        std::memcpy (this + 1, data.data (), size_);
 }
 
-SHAMapItem::SHAMapItem (uint256 const& tag, Serializer&& data)
-    : tag_ (tag)
-    , data_(std::move(data.modData()))
+boost::intrusive_ptr<SHAMapItem const>
+make_shamapitem (uint256 const& tag, Slice data)
+{
+    auto const p = detail::slabs ().allocate (
+        sizeof (SHAMapItem) + data.size ());
+    return boost::intrusive_ptr<SHAMapItem const> (
+        ::new (p) SHAMapItem (tag, data));
+}
+
+void
+intrusive_ptr_release (SHAMapItem const* x)
+{
+    if (x->refcount_.fetch_sub (1, std::memory_order_acq_rel) == 1)
+    {
+        auto const bytes = sizeof (SHAMapItem) + x->size_;
+        x->~SHAMapItem ();
+        detail::slabs ().deallocate (const_cast<SHAMapItem*> (x), bytes);
+    }
+}
+
+SHAMapItemStats
+getSHAMapItemStats ()
 {
+    return detail::slabs ().getStats ();
 }
 
 } 
@@ -8,7 +8,7 @@ namespace ripple {
 
 void
 SHAMap::visitLeaves(std::function<void (
-    std::shared_ptr<SHAMapItem const> const& item)> const& leafFunction) const
+    boost::intrusive_ptr<SHAMapItem const> const& item)> const& leafFunction) const
 {
     visitNodes(
         [&leafFunction](SHAMapAbstractNode& node)
@@ -165,9 +165,16 @@ void SHAMap::gmn_ProcessNodes (MissingNodes& mn, MissingNodes::StackEntry& se)
         else if (! backed_ || ! f_.fullbelow().touch_if_exists (childHash.as_uint256()))
         {
             SHAMapNodeID childID = nodeID.getChildNodeID (branch);
+            if (gmn_Shared (mn, childID, childHash))
+                continue;
+
+            bool const loaded = node->getChildPointer (branch) != nullptr;
             bool pending = false;
             auto d = descendAsync (node, branch, mn.filter_, pending);
 
+            if (d && ! loaded && mn.localNodes_)
+                ++*mn.localNodes_;
+
             if (!d)
             {
                 fullBelow = false; 
@@ -212,6 +219,35 @@ void SHAMap::gmn_ProcessNodes (MissingNodes& mn, MissingNodes::StackEntry& se)
     node = nullptr;
 }
 
+bool SHAMap::gmn_Shared (MissingNodes& mn, SHAMapNodeID const& nodeID,
+    SHAMapHash const& hash)
+{
+    if (! mn.have_ || ! backed_ || is_v2 ())
+        return false;
+
+    // A shared subtree is only reachable through this map's node store
+    if (&mn.have_->f_ != &f_)
+        return false;
+
+    try
+    {
+        if (! mn.have_->hasInnerNode (nodeID, hash))
+            return false;
+    }
+    catch (SHAMapMissingNode const& e)
+    {
+        JLOG(journal_.debug()) <<
+            "getMissingNodes reference map incomplete: " << e;
+        mn.have_ = nullptr;
+        return false;
+    }
+
+    f_.fullbelow().insert (hash.as_uint256());
+    if (mn.localNodes_)
+        ++*mn.localNodes_;
+    return true;
+}
+
 void SHAMap::gmn_ProcessDeferredReads (MissingNodes& mn)
 {
     auto const before = std::chrono::steady_clock::now();
@@ -251,6 +287,8 @@ void SHAMap::gmn_ProcessDeferredReads (MissingNodes& mn)
         }
     }
     mn.deferredReads_.clear();
+    if (mn.localNodes_)
+        *mn.localNodes_ += hits;
 
     auto const process_time = std::chrono::duration_cast
         <std::chrono::milliseconds> (std::chrono::steady_clock::now() - after);
@@ -266,7 +304,8 @@ void SHAMap::gmn_ProcessDeferredReads (MissingNodes& mn)
 
 
 std::vector<std::pair<SHAMapNodeID, uint256>>
-SHAMap::getMissingNodes(int max, SHAMapSyncFilter* filter)
+SHAMap::getMissingNodes(int max, SHAMapSyncFilter* filter,
+    SHAMap const* have, int* localNodes)
 {
     assert (root_->isValid ());
     assert (root_->getNodeHash().isNonZero ());
@@ -274,7 +313,7 @@ SHAMap::getMissingNodes(int max, SHAMapSyncFilter* filter)
 
     MissingNodes mn (max, filter,
         f_.db().getDesiredAsyncReadCount(ledgerSeq_),
-        f_.fullbelow().getGeneration());
+        f_.fullbelow().getGeneration(), have, localNodes);
 
     if (! root_->isInner () ||
             std::static_pointer_cast<SHAMapInnerNode>(root_)->
@@ -625,7 +664,7 @@ bool SHAMap::deepCompare (SHAMap& other) const
             auto& otherNodePeek = static_cast<SHAMapTreeNode*>(otherNode)->peekItem();
             if (nodePeek->key() != otherNodePeek->key())
                 return false;
-            if (nodePeek->peekData() != otherNodePeek->peekData())
+            if (nodePeek->slice() != otherNodePeek->slice())
                 return false;
         }
         else if (node->isInner ())
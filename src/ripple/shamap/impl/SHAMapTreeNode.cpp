@@ -8,30 +8,183 @@
 #include <ripple/basics/StringUtilities.h>
 #include <ripple/protocol/HashPrefix.h>
 #include <ripple/beast/core/LexicalCast.h>
-#include <mutex>
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <thread>
 
 #include <openssl/sha.h>
 
 namespace ripple {
 
-std::mutex SHAMapInnerNode::childLock;
+namespace {
+
+class ChildLock
+{
+    std::atomic_flag& lock_;
+
+public:
+    explicit
+    ChildLock (std::atomic_flag& lock)
+        : lock_ (lock)
+    {
+        while (lock_.test_and_set (std::memory_order_acquire))
+            std::this_thread::yield ();
+    }
+
+    ~ChildLock ()
+    {
+        lock_.clear (std::memory_order_release);
+    }
+
+    ChildLock (ChildLock const&) = delete;
+    ChildLock& operator= (ChildLock const&) = delete;
+};
+
+}
 
 SHAMapAbstractNode::~SHAMapAbstractNode() = default;
 
+int
+SHAMapInnerNode::capacityFor (int count)
+{
+    if (count == 0)
+        return 0;
+    if (count <= 2)
+        return 2;
+    if (count <= 4)
+        return 4;
+    if (count <= 8)
+        return 8;
+    return denseCapacity;
+}
+
+void
+SHAMapInnerNode::resize (int capacity)
+{
+    assert (capacity >= getBranchCount ());
+
+    auto hashes = std::make_unique<SHAMapHash[]> (capacity);
+    auto children = std::make_unique<
+        std::shared_ptr<SHAMapAbstractNode>[]> (capacity);
+
+    for (int i = 0, j = 0; i < 16; ++i)
+    {
+        if (isEmptyBranch (i))
+            continue;
+        auto const to = (capacity == denseCapacity) ? i : j++;
+        auto const from = slot (i);
+        hashes[to] = mHashes[from];
+        children[to] = std::move (mChildren[from]);
+    }
+
+    mHashes = std::move (hashes);
+    mChildren = std::move (children);
+    mCapacity = static_cast<std::uint8_t> (capacity);
+}
+
+void
+SHAMapInnerNode::setHashes (std::array<SHAMapHash, 16> const& hashes)
+{
+    assert (mIsBranch == 0);
+
+    std::uint16_t isBranch = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        if (hashes[i].isNonZero ())
+            isBranch |= (1 << i);
+    }
+
+    resize (capacityFor (std::bitset<16> (isBranch).count ()));
+    mIsBranch = isBranch;
+
+    for (int i = 0; i < 16; ++i)
+    {
+        if (! isEmptyBranch (i))
+            mHashes[slot (i)] = hashes[i];
+    }
+}
+
+void
+SHAMapInnerNode::copyBranches (SHAMapInnerNode& to) const
+{
+    assert (to.mIsBranch == 0);
+
+    to.resize (capacityFor (getBranchCount ()));
+    to.mIsBranch = mIsBranch;
+
+    auto const published = mPublished.load (std::memory_order_acquire);
+    for (int i = 0; i < 16; ++i)
+    {
+        if (isEmptyBranch (i))
+            continue;
+        auto const from = slot (i);
+        auto const dest = to.slot (i);
+        to.mHashes[dest] = mHashes[from];
+        if (published & (1 << i))
+            to.mChildren[dest] = mChildren[from];
+    }
+    to.mPublished.store (published, std::memory_order_relaxed);
+}
+
+void
+SHAMapInnerNode::insertBranch (int m, std::shared_ptr<SHAMapAbstractNode> const& child)
+{
+    assert (isEmptyBranch (m));
+
+    auto const count = getBranchCount ();
+    if (count == mCapacity)
+        resize (capacityFor (count + 1));
+
+    auto const pos = slot (m);
+    if (mCapacity != denseCapacity)
+    {
+        std::move_backward (&mHashes[pos], &mHashes[count], &mHashes[count + 1]);
+        std::move_backward (&mChildren[pos], &mChildren[count], &mChildren[count + 1]);
+    }
+
+    mHashes[pos].zero ();
+    mChildren[pos] = child;
+    mIsBranch |= (1 << m);
+    mPublished.fetch_or (1 << m, std::memory_order_release);
+}
+
+void
+SHAMapInnerNode::removeBranch (int m)
+{
+    assert (! isEmptyBranch (m));
+
+    auto const count = getBranchCount ();
+    auto const pos = slot (m);
+    auto last = pos;
+    if (mCapacity != denseCapacity)
+    {
+        std::move (&mHashes[pos + 1], &mHashes[count], &mHashes[pos]);
+        std::move (&mChildren[pos + 1], &mChildren[count], &mChildren[pos]);
+        last = count - 1;
+    }
+
+    mHashes[last].zero ();
+    mChildren[last].reset ();
+    mIsBranch &= ~ (1 << m);
+    mPublished.fetch_and (~ (1 << m), std::memory_order_relaxed);
+}
+
 std::shared_ptr<SHAMapAbstractNode>
 SHAMapInnerNode::clone(std::uint32_t seq) const
 {
     auto p = std::make_shared<SHAMapInnerNode>(seq);
     p->mHash = mHash;
-    p->mIsBranch = mIsBranch;
     p->mFullBelowGen = mFullBelowGen;
-    p->mHashes = mHashes;
-    std::lock_guard <std::mutex> lock(childLock);
+    copyBranches (*p);
+#ifndef NDEBUG
     for (int i = 0; i < 16; ++i)
     {
-        p->mChildren[i] = mChildren[i];
-        assert(std::dynamic_pointer_cast<SHAMapInnerNodeV2>(p->mChildren[i]) == nullptr);
+        if (! p->isEmptyBranch (i))
+            assert(std::dynamic_pointer_cast<SHAMapInnerNodeV2>(
+                p->mChildren[p->slot (i)]) == nullptr);
     }
+#endif
     return std::move(p);
 }
 
@@ -40,19 +193,21 @@ SHAMapInnerNodeV2::clone(std::uint32_t seq) const
 {
     auto p = std::make_shared<SHAMapInnerNodeV2>(seq);
     p->mHash = mHash;
-    p->mIsBranch = mIsBranch;
     p->mFullBelowGen = mFullBelowGen;
-    p->mHashes = mHashes;
     p->common_ = common_;
     p->depth_ = depth_;
-    std::lock_guard <std::mutex> lock(childLock);
+    copyBranches (*p);
+#ifndef NDEBUG
     for (int i = 0; i < 16; ++i)
     {
-        p->mChildren[i] = mChildren[i];
-        if (p->mChildren[i] != nullptr)
-            assert(std::dynamic_pointer_cast<SHAMapInnerNodeV2>(p->mChildren[i]) != nullptr ||
-                   std::dynamic_pointer_cast<SHAMapTreeNode>(p->mChildren[i]) != nullptr);
+        if (p->isEmptyBranch (i))
+            continue;
+        auto const& child = p->mChildren[p->slot (i)];
+        if (child != nullptr)
+            assert(std::dynamic_pointer_cast<SHAMapInnerNodeV2>(child) != nullptr ||
+                   std::dynamic_pointer_cast<SHAMapTreeNode>(child) != nullptr);
     }
+#endif
     return std::move(p);
 }
 
@@ -62,21 +217,21 @@ SHAMapTreeNode::clone(std::uint32_t seq) const
     return std::make_shared<SHAMapTreeNode>(mItem, mType, seq, mHash);
 }
 
-SHAMapTreeNode::SHAMapTreeNode (std::shared_ptr<SHAMapItem const> const& item,
+SHAMapTreeNode::SHAMapTreeNode (boost::intrusive_ptr<SHAMapItem const> const& item,
                                 TNType type, std::uint32_t seq)
     : SHAMapAbstractNode(type, seq)
     , mItem (item)
 {
-    assert (item->peekData ().size () >= 12);
+    assert (item->size () >= 12);
     updateHash();
 }
 
-SHAMapTreeNode::SHAMapTreeNode (std::shared_ptr<SHAMapItem const> const& item,
+SHAMapTreeNode::SHAMapTreeNode (boost::intrusive_ptr<SHAMapItem const> const& item,
                                 TNType type, std::uint32_t seq, SHAMapHash const& hash)
     : SHAMapAbstractNode(type, seq, hash)
     , mItem (item)
 {
-    assert (item->peekData ().size () >= 12);
+    assert (item->size () >= 12);
 }
 
 std::shared_ptr<SHAMapAbstractNode>
@@ -89,18 +244,16 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
         if (rawNode.empty ())
             return {};
 
-        Serializer s (rawNode.data(), rawNode.size() - 1);
+        Slice const body (rawNode.data(), rawNode.size() - 1);
         int type = rawNode[rawNode.size() - 1];
-        int len = s.getLength ();
+        int len = body.size ();
 
         if ((type < 0) || (type > 6))
             return {};
         if (type == 0)
         {
-            auto item = std::make_shared<SHAMapItem const>(
-                sha512Half(HashPrefix::transactionID,
-                    Slice(s.data(), s.size())),
-                        s.peekData());
+            auto item = make_shamapitem(
+                sha512Half(HashPrefix::transactionID, body), body);
             if (hashValid)
                 return std::make_shared<SHAMapTreeNode>(item, tnTRANSACTION_NM, seq, hash);
             return std::make_shared<SHAMapTreeNode>(item, tnTRANSACTION_NM, seq);
@@ -110,13 +263,13 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
             if (len < (256 / 8))
                 Throw<std::runtime_error> ("short AS node");
 
-            uint256 u;
-            s.get256 (u, len - (256 / 8));
-            s.chop (256 / 8);
+            auto const u = uint256::fromVoid (
+                body.data () + len - (256 / 8));
 
             if (u.isZero ()) Throw<std::runtime_error> ("invalid AS node");
 
-            auto item = std::make_shared<SHAMapItem const> (u, s.peekData ());
+            auto item = make_shamapitem (u,
+                Slice (body.data (), len - (256 / 8)));
             if (hashValid)
                 return std::make_shared<SHAMapTreeNode>(item, tnACCOUNT_STATE, seq, hash);
             return std::make_shared<SHAMapTreeNode>(item, tnACCOUNT_STATE, seq);
@@ -126,14 +279,12 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
             if (len != 512)
                 Throw<std::runtime_error> ("invalid FI node");
 
-            auto ret = std::make_shared<SHAMapInnerNode>(seq);
+            Serializer s (body.data (), body.size ());
+            std::array<SHAMapHash, 16> hashes;
             for (int i = 0; i < 16; ++i)
-            {
-                s.get256 (ret->mHashes[i].as_uint256(), i * 32);
-
-                if (ret->mHashes[i].isNonZero ())
-                    ret->mIsBranch |= (1 << i);
-            }
+                s.get256 (hashes[i].as_uint256(), i * 32);
+            auto ret = std::make_shared<SHAMapInnerNode>(seq);
+            ret->setHashes (hashes);
             if (hashValid)
                 ret->mHash = hash;
             else
@@ -142,7 +293,8 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
         }
         else if (type == 3)
         {
-            auto ret = std::make_shared<SHAMapInnerNode>(seq);
+            Serializer s (body.data (), body.size ());
+            std::array<SHAMapHash, 16> hashes;
             for (int i = 0; i < (len / 33); ++i)
             {
                 int pos;
@@ -150,10 +302,10 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
                     Throw<std::runtime_error> ("short CI node");
                 if ((pos < 0) || (pos >= 16))
                     Throw<std::runtime_error> ("invalid CI node");
-                s.get256 (ret->mHashes[pos].as_uint256(), i * 33);
-                if (ret->mHashes[pos].isNonZero ())
-                    ret->mIsBranch |= (1 << pos);
+                s.get256 (hashes[pos].as_uint256(), i * 33);
             }
+            auto ret = std::make_shared<SHAMapInnerNode>(seq);
+            ret->setHashes (hashes);
             if (hashValid)
                 ret->mHash = hash;
             else
@@ -165,14 +317,14 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
             if (len < (256 / 8))
                 Throw<std::runtime_error> ("short TM node");
 
-            uint256 u;
-            s.get256 (u, len - (256 / 8));
-            s.chop (256 / 8);
+            auto const u = uint256::fromVoid (
+                body.data () + len - (256 / 8));
 
             if (u.isZero ())
                 Throw<std::runtime_error> ("invalid TM node");
 
-            auto item = std::make_shared<SHAMapItem const> (u, s.peekData ());
+            auto item = make_shamapitem (u,
+                Slice (body.data (), len - (256 / 8)));
             if (hashValid)
                 return std::make_shared<SHAMapTreeNode>(item, tnTRANSACTION_MD, seq, hash);
             return std::make_shared<SHAMapTreeNode>(item, tnTRANSACTION_MD, seq);
@@ -182,14 +334,12 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
             if (len != 512)
                 Throw<std::runtime_error> ("invalid FI node");
 
-            auto ret = std::make_shared<SHAMapInnerNodeV2>(seq);
+            Serializer s (body.data (), body.size ());
+            std::array<SHAMapHash, 16> hashes;
             for (int i = 0; i < 16; ++i)
-            {
-                s.get256 (ret->mHashes[i].as_uint256(), i * 32);
-
-                if (ret->mHashes[i].isNonZero ())
-                    ret->mIsBranch |= (1 << i);
-            }
+                s.get256 (hashes[i].as_uint256(), i * 32);
+            auto ret = std::make_shared<SHAMapInnerNodeV2>(seq);
+            ret->setHashes (hashes);
             ret->set_common(id.getDepth(), id.getNodeID());
             if (hashValid)
                 ret->mHash = hash;
@@ -199,7 +349,8 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
         }
         else if (type == 6)
         {
-            auto ret = std::make_shared<SHAMapInnerNodeV2>(seq);
+            Serializer s (body.data (), body.size ());
+            std::array<SHAMapHash, 16> hashes;
             for (int i = 0; i < (len / 33); ++i)
             {
                 int pos;
@@ -207,10 +358,10 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
                     Throw<std::runtime_error> ("short CI node");
                 if ((pos < 0) || (pos >= 16))
                     Throw<std::runtime_error> ("invalid CI node");
-                s.get256 (ret->mHashes[pos].as_uint256(), i * 33);
-                if (ret->mHashes[pos].isNonZero ())
-                    ret->mIsBranch |= (1 << pos);
+                s.get256 (hashes[pos].as_uint256(), i * 33);
             }
+            auto ret = std::make_shared<SHAMapInnerNodeV2>(seq);
+            ret->setHashes (hashes);
             ret->set_common(id.getDepth(), id.getNodeID());
             if (hashValid)
                 ret->mHash = hash;
@@ -235,25 +386,23 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
         prefix |= rawNode[2];
         prefix <<= 8;
         prefix |= rawNode[3];
-        Serializer s (rawNode.data() + 4, rawNode.size() - 4);
+        Slice const body (rawNode.data() + 4, rawNode.size() - 4);
 
         if (prefix == HashPrefix::transactionID)
         {
-            auto item = std::make_shared<SHAMapItem const>(
-                sha512Half(rawNode),
-                    s.peekData ());
+            auto item = make_shamapitem(
+                sha512Half(rawNode), body);
             if (hashValid)
                 return std::make_shared<SHAMapTreeNode>(item, tnTRANSACTION_NM, seq, hash);
             return std::make_shared<SHAMapTreeNode>(item, tnTRANSACTION_NM, seq);
         }
         else if (prefix == HashPrefix::leafNode)
         {
-            if (s.getLength () < 32)
+            if (body.size () < 32)
                 Throw<std::runtime_error> ("short PLN node");
 
-            uint256 u;
-            s.get256 (u, s.getLength () - 32);
-            s.chop (32);
+            auto const u = uint256::fromVoid (
+                body.data () + body.size () - 32);
 
             if (u.isZero ())
             {
@@ -261,13 +410,15 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
                 Throw<std::runtime_error> ("invalid PLN node");
             }
 
-            auto item = std::make_shared<SHAMapItem const> (u, s.peekData ());
+            auto item = make_shamapitem (u,
+                Slice (body.data (), body.size () - 32));
             if (hashValid)
                 return std::make_shared<SHAMapTreeNode>(item, tnACCOUNT_STATE, seq, hash);
             return std::make_shared<SHAMapTreeNode>(item, tnACCOUNT_STATE, seq);
         }
         else if ((prefix == HashPrefix::innerNode) || (prefix == HashPrefix::innerNodeV2))
         {
+            Serializer s (body.data (), body.size ());
             auto len = s.getLength();
             bool isV2 = (prefix == HashPrefix::innerNodeV2);
 
@@ -280,13 +431,10 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
             else
                 ret = std::make_shared<SHAMapInnerNode>(seq);
 
+            std::array<SHAMapHash, 16> hashes;
             for (int i = 0; i < 16; ++i)
-            {
-                s.get256 (ret->mHashes[i].as_uint256(), i * 32);
-
-                if (ret->mHashes[i].isNonZero ())
-                    ret->mIsBranch |= (1 << i);
-            }
+                s.get256 (hashes[i].as_uint256(), i * 32);
+            ret->setHashes (hashes);
 
             if (isV2)
             {
@@ -311,13 +459,13 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
         }
         else if (prefix == HashPrefix::txNode)
         {
-            if (s.getLength () < 32)
+            if (body.size () < 32)
                 Throw<std::runtime_error> ("short TXN node");
 
-            uint256 txID;
-            s.get256 (txID, s.getLength () - 32);
-            s.chop (32);
-            auto item = std::make_shared<SHAMapItem const> (txID, s.peekData ());
+            auto const txID = uint256::fromVoid (
+                body.data () + body.size () - 32);
+            auto item = make_shamapitem (txID,
+                Slice (body.data (), body.size () - 32));
             if (hashValid)
                 return std::make_shared<SHAMapTreeNode>(item, tnTRANSACTION_MD, seq, hash);
             return std::make_shared<SHAMapTreeNode>(item, tnTRANSACTION_MD, seq);
@@ -342,8 +490,8 @@ SHAMapInnerNode::updateHash()
         sha512_half_hasher h;
         using beast::hash_append;
         hash_append(h, HashPrefix::innerNode);
-        for(auto const& hh : mHashes)
-            hash_append(h, hh);
+        for (int i = 0; i < 16; ++i)
+            hash_append(h, getChildHash (i));
         nh = static_cast<typename
             sha512_half_hasher::result_type>(h);
     }
@@ -356,7 +504,9 @@ SHAMapInnerNode::updateHash()
 void
 SHAMapInnerNode::updateHashDeep()
 {
-    for (auto pos = 0; pos < 16; ++pos)
+    auto const count = (mCapacity == denseCapacity) ?
+        denseCapacity : getBranchCount ();
+    for (auto pos = 0; pos < count; ++pos)
     {
         if (mChildren[pos] != nullptr)
             mHashes[pos] = mChildren[pos]->getNodeHash();
@@ -371,18 +521,18 @@ SHAMapTreeNode::updateHash()
     if (mType == tnTRANSACTION_NM)
     {
         nh = sha512Half(HashPrefix::transactionID,
-            makeSlice(mItem->peekData()));
+            mItem->slice());
     }
     else if (mType == tnACCOUNT_STATE)
     {
         nh = sha512Half(HashPrefix::leafNode,
-            makeSlice(mItem->peekData()),
+            mItem->slice(),
                 mItem->key());
     }
     else if (mType == tnTRANSACTION_MD)
     {
         nh = sha512Half(HashPrefix::txNode,
-            makeSlice(mItem->peekData()),
+            mItem->slice(),
                 mItem->key());
     }
     else
@@ -415,17 +565,17 @@ SHAMapInnerNode::addRaw(Serializer& s, SHANodeFormat format) const
         {
             s.add32 (HashPrefix::innerNode);
 
-            for (auto const& hh : mHashes)
-                s.add256 (hh.as_uint256());
+            for (int i = 0; i < 16; ++i)
+                s.add256 (getChildHash (i).as_uint256());
         }
         else  
         {
             if (getBranchCount () < 12)
             {
-                for (int i = 0; i < mHashes.size(); ++i)
+                for (int i = 0; i < 16; ++i)
                     if (!isEmptyBranch (i))
                     {
-                        s.add256 (mHashes[i].as_uint256());
+                        s.add256 (mHashes[slot (i)].as_uint256());
                         s.add8 (i);
                     }
 
@@ -433,8 +583,8 @@ SHAMapInnerNode::addRaw(Serializer& s, SHANodeFormat format) const
             }
             else
             {
-                for (auto const& hh : mHashes)
-                    s.add256 (hh.as_uint256());
+                for (int i = 0; i < 16; ++i)
+                    s.add256 (getChildHash (i).as_uint256());
 
                 s.add8 (2);
             }
@@ -453,7 +603,7 @@ SHAMapInnerNodeV2::addRaw(Serializer& s, SHANodeFormat format) const
         s.add32 (HashPrefix::innerNodeV2);
 
         for (int i = 0 ; i < 16; ++i)
-            s.add256 (mHashes[i].as_uint256());
+            s.add256 (getChildHash (i).as_uint256());
 
         s.add8(depth_);
 
@@ -507,12 +657,12 @@ SHAMapTreeNode::addRaw(Serializer& s, SHANodeFormat format) const
         if (format == snfPREFIX)
         {
             s.add32 (HashPrefix::leafNode);
-            s.addRaw (mItem->peekData ());
+            s.addRaw (mItem->data (), mItem->size ());
             s.add256 (mItem->key());
         }
         else
         {
-            s.addRaw (mItem->peekData ());
+            s.addRaw (mItem->data (), mItem->size ());
             s.add256 (mItem->key());
             s.add8 (1);
         }
@@ -522,11 +672,11 @@ SHAMapTreeNode::addRaw(Serializer& s, SHANodeFormat format) const
         if (format == snfPREFIX)
         {
             s.add32 (HashPrefix::transactionID);
-            s.addRaw (mItem->peekData ());
+            s.addRaw (mItem->data (), mItem->size ());
         }
         else
         {
-            s.addRaw (mItem->peekData ());
+            s.addRaw (mItem->data (), mItem->size ());
             s.add8 (0);
         }
     }
@@ -535,12 +685,12 @@ SHAMapTreeNode::addRaw(Serializer& s, SHANodeFormat format) const
         if (format == snfPREFIX)
         {
             s.add32 (HashPrefix::txNode);
-            s.addRaw (mItem->peekData ());
+            s.addRaw (mItem->data (), mItem->size ());
             s.add256 (mItem->key());
         }
         else
         {
-            s.addRaw (mItem->peekData ());
+            s.addRaw (mItem->data (), mItem->size ());
             s.add256 (mItem->key());
             s.add8 (4);
         }
@@ -549,7 +699,7 @@ SHAMapTreeNode::addRaw(Serializer& s, SHANodeFormat format) const
         assert (false);
 }
 
-bool SHAMapTreeNode::setItem (std::shared_ptr<SHAMapItem const> const& i, TNType type)
+bool SHAMapTreeNode::setItem (boost::intrusive_ptr<SHAMapItem const> const& i, TNType type)
 {
     mType = type;
     mItem = i;
@@ -566,13 +716,7 @@ bool SHAMapInnerNode::isEmpty () const
 int SHAMapInnerNode::getBranchCount () const
 {
     assert (isInner ());
-    int count = 0;
-
-    for (int i = 0; i < 16; ++i)
-        if (!isEmptyBranch (i))
-            ++count;
-
-    return count;
+    return static_cast<int> (std::bitset<16> (mIsBranch).count ());
 }
 
 std::string
@@ -590,14 +734,14 @@ std::string
 SHAMapInnerNode::getString(const SHAMapNodeID & id) const
 {
     std::string ret = SHAMapAbstractNode::getString(id);
-    for (int i = 0; i < mHashes.size(); ++i)
+    for (int i = 0; i < 16; ++i)
     {
         if (!isEmptyBranch (i))
         {
             ret += "\nb";
             ret += beast::lexicalCastThrow <std::string> (i);
             ret += " = ";
-            ret += to_string (mHashes[i]);
+            ret += to_string (mHashes[slot (i)]);
         }
     }
     return ret;
@@ -632,13 +776,25 @@ SHAMapInnerNode::setChild(int m, std::shared_ptr<SHAMapAbstractNode> const& chil
     assert (mType == tnINNER);
     assert (mSeq != 0);
     assert (child.get() != this);
-    mHashes[m].zero();
     mHash.zero();
     if (child)
-        mIsBranch |= (1 << m);
-    else
-        mIsBranch &= ~ (1 << m);
-    mChildren[m] = child;
+    {
+        if (isEmptyBranch (m))
+        {
+            insertBranch (m, child);
+        }
+        else
+        {
+            auto const pos = slot (m);
+            mHashes[pos].zero();
+            mChildren[pos] = child;
+            mPublished.fetch_or (1 << m, std::memory_order_release);
+        }
+    }
+    else if (!isEmptyBranch (m))
+    {
+        removeBranch (m);
+    }
 }
 
 void SHAMapInnerNode::shareChild (int m, std::shared_ptr<SHAMapAbstractNode> const& child)
@@ -648,8 +804,10 @@ void SHAMapInnerNode::shareChild (int m, std::shared_ptr<SHAMapAbstractNode> con
     assert (mSeq != 0);
     assert (child);
     assert (child.get() != this);
+    assert (!isEmptyBranch (m));
 
-    mChildren[m] = child;
+    mChildren[slot (m)] = child;
+    mPublished.fetch_or (1 << m, std::memory_order_release);
 }
 
 SHAMapAbstractNode*
@@ -658,8 +816,9 @@ SHAMapInnerNode::getChildPointer (int branch)
     assert (branch >= 0 && branch < 16);
     assert (isInner());
 
-    std::lock_guard <std::mutex> lock (childLock);
-    return mChildren[branch].get ();
+    if ((mPublished.load (std::memory_order_acquire) & (1 << branch)) == 0)
+        return nullptr;
+    return mChildren[slot (branch)].get ();
 }
 
 std::shared_ptr<SHAMapAbstractNode>
@@ -668,8 +827,9 @@ SHAMapInnerNode::getChild (int branch)
     assert (branch >= 0 && branch < 16);
     assert (isInner());
 
-    std::lock_guard <std::mutex> lock (childLock);
-    return mChildren[branch];
+    if ((mPublished.load (std::memory_order_acquire) & (1 << branch)) == 0)
+        return {};
+    return mChildren[slot (branch)];
 }
 
 std::shared_ptr<SHAMapAbstractNode>
@@ -678,17 +838,24 @@ SHAMapInnerNode::canonicalizeChild(int branch, std::shared_ptr<SHAMapAbstractNod
     assert (branch >= 0 && branch < 16);
     assert (isInner());
     assert (node);
-    assert (node->getNodeHash() == mHashes[branch]);
+    assert (node->getNodeHash() == getChildHash (branch));
+    assert (!isEmptyBranch (branch));
+
+    auto const bit = 1 << branch;
+    auto& child = mChildren[slot (branch)];
+    if (mPublished.load (std::memory_order_acquire) & bit)
+        return child;
 
-    std::lock_guard <std::mutex> lock (childLock);
-    if (mChildren[branch])
+    ChildLock lock (mLock);
+    if (mPublished.load (std::memory_order_relaxed) & bit)
     {
-        node = mChildren[branch];
+        node = child;
     }
     else
     {
         assert(std::dynamic_pointer_cast<SHAMapInnerNodeV2>(node) == nullptr);
-        mChildren[branch] = node;
+        child = node;
+        mPublished.fetch_or (bit, std::memory_order_release);
     }
     return node;
 }
@@ -699,18 +866,25 @@ SHAMapInnerNodeV2::canonicalizeChild(int branch, std::shared_ptr<SHAMapAbstractN
     assert (branch >= 0 && branch < 16);
     assert (isInner());
     assert (node);
-    assert (node->getNodeHash() == mHashes[branch]);
+    assert (node->getNodeHash() == getChildHash (branch));
+    assert (!isEmptyBranch (branch));
 
-    std::lock_guard <std::mutex> lock (childLock);
-    if (mChildren[branch])
+    auto const bit = 1 << branch;
+    auto& child = mChildren[slot (branch)];
+    if (mPublished.load (std::memory_order_acquire) & bit)
+        return child;
+
+    ChildLock lock (mLock);
+    if (mPublished.load (std::memory_order_relaxed) & bit)
     {
-        node = mChildren[branch];
+        node = child;
     }
     else
     {
         assert(std::dynamic_pointer_cast<SHAMapInnerNodeV2>(node) != nullptr ||
                std::dynamic_pointer_cast<SHAMapTreeNode>(node)    != nullptr);
-        mChildren[branch] = node;
+        child = node;
+        mPublished.fetch_or (bit, std::memory_order_release);
     }
     return node;
 }
@@ -782,10 +956,8 @@ SHAMapInnerNodeV2::setChildren(std::shared_ptr<SHAMapTreeNode> const& child1,
         b2 = *k2 >> 4;
         depth_ = 2*depth_;
     }
-    mChildren[b1] = child1;
-    mIsBranch |= 1 << b1;
-    mChildren[b2] = child2;
-    mIsBranch |= 1 << b2;
+    insertBranch (b1, child1);
+    insertBranch (b2, child2);
 }
 
 void
@@ -815,6 +987,29 @@ SHAMapTreeNode::key() const
     return mItem->key();
 }
 
+std::size_t
+SHAMapInnerNode::getBytes () const
+{
+    return sizeof (SHAMapInnerNode) + mCapacity *
+        (sizeof (SHAMapHash) + sizeof (std::shared_ptr<SHAMapAbstractNode>));
+}
+
+std::size_t
+SHAMapInnerNodeV2::getBytes () const
+{
+    return SHAMapInnerNode::getBytes () +
+        sizeof (SHAMapInnerNodeV2) - sizeof (SHAMapInnerNode);
+}
+
+std::size_t
+SHAMapTreeNode::getBytes () const
+{
+    std::size_t bytes = sizeof (SHAMapTreeNode);
+    if (mItem)
+        bytes += sizeof (SHAMapItem) + mItem->size ();
+    return bytes;
+}
+
 void
 SHAMapInnerNode::invariants(bool is_v2, bool is_root) const
 {
@@ -823,11 +1018,11 @@ SHAMapInnerNode::invariants(bool is_v2, bool is_root) const
     unsigned count = 0;
     for (int i = 0; i < 16; ++i)
     {
-        if (mHashes[i].isNonZero())
+        if (getChildHash(i).isNonZero())
         {
             assert((mIsBranch & (1 << i)) != 0);
-            if (mChildren[i] != nullptr)
-                mChildren[i]->invariants(is_v2);
+            if (mChildren[slot(i)] != nullptr)
+                mChildren[slot(i)]->invariants(is_v2);
             ++count;
         }
         else
@@ -851,20 +1046,21 @@ SHAMapInnerNodeV2::invariants(bool is_v2, bool is_root) const
     unsigned count = 0;
     for (int i = 0; i < 16; ++i)
     {
-        if (mHashes[i].isNonZero())
+        if (getChildHash(i).isNonZero())
         {
             assert((mIsBranch & (1 << i)) != 0);
-            if (mChildren[i] != nullptr)
+            auto const& child = mChildren[slot(i)];
+            if (child != nullptr)
             {
-                assert(mHashes[i] == mChildren[i]->getNodeHash());
+                assert(getChildHash(i) == child->getNodeHash());
 #ifndef NDEBUG
-                auto const& childID = mChildren[i]->key();
+                auto const& childID = child->key();
 
                 SHAMapNodeID nodeID {depth(), common()};
                 assert (i == nodeID.selectBranch(childID));
 #endif
                 assert(has_common_prefix(childID));
-                mChildren[i]->invariants(is_v2);
+                child->invariants(is_v2);
             }
             ++count;
         }
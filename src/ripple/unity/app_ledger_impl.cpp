@@ -6,6 +6,7 @@
 #include <ripple/app/ledger/impl/InboundLedgers.cpp>
 #include <ripple/app/ledger/impl/InboundTransactions.cpp>
 #include <ripple/app/ledger/impl/LedgerCleaner.cpp>
+#include <ripple/app/ledger/impl/LedgerDBWriter.cpp>
 #include <ripple/app/ledger/impl/LedgerMaster.cpp>
 #include <ripple/app/ledger/impl/LedgerReplay.cpp>
 #include <ripple/app/ledger/impl/LocalTxs.cpp>
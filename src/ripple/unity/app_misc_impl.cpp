@@ -1,10 +1,13 @@
 
 
 
+#include <ripple/app/misc/impl/AccountTxLog.cpp>
 #include <ripple/app/misc/impl/AccountTxPaging.cpp>
+#include <ripple/app/misc/impl/AccountTxStore.cpp>
 #include <ripple/app/misc/impl/AmendmentTable.cpp>
 #include <ripple/app/misc/impl/LoadFeeTrack.cpp>
 #include <ripple/app/misc/impl/Manifest.cpp>
+#include <ripple/app/misc/impl/SignatureBatch.cpp>
 #include <ripple/app/misc/impl/Transaction.cpp>
 #include <ripple/app/misc/impl/TxQ.cpp>
 #include <ripple/app/misc/impl/ValidatorList.cpp>
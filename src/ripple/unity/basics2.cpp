@@ -2,6 +2,7 @@
 
 #include <ripple/basics/impl/BasicConfig.cpp>
 #include <ripple/basics/impl/make_SSLContext.cpp>
+#include <ripple/basics/impl/MemoryGovernor.cpp>
 #include <ripple/basics/impl/mulDiv.cpp>
 #include <ripple/basics/impl/PerfLogImp.cpp>
 #include <ripple/basics/impl/ResolverAsio.cpp>
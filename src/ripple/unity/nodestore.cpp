@@ -17,6 +17,7 @@
 #include <ripple/nodestore/impl/ManagerImp.cpp>
 #include <ripple/nodestore/impl/NodeObject.cpp>
 #include <ripple/nodestore/impl/Shard.cpp>
+#include <ripple/nodestore/impl/ShardMap.cpp>
 
 
 
@@ -3,6 +3,7 @@
 
 #include <ripple/overlay/impl/PeerImp.cpp>
 #include <ripple/overlay/impl/PeerSet.cpp>
+#include <ripple/overlay/impl/SendQueue.cpp>
 #include <ripple/overlay/impl/TMHello.cpp>
 #include <ripple/overlay/impl/TrafficCount.cpp>
 
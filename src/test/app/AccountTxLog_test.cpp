@@ -0,0 +1,507 @@
+
+
+#include <ripple/app/misc/impl/AccountTxLog.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/utility/temp_dir.h>
+#include <ripple/protocol/jss.h>
+#include <test/jtx.h>
+#include <test/jtx/envconfig.h>
+#include <test/unit_test/SuiteJournal.h>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+namespace ripple {
+
+class AccountTxLog_test : public beast::unit_test::suite
+{
+    using Entries = std::vector<AccountTxStore::Entry>;
+
+    static
+    AccountID
+    makeAccount (std::uint64_t n)
+    {
+        AccountID id;
+        id = beast::zero;
+        std::memcpy (id.data (), &n, sizeof (n));
+        return id;
+    }
+
+    static
+    uint256
+    makeTxID (std::uint32_t ledgerSeq, std::uint32_t txnSeq)
+    {
+        return uint256 {(std::uint64_t{ledgerSeq} << 32) | txnSeq};
+    }
+
+    static
+    void
+    fill (AccountTxStore& store, AccountID const& alice,
+        AccountID const& bob, std::uint32_t first, std::uint32_t last)
+    {
+        for (auto seq = first; seq <= last; ++seq)
+        {
+            std::vector<AccountTxStore::Transaction> txns;
+            for (std::uint32_t txnSeq = 0; txnSeq < 3; ++txnSeq)
+            {
+                std::vector<AccountID> accounts {alice};
+                if (txnSeq == 1)
+                    accounts.push_back (bob);
+                txns.push_back ({txnSeq, makeTxID (seq, txnSeq), accounts});
+            }
+            store.insert (seq, txns);
+        }
+    }
+
+    static
+    Entries
+    all (AccountTxStore& store, AccountID const& account,
+        std::uint32_t minLedger, std::uint32_t maxLedger,
+            bool forward, std::size_t limit)
+    {
+        Entries result;
+        boost::optional<AccountTxStore::Marker> marker;
+        do
+        {
+            auto const page = store.page (
+                account, minLedger, maxLedger, forward, marker, limit);
+            result.insert (result.end (), page.begin (), page.end ());
+        }
+        while (marker);
+        return result;
+    }
+
+    static
+    bool
+    matches (Entries const& entries, std::uint32_t first,
+        std::uint32_t last, bool forward, std::vector<std::uint32_t> txnSeqs)
+    {
+        Entries expected;
+        for (auto seq = first; seq <= last; ++seq)
+        {
+            for (auto txnSeq : txnSeqs)
+                expected.push_back ({seq, txnSeq, makeTxID (seq, txnSeq)});
+        }
+        if (! forward)
+            std::reverse (expected.begin (), expected.end ());
+
+        return std::equal (entries.begin (), entries.end (),
+            expected.begin (), expected.end (),
+            [](AccountTxStore::Entry const& a, AccountTxStore::Entry const& b)
+            {
+                return a.ledgerSeq == b.ledgerSeq &&
+                    a.txnSeq == b.txnSeq && a.id == b.id;
+            });
+    }
+
+public:
+    void
+    testPaging (std::uint64_t segmentBytes)
+    {
+        testcase ("paging, " + std::to_string (segmentBytes) +
+            " byte segments");
+
+        beast::temp_dir dir;
+        test::SuiteJournal journal ("AccountTxLog_test", *this);
+        auto const alice = makeAccount (1);
+        auto const bob = makeAccount (2);
+
+        AccountTxLog store (dir.path (), journal, segmentBytes);
+        BEAST_EXPECT(store.empty ());
+        fill (store, alice, bob, 10, 29);
+        BEAST_EXPECT(! store.empty ());
+
+        auto const check = [&]
+        {
+            for (std::size_t limit : {1, 2, 7, 100})
+            {
+                BEAST_EXPECT(matches (all (store, alice, 0, 100, true, limit),
+                    10, 29, true, {0, 1, 2}));
+                BEAST_EXPECT(matches (all (store, alice, 0, 100, false, limit),
+                    10, 29, false, {0, 1, 2}));
+                BEAST_EXPECT(matches (all (store, bob, 15, 20, true, limit),
+                    15, 20, true, {1}));
+                BEAST_EXPECT(matches (all (store, bob, 15, 20, false, limit),
+                    15, 20, false, {1}));
+            }
+        };
+
+        // Before and after the full segments are indexed
+        check ();
+        store.flush ();
+        check ();
+
+        boost::optional<AccountTxStore::Marker> marker;
+        auto page = store.page (alice, 0, 100, true, marker, 4);
+        BEAST_EXPECT(page.size () == 4);
+        if (BEAST_EXPECT(marker))
+        {
+            BEAST_EXPECT(marker->ledgerSeq == 11);
+            BEAST_EXPECT(marker->txnSeq == 1);
+        }
+
+        BEAST_EXPECT(all (store, makeAccount (3), 0, 100, true, 10).empty ());
+        BEAST_EXPECT(all (store, alice, 30, 100, true, 10).empty ());
+    }
+
+    void
+    testReplace ()
+    {
+        testcase ("replace");
+
+        beast::temp_dir dir;
+        test::SuiteJournal journal ("AccountTxLog_test", *this);
+        auto const alice = makeAccount (1);
+        auto const bob = makeAccount (2);
+
+        AccountTxLog store (dir.path (), journal);
+        fill (store, alice, bob, 1, 5);
+        fill (store, alice, bob, 3, 3);
+        store.insert (4, {{5, makeTxID (4, 5), {alice}}});
+
+        auto const entries = all (store, alice, 0, 10, true, 100);
+        BEAST_EXPECT(entries.size () == 13);
+        BEAST_EXPECT(entries[9].ledgerSeq == 4);
+        BEAST_EXPECT(entries[9].txnSeq == 5);
+        BEAST_EXPECT(store.getJson ()[jss::entries] == "18");
+
+        // Across segments the copy in the newest one wins
+        beast::temp_dir segmented;
+        AccountTxLog small (segmented.path (), journal, 1);
+        fill (small, alice, bob, 1, 5);
+        small.flush ();
+        small.insert (4, {{5, makeTxID (4, 5), {alice}}});
+        for (bool forward : {true, false})
+        {
+            auto const entries = all (small, alice, 0, 10, forward, 2);
+            BEAST_EXPECT(entries.size () == 13);
+            auto const& e = entries[forward ? 9 : 3];
+            BEAST_EXPECT(e.ledgerSeq == 4);
+            BEAST_EXPECT(e.txnSeq == 5);
+        }
+    }
+
+    void
+    testRecovery ()
+    {
+        testcase ("recovery");
+
+        beast::temp_dir dir;
+        test::SuiteJournal journal ("AccountTxLog_test", *this);
+        auto const alice = makeAccount (1);
+        auto const bob = makeAccount (2);
+        auto const path = AccountTxLog::logPath (dir.path (), 1, 0);
+
+        std::uint64_t size;
+        {
+            AccountTxLog store (dir.path (), journal);
+            fill (store, alice, bob, 1, 10);
+            size = store.fileSize ();
+        }
+
+        {
+            std::ofstream ofs (path.string (),
+                std::ios::binary | std::ios::app);
+            ofs << "partial record";
+        }
+        BEAST_EXPECT(boost::filesystem::file_size (path) > size);
+
+        {
+            AccountTxLog store (dir.path (), journal);
+            BEAST_EXPECT(store.fileSize () == size);
+            BEAST_EXPECT(boost::filesystem::file_size (path) == size);
+            BEAST_EXPECT(matches (all (store, alice, 0, 100, true, 5),
+                1, 10, true, {0, 1, 2}));
+            fill (store, alice, bob, 11, 12);
+        }
+
+        AccountTxLog store (dir.path (), journal);
+        BEAST_EXPECT(matches (all (store, alice, 0, 100, false, 5),
+            1, 12, false, {0, 1, 2}));
+    }
+
+    void
+    testCompact ()
+    {
+        testcase ("compact");
+
+        beast::temp_dir dir;
+        test::SuiteJournal journal ("AccountTxLog_test", *this);
+        auto const alice = makeAccount (1);
+        auto const bob = makeAccount (2);
+
+        // Each fill record is 216 bytes, so a segment holds four ledgers
+        std::uint64_t const segmentBytes = 864;
+        {
+            AccountTxLog store (dir.path (), journal, segmentBytes);
+            fill (store, alice, bob, 1, 20);
+            fill (store, alice, bob, 18, 20);
+            store.flush ();
+
+            // The segments of ledgers 1 through 8 are dropped outright
+            auto const before = store.fileSize ();
+            store.deleteBefore (12);
+            BEAST_EXPECT(store.fileSize () < before);
+            BEAST_EXPECT(store.getJson ()[jss::compactions] == "0");
+            BEAST_EXPECT(matches (all (store, alice, 0, 100, true, 7),
+                12, 20, true, {0, 1, 2}));
+
+            // Only the segment of ledgers 9 through 12 is worth rewriting
+            auto const dropped = store.fileSize ();
+            store.compact ();
+            BEAST_EXPECT(store.getJson ()[jss::compactions] == "1");
+            BEAST_EXPECT(store.fileSize () < dropped);
+            BEAST_EXPECT(matches (all (store, alice, 0, 100, true, 7),
+                12, 20, true, {0, 1, 2}));
+            BEAST_EXPECT(matches (all (store, bob, 0, 100, false, 3),
+                12, 20, false, {1}));
+
+            store.compact ();
+            BEAST_EXPECT(store.getJson ()[jss::compactions] == "1");
+
+            fill (store, alice, bob, 5, 5);
+            fill (store, alice, bob, 21, 21);
+            BEAST_EXPECT(matches (all (store, alice, 0, 100, true, 7),
+                12, 21, true, {0, 1, 2}));
+        }
+
+        AccountTxLog store (dir.path (), journal, segmentBytes);
+        BEAST_EXPECT(matches (all (store, alice, 0, 100, true, 7),
+            12, 21, true, {0, 1, 2}));
+        BEAST_EXPECT(store.getJson ()[jss::min_ledger].asUInt () == 12);
+    }
+
+    void
+    testSegments ()
+    {
+        testcase ("segments");
+
+        using namespace boost::filesystem;
+        beast::temp_dir dir;
+        test::SuiteJournal journal ("AccountTxLog_test", *this);
+        auto const alice = makeAccount (1);
+        auto const bob = makeAccount (2);
+
+        // One ledger per segment
+        {
+            AccountTxLog store (dir.path (), journal, 1);
+            fill (store, alice, bob, 1, 10);
+            store.deleteBefore (3);
+            store.flush ();
+            BEAST_EXPECT(! exists (AccountTxLog::logPath (dir.path (), 1, 0)));
+            BEAST_EXPECT(exists (AccountTxLog::indexPath (dir.path (), 3, 0)));
+        }
+
+        // An indexed segment is not read again: damaging the checksum of
+        // its record does not truncate it
+        auto const logPath = AccountTxLog::logPath (dir.path (), 3, 0);
+        {
+            std::fstream fs (logPath.string (),
+                std::ios::binary | std::ios::in | std::ios::out);
+            fs.seekp (AccountTxLog::headerBytes +
+                2 * AccountTxLog::groupBytes + 4 * AccountTxLog::entryBytes);
+            fs.put ('x');
+        }
+        auto const size = file_size (logPath);
+        {
+            AccountTxLog store (dir.path (), journal, 1);
+            BEAST_EXPECT(file_size (logPath) == size);
+            BEAST_EXPECT(store.getJson ()[jss::min_ledger].asUInt () == 3);
+            BEAST_EXPECT(store.highWater () == 10);
+            BEAST_EXPECT(matches (all (store, bob, 4, 100, false, 4),
+                4, 10, false, {1}));
+        }
+
+        // A missing index is rebuilt from its segment
+        auto const indexPath = AccountTxLog::indexPath (dir.path (), 4, 0);
+        remove (indexPath);
+        {
+            AccountTxLog store (dir.path (), journal, 1);
+            store.flush ();
+            BEAST_EXPECT(exists (indexPath));
+            BEAST_EXPECT(matches (all (store, alice, 4, 100, true, 4),
+                4, 10, true, {0, 1, 2}));
+        }
+
+        // The log of an unsegmented store becomes the first segment
+        beast::temp_dir legacy;
+        {
+            AccountTxLog store (legacy.path (), journal);
+            fill (store, alice, bob, 1, 5);
+        }
+        rename (AccountTxLog::logPath (legacy.path (), 1, 0),
+            path (legacy.path ()) / AccountTxLog::legacyFileName);
+        {
+            AccountTxLog store (legacy.path (), journal);
+            BEAST_EXPECT(matches (all (store, alice, 0, 100, true, 2),
+                1, 5, true, {0, 1, 2}));
+        }
+        BEAST_EXPECT(! exists (
+            path (legacy.path ()) / AccountTxLog::legacyFileName));
+    }
+
+    void
+    testConcurrentPaging ()
+    {
+        testcase ("concurrent paging");
+
+        beast::temp_dir dir;
+        test::SuiteJournal journal ("AccountTxLog_test", *this);
+        auto const alice = makeAccount (1);
+        auto const bob = makeAccount (2);
+
+        AccountTxLog store (dir.path (), journal, 2000);
+        fill (store, alice, bob, 1, 200);
+
+        // Segments are indexed and compacted while pages are being read
+        std::atomic<bool> done {false};
+        std::thread compactor ([&]
+            {
+                while (! done)
+                {
+                    fill (store, alice, bob, 100, 100);
+                    store.compact ();
+                }
+            });
+
+        bool ok = true;
+        for (int i = 0; i < 20; ++i)
+        {
+            ok = ok && matches (all (store, alice, 0, 200, i % 2 == 0, 50),
+                1, 200, i % 2 == 0, {0, 1, 2});
+        }
+        done = true;
+        compactor.join ();
+        BEAST_EXPECT(ok);
+    }
+
+    void
+    testAccountTx ()
+    {
+        testcase ("account_tx");
+
+        using namespace test::jtx;
+        beast::temp_dir dir;
+        Env env (*this, envconfig ([&](std::unique_ptr<Config> cfg)
+            {
+                cfg->section ("account_tx_store").set ("path", dir.path ());
+                return cfg;
+            }));
+        BEAST_EXPECT(env.app ().getAccountTxStore ());
+
+        Account const alice {"alice"};
+        Account const bob {"bob"};
+        env.fund (XRP (10000), noripple (alice, bob));
+        env.close ();
+
+        for (int i = 0; i < 10; ++i)
+        {
+            env (pay (alice, bob, XRP (1)));
+            env.close ();
+        }
+
+        int count = 0;
+        Json::Value marker;
+        do
+        {
+            Json::Value params;
+            params[jss::account] = alice.human ();
+            params[jss::ledger_index_min] = -1;
+            params[jss::ledger_index_max] = -1;
+            params[jss::limit] = 3;
+            if (marker)
+                params[jss::marker] = marker;
+            auto const result = env.rpc (
+                "json", "account_tx", to_string (params))[jss::result];
+            if (! BEAST_EXPECT(result[jss::transactions].isArray ()))
+                break;
+            count += result[jss::transactions].size ();
+            marker = result[jss::marker];
+        }
+        while (marker);
+
+        BEAST_EXPECT(count == 11);
+    }
+
+    void
+    testReplay ()
+    {
+        testcase ("replay");
+
+        using namespace test::jtx;
+        beast::temp_dir dir;
+        beast::temp_dir replayDir;
+        test::SuiteJournal journal ("AccountTxLog_test", *this);
+        Env env (*this, envconfig ([&](std::unique_ptr<Config> cfg)
+            {
+                cfg->section ("account_tx_store").set ("path", dir.path ());
+                return cfg;
+            }));
+        auto const store = env.app ().getAccountTxStore ();
+        if (! BEAST_EXPECT(store))
+            return;
+
+        Account const alice {"alice"};
+        Account const bob {"bob"};
+        env.fund (XRP (10000), noripple (alice, bob));
+        env.close ();
+
+        for (int i = 0; i < 10; ++i)
+        {
+            env (pay (alice, bob, XRP (1)));
+            env.close ();
+        }
+        BEAST_EXPECT(store->highWater () ==
+            env.closed ()->info ().seq);
+
+        auto const expected = all (*store, alice.id (), 0, 1000, true, 100);
+        BEAST_EXPECT(expected.size () == 11);
+
+        // A store that stopped halfway only picks up the later ledgers
+        auto const mid = expected[5].ledgerSeq;
+        AccountTxLog replayed (replayDir.path (), journal);
+        replayed.insert (mid, {{0, makeTxID (mid, 0), {makeAccount (1)}}});
+        BEAST_EXPECT(replayed.highWater () == mid);
+
+        auto const rows = replayAccountTransactions (
+            env.app ().getTxnDB (), replayed, journal);
+        BEAST_EXPECT(rows == 5);
+        BEAST_EXPECT(replayed.highWater () == store->highWater ());
+
+        auto const entries = all (replayed, alice.id (), 0, 1000, true, 3);
+        BEAST_EXPECT(std::equal (entries.begin (), entries.end (),
+            expected.begin () + 6, expected.end (),
+            [](AccountTxStore::Entry const& a, AccountTxStore::Entry const& b)
+            {
+                return a.ledgerSeq == b.ledgerSeq &&
+                    a.txnSeq == b.txnSeq && a.id == b.id;
+            }));
+
+        // Nothing is left to replay once the store has caught up
+        BEAST_EXPECT(replayAccountTransactions (
+            env.app ().getTxnDB (), replayed, journal) == 0);
+
+        replayed.deleteBefore (mid + 100);
+        BEAST_EXPECT(replayed.highWater () == mid + 99);
+    }
+
+    void
+    run () override
+    {
+        testPaging (AccountTxLog::defaultSegmentBytes);
+        testPaging (1);
+        testPaging (1000);
+        testReplace ();
+        testRecovery ();
+        testCompact ();
+        testSegments ();
+        testConcurrentPaging ();
+        testAccountTx ();
+        testReplay ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(AccountTxLog,app,ripple);
+
+}
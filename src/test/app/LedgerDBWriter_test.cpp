@@ -0,0 +1,154 @@
+
+
+#include <ripple/app/ledger/AcceptedLedger.h>
+#include <ripple/app/ledger/LedgerDBWriter.h>
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/core/DatabaseCon.h>
+#include <ripple/core/JobQueue.h>
+#include <ripple/core/SociDB.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/jss.h>
+#include <test/jtx.h>
+
+namespace ripple {
+namespace test {
+
+class LedgerDBWriter_test : public beast::unit_test::suite
+{
+    static int
+    rows (DatabaseCon& con, std::string const& table)
+    {
+        auto db = con.checkoutDb ();
+
+        int count = 0;
+        *db << "SELECT count(*) FROM " + table + ";",
+            soci::into (count);
+        return count;
+    }
+
+    static LedgerDBWriter::Record
+    makeRecord (jtx::Env& env, std::uint32_t seq)
+    {
+        auto& app = env.app ();
+        auto const ledger = app.getLedgerMaster ().getLedgerBySeq (seq);
+        AcceptedLedger const accepted (
+            ledger, app.accountIDCache (), app.logs ());
+
+        LedgerDBWriter::Record record;
+        record.info = ledger->info ();
+        for (auto const& vt : accepted.getMap ())
+        {
+            LedgerDBWriter::Transaction txn;
+            txn.id = vt.second->getTransactionID ();
+            txn.txnSeq = vt.second->getTxnSeq ();
+            txn.metaSQL = vt.second->getTxn ()->getMetaSQL (
+                seq, vt.second->getEscMeta ());
+            for (auto const& account : vt.second->getAffected ())
+                txn.accounts.push_back (account);
+            record.txns.push_back (std::move (txn));
+        }
+        return record;
+    }
+
+    void
+    testSave ()
+    {
+        testcase ("save");
+
+        using namespace jtx;
+        Env env (*this);
+        Account const alice {"alice"};
+        Account const bob {"bob"};
+        env.fund (XRP (10000), alice, bob);
+        env.close ();
+
+        for (int i = 0; i < 20; ++i)
+        {
+            env (pay (alice, bob, XRP (1 + i)));
+            env (pay (bob, alice, XRP (1)));
+            env.close ();
+        }
+
+        auto& app = env.app ();
+        BEAST_EXPECT(app.getLedgerDBWriter ().size () == 0);
+        BEAST_EXPECT(app.getLedgerDBWriter ().getJson ()[jss::ledgers] !=
+            "0");
+
+        auto const ledgers = rows (app.getLedgerDB (), "Ledgers");
+        auto const txns = rows (app.getTxnDB (), "Transactions");
+        auto const acctTxns = rows (app.getTxnDB (), "AccountTransactions");
+        BEAST_EXPECT(txns >= 40);
+        BEAST_EXPECT(acctTxns >= 2 * txns);
+
+        std::uint32_t const first = 2;
+        std::uint32_t const last = env.closed ()->info ().seq;
+
+        {
+            auto db = app.getLedgerDB ().checkoutDb ();
+            *db << "DELETE FROM Ledgers WHERE LedgerSeq >= " +
+                std::to_string (first) + ";";
+        }
+        {
+            auto db = app.getTxnDB ().checkoutDb ();
+            *db << "DELETE FROM Transactions;";
+            *db << "DELETE FROM AccountTransactions;";
+        }
+        BEAST_EXPECT(rows (app.getTxnDB (), "Transactions") == 0);
+
+        // Everything but the last ledger is queued and then flushed by
+        // stopping the writer. Once stopped it saves on the caller.
+        RootStoppable parent ("LedgerDBWriter_test");
+        LedgerDBWriter writer (app, parent, env.journal);
+        parent.start ();
+
+        std::size_t saved = 0;
+        for (auto seq = first; seq < last; ++seq)
+        {
+            auto record = makeRecord (env, seq);
+            saved += record.txns.size ();
+            writer.save (std::move (record), false);
+        }
+
+        parent.stop (env.journal);
+        BEAST_EXPECT(writer.isStopped ());
+        BEAST_EXPECT(writer.size () == 0);
+
+        {
+            auto record = makeRecord (env, last);
+            saved += record.txns.size ();
+            writer.save (std::move (record), false);
+        }
+
+        BEAST_EXPECT(writer.size () == 0);
+        BEAST_EXPECT(! writer.overloaded ());
+        BEAST_EXPECT(rows (app.getLedgerDB (), "Ledgers") == ledgers);
+        BEAST_EXPECT(rows (app.getTxnDB (), "Transactions") == txns);
+        BEAST_EXPECT(rows (app.getTxnDB (), "AccountTransactions") ==
+            acctTxns);
+
+        auto const json = writer.getJson ();
+        BEAST_EXPECT(json[jss::queued].asUInt () == 0);
+        BEAST_EXPECT(json[jss::ledgers] ==
+            std::to_string (last - first + 1));
+        BEAST_EXPECT(json[jss::transactions] == std::to_string (saved));
+        BEAST_EXPECT(json[jss::max_batch].asUInt () >= 1);
+        BEAST_EXPECT(json[jss::max_batch].asUInt () <=
+            LedgerDBWriter::maxBatch);
+        BEAST_EXPECT(json.isMember (jss::latency_ms));
+
+        // Write jobs scheduled before the stop capture the writer.
+        app.getJobQueue ().rendezvous ();
+    }
+
+public:
+    void
+    run () override
+    {
+        testSave ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(LedgerDBWriter,app,ripple);
+
+}
+}
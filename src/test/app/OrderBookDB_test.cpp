@@ -0,0 +1,122 @@
+
+
+#include <ripple/app/ledger/AcceptedLedger.h>
+#include <ripple/app/ledger/OrderBookDB.h>
+#include <ripple/beast/unit_test.h>
+#include <test/jtx.h>
+
+namespace ripple {
+namespace test {
+
+class OrderBookDB_test : public beast::unit_test::suite
+{
+    static void
+    publish (jtx::Env& env)
+    {
+        auto& app = env.app ();
+        auto const ledger = env.closed ();
+        AcceptedLedger const accepted (
+            ledger, app.accountIDCache (), app.logs ());
+        app.getOrderBookDB ().processLedger (ledger, accepted);
+    }
+
+    void
+    testIncremental ()
+    {
+        testcase ("incremental");
+
+        using namespace jtx;
+        Env env (*this);
+        Account const gw {"gateway"};
+        Account const alice {"alice"};
+        auto const USD = gw["USD"];
+        auto const EUR = gw["EUR"];
+
+        env.fund (XRP (10000), gw, alice);
+        env.close ();
+        env.trust (USD (1000), alice);
+        env.trust (EUR (1000), alice);
+        env (pay (gw, alice, USD (100)));
+        env (pay (gw, alice, EUR (100)));
+        env.close ();
+        publish (env);
+
+        auto& db = env.app ().getOrderBookDB ();
+        BEAST_EXPECT(! db.isBookToXRP (USD.issue ()));
+        BEAST_EXPECT(db.getBookSize (EUR.issue ()) == 0);
+
+        auto const seq = env.seq (alice);
+        env (offer (alice, USD (10), XRP (10)));
+        env (offer (alice, USD (10), XRP (20)));
+        env (offer (alice, EUR (10), USD (10)));
+        env.close ();
+        publish (env);
+
+        BEAST_EXPECT(db.isBookToXRP (USD.issue ()));
+        BEAST_EXPECT(db.getBookSize (USD.issue ()) == 1);
+        BEAST_EXPECT(db.getBookSize (EUR.issue ()) == 1);
+
+        env (offer_cancel (alice, seq));
+        env (offer_cancel (alice, seq + 2));
+        env.close ();
+        publish (env);
+
+        BEAST_EXPECT(db.isBookToXRP (USD.issue ()));
+        BEAST_EXPECT(db.getBookSize (EUR.issue ()) == 0);
+
+        env (offer_cancel (alice, seq + 1));
+        env.close ();
+        publish (env);
+
+        BEAST_EXPECT(! db.isBookToXRP (USD.issue ()));
+        BEAST_EXPECT(db.getBookSize (USD.issue ()) == 0);
+        BEAST_EXPECT(db.getBooksByTakerPays (USD.issue ()).empty ());
+    }
+
+    void
+    testNoPeriodicRebuild ()
+    {
+        testcase ("no periodic rebuild");
+
+        using namespace jtx;
+        Env env (*this);
+        Account const gw {"gateway"};
+        auto const GBP = gw["GBP"];
+
+        env.fund (XRP (10000), gw);
+        env.close ();
+        publish (env);
+
+        // A book that is not in the ledger only survives for as long as
+        // nothing walks the state map to rebuild the book list.
+        auto& db = env.app ().getOrderBookDB ();
+        db.addOrderBook ({GBP.issue (), xrpIssue ()});
+        BEAST_EXPECT(db.isBookToXRP (GBP.issue ()));
+
+        for (int i = 0; i < 300; ++i)
+        {
+            env.close ();
+            publish (env);
+            db.setup (env.closed ());
+        }
+
+        BEAST_EXPECT(db.isBookToXRP (GBP.issue ()));
+
+        db.invalidate ();
+        db.setup (env.closed ());
+        BEAST_EXPECT(! db.isBookToXRP (GBP.issue ()));
+    }
+
+public:
+    void
+    run () override
+    {
+        testIncremental ();
+        testNoPeriodicRebuild ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(OrderBookDB,app,ripple);
+
+}
+}
@@ -1,6 +1,9 @@
 
 
+#include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/paths/AccountCurrencies.h>
+#include <ripple/app/paths/PathRequest.h>
+#include <ripple/app/paths/PathRequests.h>
 #include <ripple/basics/contract.h>
 #include <ripple/core/JobQueue.h>
 #include <ripple/json/json_reader.h>
@@ -13,6 +16,7 @@
 #include <ripple/rpc/impl/Tuning.h>
 #include <ripple/rpc/RPCHandler.h>
 #include <test/jtx.h>
+#include <test/jtx/WSClient.h>
 #include <ripple/beast/unit_test.h>
 #include <chrono>
 #include <condition_variable>
@@ -432,6 +436,99 @@ public:
         BEAST_EXPECT(equal(sa, Account("alice")["USD"](5)));
     }
 
+    void
+    path_find_deadline()
+    {
+        testcase("path find deadline");
+        using namespace jtx;
+        Env env(*this);
+        auto const gw = Account("gateway");
+        auto const USD = gw["USD"];
+        env.fund(XRP(10000), "alice", "bob", gw);
+        env.trust(USD(600), "alice");
+        env.trust(USD(700), "bob");
+        env(pay(gw, "alice", USD(70)));
+        env.close();
+
+        auto& app = env.app();
+        auto const cache = app.getPathRequests().getLineCache(
+            app.getLedgerMaster().getClosedLedger(), false);
+        Resource::Consumer c;
+        auto const request = std::make_shared<PathRequest>(app, []{}, c, 1,
+            app.getPathRequests(), env.journal);
+
+        STAmount const amount = Account("bob")["USD"](5);
+        Json::Value params = Json::objectValue;
+        params[jss::source_account] = Account("alice").human();
+        params[jss::destination_account] = Account("bob").human();
+        params[jss::destination_amount] = amount.getJson(JsonOptions::none);
+        BEAST_EXPECT(request->doCreate(cache, params).first);
+
+        // Out of time before the first source currency is searched
+        auto result = request->doUpdate(
+            cache, false, std::chrono::steady_clock::now());
+        BEAST_EXPECT(result[jss::incomplete] == true);
+        BEAST_EXPECT(result[jss::alternatives].size() == 0);
+
+        result = request->doUpdate(cache, false);
+        BEAST_EXPECT(! result.isMember(jss::incomplete));
+        BEAST_EXPECT(result[jss::alternatives].size() != 0);
+    }
+
+    void
+    path_find_updates()
+    {
+        testcase("path find updates");
+        using namespace jtx;
+        using namespace std::chrono_literals;
+        Env env(*this);
+        auto const gw = Account("gateway");
+        auto const USD = gw["USD"];
+        env.fund(XRP(10000), "alice", "bob", gw);
+        env.trust(USD(600), "alice");
+        env.trust(USD(700), "bob");
+        env(pay(gw, "alice", USD(70)));
+        env(pay(gw, "bob", USD(50)));
+        env.close();
+
+        std::vector<std::unique_ptr<WSClient>> clients;
+        for (int i = 0; i < 4; ++i)
+        {
+            clients.push_back(makeWSClient(env.app().config()));
+
+            Json::Value params;
+            params[jss::subcommand] = "create";
+            params[jss::source_account] = Account("alice").human();
+            params[jss::destination_account] = Account("bob").human();
+            params[jss::destination_amount] =
+                Account("bob")["USD"](5 + i).value().getJson(
+                    JsonOptions::none);
+            auto const jr = clients.back()->invoke(
+                "path_find", params)[jss::result];
+            BEAST_EXPECT(jr.isMember(jss::alternatives));
+        }
+
+        env(pay(gw, "alice", USD(10)));
+        env.close();
+
+        for (auto& wsc : clients)
+        {
+            BEAST_EXPECT(wsc->findMsg(5s,
+                [](auto const& jv)
+                {
+                    return jv[jss::type] == "path_find" &&
+                        jv.isMember(jss::alternatives);
+                }));
+        }
+
+        auto const counts = env.rpc("get_counts")[jss::result];
+        auto const& pathRequests = counts[jss::path_requests];
+        BEAST_EXPECT(pathRequests[jss::requests].asUInt() == 4);
+        BEAST_EXPECT(pathRequests[jss::updates] != "0");
+        BEAST_EXPECT(pathRequests[jss::lag_ledgers].isMember(jss::peak));
+        BEAST_EXPECT(pathRequests.isMember(jss::line_hit_rate));
+    }
+
     void
     xrp_to_xrp()
     {
@@ -1309,6 +1406,8 @@ public:
         payment_auto_path_find();
         path_find();
         path_find_consume_all();
+        path_find_updates();
+        path_find_deadline();
         alternative_path_consume_both();
         alternative_paths_consume_best_transfer();
         alternative_paths_consume_best_transfer_first();
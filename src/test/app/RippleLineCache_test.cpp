@@ -0,0 +1,95 @@
+
+
+#include <ripple/app/paths/RippleLineCache.h>
+#include <ripple/beast/unit_test.h>
+#include <test/jtx.h>
+#include <thread>
+
+namespace ripple {
+namespace test {
+
+class RippleLineCache_test : public beast::unit_test::suite
+{
+    void
+    testConcurrent ()
+    {
+        testcase ("concurrent");
+
+        using namespace jtx;
+        Env env (*this);
+        Account const gw {"gateway"};
+        std::vector<Account> accounts;
+        for (int i = 0; i < 8; ++i)
+            accounts.emplace_back ("account" + std::to_string (i));
+
+        env.fund (XRP (10000), gw);
+        for (auto const& account : accounts)
+            env.fund (XRP (10000), account);
+        env.close ();
+        for (std::size_t i = 0; i < accounts.size (); ++i)
+        {
+            env.trust (gw["USD"] (1000), accounts[i]);
+            if (i % 2)
+                env.trust (gw["EUR"] (1000), accounts[i]);
+        }
+        env.close ();
+
+        auto const cache = std::make_shared<RippleLineCache> (env.closed ());
+
+        std::vector<AccountID> ids;
+        for (auto const& account : accounts)
+            ids.push_back (account.id ());
+        cache->prefetch ({ ids.front () }, env.app ().getJobQueue ());
+        BEAST_EXPECT(cache->getMisses () == 1);
+
+        std::vector<std::thread> threads;
+        std::vector<std::size_t> found (4 * accounts.size ());
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back (
+                [&, t]
+                {
+                    for (std::size_t i = 0; i < ids.size (); ++i)
+                        found[t * ids.size () + i] =
+                            cache->getRippleLines (ids[i]).size ();
+                });
+        }
+        for (auto& thread : threads)
+            thread.join ();
+
+        for (int t = 0; t < 4; ++t)
+        {
+            for (std::size_t i = 0; i < ids.size (); ++i)
+                BEAST_EXPECT(found[t * ids.size () + i] == (i % 2 ? 2 : 1));
+        }
+        BEAST_EXPECT(cache->getRippleLines (gw.id ()).size () ==
+            2 * accounts.size () - accounts.size () / 2);
+
+        BEAST_EXPECT(cache->getMisses () >= 1 + ids.size ());
+        BEAST_EXPECT(cache->getHits () + cache->getMisses () ==
+            1 + 4 * ids.size () + 1);
+        BEAST_EXPECT(cache->getHitRate () > 0.0f);
+
+        auto const prefetched =
+            std::make_shared<RippleLineCache> (env.closed ());
+        prefetched->prefetch (ids, env.app ().getJobQueue ());
+        BEAST_EXPECT(prefetched->getMisses () == ids.size ());
+        for (std::size_t i = 0; i < ids.size (); ++i)
+            BEAST_EXPECT(prefetched->getRippleLines (ids[i]).size () ==
+                (i % 2 ? 2 : 1));
+        BEAST_EXPECT(prefetched->getMisses () == ids.size ());
+        BEAST_EXPECT(prefetched->getHits () == ids.size ());
+    }
+
+public:
+    void
+    run () override
+    {
+        testConcurrent ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(RippleLineCache,app,ripple);
+
+}
+}
@@ -0,0 +1,223 @@
+#include <ripple/app/misc/HashRouter.h>
+#include <ripple/app/misc/SignatureBatch.h>
+#include <ripple/app/tx/apply.h>
+#include <ripple/basics/chrono.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/Feature.h>
+#include <test/jtx.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace ripple {
+namespace test {
+
+class SignatureBatch_test : public beast::unit_test::suite
+{
+    std::shared_ptr<STTx const>
+    corrupt (std::shared_ptr<STTx const> const& stx)
+    {
+        STObject obj (*stx);
+        auto sig = obj.getFieldVL (sfTxnSignature);
+        sig[sig.size () / 2] ^= 0x55;
+        obj.setFieldVL (sfTxnSignature, sig);
+
+        Serializer s;
+        obj.add (s);
+        SerialIter sit (s.slice ());
+        return std::make_shared<STTx const> (sit);
+    }
+
+    // Counts callbacks and lets the test wait for an expected number.
+    struct Calls
+    {
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::size_t count = 0;
+
+        SignatureBatch::callback_type
+        callback ()
+        {
+            return [this] ()
+            {
+                std::lock_guard<std::mutex> lock (mutex);
+                ++count;
+                cond.notify_all ();
+            };
+        }
+
+        bool
+        wait (std::size_t expected)
+        {
+            std::unique_lock<std::mutex> lock (mutex);
+            return cond.wait_for (lock, std::chrono::seconds (30),
+                [&] { return count >= expected; });
+        }
+    };
+
+    std::vector<std::shared_ptr<STTx const>>
+    makeTxs (jtx::Env& env, jtx::Account const& from,
+        jtx::Account const& to, std::size_t count)
+    {
+        using namespace jtx;
+        auto const seq = env.seq (from);
+        std::vector<std::shared_ptr<STTx const>> txs;
+        for (std::size_t i = 0; i < count; ++i)
+            txs.push_back (env.jt (pay (from, to, XRP (1)),
+                jtx::seq (seq + i)).stx);
+        return txs;
+    }
+
+    void
+    testBatch (KeyType type, std::size_t count)
+    {
+        testcase (std::string ("batch ") + to_string (type) +
+            " " + std::to_string (count));
+
+        using namespace jtx;
+        Env env (*this);
+        Account const alice {"alice", type};
+        Account const bob {"bob"};
+        env.fund (XRP (10000), alice, bob);
+        env.close ();
+
+        auto txs = makeTxs (env, alice, bob, count);
+        for (std::size_t i = 4; i < count; i += 5)
+            txs[i] = corrupt (txs[i]);
+
+        HashRouter router (stopwatch (),
+            HashRouter::getDefaultHoldTime (),
+            HashRouter::getDefaultRecoverLimit ());
+        SignatureBatch batch (router, env.app ().getJobQueue (),
+            env.app ().getIOService (), 4,
+            std::chrono::milliseconds (10), env.journal);
+
+        Calls calls;
+        auto const rules = env.current ()->rules ();
+        for (auto const& stx : txs)
+            batch.add (stx, rules, calls.callback ());
+
+        BEAST_EXPECT (calls.wait (count));
+        env.app ().getJobQueue ().rendezvous ();
+
+        BEAST_EXPECT (calls.count == count);
+        BEAST_EXPECT (batch.size () == 0);
+        BEAST_EXPECT (batch.getVerified () == count);
+        BEAST_EXPECT (batch.getBatches () >= 1);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto const valid = checkSignature (router, *txs[i], rules);
+            if (i % 5 == 4)
+                BEAST_EXPECT (valid.first == Validity::SigBad);
+            else
+                BEAST_EXPECT (valid.first == Validity::SigGoodOnly);
+        }
+    }
+
+    void
+    testKnown ()
+    {
+        testcase ("known and repeated signatures");
+
+        using namespace jtx;
+        Env env (*this);
+        Account const alice {"alice"};
+        Account const bob {"bob"};
+        env.fund (XRP (10000), alice, bob);
+        env.close ();
+
+        auto const txs = makeTxs (env, alice, bob, 3);
+
+        HashRouter router (stopwatch (),
+            HashRouter::getDefaultHoldTime (),
+            HashRouter::getDefaultRecoverLimit ());
+        forceValidity (router, txs[0]->getTransactionID (),
+            Validity::SigGoodOnly);
+
+        // A long window keeps every add in a single batch
+        SignatureBatch batch (router, env.app ().getJobQueue (),
+            env.app ().getIOService (), 4,
+            std::chrono::seconds (1), env.journal);
+
+        Calls calls;
+        auto const rules = env.current ()->rules ();
+        batch.add (txs[0], rules, calls.callback ());
+        batch.add (txs[1], rules, calls.callback ());
+        batch.add (txs[1], rules, calls.callback ());
+        batch.add (txs[2], rules, calls.callback ());
+        batch.add (txs[1], rules, calls.callback ());
+
+        BEAST_EXPECT (calls.wait (5));
+        env.app ().getJobQueue ().rendezvous ();
+
+        BEAST_EXPECT (batch.size () == 0);
+        BEAST_EXPECT (batch.getBatches () == 1);
+        BEAST_EXPECT (batch.getVerified () == 2);
+        for (auto const& stx : txs)
+            BEAST_EXPECT (checkSignature (router, *stx, rules).first ==
+                Validity::SigGoodOnly);
+    }
+
+    void
+    testFull ()
+    {
+        testcase ("full batch");
+
+        using namespace jtx;
+        Env env (*this);
+        Account const alice {"alice"};
+        Account const bob {"bob"};
+        env.fund (XRP (10000), alice, bob);
+        env.close ();
+
+        auto const txs = makeTxs (env, alice, bob,
+            SignatureBatch::maxBatch + 1);
+
+        HashRouter router (stopwatch (),
+            HashRouter::getDefaultHoldTime (),
+            HashRouter::getDefaultRecoverLimit ());
+        {
+            // The window never closes during the test: only a full
+            // batch is dispatched, and the straggler waits.
+            SignatureBatch batch (router, env.app ().getJobQueue (),
+                env.app ().getIOService (), 4,
+                std::chrono::hours (1), env.journal);
+
+            Calls calls;
+            auto const rules = env.current ()->rules ();
+            for (std::size_t i = 0; i < SignatureBatch::maxBatch; ++i)
+                batch.add (txs[i], rules, calls.callback ());
+
+            BEAST_EXPECT (calls.wait (SignatureBatch::maxBatch));
+            env.app ().getJobQueue ().rendezvous ();
+
+            batch.add (txs.back (), rules, calls.callback ());
+            env.app ().getJobQueue ().rendezvous ();
+
+            BEAST_EXPECT (calls.count == SignatureBatch::maxBatch);
+            BEAST_EXPECT (batch.size () == 1);
+            BEAST_EXPECT (batch.getBatches () == 1);
+            BEAST_EXPECT (batch.getVerified () == SignatureBatch::maxBatch);
+        }
+        // Destruction cancels the window's timer without waiting it out
+        pass ();
+    }
+
+public:
+    void run () override
+    {
+        for (auto const type : {KeyType::secp256k1, KeyType::ed25519})
+        {
+            testBatch (type, 1);
+            testBatch (type, 100);
+        }
+        testKnown ();
+        testFull ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SignatureBatch,app,ripple);
+
+}
+}
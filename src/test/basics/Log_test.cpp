@@ -0,0 +1,142 @@
+
+
+#include <ripple/basics/Log.h>
+#include <ripple/beast/unit_test.h>
+#include <test/unit_test/FileDirGuard.h>
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+class Log_test : public beast::unit_test::suite
+{
+    static std::size_t
+    countLines (boost::filesystem::path const& path,
+        std::string const& match)
+    {
+        std::ifstream in (path.string ());
+        std::size_t count = 0;
+        for (std::string line; std::getline (in, line);)
+        {
+            if (line.find (match) != std::string::npos)
+                ++count;
+        }
+        return count;
+    }
+
+    void
+    testDrop ()
+    {
+        testcase ("drop");
+
+        using namespace beast::severities;
+        test::detail::FileDirGuard file (*this, "log_test_dir", "debug.log", "");
+
+        Logs logs (kTrace);
+        logs.silent (true);
+        BEAST_EXPECT(logs.open (file.file ()));
+        logs.startAsync (4, Logs::Overflow::drop);
+
+        int const count = 10000;
+        for (int i = 0; i < count; ++i)
+            logs.write (kInfo, "Test", "message " + std::to_string (i), false);
+        logs.write (kFatal, "Test", "fatal message", false);
+
+        BEAST_EXPECT(countLines (file.file (), "fatal message") == 1);
+
+        logs.stopAsync ();
+
+        auto const written = countLines (file.file (), "Test:NFO message");
+        BEAST_EXPECT(written + logs.dropped () == count);
+        BEAST_EXPECT(written >= 1);
+        if (logs.dropped () != 0)
+            BEAST_EXPECT(countLines (file.file (), "dropped by a full") >= 1);
+    }
+
+    void
+    testBlockAndRotate ()
+    {
+        testcase ("block and rotate");
+
+        using namespace beast::severities;
+        test::detail::FileDirGuard file (*this, "log_test_dir", "debug.log", "");
+        auto const rotated = file.subdir () / "debug.log.1";
+
+        Logs logs (kTrace);
+        logs.silent (true);
+        BEAST_EXPECT(logs.open (file.file ()));
+        logs.startAsync (4, Logs::Overflow::block);
+
+        int const count = 2000;
+        for (int i = 0; i < count; ++i)
+            logs.write (kInfo, "Test", "before " + std::to_string (i), false);
+        logs.flush ();
+
+        boost::filesystem::rename (file.file (), rotated);
+        logs.rotate ();
+
+        for (int i = 0; i < count; ++i)
+            logs.write (kInfo, "Test", "after " + std::to_string (i), false);
+        logs.stopAsync ();
+
+        logs.write (kInfo, "Test", "after stop", false);
+
+        BEAST_EXPECT(logs.dropped () == 0);
+        BEAST_EXPECT(countLines (rotated, "Test:NFO before") == count);
+        BEAST_EXPECT(countLines (file.file (), "Test:NFO after") == count + 1);
+
+        boost::filesystem::remove (rotated);
+    }
+
+    void
+    testFatalUnderLoad ()
+    {
+        testcase ("fatal under load");
+
+        using namespace beast::severities;
+        test::detail::FileDirGuard file (*this, "log_test_dir", "debug.log", "");
+
+        Logs logs (kTrace);
+        logs.silent (true);
+        BEAST_EXPECT(logs.open (file.file ()));
+        logs.startAsync (4, Logs::Overflow::block);
+
+        // Writers keep the queue full, so it never drains while the
+        // fatal message is written.
+        std::atomic<bool> stop {false};
+        std::vector<std::thread> writers;
+        for (int t = 0; t < 4; ++t)
+        {
+            writers.emplace_back ([&logs, &stop]
+            {
+                while (! stop)
+                    logs.write (kInfo, "Test", "busy", false);
+            });
+        }
+
+        logs.write (kFatal, "Test", "fatal message", false);
+        BEAST_EXPECT(countLines (file.file (), "fatal message") == 1);
+
+        stop = true;
+        for (auto& w : writers)
+            w.join ();
+        logs.stopAsync ();
+        BEAST_EXPECT(logs.dropped () == 0);
+    }
+
+public:
+    void
+    run () override
+    {
+        testDrop ();
+        testBlockAndRotate ();
+        testFatalUnderLoad ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Log, ripple_basics, ripple);
+
+}
@@ -0,0 +1,141 @@
+
+
+#include <ripple/basics/MemoryGovernor.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/jss.h>
+#include <test/unit_test/SuiteJournal.h>
+#include <algorithm>
+
+namespace ripple {
+
+class MemoryGovernor_test : public beast::unit_test::suite
+{
+    struct FakeCache
+    {
+        std::uint64_t bytes = 0;
+        std::uint64_t hits = 0;
+        std::uint64_t evicted = 0;
+        bool pinned = false;
+
+        std::uint64_t getBytes () const
+        {
+            return bytes;
+        }
+
+        std::uint64_t takeMarginalHits ()
+        {
+            auto const h = hits;
+            hits = 0;
+            return h;
+        }
+
+        std::uint64_t evictBytes (std::uint64_t n)
+        {
+            n = std::min (n, bytes);
+            if (pinned)
+                n /= 2;
+            bytes -= n;
+            evicted += n;
+            return n;
+        }
+    };
+
+public:
+    void
+    testUnlimited ()
+    {
+        testcase ("unlimited");
+
+        test::SuiteJournal journal ("MemoryGovernor_test", *this);
+        MemoryGovernor governor (0, journal);
+
+        FakeCache a {1000, 0};
+        FakeCache b {2000, 5};
+        governor.add ("a", a);
+        governor.add ("b", b);
+
+        BEAST_EXPECT(governor.govern () == 0);
+        BEAST_EXPECT(a.evicted == 0);
+        BEAST_EXPECT(b.evicted == 0);
+
+        auto const jv = governor.getJson ();
+        BEAST_EXPECT(jv[jss::bytes] == "3000");
+        BEAST_EXPECT(jv[jss::passes] == "1");
+        BEAST_EXPECT(jv[jss::caches]["a"][jss::bytes] == "1000");
+        BEAST_EXPECT(jv[jss::caches]["b"][jss::marginal_hits] == "5");
+    }
+
+    void
+    testBudget ()
+    {
+        testcase ("budget");
+
+        test::SuiteJournal journal ("MemoryGovernor_test", *this);
+
+        {
+            MemoryGovernor governor (1000, journal);
+            FakeCache cold {600, 0};
+            FakeCache hot {600, 100};
+            governor.add ("hot", hot);
+            governor.add ("cold", cold);
+
+            BEAST_EXPECT(governor.govern () == 200);
+            BEAST_EXPECT(cold.evicted == 200);
+            BEAST_EXPECT(hot.evicted == 0);
+
+            hot.hits = 100;
+            BEAST_EXPECT(governor.govern () == 0);
+
+            auto const jv = governor.getJson ();
+            BEAST_EXPECT(jv[jss::bytes] == "1000");
+            BEAST_EXPECT(jv[jss::evicted] == "200");
+            BEAST_EXPECT(jv[jss::over_budget] == "1");
+            BEAST_EXPECT(jv[jss::caches]["cold"][jss::evicted] == "200");
+        }
+
+        {
+            MemoryGovernor governor (300, journal);
+            FakeCache cold {600, 0};
+            FakeCache hot {600, 100};
+            governor.add ("hot", hot);
+            governor.add ("cold", cold);
+
+            BEAST_EXPECT(governor.govern () == 900);
+            BEAST_EXPECT(cold.evicted == 600);
+            BEAST_EXPECT(hot.evicted == 300);
+        }
+
+        {
+            MemoryGovernor governor (1000, journal);
+            FakeCache small {400, 10};
+            FakeCache large {4000, 10};
+            governor.add ("small", small);
+            governor.add ("large", large);
+
+            BEAST_EXPECT(governor.govern () == 3400);
+            BEAST_EXPECT(small.evicted == 200);
+            BEAST_EXPECT(large.evicted == 3200);
+        }
+
+        {
+            MemoryGovernor governor (100, journal);
+            FakeCache pinned {1000, 0};
+            pinned.pinned = true;
+            governor.add ("pinned", pinned);
+
+            BEAST_EXPECT(governor.govern () == 575);
+            BEAST_EXPECT(pinned.evicted == 575);
+        }
+    }
+
+    void
+    run () override
+    {
+        testUnlimited ();
+        testBudget ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(MemoryGovernor,ripple_basics,ripple);
+
+}
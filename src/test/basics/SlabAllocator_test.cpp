@@ -0,0 +1,72 @@
+
+
+#include <ripple/basics/SlabAllocator.h>
+#include <ripple/beast/unit_test.h>
+#include <algorithm>
+#include <cstring>
+#include <set>
+
+namespace ripple {
+
+class SlabAllocator_test : public beast::unit_test::suite
+{
+public:
+    void
+    testAllocate ()
+    {
+        testcase ("allocate");
+
+        SlabAllocator slab (40, 1024);
+        BEAST_EXPECT(slab.size () == 48);
+        BEAST_EXPECT(slab.getStats ().count == 0);
+        BEAST_EXPECT(slab.getStats ().reserved == 0);
+
+        std::vector<void*> v;
+        for (int i = 0; i < 100; ++i)
+        {
+            auto const p = slab.allocate ();
+            BEAST_EXPECT(reinterpret_cast<std::uintptr_t> (p) %
+                SlabAllocator::alignment == 0);
+            std::memset (p, i, slab.size ());
+            v.push_back (p);
+        }
+
+        BEAST_EXPECT(std::set<void*> (v.begin (), v.end ()).size () == 100);
+
+        auto const stats = slab.getStats ();
+        BEAST_EXPECT(stats.size == 48);
+        BEAST_EXPECT(stats.count == 100);
+        BEAST_EXPECT(stats.reserved == 5 * 21 * 48);
+
+        for (int i = 0; i < 100; ++i)
+        {
+            auto const p = static_cast<std::uint8_t*> (v[i]);
+            BEAST_EXPECT(std::all_of (p, p + slab.size (),
+                [i](std::uint8_t b) { return b == static_cast<std::uint8_t> (i); }));
+        }
+
+        for (auto p : v)
+            slab.deallocate (p);
+        BEAST_EXPECT(slab.getStats ().count == 0);
+        BEAST_EXPECT(slab.getStats ().reserved == stats.reserved);
+
+        std::set<void*> reused;
+        for (int i = 0; i < 100; ++i)
+            reused.insert (slab.allocate ());
+        BEAST_EXPECT(reused == std::set<void*> (v.begin (), v.end ()));
+        BEAST_EXPECT(slab.getStats ().reserved == stats.reserved);
+
+        for (auto p : reused)
+            slab.deallocate (p);
+    }
+
+    void
+    run () override
+    {
+        testAllocate ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SlabAllocator,ripple_basics,ripple);
+
+}
@@ -1,10 +1,16 @@
 
 
 #include <ripple/basics/chrono.h>
+#include <ripple/basics/PartitionedTaggedCache.h>
 #include <ripple/basics/TaggedCache.h>
 #include <ripple/beast/unit_test.h>
 #include <ripple/beast/clock/manual_clock.h>
+#include <ripple/beast/xor_shift_engine.h>
 #include <test/unit_test/SuiteJournal.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 namespace ripple {
 
@@ -13,8 +19,10 @@ namespace ripple {
 class TaggedCache_test : public beast::unit_test::suite
 {
 public:
-    void run () override
+    void testTaggedCache ()
     {
+        testcase ("TaggedCache");
+
         using namespace std::chrono_literals;
         using namespace beast::severities;
         test::SuiteJournal journal ("TaggedCache_test", *this);
@@ -109,10 +117,355 @@ public:
             BEAST_EXPECT(c.getTrackSize() == 0);
         }
     }
+
+    void testPartitioned ()
+    {
+        testcase ("PartitionedTaggedCache");
+
+        using namespace std::chrono_literals;
+        using namespace beast::severities;
+        test::SuiteJournal journal ("TaggedCache_test", *this);
+
+        TestStopwatch clock;
+        clock.set (0);
+
+        using Key = int;
+        using Value = std::string;
+        using Cache = PartitionedTaggedCache <Key, Value>;
+
+        Cache c ("test", 64, 1s, clock, journal,
+            beast::insight::NullCollector::New (), 4);
+        BEAST_EXPECT(c.partitions() == 4);
+        BEAST_EXPECT(c.getTargetSize() == 64);
+
+        {
+            for (Key k = 0; k < 32; ++k)
+                BEAST_EXPECT(! c.insert (k, std::to_string (k)));
+            BEAST_EXPECT(c.getCacheSize() == 32);
+            BEAST_EXPECT(c.getTrackSize() == 32);
+            BEAST_EXPECT(c.getKeys().size() == 32);
+
+            for (Key k = 0; k < 32; ++k)
+            {
+                std::string s;
+                BEAST_EXPECT(c.retrieve (k, s));
+                BEAST_EXPECT(s == std::to_string (k));
+            }
+            BEAST_EXPECT(! c.fetch (32));
+            BEAST_EXPECT(c.getHitRate() > 96.0f);
+
+            ++clock;
+            c.sweep ();
+            BEAST_EXPECT(c.getCacheSize() == 0);
+            BEAST_EXPECT(c.getTrackSize() == 0);
+        }
+
+        {
+            BEAST_EXPECT(! c.insert (3, "three"));
+
+            {
+                Cache::mapped_ptr const p1 (c.fetch (3));
+                Cache::mapped_ptr p2 (std::make_shared <Value> ("three"));
+                BEAST_EXPECT(c.canonicalize (3, p2));
+                BEAST_EXPECT(p1.get() == p2.get());
+                ++clock;
+                c.sweep ();
+                BEAST_EXPECT(c.getCacheSize() == 0);
+                BEAST_EXPECT(c.getTrackSize() == 1);
+                BEAST_EXPECT(c.refreshIfPresent (3));
+                BEAST_EXPECT(c.getCacheSize() == 1);
+                BEAST_EXPECT(c.del (3, false));
+            }
+
+            BEAST_EXPECT(c.getCacheSize() == 0);
+            BEAST_EXPECT(c.getTrackSize() == 0);
+        }
+    }
+
+    void testConcurrent ()
+    {
+        testcase ("concurrent canonicalize");
+
+        using namespace std::chrono_literals;
+        test::SuiteJournal journal ("TaggedCache_test", *this);
+
+        TestStopwatch clock;
+        clock.set (0);
+
+        using Key = int;
+        using Value = int;
+        using Cache = PartitionedTaggedCache <Key, Value>;
+
+        Cache c ("test", 0, 1min, clock, journal,
+            beast::insight::NullCollector::New (), 4);
+
+        int const keys = 4096;
+        std::size_t const threads = 8;
+
+        std::vector<std::vector<Cache::mapped_ptr>> seen (threads);
+        std::atomic<std::size_t> changed {0};
+        std::atomic<bool> start {false};
+        std::vector<std::thread> workers;
+        for (std::size_t t = 0; t < threads; ++t)
+        {
+            workers.emplace_back (
+                [&, t]
+                {
+                    auto& mine = seen[t];
+                    mine.resize (keys);
+                    beast::xor_shift_engine rng (t + 1);
+                    while (! start)
+                        std::this_thread::yield ();
+                    for (int n = 0; n < 4 * keys; ++n)
+                    {
+                        auto const k = static_cast<Key> (rng() % keys);
+                        auto v = c.fetch (k);
+                        if (! v)
+                        {
+                            v = std::make_shared <Value> (k);
+                            c.canonicalize (k, v);
+                        }
+                        if (! mine[k])
+                            mine[k] = v;
+                        else if (mine[k] != v)
+                            ++changed;
+                    }
+                });
+        }
+        start = true;
+        for (auto& w : workers)
+            w.join ();
+
+        // Every thread that touched a key must hold the one object the
+        // cache kept for it.
+        std::size_t mismatched = 0;
+        for (Key k = 0; k < keys; ++k)
+        {
+            auto const cached = c.fetch (k);
+            for (auto const& mine : seen)
+            {
+                if (mine[k] && mine[k] != cached)
+                    ++mismatched;
+            }
+            if (cached)
+                BEAST_EXPECT(*cached == k);
+        }
+        BEAST_EXPECT(changed == 0);
+        BEAST_EXPECT(mismatched == 0);
+        BEAST_EXPECT(c.getCacheSize () == c.getTrackSize ());
+        BEAST_EXPECT(c.getCacheSize () <= keys);
+    }
+
+    void testBytes ()
+    {
+        testcase ("bytes");
+
+        using namespace std::chrono_literals;
+        test::SuiteJournal journal ("TaggedCache_test", *this);
+
+        TestStopwatch clock;
+        clock.set (0);
+
+        using Key = int;
+        using Value = std::string;
+
+        {
+            using Cache = TaggedCache <Key, Value>;
+            Cache c ("test", 0, 10s, clock, journal);
+            BEAST_EXPECT(c.getBytes () == 0);
+
+            Cache::mapped_ptr held (std::make_shared <Value> ("zero"));
+            BEAST_EXPECT(! c.canonicalize (0, held));
+            auto const per = c.getBytes ();
+            BEAST_EXPECT(per > sizeof (Value));
+            for (Key k = 1; k < 10; ++k)
+            {
+                ++clock;
+                BEAST_EXPECT(! c.insert (k, std::to_string (k)));
+            }
+            BEAST_EXPECT(c.getBytes () == 10 * per);
+
+            BEAST_EXPECT(c.evictBytes (3 * per) == 3 * per);
+            BEAST_EXPECT(c.getBytes () == 7 * per);
+            BEAST_EXPECT(c.getCacheSize () == 7);
+            BEAST_EXPECT(c.getTrackSize () == 8);
+            BEAST_EXPECT(! c.fetch (2));
+
+            BEAST_EXPECT(c.fetch (0) == held);
+            BEAST_EXPECT(c.getBytes () == 8 * per);
+            held.reset ();
+
+            c.takeMarginalHits ();
+            clock.set (20);
+            BEAST_EXPECT(c.fetch (5) != nullptr);
+            BEAST_EXPECT(c.fetch (5) != nullptr);
+            BEAST_EXPECT(c.takeMarginalHits () == 1);
+            BEAST_EXPECT(c.takeMarginalHits () == 0);
+
+            BEAST_EXPECT(c.evictBytes (100 * per) == 8 * per);
+            BEAST_EXPECT(c.getBytes () == 0);
+            BEAST_EXPECT(c.getCacheSize () == 0);
+        }
+
+        {
+            using Cache = TaggedCache <Key, Value>;
+            Cache c ("test", 0, 10s, clock, journal);
+
+            for (Key k = 0; k < 10000; ++k)
+            {
+                ++clock;
+                BEAST_EXPECT(! c.insert (k, std::to_string (k)));
+            }
+            auto const before = c.getBytes ();
+
+            auto const freed = c.evictBytes (before / 2);
+            BEAST_EXPECT(freed > before / 4);
+            BEAST_EXPECT(freed < 3 * before / 4);
+            BEAST_EXPECT(! c.fetch (0));
+            BEAST_EXPECT(c.fetch (9999));
+        }
+
+        {
+            // Nearly every entry is weak, so the sampled buckets are
+            // unlikely to hold any cached entry
+            using Cache = TaggedCache <Key, Value>;
+            Cache c ("test", 0, 10s, clock, journal);
+
+            std::vector <Cache::mapped_ptr> held;
+            for (Key k = 0; k < 50000; ++k)
+            {
+                held.push_back (std::make_shared <Value> (std::to_string (k)));
+                BEAST_EXPECT(! c.canonicalize (k, held.back ()));
+            }
+            BEAST_EXPECT(c.evictBytes (c.getBytes ()) > 0);
+            BEAST_EXPECT(c.getBytes () == 0);
+            BEAST_EXPECT(c.getTrackSize () == 50000);
+
+            for (Key k : {7, 25000, 49999})
+            {
+                ++clock;
+                BEAST_EXPECT(c.fetch (k) == held[k]);
+            }
+            BEAST_EXPECT(c.getCacheSize () == 3);
+            auto const per = c.getBytes () / 3;
+
+            BEAST_EXPECT(c.evictBytes (per) == per);
+            BEAST_EXPECT(c.getCacheSize () == 2);
+            BEAST_EXPECT(c.getBytes () == 2 * per);
+            BEAST_EXPECT(c.getTrackSize () == 50000);
+
+            held.clear ();
+            BEAST_EXPECT(c.evictBytes (per) == per);
+            BEAST_EXPECT(c.getCacheSize () == 1);
+            BEAST_EXPECT(c.getTrackSize () == 1);
+            BEAST_EXPECT(c.fetch (49999));
+        }
+
+        {
+            using Cache = PartitionedTaggedCache <Key, Value>;
+            Cache c ("test", 0, 10s, clock, journal,
+                beast::insight::NullCollector::New (), 4);
+
+            for (Key k = 0; k < 64; ++k)
+            {
+                ++clock;
+                BEAST_EXPECT(! c.insert (k, std::to_string (k)));
+            }
+            auto const before = c.getBytes ();
+            BEAST_EXPECT(before > 64 * sizeof (Value));
+
+            auto const freed = c.evictBytes (before / 2);
+            BEAST_EXPECT(freed >= before / 2);
+            BEAST_EXPECT(c.getBytes () == before - freed);
+            BEAST_EXPECT(c.getBytes () > 0);
+
+            c.clear ();
+            BEAST_EXPECT(c.getBytes () == 0);
+        }
+    }
+
+    void run () override
+    {
+        testTaggedCache ();
+        testPartitioned ();
+        testConcurrent ();
+        testBytes ();
+    }
 };
 
 BEAST_DEFINE_TESTSUITE(TaggedCache,common,ripple);
 
+// Compares fetch and canonicalize throughput of a single TaggedCache and a
+// PartitionedTaggedCache as the number of contending threads grows.
+class TaggedCacheContention_test : public beast::unit_test::suite
+{
+public:
+    template <class Cache>
+    std::chrono::milliseconds
+    measure (Cache& c, std::size_t threads, int keys, int ops)
+    {
+        std::atomic<bool> start {false};
+        std::vector<std::thread> workers;
+        workers.reserve (threads);
+        for (std::size_t i = 0; i < threads; ++i)
+        {
+            workers.emplace_back (
+                [&c, &start, keys, ops, seed = i + 1]
+                {
+                    beast::xor_shift_engine rng (seed);
+                    while (! start)
+                        std::this_thread::yield ();
+                    for (int n = 0; n < ops; ++n)
+                    {
+                        auto const k = static_cast<int> (rng() % keys);
+                        if (! c.fetch (k))
+                        {
+                            auto v = std::make_shared <int> (k);
+                            c.canonicalize (k, v);
+                        }
+                    }
+                });
+        }
+
+        using namespace std::chrono;
+        auto const before = steady_clock::now ();
+        start = true;
+        for (auto& t : workers)
+            t.join ();
+        return duration_cast<milliseconds> (steady_clock::now () - before);
+    }
+
+    void run () override
+    {
+        using namespace std::chrono_literals;
+        test::SuiteJournal journal ("TaggedCacheContention_test", *this);
+        TestStopwatch clock;
+
+        int const keys = 65536;
+        int const ops = 1000000;
+        std::size_t const maxThreads =
+            std::max (2u, std::thread::hardware_concurrency ());
+
+        for (std::size_t threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            TaggedCache <int, int> single (
+                "single", keys, 1min, clock, journal);
+            PartitionedTaggedCache <int, int> partitioned (
+                "partitioned", keys, 1min, clock, journal);
+
+            auto const t1 = measure (single, threads, keys, ops);
+            auto const t2 = measure (partitioned, threads, keys, ops);
+
+            log << threads << " threads, " << ops << " ops/thread: " <<
+                "TaggedCache " << t1.count () << "ms, " <<
+                "PartitionedTaggedCache " << t2.count () << "ms" << std::endl;
+            pass ();
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(TaggedCacheContention,common,ripple);
+
 }
 
 
@@ -3,6 +3,12 @@
 #include <ripple/core/JobQueue.h>
 #include <ripple/beast/unit_test.h>
 #include <test/jtx/Env.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 namespace ripple {
 namespace test {
@@ -99,16 +105,143 @@ class JobQueue_test : public beast::unit_test::suite
         }
     }
 
+    void testLanes()
+    {
+        jtx::Env env {*this};
+
+        JobQueue& jQueue = env.app().getJobQueue();
+        jQueue.setThreadCount (4, false);
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool release = false;
+        std::atomic<int> running {0};
+        std::atomic<int> peak {0};
+        std::atomic<int> ran {0};
+
+        auto limited = [&] (Job&)
+        {
+            auto const now = ++running;
+            int expected = peak;
+            while (now > expected && ! peak.compare_exchange_weak (
+                expected, now));
+            {
+                std::unique_lock<std::mutex> lock (mutex);
+                cv.wait (lock, [&] { return release; });
+            }
+            --running;
+            ++ran;
+        };
+
+        for (int i = 0; i < 6; ++i)
+            BEAST_EXPECT (jQueue.addJob (jtLEDGER_DATA, "JobLaneTest1",
+                limited));
+
+        std::atomic<int> clientRan {0};
+        for (int i = 0; i < 100; ++i)
+            BEAST_EXPECT (jQueue.addJob (jtCLIENT, "JobLaneTest2",
+                [&clientRan] (Job&) { ++clientRan; }));
+
+        while (clientRan != 100 || running != 2)
+            std::this_thread::yield ();
+
+        BEAST_EXPECT (jQueue.getJobCount (jtLEDGER_DATA) == 4);
+        BEAST_EXPECT (jQueue.getJobCountTotal (jtLEDGER_DATA) == 6);
+
+        {
+            std::lock_guard<std::mutex> lock (mutex);
+            release = true;
+        }
+        cv.notify_all ();
+
+        jQueue.rendezvous ();
+        BEAST_EXPECT (ran == 6);
+        BEAST_EXPECT (peak == 2);
+        BEAST_EXPECT (jQueue.getJobCountTotal (jtLEDGER_DATA) == 0);
+    }
+
 public:
     void run() override
     {
         testAddJob();
         testPostCoro();
+        testLanes();
     }
 };
 
 BEAST_DEFINE_TESTSUITE(JobQueue, core, ripple);
 
+
+
+class JobQueueThroughput_test : public beast::unit_test::suite
+{
+public:
+    std::chrono::milliseconds
+    measure (JobQueue& jQueue, std::size_t producers, int jobs)
+    {
+        static JobType const types[] = {
+            jtCLIENT, jtTRANSACTION, jtPROPOSAL_t,
+            jtVALIDATION_t, jtLEDGER_DATA, jtWRITE };
+
+        std::atomic<bool> start {false};
+        std::atomic<int> done {0};
+        std::vector<std::thread> threads;
+        threads.reserve (producers);
+        for (std::size_t i = 0; i < producers; ++i)
+        {
+            threads.emplace_back (
+                [&, i]
+                {
+                    while (! start)
+                        std::this_thread::yield ();
+                    for (int n = 0; n < jobs; ++n)
+                    {
+                        jQueue.addJob (
+                            types[(i + n) % std::extent<decltype(types)>::value],
+                            "JobQueueThroughput",
+                            [&done] (Job&) { ++done; });
+                    }
+                });
+        }
+
+        using namespace std::chrono;
+        auto const before = steady_clock::now ();
+        start = true;
+        for (auto& t : threads)
+            t.join ();
+        jQueue.rendezvous ();
+        auto const elapsed =
+            duration_cast<milliseconds> (steady_clock::now () - before);
+        BEAST_EXPECT (done == static_cast<int> (producers) * jobs);
+        return elapsed;
+    }
+
+    void run () override
+    {
+        jtx::Env env {*this};
+        JobQueue& jQueue = env.app().getJobQueue();
+
+        int const jobs = 100000;
+        std::size_t const maxThreads =
+            std::max (2u, std::thread::hardware_concurrency ());
+
+        for (std::size_t threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            jQueue.setThreadCount (static_cast<int> (threads), false);
+
+            auto const elapsed = measure (jQueue, threads, jobs);
+            auto const total = threads * jobs;
+
+            log << threads << " workers, " << threads << " producers, " <<
+                total << " jobs: " << elapsed.count () << "ms, " <<
+                (total * 1000 / std::max<std::int64_t> (1, elapsed.count ())) <<
+                " jobs/s" << std::endl;
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(JobQueueThroughput, core, ripple);
+
 } 
 } 
 
@@ -2,6 +2,7 @@
 
 #include <test/jtx/WSClient.h>
 #include <test/jtx.h>
+#include <ripple/basics/strHex.h>
 #include <ripple/json/json_reader.h>
 #include <ripple/json/to_string.h>
 #include <ripple/protocol/jss.h>
@@ -258,8 +259,15 @@ private:
         }
 
         Json::Value jv;
-        Json::Reader jr;
-        jr.parse(buffer_string(rb_.data()), jv);
+        if (ws_.got_binary())
+        {
+            jv[jss::binary] = strHex(buffer_string(rb_.data()));
+        }
+        else
+        {
+            Json::Reader jr;
+            jr.parse(buffer_string(rb_.data()), jv);
+        }
         rb_.consume(rb_.size());
         auto m = std::make_shared<msg>(
             std::move(jv));
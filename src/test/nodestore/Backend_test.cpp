@@ -59,6 +59,33 @@ public:
                 fetchCopyOfBatch (*backend, &copy, batch);
                 BEAST_EXPECT(areBatchesEqual (batch, copy));
             }
+
+            if (backend->canFetchBatch ())
+            {
+                std::vector <void const*> keys;
+                keys.reserve (batch.size ());
+                for (auto const& object : batch)
+                    keys.push_back (object->getHash ().cbegin ());
+
+                Batch const copy = backend->fetchBatch (
+                    keys.size (), keys.data ());
+                BEAST_EXPECT(areBatchesEqual (batch, copy));
+
+                auto const missing = createPredictableBatch (
+                    numObjectsToTest, rng());
+                keys.clear ();
+                for (auto const& object : missing)
+                    keys.push_back (object->getHash ().cbegin ());
+
+                Batch const none = backend->fetchBatch (
+                    keys.size (), keys.data ());
+                BEAST_EXPECT(none.size () == missing.size ());
+                BEAST_EXPECT(std::all_of (none.begin (), none.end (),
+                    [](std::shared_ptr<NodeObject> const& object)
+                    {
+                        return object == nullptr;
+                    }));
+            }
         }
 
         {
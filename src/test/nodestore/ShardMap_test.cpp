@@ -0,0 +1,232 @@
+
+
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/core/ConfigSections.h>
+#include <ripple/nodestore/DatabaseShard.h>
+#include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/ShardMap.h>
+#include <ripple/beast/utility/temp_dir.h>
+#include <test/jtx.h>
+#include <test/nodestore/TestBase.h>
+#include <test/unit_test/SuiteJournal.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <tuple>
+
+namespace ripple {
+namespace NodeStore {
+
+class ShardMap_test : public TestBase
+{
+public:
+    void
+    testShardMap (std::uint64_t const seedValue)
+    {
+        testcase ("ShardMap");
+
+        DummyScheduler scheduler;
+        beast::temp_dir tempDir;
+        test::SuiteJournal journal ("ShardMap_test", *this);
+
+        Section params;
+        params.set ("type", "nudb");
+        params.set ("path", tempDir.path());
+
+        auto batch = createPredictableBatch (numObjectsToTest, seedValue);
+        {
+            std::unique_ptr <Backend> backend =
+                Manager::instance().make_Backend (
+                    params, scheduler, journal);
+            backend->open();
+            storeBatch (*backend, batch);
+        }
+
+        boost::filesystem::path const dir {tempDir.path()};
+        BEAST_EXPECT(! ShardMap::create (
+            dir, [] { return true; }, journal));
+        BEAST_EXPECT(! boost::filesystem::exists (dir / ShardMap::fileName));
+
+        BEAST_EXPECT(ShardMap::create (
+            dir, [] { return false; }, journal));
+
+        {
+            ShardMap map (dir, journal);
+            map.open (false);
+            BEAST_EXPECT(map.size () == batch.size ());
+            map.verify ();
+
+            Batch copy;
+            fetchCopyOfBatch (map, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual (batch, copy));
+
+            std::vector <void const*> keys;
+            for (auto const& object : batch)
+                keys.push_back (object->getHash ().cbegin ());
+            BEAST_EXPECT(areBatchesEqual (batch,
+                map.fetchBatch (keys.size (), keys.data ())));
+
+            auto const missing = createPredictableBatch (
+                numObjectsToTest, seedValue + 1);
+            for (auto const& object : missing)
+            {
+                std::shared_ptr <NodeObject> found;
+                BEAST_EXPECT(map.fetch (object->getHash ().cbegin (),
+                    &found) == notFound);
+                BEAST_EXPECT(! found);
+            }
+
+            Batch visited;
+            map.for_each ([&](std::shared_ptr <NodeObject> object)
+                {
+                    visited.push_back (std::move (object));
+                });
+            std::sort (batch.begin (), batch.end (), LessThan{});
+            BEAST_EXPECT(areBatchesEqual (batch, visited));
+
+            try
+            {
+                map.store (batch.front ());
+                fail ("store succeeded");
+            }
+            catch (std::runtime_error const&)
+            {
+                pass ();
+            }
+        }
+
+        auto const file {dir / ShardMap::fileName};
+        boost::filesystem::resize_file (file,
+            boost::filesystem::file_size (file) - 1);
+        try
+        {
+            ShardMap map (dir, journal);
+            map.open (false);
+            fail ("truncated map opened");
+        }
+        catch (std::runtime_error const&)
+        {
+            pass ();
+        }
+    }
+
+    void
+    testDatabaseShard ()
+    {
+        testcase ("DatabaseShard");
+
+        using namespace test::jtx;
+        using namespace std::chrono;
+
+        beast::temp_dir shardDir;
+        auto const makeConfig = [&]
+        {
+            return envconfig ([&](std::unique_ptr<Config> cfg)
+                {
+                    auto& section = cfg->section (
+                        ConfigSection::shardDatabase ());
+                    section.set ("path", shardDir.path ());
+                    section.set ("max_size_gb", "3");
+                    section.set ("ledgers_per_shard", "256");
+                    section.set ("earliest_seq", "257");
+                    return cfg;
+                });
+        };
+
+        // Ledger headers and state tree roots spread across shard 1
+        std::vector<std::tuple<uint256, std::uint32_t, Blob>> objects;
+        {
+            Env env {*this, makeConfig ()};
+            auto const db = env.app ().getShardStore ();
+            if (! BEAST_EXPECT(db))
+                return;
+
+            auto& lm = env.app ().getLedgerMaster ();
+            while (lm.getValidLedgerIndex () <= 512)
+                env.close ();
+            auto const valid = lm.getValidLedgerIndex ();
+
+            for (auto seq = db->prepareLedger (valid); seq;)
+            {
+                auto const ledger = lm.getLedgerBySeq (*seq);
+                if (! BEAST_EXPECT(ledger && db->copyLedger (ledger)))
+                    return;
+                if (! db->getCompleteShards ().empty ())
+                    break;
+                seq = db->prepareLedger (valid);
+            }
+            if (! BEAST_EXPECT(db->getCompleteShards () == "1"))
+                return;
+
+            for (std::uint32_t const seq : {257u, 384u, 512u})
+            {
+                auto const ledger = lm.getLedgerBySeq (seq);
+                if (! BEAST_EXPECT(ledger))
+                    return;
+                for (auto const& hash :
+                    {ledger->info ().hash, ledger->info ().accountHash})
+                {
+                    auto const object = db->fetch (hash, seq);
+                    if (BEAST_EXPECT(object))
+                        objects.emplace_back (hash, seq, object->getData ());
+                }
+            }
+        }
+
+        auto const checkFetch = [&](DatabaseShard& db)
+        {
+            for (auto const& o : objects)
+            {
+                auto const object = db.fetch (std::get<0> (o), std::get<1> (o));
+                BEAST_EXPECT(object && object->getData () == std::get<2> (o));
+            }
+        };
+
+        // A complete shard found at startup is converted without delay.
+        // Reads keep working while the backend is swapped underneath them.
+        boost::filesystem::path const dir {
+            boost::filesystem::path {shardDir.path ()} / "1"};
+        {
+            Env env {*this, makeConfig ()};
+            auto const db = env.app ().getShardStore ();
+            if (! BEAST_EXPECT(db))
+                return;
+
+            auto const deadline = steady_clock::now () + seconds {30};
+            while (boost::filesystem::exists (dir / "nudb.dat") &&
+                steady_clock::now () < deadline)
+            {
+                checkFetch (*db);
+                std::this_thread::sleep_for (milliseconds {10});
+            }
+            BEAST_EXPECT(boost::filesystem::exists (dir / ShardMap::fileName));
+            BEAST_EXPECT(! boost::filesystem::exists (dir / "nudb.dat"));
+            BEAST_EXPECT(! boost::filesystem::exists (dir / "nudb.key"));
+            checkFetch (*db);
+        }
+
+        // Reopened, the shard is served from the map alone
+        {
+            Env env {*this, makeConfig ()};
+            auto const db = env.app ().getShardStore ();
+            if (! BEAST_EXPECT(db))
+                return;
+            BEAST_EXPECT(db->getCompleteShards () == "1");
+            BEAST_EXPECT(! boost::filesystem::exists (dir / "nudb.dat"));
+            checkFetch (*db);
+        }
+    }
+
+    void
+    run () override
+    {
+        testShardMap (50);
+        testDatabaseShard ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ShardMap,NodeStore,ripple);
+
+}
+}
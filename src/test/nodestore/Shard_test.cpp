@@ -0,0 +1,200 @@
+
+
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/core/ConfigSections.h>
+#include <ripple/nodestore/DatabaseShard.h>
+#include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/impl/Shard.h>
+#include <ripple/protocol/HashPrefix.h>
+#include <ripple/beast/utility/temp_dir.h>
+#include <test/jtx.h>
+#include <test/unit_test/SuiteJournal.h>
+#include <boost/serialization/string.hpp>
+#include <fstream>
+#include <numeric>
+
+namespace ripple {
+namespace NodeStore {
+
+class Shard_test : public beast::unit_test::suite
+{
+    // Shard 1 holds enough ledgers for two validation segments
+    static constexpr std::uint32_t firstSeq = 513;
+    static constexpr std::uint32_t lastSeq = 1024;
+    static constexpr std::uint32_t ledgers = lastSeq - firstSeq + 1;
+
+    test::SuiteJournal journal_;
+
+    // Copy shard 1 from the node store, leaving out the state tree root
+    // of ledger `skip` if it is set.
+    std::shared_ptr<Shard>
+    makeShard (test::jtx::Env& env, Scheduler& scheduler,
+        nudb::context& ctx, boost::optional<std::uint32_t> skip = {})
+    {
+        auto& app = env.app ();
+        auto shard = std::make_shared<Shard> (*app.getShardStore (), 1,
+            16384, std::chrono::seconds {60}, journal_);
+        if (! BEAST_EXPECT(shard->open (app.config ().section (
+            ConfigSection::shardDatabase ()), scheduler, ctx)))
+        {
+            return {};
+        }
+
+        auto& backend = *shard->getBackend ();
+        while (! shard->complete ())
+        {
+            auto const seq = shard->prepare ();
+            auto const ledger = seq ?
+                app.getLedgerMaster ().getLedgerBySeq (*seq) : nullptr;
+            if (! BEAST_EXPECT(ledger))
+                return {};
+
+            Serializer s (1024);
+            s.add32 (HashPrefix::ledgerMaster);
+            addRaw (ledger->info (), s);
+            backend.store (NodeObject::createObject (hotLEDGER,
+                std::move (s.modData ()), ledger->info ().hash));
+
+            auto const copy = [&](SHAMapAbstractNode& node)
+            {
+                auto const hash = node.getNodeHash ().as_uint256 ();
+                if (*seq == skip && hash == ledger->info ().accountHash)
+                    return true;
+                if (auto object = app.getNodeStore ().fetch (hash, *seq))
+                    backend.store (object);
+                return true;
+            };
+            ledger->stateMap ().visitNodes (copy);
+            ledger->txMap ().visitNodes (copy);
+            BEAST_EXPECT(shard->setStored (ledger));
+        }
+        return shard;
+    }
+
+    void
+    writeCheckpoint (boost::filesystem::path const& path, uint256 const& hash)
+    {
+        RangeSet<std::uint32_t> all;
+        all.insert (range (firstSeq, lastSeq));
+        auto const s = to_string (hash);
+
+        boost::filesystem::create_directories (path.parent_path ());
+        std::ofstream ofs {path.string (), std::ios::trunc};
+        boost::archive::text_oarchive ar (ofs);
+        ar & s;
+        ar & all;
+    }
+
+public:
+    Shard_test ()
+        : journal_ ("Shard_test", *this)
+    {
+    }
+
+    void
+    testValidate ()
+    {
+        testcase ("validate");
+
+        using namespace test::jtx;
+
+        beast::temp_dir shardDir;
+        Env env {*this, envconfig ([&](std::unique_ptr<Config> cfg)
+            {
+                auto& section = cfg->section (
+                    ConfigSection::shardDatabase ());
+                section.set ("path", shardDir.path ());
+                section.set ("max_size_gb", "3");
+                section.set ("ledgers_per_shard", "512");
+                section.set ("earliest_seq", std::to_string (firstSeq));
+                section.set ("mapped", "0");
+                return cfg;
+            })};
+        if (! BEAST_EXPECT(env.app ().getShardStore ()))
+            return;
+
+        auto& lm = env.app ().getLedgerMaster ();
+        while (lm.getValidLedgerIndex () <= lastSeq)
+            env.close ();
+
+        DummyScheduler scheduler;
+        nudb::context ctx;
+        ctx.start ();
+
+        boost::filesystem::path const root {shardDir.path ()};
+        auto const checkpoint = root / "validation" / "1";
+        auto const inShard = root / "1" / "validate.txt";
+        std::size_t const parallel = 2;
+
+        {
+            auto shard = makeShard (env, scheduler, ctx);
+            if (! shard)
+                return;
+
+            // Stop both segments at the first checkpoint
+            std::uint32_t interrupted {0};
+            env.app ().shardFamily ()->reset ();
+            BEAST_EXPECT(! shard->validate (env.app (), parallel,
+                [&](std::uint32_t count)
+                {
+                    interrupted += count;
+                    return false;
+                }));
+            BEAST_EXPECT(interrupted > 0 && interrupted < ledgers);
+            BEAST_EXPECT(boost::filesystem::exists (checkpoint));
+            BEAST_EXPECT(! boost::filesystem::exists (inShard));
+
+            // The resumed pass reports the checkpoint first, then only
+            // the ledgers that were not yet validated
+            std::vector<std::uint32_t> resumed;
+            env.app ().shardFamily ()->reset ();
+            BEAST_EXPECT(shard->validate (env.app (), parallel,
+                [&](std::uint32_t count)
+                {
+                    resumed.push_back (count);
+                    return true;
+                }));
+            BEAST_EXPECT(! resumed.empty () &&
+                resumed.front () == interrupted);
+            BEAST_EXPECT(std::accumulate (resumed.begin (), resumed.end (),
+                std::uint32_t {0}) == ledgers);
+            BEAST_EXPECT(! boost::filesystem::exists (checkpoint));
+        }
+        boost::filesystem::remove_all (root / "1");
+
+        {
+            // A shard missing one state tree root
+            auto shard = makeShard (env, scheduler, ctx, 900);
+            if (! shard)
+                return;
+
+            // Checkpoints shipped in the shard directory, or written for
+            // different ledgers, must not skip any verification
+            RangeSet<std::uint32_t> all;
+            all.insert (range (firstSeq, lastSeq));
+            {
+                std::ofstream ofs {inShard.string (), std::ios::trunc};
+                boost::archive::text_oarchive ar (ofs);
+                ar & all;
+            }
+            writeCheckpoint (checkpoint, uint256 {});
+
+            env.app ().shardFamily ()->reset ();
+            BEAST_EXPECT(! shard->validate (env.app (), parallel));
+            BEAST_EXPECT(! boost::filesystem::exists (checkpoint));
+            BEAST_EXPECT(! boost::filesystem::exists (inShard));
+        }
+    }
+
+    void
+    run () override
+    {
+        testValidate ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Shard,NodeStore,ripple);
+
+}
+}
@@ -0,0 +1,191 @@
+
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/overlay/Message.h>
+#include <ripple/overlay/impl/ProtocolMessage.h>
+#include <ripple/protocol/messages.h>
+#include <boost/asio/buffer.hpp>
+#include <memory>
+#include <string>
+
+namespace ripple {
+
+class compression_test : public beast::unit_test::suite
+{
+    struct Handler
+    {
+        std::shared_ptr<protocol::TMLedgerData> received;
+        std::size_t size {0};
+        std::size_t uncompressedSize {0};
+        int corrupt {0};
+
+        boost::system::error_code
+        onMessageUnknown (std::uint16_t)
+        {
+            return {};
+        }
+
+        void
+        onMessageCorrupt (std::uint16_t)
+        {
+            ++corrupt;
+        }
+
+        boost::system::error_code
+        onMessageBegin (std::uint16_t,
+            std::shared_ptr<::google::protobuf::Message> const&,
+            std::size_t s, std::size_t u)
+        {
+            size = s;
+            uncompressedSize = u;
+            return {};
+        }
+
+        void
+        onMessage (std::shared_ptr<protocol::TMLedgerData> const& m)
+        {
+            received = m;
+        }
+
+        template <class T>
+        void
+        onMessage (std::shared_ptr<T> const&)
+        {
+        }
+
+        void
+        onMessageEnd (std::uint16_t,
+            std::shared_ptr<::google::protobuf::Message> const&)
+        {
+        }
+    };
+
+    static
+    protocol::TMLedgerData
+    makeLedgerData (int nodes)
+    {
+        protocol::TMLedgerData data;
+        data.set_ledgerhash (std::string (32, 'h'));
+        data.set_ledgerseq (7);
+        data.set_type (protocol::liAS_NODE);
+        for (int i = 0; i < nodes; ++i)
+        {
+            auto node = data.add_nodes ();
+            node->set_nodeid (std::string (33, static_cast<char> (i)));
+            node->set_nodedata (std::string (200, 'd') + std::to_string (i));
+        }
+        return data;
+    }
+
+public:
+    void
+    testRoundTrip ()
+    {
+        testcase ("round trip");
+
+        auto const data = makeLedgerData (100);
+        Message m (data, protocol::mtLEDGER_DATA);
+        auto const& plain = m.getBuffer ();
+        auto const& compressed = m.getBuffer (true);
+
+        BEAST_EXPECT(&m.getBuffer (true) == &compressed);
+        BEAST_EXPECT(compressed.size () < plain.size ());
+        BEAST_EXPECT(! Message::compressed (plain.begin (), plain.end ()));
+        BEAST_EXPECT(Message::compressed (
+            compressed.begin (), compressed.end ()));
+        BEAST_EXPECT(Message::getType (compressed) ==
+            protocol::mtLEDGER_DATA);
+        BEAST_EXPECT(Message::getLength (compressed) + Message::kHeaderBytes ==
+            compressed.size ());
+
+        Handler h;
+        auto const result = invokeProtocolMessage (
+            boost::asio::buffer (compressed), h);
+        BEAST_EXPECT(! result.second);
+        BEAST_EXPECT(result.first == compressed.size ());
+        BEAST_EXPECT(h.size == compressed.size ());
+        BEAST_EXPECT(h.uncompressedSize == plain.size ());
+        if (BEAST_EXPECT(h.received))
+        {
+            BEAST_EXPECT(h.received->SerializeAsString () ==
+                data.SerializeAsString ());
+        }
+
+        Handler p;
+        auto const r = invokeProtocolMessage (
+            boost::asio::buffer (plain), p);
+        BEAST_EXPECT(! r.second);
+        BEAST_EXPECT(p.uncompressedSize == 0);
+        BEAST_EXPECT(p.received);
+    }
+
+    void
+    testSmall ()
+    {
+        testcase ("small messages");
+
+        auto const data = makeLedgerData (1);
+        Message m (data, protocol::mtLEDGER_DATA);
+        BEAST_EXPECT(&m.getBuffer (true) == &m.getBuffer ());
+    }
+
+    void
+    testCorrupt ()
+    {
+        testcase ("corrupt payload");
+
+        Message m (makeLedgerData (100), protocol::mtLEDGER_DATA);
+        auto buffer = m.getBuffer (true);
+        for (std::size_t i = Message::kHeaderBytes + 4; i < buffer.size (); ++i)
+            buffer[i] = 0xFF;
+
+        Handler h;
+        auto const result = invokeProtocolMessage (
+            boost::asio::buffer (buffer), h);
+        BEAST_EXPECT(result.second);
+        BEAST_EXPECT(! h.received);
+        BEAST_EXPECT(h.corrupt == 1);
+    }
+
+    void
+    testOversized ()
+    {
+        testcase ("oversized declared size");
+
+        Message m (makeLedgerData (100), protocol::mtLEDGER_DATA);
+        auto const& compressed = m.getBuffer (true);
+
+        // Claim far more than the compressed bytes could ever expand to
+        auto claim = [&](std::uint32_t bytes)
+        {
+            auto buffer = compressed;
+            auto const p = buffer.data () + Message::kHeaderBytes;
+            p[0] = static_cast<std::uint8_t> (bytes >> 24);
+            p[1] = static_cast<std::uint8_t> (bytes >> 16);
+            p[2] = static_cast<std::uint8_t> (bytes >> 8);
+            p[3] = static_cast<std::uint8_t> (bytes);
+
+            Handler h;
+            auto const result = invokeProtocolMessage (
+                boost::asio::buffer (buffer), h);
+            BEAST_EXPECT(result.second);
+            BEAST_EXPECT(! h.received);
+            BEAST_EXPECT(h.corrupt == 1);
+        };
+        claim (Message::kMaxMessageSize);
+        claim ((compressed.size () - Message::kHeaderBytes - 4) * 255 + 1);
+    }
+
+    void
+    run () override
+    {
+        testRoundTrip ();
+        testSmall ();
+        testCorrupt ();
+        testOversized ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(compression,overlay,ripple);
+
+}
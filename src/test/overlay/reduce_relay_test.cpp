@@ -0,0 +1,177 @@
+
+
+#include <ripple/beast/clock/manual_clock.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/overlay/impl/Squelch.h>
+#include <ripple/protocol/SecretKey.h>
+#include <map>
+
+namespace ripple {
+
+namespace test {
+
+class reduce_relay_test : public beast::unit_test::suite
+{
+    using clock_type = beast::manual_clock<std::chrono::steady_clock>;
+
+    struct Handler : squelch::SquelchHandler
+    {
+        std::map<Peer::id_t, std::chrono::seconds> squelched;
+        std::set<Peer::id_t> unsquelched;
+
+        void
+        squelch (PublicKey const&, Peer::id_t id,
+            std::chrono::seconds duration) override
+        {
+            squelched[id] = duration;
+        }
+
+        void
+        unsquelch (PublicKey const&, Peer::id_t id) override
+        {
+            unsquelched.insert (id);
+        }
+    };
+
+    static
+    void
+    select (squelch::Slots<clock_type>& slots,
+        PublicKey const& validator, Peer::id_t peers, clock_type& clock)
+    {
+        for (std::size_t i = 0; i < squelch::messageThreshold; ++i)
+        {
+            for (Peer::id_t id = 1; id <= peers; ++id)
+                slots.update (validator, id, clock.now ());
+        }
+    }
+
+public:
+    void
+    testSelection ()
+    {
+        testcase ("selection");
+
+        using namespace std::chrono;
+        auto const validator = randomKeyPair (KeyType::ed25519).first;
+        clock_type clock;
+        Handler handler;
+        squelch::Slots<clock_type> slots (handler);
+
+        slots.update (validator, 1, clock.now ());
+        BEAST_EXPECT(slots.size () == 1);
+        BEAST_EXPECT(slots.getSelected (validator).empty ());
+
+        select (slots, validator, 6, clock);
+        BEAST_EXPECT((slots.getSelected (validator) ==
+            std::set<Peer::id_t> {1, 2, 3, 4, 5}));
+        BEAST_EXPECT(handler.squelched.size () == 1);
+        if (BEAST_EXPECT(handler.squelched.count (6)))
+        {
+            auto const duration = handler.squelched[6];
+            BEAST_EXPECT(duration >= squelch::minSquelchDuration);
+            BEAST_EXPECT(duration <= squelch::maxSquelchDuration);
+        }
+
+        slots.update (validator, 7, clock.now ());
+        BEAST_EXPECT(handler.squelched.count (7));
+
+        handler.squelched.clear ();
+        slots.update (validator, 6, clock.now ());
+        BEAST_EXPECT(handler.squelched.empty ());
+        BEAST_EXPECT(handler.unsquelched.empty ());
+    }
+
+    void
+    testIdle ()
+    {
+        testcase ("idle peers");
+
+        using namespace std::chrono;
+        auto const validator = randomKeyPair (KeyType::ed25519).first;
+        clock_type clock;
+        Handler handler;
+        squelch::Slots<clock_type> slots (handler);
+
+        select (slots, validator, 6, clock);
+        clock.advance (squelch::idled + 1s);
+        for (Peer::id_t id = 1; id <= 4; ++id)
+            slots.update (validator, id, clock.now ());
+
+        slots.deleteIdlePeers (clock.now ());
+        BEAST_EXPECT(slots.getSelected (validator).empty ());
+        BEAST_EXPECT(handler.unsquelched == std::set<Peer::id_t> {6});
+
+        clock.advance (squelch::idled + 1s);
+        slots.deleteIdlePeers (clock.now ());
+        BEAST_EXPECT(slots.size () == 0);
+    }
+
+    void
+    testDeletePeer ()
+    {
+        testcase ("delete peer");
+
+        auto const validator = randomKeyPair (KeyType::ed25519).first;
+        clock_type clock;
+        Handler handler;
+        squelch::Slots<clock_type> slots (handler);
+
+        select (slots, validator, 7, clock);
+        BEAST_EXPECT(handler.squelched.size () == 2);
+
+        slots.deletePeer (7);
+        BEAST_EXPECT(slots.getSelected (validator).size () ==
+            squelch::maxSelectedPeers);
+        BEAST_EXPECT(handler.unsquelched.empty ());
+
+        slots.deletePeer (1);
+        BEAST_EXPECT(slots.getSelected (validator).empty ());
+        BEAST_EXPECT(handler.unsquelched == std::set<Peer::id_t> {6});
+
+        handler.squelched.clear ();
+        select (slots, validator, 6, clock);
+        BEAST_EXPECT(slots.getSelected (validator).size () ==
+            squelch::maxSelectedPeers);
+        BEAST_EXPECT(handler.squelched.size () == 1);
+    }
+
+    void
+    testExpire ()
+    {
+        testcase ("squelch expiration");
+
+        using namespace std::chrono;
+        auto const validator = randomKeyPair (KeyType::ed25519).first;
+        clock_type clock;
+        Handler handler;
+        squelch::Slots<clock_type> slots (handler);
+
+        select (slots, validator, 6, clock);
+        BEAST_EXPECT(handler.squelched.count (6));
+        auto const duration = handler.squelched[6];
+        handler.squelched.clear ();
+
+        clock.advance (duration - 1s);
+        slots.update (validator, 6, clock.now ());
+        BEAST_EXPECT(handler.squelched.empty ());
+
+        clock.advance (1s);
+        slots.update (validator, 6, clock.now ());
+        BEAST_EXPECT(handler.squelched.count (6));
+    }
+
+    void
+    run () override
+    {
+        testSelection ();
+        testIdle ();
+        testDeletePeer ();
+        testExpire ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(reduce_relay,overlay,ripple);
+
+}
+
+}
@@ -0,0 +1,144 @@
+
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/overlay/impl/SendQueue.h>
+#include <ripple/overlay/impl/Tuning.h>
+#include <ripple/protocol/messages.h>
+#include <cstring>
+#include <string>
+
+namespace ripple {
+
+class send_queue_test : public beast::unit_test::suite
+{
+    static
+    Message::pointer
+    makePing (std::uint32_t seq)
+    {
+        protocol::TMPing ping;
+        ping.set_type (protocol::TMPing::ptPING);
+        ping.set_seq (seq);
+        return std::make_shared<Message> (ping, protocol::mtPING);
+    }
+
+    static
+    Message::pointer
+    makeValidation (std::size_t bytes)
+    {
+        protocol::TMValidation val;
+        val.set_validation (std::string (bytes, 'v'));
+        return std::make_shared<Message> (val, protocol::mtVALIDATION);
+    }
+
+    static
+    std::vector<std::uint8_t>
+    concat (std::vector<Message::pointer> const& messages)
+    {
+        std::vector<std::uint8_t> result;
+        for (auto const& m : messages)
+        {
+            auto const& buffer = m->getBuffer ();
+            result.insert (result.end (), buffer.begin (), buffer.end ());
+        }
+        return result;
+    }
+
+    static
+    bool
+    equal (boost::asio::const_buffer const& buffer,
+        std::vector<std::uint8_t> const& expected)
+    {
+        return boost::asio::buffer_size (buffer) == expected.size () &&
+            std::memcmp (boost::asio::buffer_cast<void const*> (buffer),
+                expected.data (), expected.size ()) == 0;
+    }
+
+public:
+    void
+    testPriority ()
+    {
+        testcase ("priority");
+
+        SendQueue q;
+        auto const ping1 = makePing (1);
+        auto const ping2 = makePing (2);
+        auto const val = makeValidation (100);
+        BEAST_EXPECT(! SendQueue::priority (*ping1));
+        BEAST_EXPECT(SendQueue::priority (*val));
+
+        q.push (ping1);
+        q.push (ping2);
+        q.push (val);
+        BEAST_EXPECT(q.size () == 3);
+        BEAST_EXPECT(! q.writing ());
+
+        BEAST_EXPECT(equal (q.prepare (false), concat ({val, ping1, ping2})));
+        BEAST_EXPECT(q.writing ());
+        BEAST_EXPECT(q.size () == 3);
+
+        q.push (makePing (3));
+        BEAST_EXPECT(q.size () == 4);
+        BEAST_EXPECT(q.consume () == 3);
+        BEAST_EXPECT(q.size () == 1);
+        BEAST_EXPECT(boost::asio::buffer_size (q.prepare (false)) ==
+            makePing (3)->getBuffer ().size ());
+        BEAST_EXPECT(q.consume () == 1);
+        BEAST_EXPECT(q.empty ());
+    }
+
+    void
+    testLimits ()
+    {
+        testcase ("limits");
+
+        SendQueue q;
+        for (std::uint32_t i = 0; i < Tuning::sendBatchMessages + 8; ++i)
+            q.push (makePing (i));
+        q.prepare (false);
+        BEAST_EXPECT(q.consume () == Tuning::sendBatchMessages);
+        q.prepare (false);
+        BEAST_EXPECT(q.consume () == 8);
+        BEAST_EXPECT(q.empty ());
+
+        std::vector<Message::pointer> const vals {
+            makeValidation (6000), makeValidation (6000),
+            makeValidation (6000)};
+        for (auto const& m : vals)
+            q.push (m);
+        BEAST_EXPECT(equal (q.prepare (false), concat ({vals[0], vals[1]})));
+        BEAST_EXPECT(q.consume () == 2);
+        BEAST_EXPECT(equal (q.prepare (false), concat ({vals[2]})));
+        BEAST_EXPECT(q.consume () == 1);
+    }
+
+    void
+    testLarge ()
+    {
+        testcase ("large messages");
+
+        SendQueue q;
+        auto const large = makeValidation (Tuning::sendBatchBytes);
+        q.push (makePing (1));
+        q.push (large);
+
+        auto const buffer = q.prepare (false);
+        BEAST_EXPECT(boost::asio::buffer_cast<void const*> (buffer) ==
+            large->getBuffer ().data ());
+        BEAST_EXPECT(boost::asio::buffer_size (buffer) ==
+            large->getBuffer ().size ());
+        BEAST_EXPECT(q.consume () == 1);
+        BEAST_EXPECT(q.size () == 1);
+    }
+
+    void
+    run () override
+    {
+        testPriority ();
+        testLimits ();
+        testLarge ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(send_queue,overlay,ripple);
+
+}
@@ -4,6 +4,8 @@
 #include <ripple/protocol/Feature.h>
 #include <ripple/protocol/jss.h>
 #include <test/jtx.h>
+#include <test/jtx/WSClient.h>
+#include <set>
 
 namespace ripple {
 
@@ -415,6 +417,77 @@ public:
         }
     }
 
+    void testStream()
+    {
+        using namespace test::jtx;
+        using namespace std::chrono_literals;
+        Env env { *this, envconfig(no_admin) };
+        Account const gw { "gateway" };
+        env.fund(XRP(100000), gw);
+
+        int const num_accounts = 20;
+
+        for (auto i = 0; i < num_accounts; i++)
+        {
+            Account const bob { std::string("bob") + std::to_string(i) };
+            env.fund(XRP(1000), bob);
+        }
+        env.close();
+
+        Json::Value jvParams;
+        jvParams[jss::ledger_index] = "closed";
+        jvParams[jss::binary]       = true;
+        auto jrr = env.rpc ( "json", "ledger_data",
+            boost::lexical_cast<std::string>(jvParams)) [jss::result];
+        auto const total_count = jrr[jss::state].size();
+
+        jvParams[jss::stream] = "yes";
+        jrr = env.rpc ( "json", "ledger_data",
+            boost::lexical_cast<std::string>(jvParams)) [jss::result];
+        BEAST_EXPECT( jrr[jss::error] == "invalidParams" );
+
+        jvParams[jss::stream] = true;
+        jrr = env.rpc ( "json", "ledger_data",
+            boost::lexical_cast<std::string>(jvParams)) [jss::result];
+        BEAST_EXPECT( jrr[jss::error] == "notSupported" );
+
+        auto wsc = test::makeWSClient(env.app().config());
+        jvParams[jss::limit] = 4;
+        jrr = wsc->invoke("ledger_data", jvParams)[jss::result];
+        BEAST_EXPECT( ! jrr.isMember(jss::error) );
+        BEAST_EXPECT( ! jrr.isMember(jss::marker) );
+        BEAST_EXPECT( jrr.isMember(jss::ledger) );
+        BEAST_EXPECT( jrr[jss::chunks].asUInt() ==
+            (total_count + 3) / 4 );
+
+        std::set<std::string> seen;
+        std::string last;
+        while (auto jv = wsc->getMsg(100ms))
+        {
+            if (! BEAST_EXPECT( (*jv)[jss::type] == "ledger_data" ))
+                break;
+            BEAST_EXPECT( (*jv)[jss::ledger_hash] == jrr[jss::ledger_hash] );
+            BEAST_EXPECT( checkMarker(*jv) );
+            BEAST_EXPECT( (*jv)[jss::state].size() <= 4 );
+            for (auto const& entry : (*jv)[jss::state])
+            {
+                BEAST_EXPECT( entry[jss::data].isString() );
+                seen.insert(entry[jss::index].asString());
+            }
+            last = std::max(last, (*jv)[jss::marker].asString());
+        }
+        BEAST_EXPECT( seen.size() == total_count );
+
+        jvParams[jss::marker] = *std::next(seen.begin(), 10);
+        jrr = wsc->invoke("ledger_data", jvParams)[jss::result];
+        BEAST_EXPECT( ! jrr.isMember(jss::ledger) );
+        std::size_t resumed = 0;
+        while (auto jv = wsc->getMsg(100ms))
+            resumed += (*jv)[jss::state].size();
+        BEAST_EXPECT( resumed == total_count - 11 );
+        BEAST_EXPECT( last == *seen.rbegin() );
+    }
+
     void run() override
     {
         testCurrentLedgerToLimits(true);
@@ -424,6 +497,7 @@ public:
         testMarkerFollow();
         testLedgerHeader();
         testLedgerType();
+        testStream();
     }
 };
 
@@ -69,6 +69,24 @@ public:
             BEAST_EXPECT(result[jss::result][jss::info]
                 [jss::pubkey_validator] == validator_data::public_key);
         }
+        {
+            Env env(*this);
+            Account const alice {"alice"};
+            env.fund(XRP(10000), alice);
+            for (int i = 0; i < 5; ++i)
+                env(noop(alice));
+            env.close();
+
+            auto const result = env.rpc("server_info");
+            auto const& txApply =
+                result[jss::result][jss::info][jss::tx_apply];
+            BEAST_EXPECT(txApply[jss::queued] == 0);
+            BEAST_EXPECT(txApply[jss::batches] != "0");
+            BEAST_EXPECT(
+                std::stoul(txApply[jss::transactions].asString()) >= 7);
+            BEAST_EXPECT(txApply[jss::preflight_us].isMember(jss::peak));
+            BEAST_EXPECT(txApply[jss::apply_us].isMember(jss::average));
+        }
     }
 
     void run () override
@@ -3,7 +3,9 @@
 #include <ripple/app/main/LoadManager.h>
 #include <ripple/app/misc/LoadFeeTrack.h>
 #include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/basics/StringUtilities.h>
 #include <ripple/core/ConfigSections.h>
+#include <ripple/net/InfoSub.h>
 #include <ripple/protocol/jss.h>
 #include <test/jtx/WSClient.h>
 #include <test/jtx/envconfig.h>
@@ -245,6 +247,113 @@ public:
         BEAST_EXPECT(jv[jss::status] == "success");
     }
 
+    void testSharedMessages()
+    {
+        using namespace std::chrono_literals;
+        using namespace jtx;
+        Env env(*this);
+        auto wsc1 = makeWSClient(env.app().config());
+        auto wsc2 = makeWSClient(env.app().config());
+
+        Json::Value stream;
+        stream[jss::streams] = Json::arrayValue;
+        stream[jss::streams].append("transactions");
+        BEAST_EXPECT(wsc1->invoke("subscribe", stream)[jss::status] == "success");
+        BEAST_EXPECT(wsc2->invoke("subscribe", stream)[jss::status] == "success");
+
+        auto const before = InfoSubMessage::getStats();
+
+        env.fund(XRP(10000), "alice");
+        env.close();
+
+        auto const created = [&](auto const& jv)
+        {
+            return jv[jss::meta]["AffectedNodes"][1u]
+                ["CreatedNode"]["NewFields"][jss::Account] ==
+                    Account("alice").human();
+        };
+        BEAST_EXPECT(wsc1->findMsg(5s, created));
+        BEAST_EXPECT(wsc2->findMsg(5s, created));
+
+        auto const after = InfoSubMessage::getStats();
+        BEAST_EXPECT(after.rendered > before.rendered);
+        BEAST_EXPECT(after.shared > before.shared);
+        BEAST_EXPECT(after.bytesAvoided > before.bytesAvoided);
+
+        auto const counts = env.rpc("get_counts")[jss::result];
+        BEAST_EXPECT(counts.isMember(jss::stream_messages));
+        BEAST_EXPECT(std::stoull(counts[jss::stream_messages]
+            [jss::bytes_avoided].asString()) >= after.bytesAvoided);
+    }
+
+    void testBinary()
+    {
+        using namespace std::chrono_literals;
+        using namespace jtx;
+        Env env(*this);
+        auto wsc = makeWSClient(env.app().config());
+
+        Json::Value stream;
+        stream[jss::streams] = Json::arrayValue;
+        stream[jss::streams].append("transactions");
+        stream[jss::streams].append("ledger");
+        stream[jss::binary] = true;
+        BEAST_EXPECT(wsc->invoke("subscribe", stream)[jss::status] == "success");
+
+        env.fund(XRP(10000), "alice");
+        env.close();
+
+        auto const binary = [](auto const& jv)
+        {
+            return jv.isMember(jss::binary);
+        };
+
+        bool sawTransaction = false;
+        bool sawLedger = false;
+        while (auto const jv = wsc->findMsg(5s, binary))
+        {
+            auto const blob = strUnHex((*jv)[jss::binary].asString());
+            BEAST_EXPECT(blob.second);
+            SerialIter sit(makeSlice(blob.first));
+            BEAST_EXPECT(sit.get8() == InfoSubMessage::binaryVersion);
+
+            auto const type = sit.get8();
+            if (type == InfoSubMessage::binaryTransaction)
+            {
+                BEAST_EXPECT(sit.get8() == 1);
+                BEAST_EXPECT(sit.get32() == env.closed()->info().seq);
+                BEAST_EXPECT(sit.get256() == env.closed()->info().hash);
+                BEAST_EXPECT(sit.get32() == TERtoInt(tesSUCCESS));
+
+                auto const txBlob = sit.getVL();
+                SerialIter txSit(makeSlice(txBlob));
+                STTx const tx(txSit);
+                BEAST_EXPECT(env.closed()->txExists(tx.getTransactionID()));
+                BEAST_EXPECT(! sit.getVL().empty());
+                sawTransaction = true;
+            }
+            else if (type == InfoSubMessage::binaryLedger)
+            {
+                BEAST_EXPECT(sit.get256() == env.closed()->info().hash);
+                BEAST_EXPECT(sit.get32() == env.closed()->info().seq);
+                sawLedger = true;
+            }
+            else
+            {
+                fail("unknown binary message type");
+            }
+
+            if (sawTransaction && sawLedger)
+                break;
+        }
+        BEAST_EXPECT(sawTransaction);
+        BEAST_EXPECT(sawLedger);
+
+        stream[jss::binary] = "yes";
+        BEAST_EXPECT(wsc->invoke("subscribe", stream)
+            [jss::result][jss::error] == "invalidParams");
+    }
+
     void testManifests()
     {
         using namespace jtx;
@@ -614,6 +723,8 @@ public:
         testServer();
         testLedger();
         testTransactions();
+        testSharedMessages();
+        testBinary();
         testManifests();
         testValidations();
         testSubErrors(true);
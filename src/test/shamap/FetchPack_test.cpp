@@ -66,14 +66,13 @@ public:
         beast::Journal mJournal;
     };
 
-    std::shared_ptr <Item>
+    boost::intrusive_ptr <Item const>
     make_random_item (beast::xor_shift_engine& r)
     {
         Serializer s;
         for (int d = 0; d < 3; ++d)
             s.add32 (ripple::rand_int<std::uint32_t>(r));
-        return std::make_shared <Item> (
-            s.getSHA512Half(), s.peekData ());
+        return make_shamapitem (s.getSHA512Half(), s);
     }
 
     void
@@ -84,9 +83,9 @@ public:
     {
         while (n--)
         {
-            std::shared_ptr <SHAMapItem> item (
+            boost::intrusive_ptr<SHAMapItem const> item (
                 make_random_item (r));
-            auto const result (t.addItem (std::move(*item), false, false));
+            auto const result (t.addGiveItem (item, false, false));
             assert (result);
             (void) result;
         }
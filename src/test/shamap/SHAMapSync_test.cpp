@@ -17,15 +17,14 @@ class sync_test : public beast::unit_test::suite
 public:
     beast::xor_shift_engine eng_;
 
-    std::shared_ptr<SHAMapItem> makeRandomAS ()
+    boost::intrusive_ptr<SHAMapItem const> makeRandomAS ()
     {
         Serializer s;
 
         for (int d = 0; d < 3; ++d)
             s.add32 (rand_int<std::uint32_t>(eng_));
 
-        return std::make_shared<SHAMapItem>(
-            s.getSHA512Half(), s.peekData ());
+        return make_shamapitem(s.getSHA512Half(), s);
     }
 
     bool confuseMap (SHAMap& map, int count)
@@ -36,10 +35,10 @@ public:
 
         for (int i = 0; i < count; ++i)
         {
-            std::shared_ptr<SHAMapItem> item = makeRandomAS ();
+            boost::intrusive_ptr<SHAMapItem const> item = makeRandomAS ();
             items.push_back (item->key());
 
-            if (!map.addItem (std::move(*item), false, false))
+            if (!map.addGiveItem (item, false, false))
             {
                 log << "Unable to add item to map\n";
                 return false;
@@ -76,6 +75,86 @@ public:
 
         log << "Run, version 2\n" << std::endl;
         run(SHAMap::version{2}, journal);
+
+        testReference(journal);
+    }
+
+    int sync (SHAMap& source, SHAMap& destination, SHAMap const* have,
+        int& localNodes)
+    {
+        destination.setSynching ();
+
+        std::vector<SHAMapNodeID> rootIDs;
+        std::vector<Blob> rootNodes;
+        BEAST_EXPECT(source.getNodeFat (
+            SHAMapNodeID (), rootIDs, rootNodes, false, 0));
+        BEAST_EXPECT(destination.addRootNode (
+            source.getHash(), makeSlice(rootNodes.front ()),
+            snfWIRE, nullptr).isGood());
+
+        int transferred = 0;
+        while (true)
+        {
+            auto nodesMissing = destination.getMissingNodes (
+                2048, nullptr, have, &localNodes);
+            if (nodesMissing.empty ())
+                break;
+
+            std::vector<SHAMapNodeID> gotNodeIDs;
+            std::vector<Blob> gotNodes;
+            for (auto& it : nodesMissing)
+            {
+                if (!source.getNodeFat (
+                        it.first, gotNodeIDs, gotNodes, false, 0))
+                    fail("", __FILE__, __LINE__);
+            }
+
+            for (std::size_t i = 0; i < gotNodeIDs.size(); ++i)
+            {
+                if (destination.addKnownNode (gotNodeIDs[i],
+                        makeSlice(gotNodes[i]), nullptr).isUseful())
+                    ++transferred;
+            }
+        }
+
+        destination.clearSynching ();
+        return transferred;
+    }
+
+    void testReference(beast::Journal const& journal)
+    {
+        testcase ("reference map");
+
+        TestFamily f(journal), f2(journal);
+        SHAMap previous (SHAMapType::FREE, f, SHAMap::version{1});
+        for (int i = 0; i < 5000; ++i)
+            previous.addGiveItem (makeRandomAS (), false, false);
+        previous.flushDirty (hotACCOUNT_NODE, 1);
+        previous.setImmutable ();
+
+        auto current = previous.snapShot (true);
+        for (int i = 0; i < 10; ++i)
+            current->addGiveItem (makeRandomAS (), false, false);
+        current->setImmutable ();
+
+        int fullLocal = 0;
+        SHAMap full (SHAMapType::FREE, f2, SHAMap::version{1});
+        auto const fullCount = sync (*current, full, &previous, fullLocal);
+        BEAST_EXPECT(current->deepCompare (full));
+
+        // A reference map from another family is ignored
+        BEAST_EXPECT(fullLocal == 0);
+
+        // Subtrees shared with the reference map are not transferred, and
+        // are fetched from the family's node store when walked
+        int diffLocal = 0;
+        SHAMap diff (SHAMapType::FREE, f, SHAMap::version{1});
+        auto const diffCount = sync (*current, diff, &previous, diffLocal);
+        BEAST_EXPECT(diffCount > 0);
+        BEAST_EXPECT(diffCount * 10 < fullCount);
+        BEAST_EXPECT(diffLocal > 0);
+        f.treecache ().reset ();
+        BEAST_EXPECT(current->deepCompare (diff));
     }
 
     void run(SHAMap::version v, beast::Journal const& journal)
@@ -87,7 +166,7 @@ public:
         int items = 10000;
         for (int i = 0; i < items; ++i)
         {
-            source.addItem (std::move(*makeRandomAS ()), false, false);
+            source.addGiveItem (makeRandomAS (), false, false);
             if (i % 100 == 0)
                 source.invariants();
         }
@@ -4,9 +4,16 @@
 #include <ripple/basics/Blob.h>
 #include <ripple/basics/StringUtilities.h>
 #include <ripple/beast/unit_test.h>
+#include <ripple/beast/xor_shift_engine.h>
 #include <ripple/beast/utility/Journal.h>
+#include <ripple/protocol/digest.h>
+#include <ripple/protocol/HashPrefix.h>
 #include <test/shamap/common.h>
 #include <test/unit_test/SuiteJournal.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 namespace ripple {
 namespace tests {
@@ -35,10 +42,10 @@ static_assert( std::is_move_assignable      <SHAMap::const_iterator>{}, "");
 
 static_assert( std::is_nothrow_destructible <SHAMapItem>{}, "");
 static_assert(!std::is_default_constructible<SHAMapItem>{}, "");
-static_assert( std::is_copy_constructible   <SHAMapItem>{}, "");
-static_assert( std::is_copy_assignable      <SHAMapItem>{}, "");
-static_assert( std::is_move_constructible   <SHAMapItem>{}, "");
-static_assert( std::is_move_assignable      <SHAMapItem>{}, "");
+static_assert(!std::is_copy_constructible   <SHAMapItem>{}, "");
+static_assert(!std::is_copy_assignable      <SHAMapItem>{}, "");
+static_assert(!std::is_move_constructible   <SHAMapItem>{}, "");
+static_assert(!std::is_move_assignable      <SHAMapItem>{}, "");
 
 static_assert( std::is_nothrow_destructible <SHAMapNodeID>{}, "");
 static_assert( std::is_default_constructible<SHAMapNodeID>{}, "");
@@ -110,6 +117,170 @@ public:
         run (false, SHAMap::version{1}, journal);
         run (true,  SHAMap::version{2}, journal);
         run (false, SHAMap::version{2}, journal);
+
+        testInnerNode (journal);
+        testConcurrentDescend (journal);
+    }
+
+    void testInnerNode (beast::Journal const& journal)
+    {
+        testcase ("inner node layout");
+
+        std::array<std::shared_ptr<SHAMapAbstractNode>, 16> leaves;
+        for (int i = 0; i < 16; ++i)
+            leaves[i] = std::make_shared<SHAMapTreeNode> (
+                make_shamapitem (sha512Half (i), IntToVUC (i)),
+                    SHAMapTreeNode::tnACCOUNT_STATE, 1);
+
+        auto check = [&](SHAMapInnerNode& node, std::uint16_t present)
+        {
+            int count = 0;
+            for (int i = 0; i < 16; ++i)
+            {
+                bool const has = (present & (1 << i)) != 0;
+                BEAST_EXPECT(node.isEmptyBranch (i) == !has);
+                BEAST_EXPECT(node.getChild (i) == (has ? leaves[i] : nullptr));
+                if (has)
+                    ++count;
+            }
+            BEAST_EXPECT(node.getBranchCount () == count);
+            if (count == 0)
+                return;
+
+            node.updateHashDeep ();
+            sha512_half_hasher h;
+            using beast::hash_append;
+            hash_append (h, HashPrefix::innerNode);
+            for (int i = 0; i < 16; ++i)
+            {
+                auto const expected = (present & (1 << i)) ?
+                    leaves[i]->getNodeHash () : SHAMapHash{};
+                BEAST_EXPECT(node.getChildHash (i) == expected);
+                hash_append (h, expected);
+            }
+            BEAST_EXPECT(node.getNodeHash ().as_uint256 () ==
+                static_cast<sha512_half_hasher::result_type> (h));
+
+            for (auto const format : {snfWIRE, snfPREFIX})
+            {
+                Serializer s;
+                node.addRaw (s, format);
+                auto const copy = std::static_pointer_cast<SHAMapInnerNode> (
+                    SHAMapAbstractNode::make (s.slice (), 0, format,
+                        SHAMapHash{}, false, journal, SHAMapNodeID{}));
+                BEAST_EXPECT(copy->getNodeHash () == node.getNodeHash ());
+                for (int i = 0; i < 16; ++i)
+                    BEAST_EXPECT(copy->getChildHash (i) == node.getChildHash (i));
+            }
+
+            auto const clone = std::static_pointer_cast<SHAMapInnerNode> (
+                node.clone (2));
+            BEAST_EXPECT(clone->getNodeHash () == node.getNodeHash ());
+            for (int i = 0; i < 16; ++i)
+                BEAST_EXPECT(clone->getChild (i) == node.getChild (i));
+        };
+
+        beast::xor_shift_engine eng (19);
+        std::array<int, 16> order;
+        std::iota (order.begin (), order.end (), 0);
+
+        for (int round = 0; round < 8; ++round)
+        {
+            std::shuffle (order.begin (), order.end (), eng);
+            SHAMapInnerNode node (1);
+            std::uint16_t present = 0;
+            check (node, present);
+
+            for (auto const i : order)
+            {
+                node.setChild (i, leaves[i]);
+                present |= (1 << i);
+                check (node, present);
+            }
+
+            std::shuffle (order.begin (), order.end (), eng);
+            for (auto const i : order)
+            {
+                node.setChild (i, nullptr);
+                present &= ~(1 << i);
+                check (node, present);
+            }
+        }
+    }
+
+    void testConcurrentDescend (beast::Journal const& journal)
+    {
+        testcase ("concurrent descend backed");
+
+        tests::TestFamily tf{journal};
+
+        int const items = 5000;
+        std::size_t const threads = 8;
+
+        std::vector<uint256> keys;
+        SHAMapHash root;
+        {
+            SHAMap source{SHAMapType::FREE, tf, SHAMap::version{1}};
+            for (int i = 0; i < items; ++i)
+            {
+                keys.push_back (sha512Half (i));
+                source.addGiveItem (make_shamapitem (
+                    keys.back (), IntToVUC (i)), false, false);
+            }
+            source.flushDirty (hotACCOUNT_NODE, 1);
+            root = source.getHash ();
+        }
+
+        // Only the root is loaded: every other node comes from the
+        // database while the threads below race to publish it.
+        tf.treecache ().reset ();
+        SHAMap map{SHAMapType::FREE, tf, SHAMap::version{1}};
+        BEAST_EXPECT(map.fetchRoot (root, nullptr));
+
+        std::vector<std::vector<SHAMapItem const*>> seen (threads);
+        std::atomic<bool> start {false};
+        std::vector<std::thread> workers;
+        for (std::size_t t = 0; t < threads; ++t)
+        {
+            workers.emplace_back (
+                [&, t]
+                {
+                    auto& mine = seen[t];
+                    mine.resize (items);
+                    while (! start)
+                        std::this_thread::yield ();
+                    for (std::size_t k = 0; k < items; ++k)
+                    {
+                        auto const i = (k * (t + 1) + t * items / threads)
+                            % items;
+                        mine[i] = map.peekItem (keys[i]).get ();
+                    }
+                });
+        }
+        start = true;
+        for (auto& w : workers)
+            w.join ();
+
+        std::size_t mismatched = 0;
+        for (std::size_t i = 0; i < items; ++i)
+        {
+            BEAST_EXPECT(seen[0][i] && seen[0][i]->key () == keys[i]);
+            for (std::size_t t = 1; t < threads; ++t)
+            {
+                if (seen[t][i] != seen[0][i])
+                    ++mismatched;
+            }
+        }
+        BEAST_EXPECT(mismatched == 0);
+
+        std::size_t walked = 0;
+        for (auto const& item : map)
+        {
+            (void)item;
+            ++walked;
+        }
+        BEAST_EXPECT(walked == items);
+        map.invariants ();
     }
 
     void run (bool backed, SHAMap::version v, beast::Journal const& journal)
@@ -133,32 +304,32 @@ public:
         if (! backed)
             sMap.setUnbacked ();
 
-        SHAMapItem i1 (h1, IntToVUC (1)), i2 (h2, IntToVUC (2)), i3 (h3, IntToVUC (3)), i4 (h4, IntToVUC (4)), i5 (h5, IntToVUC (5));
-        unexpected (!sMap.addItem (SHAMapItem{i2}, true, false), "no add");
+        auto i1 = make_shamapitem (h1, IntToVUC (1)), i2 = make_shamapitem (h2, IntToVUC (2)), i3 = make_shamapitem (h3, IntToVUC (3)), i4 = make_shamapitem (h4, IntToVUC (4)), i5 = make_shamapitem (h5, IntToVUC (5));
+        unexpected (!sMap.addGiveItem (i2, true, false), "no add");
         sMap.invariants();
-        unexpected (!sMap.addItem (SHAMapItem{i1}, true, false), "no add");
+        unexpected (!sMap.addGiveItem (i1, true, false), "no add");
         sMap.invariants();
 
         auto i = sMap.begin();
         auto e = sMap.end();
-        unexpected (i == e || (*i != i1), "bad traverse");
+        unexpected (i == e || (*i != *i1), "bad traverse");
         ++i;
-        unexpected (i == e || (*i != i2), "bad traverse");
+        unexpected (i == e || (*i != *i2), "bad traverse");
         ++i;
         unexpected (i != e, "bad traverse");
-        sMap.addItem (SHAMapItem{i4}, true, false);
+        sMap.addGiveItem (i4, true, false);
         sMap.invariants();
-        sMap.delItem (i2.key());
+        sMap.delItem (i2->key());
         sMap.invariants();
-        sMap.addItem (SHAMapItem{i3}, true, false);
+        sMap.addGiveItem (i3, true, false);
         sMap.invariants();
         i = sMap.begin();
         e = sMap.end();
-        unexpected (i == e || (*i != i1), "bad traverse");
+        unexpected (i == e || (*i != *i1), "bad traverse");
         ++i;
-        unexpected (i == e || (*i != i3), "bad traverse");
+        unexpected (i == e || (*i != *i3), "bad traverse");
         ++i;
-        unexpected (i == e || (*i != i4), "bad traverse");
+        unexpected (i == e || (*i != *i4), "bad traverse");
         ++i;
         unexpected (i != e, "bad traverse");
 
@@ -238,8 +409,8 @@ public:
             BEAST_EXPECT(map.getHash() == beast::zero);
             for (int k = 0; k < keys.size(); ++k)
             {
-                SHAMapItem item (keys[k], IntToVUC (k));
-                BEAST_EXPECT(map.addItem (std::move(item), true, false));
+                BEAST_EXPECT(map.addGiveItem (
+                    make_shamapitem (keys[k], IntToVUC (k)), true, false));
                 BEAST_EXPECT(map.getHash().as_uint256() == hashes[k]);
                 map.invariants();
             }
@@ -292,7 +463,7 @@ public:
                 map.setUnbacked ();
             for (auto const& k : keys)
             {
-                map.addItem(SHAMapItem{k, IntToVUC(0)}, true, false);
+                map.addGiveItem(make_shamapitem(k, IntToVUC(0)), true, false);
                 map.invariants();
             }
 
@@ -303,11 +474,160 @@ public:
                 --h;
             }
         }
+
+        if (backed)
+            testcase ("parallel flush backed");
+        else
+            testcase ("parallel flush unbacked");
+
+        {
+            tests::TestFamily tf{journal};
+            SHAMap serial{SHAMapType::FREE, tf, v};
+            SHAMap parallel{SHAMapType::FREE, tf, v};
+            if (! backed)
+            {
+                serial.setUnbacked ();
+                parallel.setUnbacked ();
+            }
+
+            std::vector<std::thread> helpers;
+            auto const schedule = [&helpers](std::function<void()> f)
+            {
+                helpers.emplace_back (std::move (f));
+                return true;
+            };
+            auto const joinHelpers = [&helpers]
+            {
+                for (auto& h : helpers)
+                    h.join ();
+                helpers.clear ();
+            };
+
+            std::vector<uint256> keys;
+            for (int i = 0; i < 2000; ++i)
+            {
+                keys.push_back (sha512Half (i));
+                serial.addGiveItem (make_shamapitem (keys.back(), IntToVUC(i)), true, false);
+                parallel.addGiveItem (make_shamapitem (keys.back(), IntToVUC(i)), true, false);
+            }
+
+            auto const flushed = serial.flushDirty (hotACCOUNT_NODE, 1);
+            BEAST_EXPECT(flushed > 2000);
+            BEAST_EXPECT(parallel.flushDirty (
+                hotACCOUNT_NODE, 1, 3, schedule) == flushed);
+            joinHelpers ();
+            BEAST_EXPECT(serial.getHash() == parallel.getHash());
+            parallel.invariants();
+
+            for (int i = 0; i < 2000; i += 7)
+            {
+                BEAST_EXPECT(serial.delItem (keys[i]));
+                BEAST_EXPECT(parallel.delItem (keys[i]));
+            }
+            BEAST_EXPECT(serial.flushDirty (hotACCOUNT_NODE, 2) ==
+                parallel.flushDirty (hotACCOUNT_NODE, 2, 3, schedule));
+            joinHelpers ();
+            BEAST_EXPECT(serial.getHash() == parallel.getHash());
+            parallel.invariants();
+        }
     }
 };
 
 BEAST_DEFINE_TESTSUITE(SHAMap,ripple_app,ripple);
 
+// Measures how traversal of one shared map scales with the number of
+// threads. Each round loads a fresh map from the root, so the first walk
+// in every thread races to publish the children it fetches.
+class SHAMapTraversal_test : public beast::unit_test::suite
+{
+public:
+    std::chrono::milliseconds
+    measure (SHAMap const& map, std::vector<uint256> const& keys,
+        std::size_t threads, int walks)
+    {
+        std::atomic<bool> start {false};
+        std::atomic<std::size_t> visited {0};
+        std::vector<std::thread> workers;
+        workers.reserve (threads);
+        for (std::size_t i = 0; i < threads; ++i)
+        {
+            workers.emplace_back (
+                [&, seed = i + 1]
+                {
+                    beast::xor_shift_engine rng (seed);
+                    std::size_t n = 0;
+                    while (! start)
+                        std::this_thread::yield ();
+                    for (int w = 0; w < walks; ++w)
+                    {
+                        for (auto const& item : map)
+                        {
+                            (void)item;
+                            ++n;
+                        }
+                        for (std::size_t k = 0; k < keys.size (); ++k)
+                        {
+                            if (map.hasItem (keys[rng () % keys.size ()]))
+                                ++n;
+                        }
+                    }
+                    visited += n;
+                });
+        }
+
+        using namespace std::chrono;
+        auto const before = steady_clock::now ();
+        start = true;
+        for (auto& t : workers)
+            t.join ();
+        auto const elapsed =
+            duration_cast<milliseconds> (steady_clock::now () - before);
+
+        BEAST_EXPECT(visited == 2 * threads * walks * keys.size ());
+        return elapsed;
+    }
+
+    void run () override
+    {
+        test::SuiteJournal journal ("SHAMapTraversal_test", *this);
+        tests::TestFamily tf{journal};
+
+        int const items = 100000;
+        int const walks = 10;
+        std::size_t const maxThreads =
+            std::max (2u, std::thread::hardware_concurrency ());
+
+        std::vector<uint256> keys;
+        keys.reserve (items);
+        SHAMapHash root;
+        {
+            SHAMap source{SHAMapType::FREE, tf, SHAMap::version{1}};
+            for (int i = 0; i < items; ++i)
+            {
+                keys.push_back (sha512Half (i));
+                source.addGiveItem (make_shamapitem (
+                    keys.back (), SHAMap_test::IntToVUC (i)), false, false);
+            }
+            source.flushDirty (hotACCOUNT_NODE, 1);
+            root = source.getHash ();
+        }
+
+        for (std::size_t threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            tf.treecache ().reset ();
+            SHAMap map{SHAMapType::FREE, tf, SHAMap::version{1}};
+            if (! BEAST_EXPECT(map.fetchRoot (root, nullptr)))
+                return;
+
+            auto const t = measure (map, keys, threads, walks);
+            log << threads << " threads, " << walks << " walks/thread: " <<
+                t.count () << "ms" << std::endl;
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(SHAMapTraversal,ripple_app,ripple);
+
 } 
 } 
 
@@ -1,6 +1,7 @@
 
 
 
+#include <test/app/AccountTxLog_test.cpp>
 #include <test/app/AccountTxPaging_test.cpp>
 #include <test/app/AmendmentTable_test.cpp>
 #include <test/app/Check_test.cpp>
@@ -12,6 +13,7 @@
 #include <test/app/Flow_test.cpp>
 #include <test/app/Freeze_test.cpp>
 #include <test/app/HashRouter_test.cpp>
+#include <test/app/LedgerDBWriter_test.cpp>
 #include <test/app/LedgerHistory_test.cpp>
 #include <test/app/LedgerLoad_test.cpp>
 #include <test/app/LedgerReplay_test.cpp>
@@ -20,6 +22,7 @@
 #include <test/app/MultiSign_test.cpp>
 #include <test/app/OfferStream_test.cpp>
 #include <test/app/Offer_test.cpp>
+#include <test/app/OrderBookDB_test.cpp>
 #include <test/app/OversizeMeta_test.cpp>
 
 #include <test/unit_test/multi_runner.cpp>
@@ -8,10 +8,12 @@
 #include <test/app/RCLCensorshipDetector_test.cpp>
 #include <test/app/RCLValidations_test.cpp>
 #include <test/app/Regression_test.cpp>
+#include <test/app/RippleLineCache_test.cpp>
 #include <test/app/SetAuth_test.cpp>
 #include <test/app/SetRegularKey_test.cpp>
 #include <test/app/SetTrust_test.cpp>
 #include <test/app/SHAMapStore_test.cpp>
+#include <test/app/SignatureBatch_test.cpp>
 #include <test/app/Taker_test.cpp>
 #include <test/app/Ticket_test.cpp>
 #include <test/app/Transaction_ordering_test.cpp>
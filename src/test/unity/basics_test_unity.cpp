@@ -9,10 +9,13 @@
 #include <test/basics/FileUtilities_test.cpp>
 #include <test/basics/hardened_hash_test.cpp>
 #include <test/basics/KeyCache_test.cpp>
+#include <test/basics/Log_test.cpp>
+#include <test/basics/MemoryGovernor_test.cpp>
 #include <test/basics/mulDiv_test.cpp>
 #include <test/basics/PerfLog_test.cpp>
 #include <test/basics/qalloc_test.cpp>
 #include <test/basics/RangeSet_test.cpp>
+#include <test/basics/SlabAllocator_test.cpp>
 #include <test/basics/Slice_test.cpp>
 #include <test/basics/StringUtilities_test.cpp>
 #include <test/basics/TaggedCache_test.cpp>
@@ -5,6 +5,8 @@
 #include <test/nodestore/Basics_test.cpp>
 #include <test/nodestore/Database_test.cpp>
 #include <test/nodestore/import_test.cpp>
+#include <test/nodestore/ShardMap_test.cpp>
+#include <test/nodestore/Shard_test.cpp>
 #include <test/nodestore/Timing_test.cpp>
 #include <test/nodestore/varint_test.cpp>
 
@@ -2,6 +2,9 @@
 
 
 #include <test/overlay/cluster_test.cpp>
+#include <test/overlay/compression_test.cpp>
+#include <test/overlay/reduce_relay_test.cpp>
+#include <test/overlay/send_queue_test.cpp>
 #include <test/overlay/short_read_test.cpp>
 #include <test/overlay/TMHello_test.cpp>
 